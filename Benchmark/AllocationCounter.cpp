@@ -0,0 +1,37 @@
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+Replacement of the global operator new and delete that counts the allocations of the whole benchmark process,
+including the communication threads. The array and nothrow forms of the standard library forward to these.
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+static std::atomic<uint64_t> AllocationCount{0};
+
+uint64_t GetAllocationCount()
+{
+    return AllocationCount.load(std::memory_order_relaxed);
+}
+
+void *operator new(std::size_t Size)
+{
+    AllocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(Size ? Size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+#include <cstdint>
+
+// number of calls to the global operator new since the start of the process, see AllocationCounter.cpp
+uint64_t GetAllocationCount();
@@ -0,0 +1,879 @@
+#include "MicroBenchmarks.h"
+#include "AllocationCounter.h"
+
+#include "../Leica.LMF/MeasurementQueue.h"
+#include "../Libraries/TCP/FrameTiming.h"
+#include "../Libraries/TCP/Message.h"
+#include "../Libraries/TCP/TCPTelegram.h"
+#include "../Libraries/Utility/OrientationKernels.h"
+#include "../Libraries/Utility/baseUnits.h"
+#include "../Libraries/Utility/Print.h"
+#include "../Libraries/XML/ProxyKeywords.h"
+#include "../Libraries/XML/TinyXML_AttributeValues.h"
+#include "../Libraries/XML/TinyXML_Base64.h"
+#include "../Libraries/XML/TinyXML_Extra.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <random>
+#include <thread>
+
+using Clock = std::chrono::steady_clock;
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+Runner
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+void CMicroBenchmarks::Register(const std::string &Name, Function Benchmark, size_t BytesPerOp)
+{
+    m_Benchmarks.push_back({Name, std::move(Benchmark), BytesPerOp});
+}
+
+std::vector<nlohmann::json> CMicroBenchmarks::Run(const MicroBenchmarkOptions &Options) const
+{
+    auto Time = [](const Function &Benchmark, uint64_t Iterations)
+    {
+        auto Start = Clock::now();
+        Benchmark(Iterations);
+        return std::chrono::duration<double>(Clock::now() - Start).count();
+    };
+
+    std::vector<nlohmann::json> Results;
+    for (const Entry &entry : m_Benchmarks)
+    {
+        if (!Options.Filter.empty() && entry.Name.find(Options.Filter) == std::string::npos)
+            continue;
+
+        // batch size, the first call also warms up the caches
+        uint64_t Iterations = 1;
+        while (Time(entry.Benchmark, Iterations) < Options.MinTimeSeconds && Iterations < (uint64_t(1) << 40))
+            Iterations *= 2;
+
+        std::vector<double> NsPerOp;
+        uint64_t            AllocStart = GetAllocationCount();
+        for (size_t r = 0; r < std::max<size_t>(Options.Repetitions, 1); r++)
+            NsPerOp.push_back(Time(entry.Benchmark, Iterations) * 1e9 / Iterations);
+        double AllocationsPerOp = static_cast<double>(GetAllocationCount() - AllocStart) / (Iterations * NsPerOp.size());
+
+        std::sort(NsPerOp.begin(), NsPerOp.end());
+        double Median = NsPerOp[NsPerOp.size() / 2];
+
+        nlohmann::json Record = {{"name", entry.Name},
+                                 {"label", Options.Label},
+                                 {"iterations", Iterations},
+                                 {"ns_per_op", Median},
+                                 {"ns_per_op_min", NsPerOp.front()},
+                                 {"allocations_per_op", AllocationsPerOp}};
+        if (entry.BytesPerOp > 0)
+            Record["mb_per_s"] = entry.BytesPerOp / Median * 1e3;
+        PrintInfo("{:<48} {:>12.1f} ns {:>8.2f} allocs", entry.Name, Median, AllocationsPerOp);
+        Results.push_back(std::move(Record));
+    }
+    return Results;
+}
+
+size_t CMicroBenchmarks::CompareBaseline(const std::vector<nlohmann::json> &Results, const std::string &BaselineFile, double Tolerance)
+{
+    std::ifstream File(BaselineFile);
+    if (!File)
+    {
+        PrintError("Baseline {} could not be opened", BaselineFile);
+        return 0;
+    }
+    std::map<std::string, nlohmann::json> Baseline; // last record of every name
+    std::string                           Line;
+    while (std::getline(File, Line))
+    {
+        nlohmann::json Record = nlohmann::json::parse(Line, nullptr, false);
+        if (Record.is_object() && Record.contains("name") && Record.contains("ns_per_op"))
+            Baseline[Record["name"].get<std::string>()] = std::move(Record);
+    }
+
+    size_t Regressions = 0;
+    for (const auto &Result : Results)
+    {
+        auto Match = Baseline.find(Result["name"].get<std::string>());
+        if (Match == Baseline.end())
+            continue;
+        double BaseNs = Match->second["ns_per_op"].get<double>();
+        double Ns     = Result["ns_per_op"].get<double>();
+        std::string Line = fmt::format("{} : {:.1f} -> {:.1f} ns ({:+.1f}%) vs {}", Match->first, BaseNs, Ns, (Ns / BaseNs - 1.0) * 100.0,
+                                       Match->second.value("label", std::string()));
+        if (BaseNs > 0.0 && Ns > BaseNs * (1.0 + Tolerance))
+        {
+            PrintError("REGRESSION {}", Line);
+            Regressions++;
+        }
+        else
+            PrintInfo("{}", Line);
+    }
+    return Regressions;
+}
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+Payloads, the sizes of a large system : 8 cameras, 20 rigid bodies, 100 markers, 301 channels
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+static std::vector<std::string> Names(const std::string &Prefix, size_t Count)
+{
+    std::vector<std::string> Result;
+    for (size_t i = 0; i < Count; i++)
+        Result.push_back(fmt::format("{}{}", Prefix, i + 1));
+    return Result;
+}
+
+static std::vector<std::vector<double>> Matrix4x4(double X)
+{
+    return {{1.0, 0.0, 0.0, X}, {0.0, 1.0, 0.0, 0.0}, {0.0, 0.0, 1.0, 0.0}, {0.0, 0.0, 0.0, 1.0}};
+}
+
+static CTrack::Message HardwareDetectReply()
+{
+    CTrack::Message                               message(TAG_COMMAND_HARDWAREDETECT);
+    std::vector<std::vector<std::vector<double>>> cameraPositions;
+    for (int i = 0; i < 8; i++)
+        cameraPositions.push_back(Matrix4x4(1000.0 * i));
+    message.GetParams()[ATTRIB_HARDWAREDETECT_PRESENT]     = true;
+    message.GetParams()[ATTRIB_HARDWAREDETECT_SERIAL]      = "123456789";
+    message.GetParams()[ATTRIB_HARDWAREDETECT_FEEDBACK]    = "Found 8 cameras";
+    message.GetParams()[ATTRIB_HARDWAREDETECT_NAMES]       = Names("Camera", 8);
+    message.GetParams()[ATTRIB_HARDWAREDETECT_SERIALS]     = Names("SN", 8);
+    message.GetParams()[ATTRIB_HARDWAREDETECT_IPADDRESSES] = std::vector<std::string>(8, "192.168.10.100");
+    message.GetParams()[ATTRIB_HARDWAREDETECT_IPPORTS]     = std::vector<int>(8, 5000);
+    message.GetParams()[ATTRIB_HARDWAREDETECT_POS4x4]      = cameraPositions;
+    message.GetParams()[ATTRIB_RESULT]                     = true;
+    return message;
+}
+
+static CTrack::Message ConfigDetectReply()
+{
+    CTrack::Message message(TAG_COMMAND_CONFIGDETECT);
+    for (const auto &Body : Names("6dof", 20))
+    {
+        message.GetParams()[ATTRIB_6DOF][Body][ATTRIB_CONFIG_ORIENT_CONVENTION] = "3x3";
+        message.GetParams()[ATTRIB_6DOF][Body][ATTRIB_CONFIG_RESIDU]            = false;
+        message.GetParams()[ATTRIB_6DOF][Body][ATTRIB_CONFIG_3DMARKERS]         = Names(Body + "_", 4);
+    }
+    message.GetParams()[ATTRIB_PROBES]["probe"][ATTRIB_CONFIG_ORIENT_CONVENTION] = "3x3";
+    message.GetParams()[ATTRIB_PROBES]["probe"][ATTRIB_PROBE_NUMBUTTONS]         = 4;
+    message.GetParams()[ATTRIB_PROBES]["probe"][ATTRIB_CONFIG_RESIDU]            = false;
+    message.GetParams()[ATTRIB_PROBES]["probe"][ATTRIB_CONFIG_3DMARKERS]         = Names("probe", 4);
+    message.GetParams()[ATTRIB_CONFIG_3DMARKERS]                                 = Names("marker", 100);
+    return message;
+}
+
+static CTrack::Message CheckInitRequest()
+{
+    CTrack::Message  message(TAG_COMMAND_CHECKINIT);
+    std::vector<int> Types(301, 1);
+    std::vector<int> Indices;
+    Types[0] = 0;
+    for (int i = 0; i < 100; i++)
+        Indices.push_back(1 + 3 * i);
+    message.GetParams()[ATTRIB_CHECKINIT_MEASFREQ]     = 100.0;
+    message.GetParams()[ATTRIB_CHECKINIT_CHANNELNAMES] = Names("channel", 301);
+    message.GetParams()[ATTRIB_CHECKINIT_CHANNELTYPES] = Types;
+    message.GetParams()[ATTRIB_CHECKINIT_3DNAMES]      = Names("marker", 100);
+    message.GetParams()[ATTRIB_CHECKINIT_3DINDICES]    = Indices;
+    return message;
+}
+
+static std::vector<double> Doubles(size_t Count)
+{
+    std::vector<double> Values(Count);
+    for (size_t i = 0; i < Count; i++)
+        Values[i] = 1234.5678 + 0.001 * i;
+    return Values;
+}
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+Serialization benchmarks
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+void CMicroBenchmarks::RegisterSerialization()
+{
+    // data telegrams measure the plain format, without the timestamp trailer
+    CTrack::FrameTiming::SetTrailerEnabled(false);
+
+    for (size_t NumChannels : {10, 301, 10000})
+    {
+        size_t Bytes = NumChannels * sizeof(double);
+        Register(fmt::format("tcpgram.encode_double_array/{}", NumChannels),
+                 [Values = Doubles(NumChannels)](uint64_t Iterations) mutable
+                 {
+                     for (uint64_t i = 0; i < Iterations; i++)
+                     {
+                         CTCPGram TCPGram(Values);
+                         DoNotOptimize(TCPGram);
+                     }
+                 },
+                 Bytes);
+
+        std::vector<double> Values  = Doubles(NumChannels);
+        auto                Encoded = std::make_shared<CTCPGram>(Values);
+        Register(fmt::format("tcpgram.get_double_array/{}", NumChannels),
+                 [Encoded](uint64_t Iterations)
+                 {
+                     std::vector<double> Values;
+                     for (uint64_t i = 0; i < Iterations; i++)
+                     {
+                         Encoded->GetDoubleArray(Values);
+                         DoNotOptimize(Values);
+                     }
+                 },
+                 Bytes);
+        Register(fmt::format("tcpgram.get_double_que/{}", NumChannels),
+                 [Encoded](uint64_t Iterations)
+                 {
+                     std::deque<double> Values;
+                     for (uint64_t i = 0; i < Iterations; i++)
+                     {
+                         Encoded->GetDoubleQue(Values);
+                         DoNotOptimize(Values);
+                     }
+                 },
+                 Bytes);
+    }
+
+    std::vector<std::pair<const char *, CTrack::Message>> Payloads = {
+        {"hardware_detect", HardwareDetectReply()}, {"config_detect", ConfigDetectReply()}, {"check_init", CheckInitRequest()}};
+    for (auto &[Name, Payload] : Payloads)
+    {
+        std::string Text = Payload.Serialize();
+        Register(fmt::format("message.serialize/{}", Name),
+                 [Payload = Payload](uint64_t Iterations)
+                 {
+                     for (uint64_t i = 0; i < Iterations; i++)
+                     {
+                         std::string Text = Payload.Serialize();
+                         DoNotOptimize(Text);
+                     }
+                 },
+                 Text.size());
+        Register(fmt::format("message.deserialize/{}", Name),
+                 [Text](uint64_t Iterations)
+                 {
+                     for (uint64_t i = 0; i < Iterations; i++)
+                     {
+                         CTrack::Message Message = CTrack::Message::Deserialize(Text);
+                         DoNotOptimize(Message);
+                     }
+                 },
+                 Text.size());
+        Register(fmt::format("tcpgram.message_roundtrip/{}", Name),
+                 [Payload = Payload](uint64_t Iterations)
+                 {
+                     CTrack::Message Received;
+                     for (uint64_t i = 0; i < Iterations; i++)
+                     {
+                         CTCPGram TCPGram(Payload);
+                         TCPGram.GetMessage(Received);
+                         DoNotOptimize(Received);
+                     }
+                 },
+                 Text.size());
+    }
+
+    // a 1 MB blob in the XML of a message, base64 in the attribute against an attachment of the message
+    auto Blob = std::make_shared<std::vector<char>>(1 << 20);
+    for (size_t i = 0; i < Blob->size(); i++)
+        (*Blob)[i] = static_cast<char>(i * 31);
+    Register("tcpgram.blob_roundtrip/1MB/base64",
+             [Blob](uint64_t Iterations)
+             {
+                 const int Length = static_cast<int>(Blob->size());
+                 for (uint64_t i = 0; i < Iterations; i++)
+                 {
+                     TiXmlElement          Calibration("Calibration");
+                     std::unique_ptr<char> pBuffer(new char[Length]);
+                     memcpy(pBuffer.get(), Blob->data(), Length);
+                     GetSetAttributeBinary(&Calibration, "data", pBuffer, Length, XML_WRITE);
+                     CTrack::Message Sent(MSG_ENGINE_CONFIG);
+                     Sent.GetParams()[PARAM_XML] = XMLToString(&Calibration);
+
+                     CTCPGram        TCPGram(Sent);
+                     CTrack::Message Received;
+                     TCPGram.GetMessage(Received);
+                     TiXmlDocument         Document;
+                     TiXmlElement         *pXML = StringToXML(Received.GetParams()[PARAM_XML].get<std::string>(), Document);
+                     std::unique_ptr<char> pRead;
+                     GetSetAttributeBinary(pXML, "data", pRead, Length, XML_READ);
+                     DoNotOptimize(pRead);
+                 }
+             },
+             Blob->size());
+    Register("tcpgram.blob_roundtrip/1MB/attachment",
+             [Blob](uint64_t Iterations)
+             {
+                 for (uint64_t i = 0; i < Iterations; i++)
+                 {
+                     TiXmlElement    Calibration("Calibration");
+                     CTrack::Message Sent(MSG_ENGINE_CONFIG);
+                     GetSetAttributeAttachment(&Calibration, "data", *Blob, Sent, XML_WRITE);
+                     Sent.GetParams()[PARAM_XML] = XMLToString(&Calibration);
+
+                     CTCPGram        TCPGram(Sent);
+                     CTrack::Message Received;
+                     TCPGram.GetMessage(Received);
+                     TiXmlDocument     Document;
+                     TiXmlElement     *pXML = StringToXML(Received.GetParams()[PARAM_XML].get<std::string>(), Document);
+                     std::vector<char> Read;
+                     GetSetAttributeAttachment(pXML, "data", Read, Received, XML_READ);
+                     DoNotOptimize(Read);
+                 }
+             },
+             Blob->size());
+
+    // the base64 codec on the same blob, the iterator templates against the SIMD buffer functions
+    std::string BlobText;
+    base64::Encode(Blob->data(), Blob->size(), BlobText);
+    Register("base64.encode/1MB/template",
+             [Blob](uint64_t Iterations)
+             {
+                 for (uint64_t i = 0; i < Iterations; i++)
+                 {
+                     std::string Text;
+                     base64::encode(Blob->begin(), Blob->end(), back_inserter(Text));
+                     DoNotOptimize(Text);
+                 }
+             },
+             Blob->size());
+    Register("base64.encode/1MB/simd",
+             [Blob](uint64_t Iterations)
+             {
+                 std::string Text;
+                 for (uint64_t i = 0; i < Iterations; i++)
+                 {
+                     base64::Encode(Blob->data(), Blob->size(), Text);
+                     DoNotOptimize(Text);
+                 }
+             },
+             Blob->size());
+    Register("base64.decode/1MB/template",
+             [BlobText](uint64_t Iterations)
+             {
+                 for (uint64_t i = 0; i < Iterations; i++)
+                 {
+                     std::vector<char> Bytes;
+                     base64::decode(BlobText.begin(), BlobText.end(), back_inserter(Bytes));
+                     DoNotOptimize(Bytes);
+                 }
+             },
+             Blob->size());
+    Register("base64.decode/1MB/simd",
+             [BlobText](uint64_t Iterations)
+             {
+                 std::vector<char> Bytes;
+                 for (uint64_t i = 0; i < Iterations; i++)
+                 {
+                     base64::Decode(BlobText.data(), BlobText.size(), Bytes);
+                     DoNotOptimize(Bytes);
+                 }
+             },
+             Blob->size());
+
+    // legacy codes are converted to json messages by the constructors
+    std::string  CommandText = "<Command Name=\"StartTracking\" Frequency=\"100\"><Channels>" + std::string(2000, 'x') + "</Channels></Command>";
+    TiXmlDocument Document;
+    TiXmlElement *pCommand = StringToXML(CommandText, Document);
+    Register("tcpgram.legacy_string/command",
+             [CommandText](uint64_t Iterations)
+             {
+                 for (uint64_t i = 0; i < Iterations; i++)
+                 {
+                     CTCPGram TCPGram(CommandText, TCPGRAM_CODE_COMMAND);
+                     DoNotOptimize(TCPGram);
+                 }
+             },
+             CommandText.size());
+    if (pCommand)
+    {
+        auto pElement = std::shared_ptr<TiXmlElement>(static_cast<TiXmlElement *>(pCommand->Clone()));
+        Register("tcpgram.legacy_xml/command",
+                 [pElement](uint64_t Iterations)
+                 {
+                     for (uint64_t i = 0; i < Iterations; i++)
+                     {
+                         CTCPGram TCPGram(*pElement, TCPGRAM_CODE_COMMAND);
+                         DoNotOptimize(TCPGram);
+                     }
+                 },
+                 CommandText.size());
+    }
+
+    // TinyXML_Extra text helpers
+    std::vector<double> Array = Doubles(1000);
+    std::string         ArrayText;
+    DoubleArrayToText(Array, ArrayText);
+    Register("xml.text_to_double_array/1000",
+             [ArrayText](uint64_t Iterations)
+             {
+                 std::vector<double> Values;
+                 for (uint64_t i = 0; i < Iterations; i++)
+                 {
+                     TextToDoubleArray(Values, ArrayText);
+                     DoNotOptimize(Values);
+                 }
+             },
+             ArrayText.size());
+
+    std::vector<std::vector<double>> Matrix(100, std::vector<double>{1.25, -2.5, 3.75});
+    std::string                      MatrixText;
+    MatrixToText(Matrix, MatrixText);
+    Register("xml.text_to_matrix/100x3",
+             [MatrixText](uint64_t Iterations)
+             {
+                 std::vector<std::vector<double>> Values;
+                 for (uint64_t i = 0; i < Iterations; i++)
+                 {
+                     TextToMatrix(Values, MatrixText);
+                     DoNotOptimize(Values);
+                 }
+             },
+             MatrixText.size());
+
+    std::vector<std::vector<std::vector<double>>> Matrices;
+    for (int i = 0; i < 20; i++)
+        Matrices.push_back(Matrix4x4(100.0 * i));
+    std::string MatricesText;
+    MatrixArrayToText(Matrices, MatricesText);
+    Register("xml.matrix_array_to_text/20x4x4",
+             [Matrices](uint64_t Iterations)
+             {
+                 std::string Text;
+                 for (uint64_t i = 0; i < Iterations; i++)
+                 {
+                     MatrixArrayToText(Matrices, Text);
+                     DoNotOptimize(Text);
+                 }
+             },
+             MatricesText.size());
+    Register("xml.text_to_matrix_array/20x4x4",
+             [MatricesText](uint64_t Iterations)
+             {
+                 std::vector<std::vector<std::vector<double>>> Values;
+                 for (uint64_t i = 0; i < Iterations; i++)
+                 {
+                     TextToMatrixArray(Values, MatricesText);
+                     DoNotOptimize(Values);
+                 }
+             },
+             MatricesText.size());
+
+    // an engine configuration : 301 channels with their attributes and the matrices as element text
+    std::string ConfigText = "<Config Name=\"engine\" Frequency=\"100\">";
+    for (const auto &Name : Names("channel", 301))
+        ConfigText += fmt::format("<Channel Name=\"{}\" Type=\"1\" Unit=\"mm\" Decimals=\"3\"/>", Name);
+    ConfigText += "<Matrices>" + MatricesText + "</Matrices><Matrix>" + MatrixText + "</Matrix></Config>";
+    Register("xml.parse/config",
+             [ConfigText](uint64_t Iterations)
+             {
+                 for (uint64_t i = 0; i < Iterations; i++)
+                 {
+                     TiXmlDocument Document;
+                     DoNotOptimize(StringToXML(ConfigText, Document));
+                 }
+             },
+             ConfigText.size());
+
+    // path lookups of the last channel of 301, walked every time against the path index
+    auto        pTree       = std::make_shared<TiXmlElement>("Engine");
+    std::string ChannelPath = "Setup\\Channels\\channel301";
+    for (const auto &Name : Names("channel", 301))
+        CreateElement(pTree.get(), "Setup\\Channels\\" + Name);
+    Register("xml.find_element/3x301/walk",
+             [pTree, ChannelPath](uint64_t Iterations)
+             {
+                 for (uint64_t i = 0; i < Iterations; i++)
+                     DoNotOptimize(FindElement(pTree.get(), ChannelPath));
+             });
+    Register("xml.find_element/3x301/index",
+             [pTree, ChannelPath](uint64_t Iterations)
+             {
+                 CXMLPathIndex Index(pTree.get());
+                 for (uint64_t i = 0; i < Iterations; i++)
+                     DoNotOptimize(Index.FindElement(ChannelPath));
+             });
+}
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+Orientation conversions, 100 frames of 20 rigid bodies per operation
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+static std::vector<std::pair<std::string, std::shared_ptr<COrientation>>> Orientations()
+{
+    return {{"roll_pitch_yaw", std::make_shared<COrientationRollPitchYaw>()},
+            {"steer_camber_spin", std::make_shared<COrientationSteerCamberSpin>()},
+            {"skrew", std::make_shared<COrientationSkrew>()},
+            {"kuka_abc", std::make_shared<COrientationKukaABC>()},
+            {"quaternion", std::make_shared<COrientationQuaternion>()},
+            {"z_vector", std::make_shared<COrientationZVector>()}};
+}
+
+// rotations turning a few times around every axis, with the poses the conversions handle apart every 10th frame :
+// no rotation, gimbal lock and a half turn. The channels are random values, the T4x4 columns 3 a translation.
+static CPoseBatch Poses(size_t NumFrames, size_t NumSeries)
+{
+    CPoseBatch                             Batch;
+    COrientationRollPitchYaw               RollPitchYaw;
+    std::mt19937                           Random(12345);
+    std::uniform_real_distribution<double> Value(-4.0, 4.0);
+
+    Batch.Resize(NumFrames * NumSeries, NumSeries);
+    for (size_t Frame = 0; Frame < NumFrames; Frame++)
+    {
+        for (size_t Series = 0; Series < NumSeries; Series++)
+        {
+            size_t i         = Frame * NumSeries + Series;
+            double Angles[3] = {0.13 * Frame * (Series + 1), 0.5 * sin(0.07 * Frame) + 0.1 * Series, -0.21 * Frame + Series};
+            switch (Frame % 10)
+            {
+            case 3: Angles[0] = Angles[1] = Angles[2] = 0.0; break;
+            case 6: Angles[1] = (Series % 2 ? -PI : PI) / 2.0; break;
+            case 9: Angles[0] = PI, Angles[1] = Angles[2] = 0.0; break;
+            }
+            double T4x4[16] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, Value(Random), Value(Random), Value(Random), 1.0};
+            RollPitchYaw.ToT4x4(Angles, T4x4);
+            Batch.SetT4x4(i, T4x4);
+
+            double Channels[CPoseBatch::MAX_CHANNELS];
+            for (double &Channel : Channels)
+                Channel = Frame % 10 == 3 ? 0.0 : Value(Random);
+            Batch.SetAngles(i, Channels, CPoseBatch::MAX_CHANNELS);
+        }
+    }
+    return Batch;
+}
+
+size_t CMicroBenchmarks::CheckOrientationBatches()
+{
+    // sizes that leave a remainder after the SIMD lanes
+    const size_t NumFrames = 103, NumSeries = 7, NumPoses = NumFrames * NumSeries;
+    size_t       Mismatches = 0;
+
+    for (auto &[Name, pOrientation] : Orientations())
+    {
+        COrientation &Orientation = *pOrientation;
+        const int     NumChannels = Orientation.GetNumOrientChannels();
+        CPoseBatch    Input       = Poses(NumFrames, NumSeries);
+
+        auto Compare = [&](const char *Operation, size_t Pose, const double *Expected, const double *Actual, int Count)
+        {
+            if (memcmp(Expected, Actual, Count * sizeof(double)) == 0)
+                return true;
+            for (int k = 0; k < Count; k++)
+            {
+                if (memcmp(&Expected[k], &Actual[k], sizeof(double)) != 0)
+                {
+                    PrintError("{} {} pose {} value {} : {:.17g} instead of {:.17g}", Name, Operation, Pose, k, Actual[k], Expected[k]);
+                    break;
+                }
+            }
+            Mismatches++;
+            return false;
+        };
+
+        double T4x4[16], Angles[CPoseBatch::MAX_CHANNELS], Actual[16];
+
+        CPoseBatch Batch = Input;
+        Orientation.ToT4x4Batch(Batch);
+        for (size_t i = 0; i < NumPoses; i++)
+        {
+            Input.GetT4x4(i, T4x4);
+            Input.GetAngles(i, Angles, NumChannels);
+            Orientation.ToT4x4(Angles, T4x4);
+            Batch.GetT4x4(i, Actual);
+            if (!Compare("ToT4x4", i, T4x4, Actual, 16))
+                break;
+        }
+
+        Batch = Input;
+        Orientation.From4x4Batch(Batch);
+        for (size_t i = 0; i < NumPoses; i++)
+        {
+            Input.GetT4x4(i, T4x4);
+            Orientation.From4x4(T4x4, Angles);
+            Batch.GetAngles(i, Actual, NumChannels);
+            if (!Compare("From4x4", i, Angles, Actual, NumChannels))
+                break;
+        }
+
+        // continues a recording that is a few turns further
+        std::vector<double> AnglesPrev(NumSeries * NumChannels), Expected(NumPoses * NumChannels);
+        for (size_t k = 0; k < AnglesPrev.size(); k++)
+            AnglesPrev[k] = 4.0 * PI + 0.1 * k;
+        Batch = Input;
+        Orientation.From4x4UnwrapBatch(Batch, AnglesPrev.data());
+        for (size_t i = 0; i < NumPoses; i++)
+        {
+            double *Prev = i < NumSeries ? &AnglesPrev[i * NumChannels] : &Expected[(i - NumSeries) * NumChannels];
+            Input.GetT4x4(i, T4x4);
+            Orientation.From4x4Unwrap(T4x4, Prev, &Expected[i * NumChannels]);
+            Batch.GetAngles(i, Actual, NumChannels);
+            if (!Compare("From4x4Unwrap", i, &Expected[i * NumChannels], Actual, NumChannels))
+                break;
+        }
+
+        // COrientationStream, the first frame is not unwrapped
+        COrientationStream                         Stream(Orientation.GetOrientName(), true);
+        std::vector<OrientationKernels::Matrix4x4> Frame(NumSeries);
+        std::vector<double>                        StreamAngles;
+        bool                                       bEqual = true;
+        for (size_t i = 0; i < NumPoses && bEqual; i += NumSeries)
+        {
+            for (size_t s = 0; s < NumSeries; s++)
+                Input.GetT4x4(i + s, Frame[s].data());
+            Stream.From4x4(Frame, StreamAngles);
+            for (size_t s = 0; s < NumSeries && bEqual; s++)
+            {
+                Input.GetT4x4(i + s, T4x4);
+                if (i == 0)
+                    Orientation.From4x4(T4x4, &Expected[s * NumChannels]);
+                else
+                    Orientation.From4x4Unwrap(T4x4, &Expected[(i + s - NumSeries) * NumChannels], &Expected[(i + s) * NumChannels]);
+                bEqual = Compare("COrientationStream", i + s, &Expected[(i + s) * NumChannels], &StreamAngles[s * NumChannels], NumChannels);
+            }
+        }
+    }
+    PrintInfo("Orientation batches : {}", Mismatches ? fmt::format("{} conversions differ from the calls per pose", Mismatches) : "bit for bit equal");
+    return Mismatches;
+}
+
+void CMicroBenchmarks::RegisterOrientation()
+{
+    const size_t NumFrames = 100, NumSeries = 20, NumPoses = NumFrames * NumSeries;
+    auto         Input     = std::make_shared<const CPoseBatch>(Poses(NumFrames, NumSeries));
+
+    for (auto &[Name, pOrientation] : Orientations())
+    {
+        const int NumChannels = pOrientation->GetNumOrientChannels();
+
+        // the calls per pose on the arrays a driver keeps, pose after pose
+        auto T4x4   = std::make_shared<std::vector<double>>(NumPoses * 16);
+        auto Angles = std::make_shared<std::vector<double>>(NumPoses * NumChannels);
+        for (size_t i = 0; i < NumPoses; i++)
+        {
+            Input->GetT4x4(i, &(*T4x4)[i * 16]);
+            Input->GetAngles(i, &(*Angles)[i * NumChannels], NumChannels);
+        }
+
+        Register(fmt::format("orientation.to_t4x4/{}/scalar", Name),
+                 [pOrientation, T4x4, Angles, NumChannels](uint64_t Iterations)
+                 {
+                     for (uint64_t n = 0; n < Iterations; n++)
+                     {
+                         for (size_t i = 0; i < NumPoses; i++)
+                             pOrientation->ToT4x4(&(*Angles)[i * NumChannels], &(*T4x4)[i * 16]);
+                         DoNotOptimize(*T4x4);
+                     }
+                 });
+        Register(fmt::format("orientation.to_t4x4/{}/batch", Name),
+                 [pOrientation, Batch = *Input](uint64_t Iterations) mutable
+                 {
+                     for (uint64_t n = 0; n < Iterations; n++)
+                     {
+                         pOrientation->ToT4x4Batch(Batch);
+                         DoNotOptimize(Batch);
+                     }
+                 });
+        Register(fmt::format("orientation.from_4x4/{}/scalar", Name),
+                 [pOrientation, T4x4, Angles, NumChannels](uint64_t Iterations)
+                 {
+                     for (uint64_t n = 0; n < Iterations; n++)
+                     {
+                         for (size_t i = 0; i < NumPoses; i++)
+                             pOrientation->From4x4(&(*T4x4)[i * 16], &(*Angles)[i * NumChannels]);
+                         DoNotOptimize(*Angles);
+                     }
+                 });
+        Register(fmt::format("orientation.from_4x4/{}/batch", Name),
+                 [pOrientation, Batch = *Input](uint64_t Iterations) mutable
+                 {
+                     for (uint64_t n = 0; n < Iterations; n++)
+                     {
+                         pOrientation->From4x4Batch(Batch);
+                         DoNotOptimize(Batch);
+                     }
+                 });
+        Register(fmt::format("orientation.from_4x4_unwrap/{}/scalar", Name),
+                 [pOrientation, T4x4, Angles, NumChannels](uint64_t Iterations)
+                 {
+                     for (uint64_t n = 0; n < Iterations; n++)
+                     {
+                         for (size_t i = NumSeries; i < NumPoses; i++)
+                             pOrientation->From4x4Unwrap(&(*T4x4)[i * 16], &(*Angles)[(i - NumSeries) * NumChannels], &(*Angles)[i * NumChannels]);
+                         DoNotOptimize(*Angles);
+                     }
+                 });
+        Register(fmt::format("orientation.from_4x4_unwrap/{}/batch", Name),
+                 [pOrientation, Batch = *Input](uint64_t Iterations) mutable
+                 {
+                     for (uint64_t n = 0; n < Iterations; n++)
+                     {
+                         pOrientation->From4x4UnwrapBatch(Batch, nullptr);
+                         DoNotOptimize(Batch);
+                     }
+                 });
+
+        // COrientationStream, frame after frame with the convention resolved once
+        std::vector<std::vector<OrientationKernels::Matrix4x4>> Frames(NumFrames, std::vector<OrientationKernels::Matrix4x4>(NumSeries));
+        for (size_t i = 0; i < NumPoses; i++)
+            Input->GetT4x4(i, Frames[i / NumSeries][i % NumSeries].data());
+        Register(fmt::format("orientation.from_4x4_unwrap/{}/stream", Name),
+                 [Stream = COrientationStream(pOrientation->GetOrientName(), true), Frames](uint64_t Iterations) mutable
+                 {
+                     std::vector<double> Angles;
+                     for (uint64_t n = 0; n < Iterations; n++)
+                     {
+                         for (const auto &Frame : Frames)
+                             Stream.From4x4(Frame, Angles);
+                         DoNotOptimize(Angles);
+                     }
+                 });
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+Unit conversion, 100 frames of 20 rigid bodies with a position and roll pitch yaw each
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+void CMicroBenchmarks::RegisterUnits()
+{
+    const size_t             NumFrames = 100, NumSeries = 20;
+    std::vector<std::string> BaseUnits;
+    for (size_t i = 0; i < NumSeries; i++)
+    {
+        BaseUnits.insert(BaseUnits.end(), 3, UNIT_MM);
+        BaseUnits.insert(BaseUnits.end(), 3, UNIT_ANGLE);
+    }
+    auto       Values = std::make_shared<std::vector<double>>(Doubles(NumFrames * BaseUnits.size()));
+    CBaseUnits Units;
+
+    Register("units.convert/100x120/lookup",
+             [Units, BaseUnits, Values](uint64_t Iterations) mutable
+             {
+                 std::vector<double> Result(Values->size());
+                 for (uint64_t n = 0; n < Iterations; n++)
+                 {
+                     for (size_t i = 0; i < Values->size(); i++)
+                         Result[i] = (*Values)[i] * Units.GetConversionFactor(BaseUnits[i % BaseUnits.size()]);
+                     DoNotOptimize(Result);
+                 }
+             },
+             Values->size() * sizeof(double));
+    Register("units.convert/100x120/plan",
+             [Plan = CUnitPlan(Units, BaseUnits), Values](uint64_t Iterations)
+             {
+                 std::vector<double> Result(Values->size());
+                 for (uint64_t n = 0; n < Iterations; n++)
+                 {
+                     Plan.Convert(Values->data(), Result.data(), Values->size());
+                     DoNotOptimize(Result);
+                 }
+             },
+             Values->size() * sizeof(double));
+    Register("units.text/100x120/lookup",
+             [Units, BaseUnits, Values](uint64_t Iterations) mutable
+             {
+                 std::string Text;
+                 for (uint64_t n = 0; n < Iterations; n++)
+                 {
+                     Text.clear();
+                     for (size_t i = 0; i < Values->size(); i++)
+                     {
+                         const std::string &BaseUnit = BaseUnits[i % BaseUnits.size()];
+                         Text += fmt::format("{:.{}f}", (*Values)[i] * Units.GetConversionFactor(BaseUnit), Units.GetNumDecimals(BaseUnit));
+                         Text += (i + 1) % BaseUnits.size() ? '\t' : '\n';
+                     }
+                     DoNotOptimize(Text);
+                 }
+             });
+    Register("units.text/100x120/plan",
+             [Plan = CUnitPlan(Units, BaseUnits), Values](uint64_t Iterations)
+             {
+                 std::string Text;
+                 for (uint64_t n = 0; n < Iterations; n++)
+                 {
+                     Text.clear();
+                     Plan.AppendText(Values->data(), Values->size(), Text);
+                     DoNotOptimize(Text);
+                 }
+             });
+}
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+Leica measurement queue, the synthetic producer stands in for the LMF event thread
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+size_t CMicroBenchmarks::CheckMeasurementQueue()
+{
+    const double RateHz = 20000.0, Seconds = 0.5;
+    size_t       Errors = 0;
+    auto         Error  = [&Errors](const std::string &Text)
+    {
+        if (Errors++ == 0)
+            PrintError("Measurement queue : {}", Text);
+    };
+
+    CMeasurementQueue             Queue;
+    CSyntheticMeasurementProducer Producer;
+    for (int Run = 0; Run < 2; Run++)
+    {
+        // the time base restarts with every run
+        Queue.Reset();
+        Clock::time_point   Start = Clock::now();
+        std::vector<double> Values;
+        Producer.Start(Queue, RateHz);
+        while (Clock::now() - Start < std::chrono::duration<double>(Seconds))
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            Queue.Drain(Values);
+        }
+        Producer.Stop();
+        Queue.Drain(Values);
+        Clock::time_point End = Clock::now();
+
+        // the producer moves 0.01 rad on a circle of 1000 mm per sample, a lost or reordered sample breaks the step
+        const size_t NumSamples = Values.size() / MeasurementSample::NUM_VALUES;
+        if (NumSamples < 2)
+            Error(fmt::format("run {} : {} samples drained", Run, NumSamples));
+        if (Queue.GetNumDropped() != 0)
+            Error(fmt::format("run {} : {} samples dropped", Run, Queue.GetNumDropped()));
+        double PrevTime = 0.0, PrevAngle = 0.0;
+        for (size_t i = 0; i < NumSamples; i++)
+        {
+            const double *Sample = &Values[i * MeasurementSample::NUM_VALUES];
+            double        Angle  = std::atan2(Sample[2], Sample[1]);
+            if (Sample[0] < PrevTime || Queue.GetTimePoint(Sample[0]) < Start || Queue.GetTimePoint(Sample[0]) > End)
+                Error(fmt::format("run {} sample {} : timestamp {} s out of order or out of the run", Run, i, Sample[0]));
+            if (std::abs(std::hypot(Sample[1], Sample[2]) - 1000.0) > 1e-6)
+                Error(fmt::format("run {} sample {} : ({}, {}) is not on the circle", Run, i, Sample[1], Sample[2]));
+            double Step = i == 0 ? Angle : std::remainder(Angle - PrevAngle, 2.0 * PI) - 0.01;
+            if (std::abs(Step) > 1e-9)
+                Error(fmt::format("run {} sample {} : lost or out of order", Run, i));
+            PrevTime  = Sample[0];
+            PrevAngle = Angle;
+        }
+        PrintInfo("Measurement queue run {} : {} samples in {:.2f} s", Run, NumSamples, std::chrono::duration<double>(End - Start).count());
+    }
+    PrintInfo("Measurement queue : {}", Errors ? fmt::format("{} errors", Errors) : "all samples in order");
+    return Errors;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#undef strtoull
+#undef strtoll
+#include <nlohmann/json.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+CMicroBenchmarks : Google Benchmark style timing of the serialization and orientation hot paths
+
+A benchmark is a function that runs its operation Iterations times. The runner doubles the iteration count
+until one batch takes at least MinTime, then times Repetitions batches of that size and reports the median, so
+a single preempted batch does not move the result. Allocations are counted with the operator new replacement of
+AllocationCounter.cpp.
+
+One json record per benchmark :
+
+    { "name", "label", "iterations", "ns_per_op", "ns_per_op_min", "allocations_per_op", "mb_per_s" }
+
+label is free text from the command line, typically the commit hash, so that records of several commits can be
+kept in one file and compared with a baseline.
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+struct MicroBenchmarkOptions
+{
+    double      MinTimeSeconds = 0.2;
+    size_t      Repetitions    = 5;
+    std::string Filter;  // substring of the benchmark name, empty = all
+    std::string Label;
+};
+
+class CMicroBenchmarks
+{
+  public:
+    using Function = std::function<void(uint64_t Iterations)>;
+
+    // BytesPerOp > 0 adds the throughput to the record
+    void Register(const std::string &Name, Function Benchmark, size_t BytesPerOp = 0);
+
+    // CTCPGram, Message and TinyXML_Extra text helpers
+    void RegisterSerialization();
+
+    // COrientation conversions per pose and as CPoseBatch
+    void RegisterOrientation();
+
+    // compares the batch conversions bit for bit with the calls per pose, returns the number of mismatches
+    static size_t CheckOrientationBatches();
+
+    // CBaseUnits lookups per value against a compiled CUnitPlan
+    void RegisterUnits();
+
+    // drains the Leica measurement queue while the synthetic producer fills it, returns the number of lost,
+    // reordered or mistimed samples
+    static size_t CheckMeasurementQueue();
+
+    std::vector<nlohmann::json> Run(const MicroBenchmarkOptions &Options) const;
+
+    // compare ns_per_op with the last record of the same name in a baseline file, returns the number of regressions
+    static size_t CompareBaseline(const std::vector<nlohmann::json> &Results, const std::string &BaselineFile, double Tolerance);
+
+  protected:
+    struct Entry
+    {
+        std::string Name;
+        Function    Benchmark;
+        size_t      BytesPerOp = 0;
+    };
+    std::vector<Entry> m_Benchmarks;
+};
+
+// keeps the compiler from optimizing a result away
+template <typename T> inline void DoNotOptimize(const T &Value)
+{
+    static volatile const void *Sink;
+    Sink = &Value;
+}
@@ -0,0 +1,443 @@
+#include "TelegramBenchmark.h"
+#include "AllocationCounter.h"
+
+#include "../Libraries/TCP/FrameTiming.h"
+#include "../Libraries/TCP/TCPTelegram.h"
+#include "../Libraries/Utility/CommandLineParameters.h"
+#include "../Libraries/Utility/FramePacer.h"
+#include "../Libraries/Utility/Metrics.h"
+#include "../Libraries/Utility/Print.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <limits>
+#include <thread>
+
+using Clock = std::chrono::steady_clock;
+
+constexpr auto CONNECT_TIMEOUT = std::chrono::seconds(10);
+constexpr auto REPORT_TIMEOUT  = std::chrono::seconds(30);
+constexpr auto FLUSH_DELAY     = std::chrono::milliseconds(500);
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+Helpers
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+// user + kernel time of this process
+static double ProcessCpuSeconds()
+{
+    FILETIME Creation, Exit, Kernel, User;
+    if (!GetProcessTimes(GetCurrentProcess(), &Creation, &Exit, &Kernel, &User))
+        return 0.0;
+    auto ToSeconds = [](const FILETIME &Time) { return ((static_cast<uint64_t>(Time.dwHighDateTime) << 32) | Time.dwLowDateTime) * 1e-7; };
+    return ToSeconds(Kernel) + ToSeconds(User);
+}
+
+static double PerFrame(double Value, uint64_t Frames)
+{
+    return Frames ? Value / Frames : 0.0;
+}
+
+static HANDLE StartClient(const TelegramBenchmarkConfig &Config, size_t Index)
+{
+    char ExePath[MAX_PATH];
+    GetModuleFileNameA(nullptr, ExePath, MAX_PATH);
+
+    TelegramBenchmarkConfig ClientConfig = Config;
+    ClientConfig.ClientIndex             = Index;
+    CommandLineParameters Parameters;
+    Parameters.getJsonObject() = ClientConfig.ToJson();
+    Parameters.set(BenchmarkCmdLine::Role, std::string("client"));
+
+    std::string         CommandLine = fmt::format("\"{}\" {}", ExePath, CommandLineParameters::generateCommandLineArgument(Parameters));
+    STARTUPINFOA        StartupInfo{};
+    PROCESS_INFORMATION ProcessInfo{};
+    StartupInfo.cb = sizeof(StartupInfo);
+    if (!CreateProcessA(nullptr, CommandLine.data(), nullptr, nullptr, FALSE, CREATE_NO_WINDOW, nullptr, nullptr, &StartupInfo, &ProcessInfo))
+    {
+        PrintError("Could not start benchmark client {} : error {}", Index, GetLastError());
+        return nullptr;
+    }
+    CloseHandle(ProcessInfo.hThread);
+    return ProcessInfo.hProcess;
+}
+
+nlohmann::json CTelegramBenchmark::HistogramToJson(const CLogHistogram &Histogram, double Scale)
+{
+    return {{"count", Histogram.GetCount()},
+            {"mean", Histogram.GetMean() * Scale},
+            {"p50", Histogram.GetPercentile(0.50) * Scale},
+            {"p90", Histogram.GetPercentile(0.90) * Scale},
+            {"p99", Histogram.GetPercentile(0.99) * Scale},
+            {"p999", Histogram.GetPercentile(0.999) * Scale},
+            {"max", Histogram.GetMax() * Scale}};
+}
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+Configuration
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+nlohmann::json TelegramBenchmarkConfig::ToJson() const
+{
+    return {{BenchmarkCmdLine::Channels, NumChannels},
+            {BenchmarkCmdLine::Rate, RateHz},
+            {BenchmarkCmdLine::Clients, NumClients},
+            {BenchmarkCmdLine::MessageEvery, MessageEvery},
+            {BenchmarkCmdLine::MessageBytes, MessageBytes},
+            {BenchmarkCmdLine::Duration, DurationSeconds},
+            {BenchmarkCmdLine::MaxQueued, MaxQueued},
+            {BenchmarkCmdLine::Port, Port},
+            {BenchmarkCmdLine::ClientIndex, ClientIndex}};
+}
+
+TelegramBenchmarkConfig TelegramBenchmarkConfig::FromJson(const nlohmann::json &Params)
+{
+    TelegramBenchmarkConfig Config;
+    Config.NumChannels     = Params.value(BenchmarkCmdLine::Channels, Config.NumChannels);
+    Config.RateHz          = Params.value(BenchmarkCmdLine::Rate, Config.RateHz);
+    Config.NumClients      = Params.value(BenchmarkCmdLine::Clients, Config.NumClients);
+    Config.MessageEvery    = Params.value(BenchmarkCmdLine::MessageEvery, Config.MessageEvery);
+    Config.MessageBytes    = Params.value(BenchmarkCmdLine::MessageBytes, Config.MessageBytes);
+    Config.DurationSeconds = Params.value(BenchmarkCmdLine::Duration, Config.DurationSeconds);
+    Config.MaxQueued       = Params.value(BenchmarkCmdLine::MaxQueued, Config.MaxQueued);
+    Config.Port            = Params.value(BenchmarkCmdLine::Port, Config.Port);
+    Config.ClientIndex     = Params.value(BenchmarkCmdLine::ClientIndex, Config.ClientIndex);
+    if (Config.NumChannels > MAX_CHANNELS)
+    {
+        PrintWarning("{} channels do not fit the telegram format, using {}", Config.NumChannels, MAX_CHANNELS);
+        Config.NumChannels = MAX_CHANNELS;
+    }
+    Config.NumChannels = std::max<size_t>(Config.NumChannels, 1); // channel 0 carries the frame index
+    Config.NumClients  = std::max<size_t>(Config.NumClients, 1);
+    Config.MaxQueued   = std::max<size_t>(Config.MaxQueued, 1);
+    return Config;
+}
+
+std::vector<TelegramBenchmarkConfig> CTelegramBenchmark::ExpandSweep(const nlohmann::json &Params)
+{
+    std::vector<nlohmann::json> Combinations = {Params};
+    for (const char *Key : {BenchmarkCmdLine::Channels, BenchmarkCmdLine::Rate, BenchmarkCmdLine::Clients, BenchmarkCmdLine::MessageEvery})
+    {
+        if (!Params.contains(Key) || !Params[Key].is_array())
+            continue;
+        std::vector<nlohmann::json> Expanded;
+        for (const auto &Combination : Combinations)
+        {
+            for (const auto &Value : Params[Key])
+            {
+                nlohmann::json Next = Combination;
+                Next[Key]           = Value;
+                Expanded.push_back(std::move(Next));
+            }
+        }
+        Combinations = std::move(Expanded);
+    }
+
+    std::vector<TelegramBenchmarkConfig> Configs;
+    for (const auto &Combination : Combinations)
+        Configs.push_back(TelegramBenchmarkConfig::FromJson(Combination));
+    return Configs;
+}
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+Sender
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+nlohmann::json CTelegramBenchmark::RunServer(const TelegramBenchmarkConfig &Config)
+{
+    nlohmann::json Result = {{"config", Config.ToJson()}};
+
+    CTrack::FrameTiming::SetTrailerEnabled(true);
+    TelegramBenchmarkConfig RunConfig = Config;
+    RunConfig.Port                    = static_cast<unsigned short>(FindAvailableTCPPortNumber(Config.Port));
+
+    CCommunicationObject              Server;
+    std::vector<nlohmann::json>       Reports;
+    std::vector<CTrack::Subscription> subscriptions;
+    subscriptions.emplace_back(Server.Subscribe(BenchmarkMsg::Report,
+                                                [&Reports](const CTrack::Message &message) -> CTrack::Reply
+                                                {
+                                                    Reports.push_back(message.GetParams());
+                                                    return nullptr;
+                                                }));
+    auto PollMessages = [&Server]()
+    {
+        std::unique_ptr<CTCPGram> TCPGram;
+        while (Server.GetReceivePackage(TCPGram))
+            TCPGram.reset();
+    };
+
+    Server.SetThreadName("Benchmark server");
+    Server.Open(TCP_SERVER, RunConfig.Port);
+
+    std::vector<HANDLE> Clients;
+    for (size_t i = 0; i < RunConfig.NumClients; i++)
+    {
+        if (HANDLE hProcess = StartClient(RunConfig, i))
+            Clients.push_back(hProcess);
+    }
+
+    auto Deadline = Clock::now() + CONNECT_TIMEOUT;
+    while (Server.GetNumConnections() < Clients.size() && Clock::now() < Deadline)
+    {
+        PollMessages();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    size_t NumConnected = Server.GetNumConnections();
+    if (NumConnected < RunConfig.NumClients)
+    {
+        Result["error"] = fmt::format("{} of {} clients connected", NumConnected, RunConfig.NumClients);
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+    // Send frames for the configured duration
+    //--------------------------------------------------------------------------------------------------------
+    CTrack::CMetricGauge &SendQueue = CTrack::CMetricsRegistry::Instance().Gauge(fmt::format("tcp.{}.send_queue", RunConfig.Port));
+    std::vector<double>   Values(RunConfig.NumChannels, 0.0);
+    CTrack::Message       Ping(BenchmarkMsg::Ping, {{"payload", std::string(RunConfig.MessageBytes, 'x')}});
+    CFramePacer           Pacer;
+    if (RunConfig.RateHz > 0.0)
+        Pacer.Start(RunConfig.RateHz);
+
+    uint64_t Frames     = 0;
+    uint64_t Messages   = 0;
+    uint64_t QueueWaits = 0;
+    double   CpuStart   = ProcessCpuSeconds();
+    uint64_t AllocStart = GetAllocationCount();
+    auto     Start      = Clock::now();
+    auto     End        = Start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(RunConfig.DurationSeconds));
+    while (NumConnected > 0 && Clock::now() < End)
+    {
+        if (Pacer.IsStarted())
+            Pacer.WaitNext();
+        while (SendQueue.Get() >= RunConfig.MaxQueued && Clock::now() < End)
+        {
+            QueueWaits++;
+            std::this_thread::yield();
+        }
+
+        Values[0]                         = static_cast<double>(Frames);
+        std::unique_ptr<CTCPGram> TCPGram = std::make_unique<CTCPGram>(Values, CTrack::FrameTimestamps::Now());
+        Server.PushSendPackage(TCPGram);
+        Frames++;
+        if (RunConfig.MessageEvery && Frames % RunConfig.MessageEvery == 0)
+        {
+            Server.SendMessage(Ping);
+            Messages++;
+        }
+    }
+    double   Elapsed     = std::chrono::duration<double>(Clock::now() - Start).count();
+    double   CpuSeconds  = ProcessCpuSeconds() - CpuStart;
+    uint64_t Allocations = GetAllocationCount() - AllocStart;
+    double   FrameBytes  = static_cast<double>(sizeof(TMessageHeader) + sizeof(std::uint16_t) + RunConfig.NumChannels * sizeof(double) +
+                                            CTrack::FrameTimestamps::TRAILER_SIZE);
+
+    Result["sender"] = {{"frames", Frames},
+                        {"messages", Messages},
+                        {"duration_s", Elapsed},
+                        {"fps", Elapsed > 0.0 ? Frames / Elapsed : 0.0},
+                        {"mbps", Elapsed > 0.0 ? Frames * FrameBytes / Elapsed / 1e6 : 0.0},
+                        {"cpu_us_per_frame", PerFrame(CpuSeconds * 1e6, Frames)},
+                        {"allocations_per_frame", PerFrame(static_cast<double>(Allocations), Frames)},
+                        {"queue_waits", QueueWaits}};
+
+    //--------------------------------------------------------------------------------------------------------
+    // Collect the receiver reports
+    //--------------------------------------------------------------------------------------------------------
+    CTrack::Message Stop(BenchmarkMsg::Stop, {{"frames", Frames}});
+    Server.SendMessage(Stop);
+    Deadline = Clock::now() + REPORT_TIMEOUT;
+    while (Reports.size() < NumConnected && Clock::now() < Deadline)
+    {
+        PollMessages();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    Server.Close();
+    for (HANDLE hProcess : Clients)
+    {
+        if (WaitForSingleObject(hProcess, 5000) != WAIT_OBJECT_0)
+            TerminateProcess(hProcess, 1);
+        CloseHandle(hProcess);
+    }
+
+    // summary : the slowest receiver and the worst latency statistics
+    Result["receivers"]   = Reports;
+    double   MinFPS       = Reports.empty() ? 0.0 : std::numeric_limits<double>::max();
+    uint64_t FramesLost   = 0;
+    auto     WorstLatency = nlohmann::json::object();
+    for (const auto &Report : Reports)
+    {
+        MinFPS = std::min(MinFPS, Report.value("fps", 0.0));
+        FramesLost += Report.value("frames_lost", uint64_t(0));
+        for (const auto &[Key, Value] : Report["latency_us"].items())
+            WorstLatency[Key] = std::max(WorstLatency.value(Key, 0.0), Value.get<double>());
+    }
+    if (Reports.size() < RunConfig.NumClients && !Result.contains("error"))
+        Result["error"] = fmt::format("{} of {} clients reported", Reports.size(), RunConfig.NumClients);
+    Result["fps"]         = MinFPS;
+    Result["latency_us"]  = WorstLatency;
+    Result["frames_lost"] = FramesLost;
+    return Result;
+}
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+Receiver, runs in a child process
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+int CTelegramBenchmark::RunClient(const TelegramBenchmarkConfig &Config)
+{
+    CCommunicationObject              Client;
+    std::vector<CTrack::Subscription> subscriptions;
+    uint64_t                          Messages   = 0;
+    uint64_t                          FramesSent = 0;
+    bool                              bStop      = false;
+    subscriptions.emplace_back(Client.Subscribe(BenchmarkMsg::Ping,
+                                                [&Messages](const CTrack::Message &) -> CTrack::Reply
+                                                {
+                                                    Messages++;
+                                                    return nullptr;
+                                                }));
+    subscriptions.emplace_back(Client.Subscribe(BenchmarkMsg::Stop,
+                                                [&bStop, &FramesSent](const CTrack::Message &message) -> CTrack::Reply
+                                                {
+                                                    FramesSent = message.GetParams().value("frames", uint64_t(0));
+                                                    bStop      = true;
+                                                    return nullptr;
+                                                }));
+
+    Client.SetThreadName(fmt::format("Benchmark client {}", Config.ClientIndex));
+    Client.Open(TCP_CLIENT, Config.Port, 0, "127.0.0.1");
+    if (!Client.WaitConnection(static_cast<DWORD>(std::chrono::milliseconds(CONNECT_TIMEOUT).count())))
+    {
+        Client.Close();
+        return 1;
+    }
+
+    CLogHistogram       LatencyNs;
+    std::vector<double> Values;
+    uint64_t            Frames     = 0;
+    uint64_t            FramesLost = 0;
+    uint64_t            Bytes      = 0;
+    double              NextIndex  = 0.0;
+    double              CpuStart   = 0.0;
+    uint64_t            AllocStart = 0;
+    Clock::time_point   FirstFrame;
+    Clock::time_point   LastFrame;
+    while (!bStop && Client.GetNumConnections() > 0)
+    {
+        std::unique_ptr<CTCPGram> TCPGram;
+        if (!Client.GetReceivePackage(TCPGram))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        if (TCPGram->GetCode() != TCPGRAM_CODE_DATA)
+            continue;
+
+        int64_t PickupNs = CTrack::FrameTimestamps::Now();
+        LastFrame        = Clock::now();
+        if (Frames == 0)
+        {
+            FirstFrame = LastFrame;
+            CpuStart   = ProcessCpuSeconds();
+            AllocStart = GetAllocationCount();
+        }
+        if (TCPGram->m_Timestamps.Has(CTrack::FrameStage::Acquire))
+            LatencyNs.Record(static_cast<uint64_t>(std::max<int64_t>(PickupNs - TCPGram->m_Timestamps.Get(CTrack::FrameStage::Acquire), 0)));
+        Bytes += TCPGram->GetSize() + sizeof(TMessageHeader);
+        if (TCPGram->GetDoubleArray(Values) && !Values.empty())
+        {
+            if (Values[0] > NextIndex)
+                FramesLost += static_cast<uint64_t>(Values[0] - NextIndex);
+            NextIndex = Values[0] + 1.0;
+        }
+        Frames++;
+    }
+
+    double   Elapsed     = std::chrono::duration<double>(LastFrame - FirstFrame).count();
+    double   CpuSeconds  = Frames ? ProcessCpuSeconds() - CpuStart : 0.0;
+    uint64_t Allocations = Frames ? GetAllocationCount() - AllocStart : 0;
+    if (FramesSent > Frames + FramesLost)
+        FramesLost = FramesSent - Frames;
+
+    CTrack::Message Report(BenchmarkMsg::Report, {{"client", Config.ClientIndex},
+                                                  {"frames", Frames},
+                                                  {"frames_lost", FramesLost},
+                                                  {"bytes", Bytes},
+                                                  {"messages", Messages},
+                                                  {"duration_s", Elapsed},
+                                                  {"fps", Elapsed > 0.0 ? (Frames - 1) / Elapsed : 0.0},
+                                                  {"mbps", Elapsed > 0.0 ? Bytes / Elapsed / 1e6 : 0.0},
+                                                  {"latency_us", HistogramToJson(LatencyNs, 1e-3)},
+                                                  {"cpu_us_per_frame", PerFrame(CpuSeconds * 1e6, Frames)},
+                                                  {"allocations_per_frame", PerFrame(static_cast<double>(Allocations), Frames)},
+                                                  {"stages", CTrack::FrameTiming::GetLatencyReport()}});
+    Client.SendMessage(Report);
+    std::this_thread::sleep_for(FLUSH_DELAY);
+    Client.Close();
+    return 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+Baseline comparison, records match on channels, rate, clients and message_every
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+size_t CTelegramBenchmark::CompareBaseline(const std::vector<nlohmann::json> &Results, const std::string &BaselineFile, double Tolerance)
+{
+    std::ifstream File(BaselineFile);
+    if (!File)
+    {
+        PrintError("Baseline {} could not be opened", BaselineFile);
+        return 0;
+    }
+    std::vector<nlohmann::json> Baseline;
+    std::string                 Line;
+    while (std::getline(File, Line))
+    {
+        if (!Line.empty())
+            Baseline.push_back(nlohmann::json::parse(Line, nullptr, false));
+    }
+
+    auto Key = [](const nlohmann::json &Record)
+    {
+        const auto &Config = Record["config"];
+        return nlohmann::json::array({Config[BenchmarkCmdLine::Channels], Config[BenchmarkCmdLine::Rate], Config[BenchmarkCmdLine::Clients],
+                                      Config[BenchmarkCmdLine::MessageEvery]});
+    };
+
+    size_t Regressions = 0;
+    for (const auto &Result : Results)
+    {
+        auto Match = std::find_if(Baseline.rbegin(), Baseline.rend(), [&](const nlohmann::json &Record)
+                                  { return Record.is_object() && Record.contains("config") && Key(Record) == Key(Result); });
+        if (Match == Baseline.rend())
+            continue;
+
+        double BaseFPS = Match->value("fps", 0.0);
+        double FPS     = Result.value("fps", 0.0);
+        double BaseP99 = (*Match)["latency_us"].value("p99", 0.0);
+        double P99     = Result["latency_us"].value("p99", 0.0);
+        bool   bSlower = BaseFPS > 0.0 && FPS < BaseFPS * (1.0 - Tolerance);
+        bool   bLater  = BaseP99 > 0.0 && P99 > BaseP99 * (1.0 + Tolerance);
+        std::string Line = fmt::format("{} : fps {:.0f} -> {:.0f}, p99 {:.1f} -> {:.1f} us", Key(Result).dump(), BaseFPS, FPS, BaseP99, P99);
+        if (bSlower || bLater)
+        {
+            PrintError("REGRESSION {}", Line);
+            Regressions++;
+        }
+        else
+            PrintInfo("{}", Line);
+    }
+    return Regressions;
+}
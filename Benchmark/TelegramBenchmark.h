@@ -0,0 +1,97 @@
+#pragma once
+
+#include "../Libraries/TCP/TCPCommunication.h"
+#include "../Libraries/Utility/LogHistogram.h"
+
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+CTelegramBenchmark : throughput and latency of the TCP telegram layer over loopback
+
+The sender is a CCommunicationObject server in this process. The receivers are CCommunicationObject clients in
+child processes started from the same executable, because communication objects on the same port share one
+communication thread inside a process. Every data telegram carries the FrameTiming trailer, so a receiver
+measures the latency from the moment the sender created the frame until its own main loop picked it up. The
+steady clock is QueryPerformanceCounter, which is common to all processes on the PC.
+
+The sender never queues more than MaxQueued telegrams, above that it waits for the communication thread, so an
+unthrottled run (RateHz 0) measures the sustainable rate instead of filling memory. After DurationSeconds the
+sender sends benchmark.stop and every receiver answers with a benchmark.report.
+
+One run produces one json record :
+
+    { "config": {...},
+      "sender":    { "frames", "messages", "duration_s", "fps", "mbps", "cpu_us_per_frame", "allocations_per_frame", "queue_waits" },
+      "receivers": [ { "frames", "frames_lost", "bytes", "messages", "duration_s", "fps", "mbps",
+                       "latency_us": { "count", "mean", "p50", "p90", "p99", "p999", "max" },
+                       "cpu_us_per_frame", "allocations_per_frame", "stages": FrameTiming::GetLatencyReport() } ],
+      "fps": slowest receiver, "latency_us": worst receiver per statistic, "frames_lost": total }
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+namespace BenchmarkCmdLine
+{
+    constexpr char const *Mode         = "mode";          // "transport" (default) or "micro", see MicroBenchmarks.h
+    constexpr char const *Role         = "role";          // "server" (default) or "client"
+    constexpr char const *ClientIndex  = "client_index";  // set by the server for its child processes
+    constexpr char const *Channels     = "channels";      // doubles per frame, a number or an array to sweep
+    constexpr char const *Rate         = "rate";          // frames per second, 0 = unthrottled, number or array
+    constexpr char const *Clients      = "clients";       // receiving processes, number or array
+    constexpr char const *MessageEvery = "message_every"; // a json message after every n frames, 0 = none, number or array
+    constexpr char const *MessageBytes = "message_bytes"; // payload size of those messages
+    constexpr char const *Duration     = "duration";      // seconds per run
+    constexpr char const *MaxQueued    = "max_queued";    // send queue depth at which the sender waits
+    constexpr char const *Port         = "port";          // first port to try
+    constexpr char const *Output       = "output";        // ndjson file the results are appended to
+    constexpr char const *Baseline     = "baseline";      // ndjson file of an earlier run to compare against
+    constexpr char const *Tolerance    = "tolerance";     // allowed relative regression, default 0.1
+    constexpr char const *Filter       = "filter";        // micro : substring of the benchmark names to run
+    constexpr char const *Label        = "label";         // micro : stored with every record, e.g. the commit hash
+    constexpr char const *MinTime      = "min_time";      // micro : minimum seconds per timed batch
+} // namespace BenchmarkCmdLine
+
+namespace BenchmarkMsg
+{
+    constexpr char const *Ping   = "benchmark.ping";   // Params: { "payload": string }
+    constexpr char const *Stop   = "benchmark.stop";   // Params: { "frames": number sent }
+    constexpr char const *Report = "benchmark.report"; // Params: receiver record, see above
+} // namespace BenchmarkMsg
+
+struct TelegramBenchmarkConfig
+{
+    size_t         NumChannels     = 1000;
+    double         RateHz          = 0.0;
+    size_t         NumClients      = 1;
+    size_t         MessageEvery    = 0;
+    size_t         MessageBytes    = 256;
+    double         DurationSeconds = 5.0;
+    size_t         MaxQueued       = 64;
+    unsigned short Port            = 40100;
+    size_t         ClientIndex     = 0;
+
+    // the wire format stores the channel count in 16 bits
+    static constexpr size_t MAX_CHANNELS = 65535;
+
+    nlohmann::json                 ToJson() const;
+    static TelegramBenchmarkConfig FromJson(const nlohmann::json &Params);
+};
+
+class CTelegramBenchmark
+{
+  public:
+    // sender : runs one configuration and returns its record
+    static nlohmann::json RunServer(const TelegramBenchmarkConfig &Config);
+    // receiver : connects to Config.Port and reports to the server when it sends benchmark.stop
+    static int RunClient(const TelegramBenchmarkConfig &Config);
+
+    // expand the array valued keys of the command line into one configuration per combination
+    static std::vector<TelegramBenchmarkConfig> ExpandSweep(const nlohmann::json &Params);
+
+    // compare fps and p99 latency with the matching records of a baseline file, returns the number of regressions
+    static size_t CompareBaseline(const std::vector<nlohmann::json> &Results, const std::string &BaselineFile, double Tolerance);
+
+  protected:
+    static nlohmann::json HistogramToJson(const CLogHistogram &Histogram, double Scale);
+};
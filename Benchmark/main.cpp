@@ -0,0 +1,113 @@
+#include "MicroBenchmarks.h"
+#include "TelegramBenchmark.h"
+
+#include "../Libraries/Utility/CommandLineParameters.h"
+#include "../Libraries/Utility/Logging.h"
+#include "../Libraries/Utility/Print.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+Benchmark of the TCP telegram layer, see TelegramBenchmark.h
+
+    Benchmark.exe "{\"channels\":[10,1000,10000,65535],\"rate\":0,\"clients\":[1,4],\"duration\":5,\"output\":\"new.ndjson\",\"baseline\":\"base.ndjson\"}"
+
+Array values are swept, every combination is one run and one line in the output file. With a baseline the exit
+code is 1 when a run is slower or has a higher p99 latency than the tolerance allows.
+
+Microbenchmarks of the serialization paths and the orientation conversions, see MicroBenchmarks.h
+
+    Benchmark.exe "{\"mode\":\"micro\",\"filter\":\"message.\",\"label\":\"66ae510\",\"baseline\":\"micro_base.ndjson\"}"
+
+The batch conversions of OrientationBatch.cpp are first compared bit for bit with the calls per pose, and the
+Leica measurement queue is drained while a synthetic producer fills it. A difference or a lost sample is exit
+code 1.
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+static int RunMicroBenchmarks(CommandLineParameters &parameters)
+{
+    MicroBenchmarkOptions options;
+    options.Filter         = parameters.getString(BenchmarkCmdLine::Filter, "");
+    options.Label          = parameters.getString(BenchmarkCmdLine::Label, "");
+    options.MinTimeSeconds = parameters.getDouble(BenchmarkCmdLine::MinTime, options.MinTimeSeconds);
+
+    std::string outputFile   = parameters.getString(BenchmarkCmdLine::Output, "micro_benchmark.ndjson");
+    std::string baselineFile = parameters.getString(BenchmarkCmdLine::Baseline, "");
+    double      tolerance    = parameters.getDouble(BenchmarkCmdLine::Tolerance, 0.1);
+
+    // timing batch conversions that differ from the calls per pose is pointless
+    if (CMicroBenchmarks::CheckOrientationBatches() > 0 || CMicroBenchmarks::CheckMeasurementQueue() > 0)
+    {
+        return 1;
+    }
+
+    CMicroBenchmarks benchmarks;
+    benchmarks.RegisterSerialization();
+    benchmarks.RegisterOrientation();
+    benchmarks.RegisterUnits();
+    std::vector<nlohmann::json> results = benchmarks.Run(options);
+
+    std::ofstream output(outputFile, std::ios::app);
+    for (const auto &result : results)
+        output << result.dump() << std::endl;
+    PrintInfo("Results appended to {}", outputFile);
+
+    if (!baselineFile.empty() && CMicroBenchmarks::CompareBaseline(results, baselineFile, tolerance) > 0)
+    {
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    CommandLineParameters parameters(argc, argv);
+    nlohmann::json        params = parameters.isInitializedFromJson() ? parameters.getJsonObject() : nlohmann::json::object();
+
+    if (parameters.getString(BenchmarkCmdLine::Role, "server") == "client")
+    {
+        return CTelegramBenchmark::RunClient(TelegramBenchmarkConfig::FromJson(params));
+    }
+
+    CTrack::InitLogging();
+    SetConsoleTabText("Benchmark");
+
+    if (parameters.getString(BenchmarkCmdLine::Mode, "transport") == "micro")
+    {
+        return RunMicroBenchmarks(parameters);
+    }
+
+    std::string outputFile   = parameters.getString(BenchmarkCmdLine::Output, "telegram_benchmark.ndjson");
+    std::string baselineFile = parameters.getString(BenchmarkCmdLine::Baseline, "");
+    double      tolerance    = parameters.getDouble(BenchmarkCmdLine::Tolerance, 0.1);
+
+    std::vector<TelegramBenchmarkConfig> configs = CTelegramBenchmark::ExpandSweep(params);
+    std::vector<nlohmann::json>          results;
+    std::ofstream                        output(outputFile, std::ios::app);
+    for (size_t i = 0; i < configs.size(); i++)
+    {
+        const TelegramBenchmarkConfig &config = configs[i];
+        PrintInfo("Run {}/{} : {} channels, {} Hz, {} clients, message every {} frames", i + 1, configs.size(), config.NumChannels, config.RateHz,
+                  config.NumClients, config.MessageEvery);
+
+        nlohmann::json result = CTelegramBenchmark::RunServer(config);
+        if (result.contains("error"))
+            PrintError("{}", result["error"].get<std::string>());
+        PrintInfo("    {:.0f} fps, p50 {:.1f} us, p99 {:.1f} us, {:.2f} cpu us/frame, {:.2f} allocations/frame, {} lost", result.value("fps", 0.0),
+                  result["latency_us"].value("p50", 0.0), result["latency_us"].value("p99", 0.0), result["sender"].value("cpu_us_per_frame", 0.0),
+                  result["sender"].value("allocations_per_frame", 0.0), result.value("frames_lost", uint64_t(0)));
+        output << result.dump() << std::endl;
+        results.push_back(std::move(result));
+    }
+    PrintInfo("Results appended to {}", outputFile);
+
+    if (!baselineFile.empty() && CTelegramBenchmark::CompareBaseline(results, baselineFile, tolerance) > 0)
+    {
+        return 1;
+    }
+    return 0;
+}
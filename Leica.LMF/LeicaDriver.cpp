@@ -4,6 +4,7 @@
 #include "../Libraries/XML/TinyXML_AttributeValues.h"
 #include "../Libraries/Utility/StringUtilities.h"
 #include "../Libraries/Utility/Print.h"
+#include "../Libraries/Utility/Metrics.h"
 #include <msclr/marshal_cppstd.h>
 #include <vcclr.h>
 
@@ -26,10 +27,12 @@ LeicaDriver - Native wrapper implementing IDriver interface
 LeicaDriver::LeicaDriver()
 {
     m_pManagedDriver = gcnew CLeicaLMFDriver();
+    static_cast<CLeicaLMFDriver^>(m_pManagedDriver)->SetMeasurementQueue(&m_MeasurementQueue);
 }
 
 LeicaDriver::~LeicaDriver()
 {
+    StopMeasurementSource();
     if (static_cast<CLeicaLMFDriver^>(m_pManagedDriver) != nullptr)
     {
         delete static_cast<CLeicaLMFDriver^>(m_pManagedDriver);
@@ -50,6 +53,7 @@ void LeicaDriver::Disconnect()
         CTrack::Message message(TAG_COMMAND_SHUTDOWN);
         static_cast<CLeicaLMFDriver^>(m_pManagedDriver)->ShutDown(message);
     }
+    StopMeasurementSource();
     m_bConnected = false;
     m_bRunning   = false;
 }
@@ -121,7 +125,7 @@ bool LeicaDriver::Initialize(double frequencyHz)
     m_MeasurementFrequencyHz = frequencyHz;
     m_FrameNumber            = 0;
     m_CurrentFPS             = 0.0;
-    m_LastFPSFrameNumber     = 0;
+    m_FrameRate.Reset();
 
     CTrack::Message message(TAG_COMMAND_CHECKINIT);
     message.GetParams()[ATTRIB_CHECKINIT_MEASFREQ] = frequencyHz;
@@ -135,48 +139,41 @@ bool LeicaDriver::Initialize(double frequencyHz)
 
 bool LeicaDriver::Run()
 {
-    if (m_bRunning && static_cast<CLeicaLMFDriver^>(m_pManagedDriver) != nullptr)
+    // everything that arrived since the previous call, one sample per measurement event
+    m_DrainedValues.clear();
+    if (!m_bRunning)
     {
-        bool result = static_cast<CLeicaLMFDriver^>(m_pManagedDriver)->Run();
-
-        if (result)
-        {
-            // Update frame number and FPS
-            m_FrameNumber++;
-            auto now = std::chrono::steady_clock::now();
-            if (m_LastFPSFrameNumber == 0)
-            {
-                m_LastFPSUpdateTime  = now;
-                m_LastFPSFrameNumber = m_FrameNumber;
-            }
-            else
-            {
-                auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(now - m_LastFPSUpdateTime).count();
-                if (elapsedMs >= 1000)
-                {
-                    uint32_t framesDelta = m_FrameNumber - m_LastFPSFrameNumber;
-                    m_CurrentFPS         = framesDelta * 1000.0 / elapsedMs;
-                    m_LastFPSUpdateTime  = now;
-                    m_LastFPSFrameNumber = m_FrameNumber;
-                }
-            }
-        }
-        return result;
+        return false;
     }
-    return m_bRunning;
+    size_t NumSamples = m_MeasurementQueue.Drain(m_DrainedValues);
+    if (NumSamples == 0)
+    {
+        return false;
+    }
+    m_LastValues.assign(m_DrainedValues.end() - MeasurementSample::NUM_VALUES, m_DrainedValues.end());
+
+    // Update frame number and FPS
+    m_FrameNumber += static_cast<uint32_t>(NumSamples);
+    m_CurrentFPS = m_FrameRate.Tick(NumSamples);
+    m_MetricSamples.Add(NumSamples);
+    m_MetricDrainBatch.Record(NumSamples);
+    m_MetricDropped.Set(static_cast<double>(m_MeasurementQueue.GetNumDropped()));
+    return true;
 }
 
 bool LeicaDriver::GetValues(std::vector<double>& values)
 {
-    if (m_bRunning && static_cast<CLeicaLMFDriver^>(m_pManagedDriver) != nullptr)
+    if (m_bRunning && !m_LastValues.empty())
     {
-        return static_cast<CLeicaLMFDriver^>(m_pManagedDriver)->GetValues(values);
+        values = m_LastValues;
+        return true;
     }
     return false;
 }
 
 bool LeicaDriver::Shutdown()
 {
+    StopMeasurementSource();
     if (static_cast<CLeicaLMFDriver^>(m_pManagedDriver) != nullptr)
     {
         CTrack::Message message(TAG_COMMAND_SHUTDOWN);
@@ -186,6 +183,27 @@ bool LeicaDriver::Shutdown()
     return true;
 }
 
+void LeicaDriver::StartMeasurementSource(double frequencyHz)
+{
+    StopMeasurementSource();
+    m_MeasurementQueue.Reset();
+    m_DrainedValues.clear();
+    m_LastValues.clear();
+    if (m_bSynthetic)
+    {
+        m_SyntheticProducer.Start(m_MeasurementQueue, frequencyHz);
+    }
+}
+
+void LeicaDriver::StopMeasurementSource()
+{
+    m_SyntheticProducer.Stop();
+    if (m_MeasurementQueue.GetNumDropped() != 0)
+    {
+        PrintWarning("{} measurements dropped, queue capacity {}", m_MeasurementQueue.GetNumDropped(), m_MeasurementQueue.GetCapacity());
+    }
+}
+
 bool LeicaDriver::HasCapability(const std::string& capability) const
 {
     // Leica laser trackers support these capabilities
@@ -221,20 +239,25 @@ CTrack::Reply LeicaDriver::ConfigDetect(const CTrack::Message& message)
 
 CTrack::Reply LeicaDriver::CheckInitialize(const CTrack::Message& message)
 {
+    CTrack::Reply reply;
+    m_MeasurementFrequencyHz = message.GetParams().value(ATTRIB_CHECKINIT_MEASFREQ, m_MeasurementFrequencyHz);
+    StartMeasurementSource(m_MeasurementFrequencyHz);
     if (static_cast<CLeicaLMFDriver^>(m_pManagedDriver) != nullptr)
     {
-        return static_cast<CLeicaLMFDriver^>(m_pManagedDriver)->CheckInitialize(message);
+        reply = static_cast<CLeicaLMFDriver^>(m_pManagedDriver)->CheckInitialize(message);
     }
-    return nullptr;
+    m_bRunning = true;
+    return reply;
 }
 
 CTrack::Reply LeicaDriver::ShutDown(const CTrack::Message& message)
 {
+    StopMeasurementSource();
+    m_bRunning = false;
     if (static_cast<CLeicaLMFDriver^>(m_pManagedDriver) != nullptr)
     {
         return static_cast<CLeicaLMFDriver^>(m_pManagedDriver)->ShutDown(message);
     }
-    m_bRunning = false;
     return nullptr;
 }
 
@@ -428,35 +451,32 @@ CTrack::Reply CLeicaLMFDriver::CheckInitialize(const CTrack::Message &message)
 {
     double measurementFrequency = message.GetParams().value(ATTRIB_CHECKINIT_MEASFREQ, 10.0);
     m_bRunning                  = true;
-    return nullptr;
-}
-
-bool CLeicaLMFDriver::Run()
-{
-    return false;
-}
-
-bool CLeicaLMFDriver::GetValues(std::vector<double> &values)
-{
-    if (m_bRunning)
+    if (m_LMFTracker)
     {
-        values.reserve(m_arDoubles.size());
-        for each (double value in m_arDoubles)
+        try
         {
-            values.push_back(value);
+            // results arrive through OnMeasurementArrived
+            m_LMFTracker->Measurement->StartMeasurement();
+        }
+        catch (LMF::Tracker::ErrorHandling::LmfException ^ ex)
+        {
+            PrintError("LMF error starting measurement : {}", msclr::interop::marshal_as<std::string>(ex->Description));
         }
-        return true;
-    }
-    else
-    {
-        return false;
     }
+    return nullptr;
 }
 
 CTrack::Reply CLeicaLMFDriver::ShutDown(const CTrack::Message &message)
 {
     if (m_LMFTracker)
     {
+        try
+        {
+            m_LMFTracker->Measurement->StopMeasurement();
+        }
+        catch (LMF::Tracker::ErrorHandling::LmfException ^)
+        {
+        }
         m_LMFTracker->Disconnect();
         m_LMFTracker = nullptr;
     }
@@ -505,7 +525,7 @@ void CLeicaLMFDriver::RegisterEvents()
             gcnew LMF::Tracker::Targets::TargetCollection::TargetPositionChangedHandler(this, &CLeicaLMFDriver::OnTargetPostionChanged);
 
         m_LMFTracker->Measurement->MeasurementArrived +=
-            gcnew                                       LMF::Tracker::Measurements::MeasurementSettings::MeasurementArrivedHandler(&OnMeasurementArrived);
+            gcnew LMF::Tracker::Measurements::MeasurementSettings::MeasurementArrivedHandler(this, &CLeicaLMFDriver::OnMeasurementArrived);
         m_LMFTracker->Targets->SelectedChanged += gcnew LMF::Tracker::Targets::TargetCollection::SelectedChangedHandler(&OnTargetSelectedChanged);
 
         m_LMFTracker->Measurement->Status->Preconditions->Changed +=
@@ -551,6 +571,24 @@ void CLeicaLMFDriver::OnTargetPostionChanged(LMF::Tracker::Tracker ^ sender, LMF
 
 void CLeicaLMFDriver::OnMeasurementArrived(MeasurementSettings ^ sender, MeasurementCollection ^ measurements, LmfException ^ exception)
 {
+    // LMF event thread : only unpack the coordinates and queue them, Run() does the rest on the main thread
+    if (exception != nullptr || measurements == nullptr || m_pMeasurementQueue == nullptr)
+    {
+        return;
+    }
+    for each (Measurement ^ measurement in measurements)
+    {
+        if (SingleShotMeasurement3D ^ singleShot = dynamic_cast<SingleShotMeasurement3D ^>(measurement))
+        {
+            m_pMeasurementQueue->Push(singleShot->Position->Coordinate1->Value, singleShot->Position->Coordinate2->Value,
+                                      singleShot->Position->Coordinate3->Value);
+        }
+        else if (StationaryMeasurement3D ^ stationary = dynamic_cast<StationaryMeasurement3D ^>(measurement))
+        {
+            m_pMeasurementQueue->Push(stationary->Position->Coordinate1->Value, stationary->Position->Coordinate2->Value,
+                                      stationary->Position->Coordinate3->Value);
+        }
+    }
 }
 
 void CLeicaLMFDriver::OnTargetSelectedChanged(TargetCollection ^ sender, Target ^ target)
@@ -2,9 +2,11 @@
 
 #include "../Libraries/Driver/IDriver.h"
 #include "../Libraries/TCP/Subscriber.h"
+#include "../Libraries/TCP/FrameTiming.h"
+#include "../Libraries/Utility/Metrics.h"
+#include "MeasurementQueue.h"
 
 #include <tinyxml.h>
-#include <cliext/vector>
 #include <cliext/map>
 #include <vcclr.h>
 #include <chrono>
@@ -70,7 +72,7 @@ class LeicaDriver : public CTrack::IDriver, public CTrack::Subscriber
 
     // Device-Specific Capabilities
     bool HasCapability(const std::string& capability) const override;
-    int  GetRecommendedPollingIntervalMs() const override { return 100; } // 10Hz default for laser trackers
+    int  GetRecommendedPollingIntervalMs() const override { return 5; } // measurements are queued on arrival, Run() only drains
     std::string GetDeviceInfo() const override;
 
     //-------------------------------------------------------------------------
@@ -87,6 +89,22 @@ class LeicaDriver : public CTrack::IDriver, public CTrack::Subscriber
     //-------------------------------------------------------------------------
     CLeicaLMFDriver^ GetManagedDriver() { return m_pManagedDriver; }
 
+    //-------------------------------------------------------------------------
+    // Measurement ingestion
+    //-------------------------------------------------------------------------
+
+    // feed the queue from a synthetic producer at the measurement frequency instead of the LMF events
+    void     SetSynthetic(bool bSynthetic) { m_bSynthetic = bSynthetic; }
+    // samples drained by the last Run(), MeasurementSample::NUM_VALUES doubles per sample, oldest first
+    const std::vector<double> &GetDrainedValues() const { return m_DrainedValues; }
+    uint64_t GetNumDropped() const { return m_MeasurementQueue.GetNumDropped(); }
+    // steady clock nanoseconds of a drained sample timestamp, for the data telegram
+    int64_t  GetSampleTimeNs(double Timestamp) const { return CTrack::FrameTimestamps::ToNs(m_MeasurementQueue.GetTimePoint(Timestamp)); }
+
+  protected:
+    void StartMeasurementSource(double frequencyHz);
+    void StopMeasurementSource();
+
   protected:
     gcroot<CLeicaLMFDriver^> m_pManagedDriver;
     bool                     m_bConnected          = false;
@@ -96,9 +114,18 @@ class LeicaDriver : public CTrack::IDriver, public CTrack::Subscriber
     double                   m_CurrentFPS          = 0.0;
     double                   m_MeasurementFrequencyHz = 10.0;
 
-    // For FPS calculation
-    std::chrono::steady_clock::time_point m_LastFPSUpdateTime;
-    uint32_t                              m_LastFPSFrameNumber = 0;
+    // pushed by the LMF event thread (or the synthetic producer), drained by Run()
+    CMeasurementQueue             m_MeasurementQueue;
+    CSyntheticMeasurementProducer m_SyntheticProducer;
+    bool                          m_bSynthetic = false;
+    std::vector<double>           m_DrainedValues;
+    std::vector<double>           m_LastValues;
+
+    // FPS and metrics
+    CTrack::CFrameRateMeter m_FrameRate;
+    CTrack::CMetricCounter &m_MetricSamples    = CTrack::CMetricsRegistry::Instance().Counter("leica.samples");
+    CTrack::CMetricGauge   &m_MetricDropped    = CTrack::CMetricsRegistry::Instance().Gauge("leica.dropped");
+    CLogHistogram          &m_MetricDrainBatch = CTrack::CMetricsRegistry::Instance().Histogram("leica.drain_batch");
 };
 
 //------------------------------------------------------------------------------------------------------------------
@@ -117,10 +144,11 @@ ref class CLeicaLMFDriver
     CTrack::Reply                 HardwareDetect(const CTrack::Message &);
     CTrack::Reply                 ConfigDetect(const CTrack::Message &);
     CTrack::Reply                 CheckInitialize(const CTrack::Message &);
-    bool                          Run();
-    bool                          GetValues(std::vector<double> &values);
     CTrack::Reply                 ShutDown(const CTrack::Message &message);
 
+    // measurements are pushed into this queue from the event thread, the queue is owned by LeicaDriver
+    void SetMeasurementQueue(CMeasurementQueue *pQueue) { m_pMeasurementQueue = pQueue; }
+
   public:
     int DetectTrackers(std::vector<std::string> &Names, std::vector<std::string> &SerialNumbers, std::vector<std::string> &IPAddresses,
                        std::vector<std::string> &Types, std::vector<std::string> &Comments);
@@ -137,7 +165,7 @@ ref class CLeicaLMFDriver
     void OnMeasurementProfileChanged(MeasurementProfileCollection ^ sender, MeasurementProfile ^ profile);
     void OnTargetPostionChanged(LMF::Tracker::Tracker ^ sender, LMF::Tracker::MeasurementResults::SingleShotMeasurement3D ^ position);
 
-    static void OnMeasurementArrived(MeasurementSettings ^ sender, MeasurementCollection ^ measurements, LmfException ^ exception);
+    void        OnMeasurementArrived(MeasurementSettings ^ sender, MeasurementCollection ^ measurements, LmfException ^ exception);
     static void OnTargetSelectedChanged(TargetCollection ^ sender, Target ^ target);
     static void OnTriggerHappend(Trigger ^ trigger, TriggerEventData ^ data);
     static void OnImageArrived(LMF::Tracker::OVC::OverviewCamera ^ sender, cli::array<System::Byte> ^ % image, ATRCoordinateCollection ^ atrcoordinates);
@@ -147,9 +175,9 @@ ref class CLeicaLMFDriver
     static void OnPowerSourceChanged(LMF::Tracker::BasicTypes::EnumTypes::ReadOnlyPowerSourceValue ^ sender, LMF::Tracker::Enums::EPowerSource newValue);
     /* */
   public:
-    cliext::vector<double> m_arDoubles;
-    bool                   m_bRunning = false;
+    bool m_bRunning = false;
 
   protected:
     LMF::Tracker::Tracker ^ m_LMFTracker = nullptr;
+    CMeasurementQueue *m_pMeasurementQueue = nullptr;
 };
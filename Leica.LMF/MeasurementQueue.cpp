@@ -0,0 +1,111 @@
+#include "MeasurementQueue.h"
+
+#include <cmath>
+#include <thread>
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+CMeasurementQueue
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+void CMeasurementQueue::Push(double X, double Y, double Z)
+{
+    MeasurementSample Sample;
+    Sample.Timestamp = GetTime();
+    Sample.X         = X;
+    Sample.Y         = Y;
+    Sample.Z         = Z;
+    Push(Sample);
+}
+
+void CMeasurementQueue::Push(const MeasurementSample &Sample)
+{
+    // the event thread must never block, a full queue means Run() is not keeping up
+    if (!m_Queue.TryPush(Sample))
+    {
+        m_NumDropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+size_t CMeasurementQueue::Drain(std::vector<double> &Values)
+{
+    return m_Queue.Drain(
+        [&Values](const MeasurementSample &Sample)
+        {
+            Values.push_back(Sample.Timestamp);
+            Values.push_back(Sample.X);
+            Values.push_back(Sample.Y);
+            Values.push_back(Sample.Z);
+        });
+}
+
+void CMeasurementQueue::Reset()
+{
+    m_Queue.Drain([](const MeasurementSample &) {});
+    m_EpochTicks.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+    m_NumDropped.store(0, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+CSyntheticMeasurementProducer
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+struct CSyntheticMeasurementProducer::Worker
+{
+    std::thread       Thread;
+    std::atomic<bool> bQuit{false};
+};
+
+CSyntheticMeasurementProducer::CSyntheticMeasurementProducer() = default;
+
+CSyntheticMeasurementProducer::~CSyntheticMeasurementProducer()
+{
+    Stop();
+}
+
+void CSyntheticMeasurementProducer::Start(CMeasurementQueue &Queue, double RateHz)
+{
+    Stop();
+    if (RateHz <= 0.0)
+    {
+        return;
+    }
+    m_pWorker       = std::make_unique<Worker>();
+    Worker *pWorker = m_pWorker.get();
+    pWorker->Thread = std::thread(
+        [pWorker, &Queue, RateHz]()
+        {
+            using Clock              = std::chrono::steady_clock;
+            const auto        Period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / RateHz));
+            Clock::time_point Next   = Clock::now();
+            uint64_t          Index  = 0;
+            while (!pWorker->bQuit.load(std::memory_order_relaxed))
+            {
+                double Angle = 0.01 * static_cast<double>(Index++);
+                Queue.Push(1000.0 * std::cos(Angle), 1000.0 * std::sin(Angle), 10.0 * std::sin(0.1 * Angle));
+                Next += Period;
+                std::this_thread::sleep_until(Next);
+            }
+        });
+}
+
+void CSyntheticMeasurementProducer::Stop()
+{
+    if (m_pWorker)
+    {
+        m_pWorker->bQuit = true;
+        if (m_pWorker->Thread.joinable())
+        {
+            m_pWorker->Thread.join();
+        }
+        m_pWorker.reset();
+    }
+}
+
+bool CSyntheticMeasurementProducer::IsRunning() const
+{
+    return m_pWorker != nullptr;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "../Libraries/Utility/SPSCQueue.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+Native measurement ingestion for the Leica driver
+
+The LMF MeasurementArrived event pushes every measurement into CMeasurementQueue as soon as it arrives, Run()
+drains all queued samples in one pass on the main thread. No managed code is involved on the consumer side,
+so this file and the synthetic producer compile and run on any platform.
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+struct MeasurementSample
+{
+    double Timestamp = 0.0; // seconds since the queue was reset
+    double X         = 0.0;
+    double Y         = 0.0;
+    double Z         = 0.0;
+
+    static constexpr size_t NUM_VALUES = 4; // values per sample in a data telegram : time x y z
+};
+
+class CMeasurementQueue
+{
+  public:
+    explicit CMeasurementQueue(size_t Capacity = 4096) : m_Queue(Capacity) { Reset(); }
+
+    // producer (event thread)
+    void Push(double X, double Y, double Z);
+    void Push(const MeasurementSample &Sample);
+
+    // consumer : append all queued samples as rows of NUM_VALUES doubles, returns the number of samples
+    size_t Drain(std::vector<double> &Values);
+
+    // restart the time base and the counters, only while no producer is active
+    void     Reset();
+    double   GetTime() const { return std::chrono::duration<double>(std::chrono::steady_clock::now() - GetEpoch()).count(); }
+    // steady clock time point of a sample timestamp
+    std::chrono::steady_clock::time_point GetTimePoint(double Timestamp) const
+    {
+        return GetEpoch() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(Timestamp));
+    }
+    uint64_t GetNumDropped() const { return m_NumDropped.load(std::memory_order_relaxed); }
+    size_t   GetCapacity() const { return m_Queue.GetCapacity(); }
+
+  protected:
+    std::chrono::steady_clock::time_point GetEpoch() const
+    {
+        return std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(m_EpochTicks.load(std::memory_order_relaxed)));
+    }
+
+  protected:
+    CSPSCQueue<MeasurementSample>               m_Queue;
+    std::atomic<std::chrono::steady_clock::rep> m_EpochTicks{0}; // steady clock ticks, the event thread reads it while Reset() writes it
+    std::atomic<uint64_t>                       m_NumDropped{0};
+};
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+CSyntheticMeasurementProducer : stands in for the LMF event thread
+
+Pushes a reflector moving on a circle into the queue at a fixed rate from its own thread, so the push/drain
+path can be exercised without a tracker or the LMF simulator.
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+class CSyntheticMeasurementProducer
+{
+  public:
+    CSyntheticMeasurementProducer();
+    ~CSyntheticMeasurementProducer();
+
+    void Start(CMeasurementQueue &Queue, double RateHz);
+    void Stop();
+    bool IsRunning() const;
+
+  protected:
+    struct Worker;
+    std::unique_ptr<Worker> m_pWorker;
+};
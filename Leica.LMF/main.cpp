@@ -1,3 +1,6 @@
+#include "../Libraries/Testing/ClientStressTest.h"
+#include "../Libraries/Testing/FlightRecorder.h"
+#include "../Libraries/Testing/ProfilingControl.h"
 #include "../Libraries/Testing/StressTest.h"
 #include "../Libraries/TCP/TCPCommunication.h"
 #include "../Libraries/TCP/TCPTelegram.h"
@@ -15,6 +18,7 @@
 #include "LeicaDriver.h"
 
 #include <msclr/gcroot.h>
+#include <algorithm>
 #include <conio.h>
 #include <iostream>
 #include <memory>
@@ -53,16 +57,50 @@ int main(int argc, char *argv[])
 
     unsigned short PortNumber(40001);
     bool           showConsole{true};
+    bool           profiling{false};
+    bool           synthetic{false};
+    bool           timestamps{false};
+    double         metricsLog{0.0};
+    int            flightRecorder{0};
+    std::string    stressReplay;
+    double         stressReplaySpeed{0.0};
 
     CommandLineParameters parameters(argc, argv);
 
     if (parameters.isInitializedFromJson())
     {
-        PortNumber  = parameters.getInt(TCPPORT, 40001);
-        showConsole = parameters.getBool(SHOWCONSOLE, false);
+        PortNumber        = parameters.getInt(TCPPORT, 40001);
+        showConsole       = parameters.getBool(SHOWCONSOLE, false);
+        profiling         = parameters.getBool(PROFILING, false);
+        synthetic         = parameters.getBool(ProxyCmdLine::Synthetic, false);
+        timestamps        = parameters.getBool(ProxyCmdLine::Timestamps, false);
+        metricsLog        = parameters.getDouble(ProxyCmdLine::MetricsLog, 0.0);
+        flightRecorder    = parameters.getInt(ProxyCmdLine::FlightRecorder, 0);
+        stressReplay      = parameters.getString(ProxyCmdLine::StressReplay, "");
+        stressReplaySpeed = parameters.getDouble(ProxyCmdLine::StressReplaySpeed, 0.0);
     }
     PortNumber = FindAvailableTCPPortNumber(PortNumber);
 
+    // Set global profiling flag - controls Tracy profiling in all components
+    CTrack::SetProfilingEnabled(profiling);
+    if (parameters.isInitializedFromJson() && parameters.getJsonObject().contains(ProxyCmdLine::ProfilingControl))
+    {
+        try
+        {
+            CTrack::ConfigureProfiling(parameters.getJsonObject()[ProxyCmdLine::ProfilingControl]);
+        }
+        catch (const std::exception &e)
+        {
+            PrintError("profiling_control ignored : {}", e.what());
+        }
+    }
+    CTrack::FrameTiming::SetTrailerEnabled(timestamps);
+    CTrack::CMetricsRegistry::Instance().SetLogInterval(metricsLog);
+    size_t flightRecorderEntries = flightRecorder > 0 ? std::clamp<size_t>(flightRecorder, CTrack::FlightRecorder::MIN_ENTRIES_PER_THREAD,
+                                                                           CTrack::FlightRecorder::MAX_ENTRIES_PER_THREAD)
+                                                      : 0;
+    CTrack::FlightRecorder::SetEnabled(flightRecorder > 0, flightRecorderEntries);
+
     ShowConsole(showConsole);
     if (showConsole)
     {
@@ -78,14 +116,18 @@ int main(int argc, char *argv[])
         PrintInfo("l : report last coordinates");
         PrintInfo("z : start stress test");
         PrintInfo("y : stop stress test");
+        PrintInfo("m : start/stop multi-client stress test");
+        PrintInfo("f : dump the flight recorder as Chrome trace");
     }
 
     // startup server object - use native LeicaDriver wrapper for IDriver compatibility
     std::unique_ptr<LeicaDriver>      driver = std::make_unique<LeicaDriver>();
+    driver->SetSynthetic(synthetic);
     CCommunicationObject              TCPServer;
     std::vector<CTrack::Subscription> subscriptions;
     std::unique_ptr<CTrack::Message>  manualMessage;
     std::unique_ptr<StressTest>       stressTest;
+    ClientStressTest                  clientStress(PortNumber);
     bool                              bContinueLoop = true;
     std::vector<std::string>          names({"Simulator"}), serialNumbers({"506432"}), IPAddresses({"AT960LRSimulator#506432"}), types({"AT960LRSimulator"}),
         comments({"using simulator"});
@@ -109,6 +151,10 @@ int main(int argc, char *argv[])
         TAG_COMMAND_CHECKINIT, [&driver](const CTrack::Message &message) -> CTrack::Reply { return driver->CheckInitialize(message); })));
     subscriptions.emplace_back(std::move(TCPServer.GetMessageResponder()->Subscribe(
         TAG_COMMAND_SHUTDOWN, [&driver](const CTrack::Message &message) -> CTrack::Reply { return driver->ShutDown(message); })));
+    subscriptions.emplace_back(std::move(TCPServer.GetMessageResponder()->Subscribe(ProxyMsg::Diagnostics, &CTrack::FrameTiming::OnDiagnostics)));
+    subscriptions.emplace_back(std::move(TCPServer.GetMessageResponder()->Subscribe(ProxyMsg::Metrics, &CTrack::CMetricsRegistry::OnMetrics)));
+    subscriptions.emplace_back(std::move(TCPServer.GetMessageResponder()->Subscribe(ProxyMsg::DumpTrace, &CTrack::FlightRecorder::OnDumpTrace)));
+    subscriptions.emplace_back(std::move(TCPServer.GetMessageResponder()->Subscribe(ProxyMsg::Profiling, &CTrack::OnProfiling)));
 
     // start server
     TCPServer.Open(TCP_SERVER, PortNumber);
@@ -117,8 +163,39 @@ int main(int argc, char *argv[])
     // Initialize stress test
     stressTest = std::make_unique<StressTest>(driver.get(), TCPServer.GetMessageResponder());
 
+    if (parameters.isInitializedFromJson() && parameters.getJsonObject().contains(ProxyCmdLine::StressClients))
+    {
+        clientStress.Start(ClientStressConfig::FromJson(parameters.getJsonObject()[ProxyCmdLine::StressClients]));
+    }
+
+    // unattended replay, the proxy ends with the verdict as exit code
+    int exitCode = 0;
+    if (!stressReplay.empty())
+    {
+        try
+        {
+            StressTest::ReplayScript script = StressTest::ReplayScript::Load(stressReplay);
+            if (stressReplaySpeed > 0.0)
+            {
+                script.Speed = stressReplaySpeed;
+            }
+            stressTest->StartReplay(script);
+        }
+        catch (const std::exception &e)
+        {
+            PrintError("{}", e.what());
+            exitCode      = 1;
+            bContinueLoop = false;
+        }
+    }
+
     while (bContinueLoop)
     {
+        if (!stressReplay.empty() && !stressTest->IsRunning())
+        {
+            exitCode      = stressTest->GetState() == StressTest::TestState::Error ? 1 : 0;
+            bContinueLoop = false;
+        }
         try
         {
 
@@ -166,16 +243,12 @@ int main(int argc, char *argv[])
             bool stressTestTracking = stressTest && stressTest->IsRunning() && stressTest->IsTracking();
             if (!stressTestTracking && driver->Run())
             {
-                std::vector<double> values;
-                if (driver->GetValues(values))
+                // one data telegram per queued measurement, in arrival order
+                const std::vector<double> &drained = driver->GetDrainedValues();
+                for (size_t offset = 0; offset < drained.size(); offset += MeasurementSample::NUM_VALUES)
                 {
-                    std::string valueString;
-                    for (const auto& value : values)
-                    {
-                        valueString += fmt::format(" {:.3f} ", value);
-                    }
-                    PrintInfo(valueString);
-                    std::unique_ptr<CTCPGram> TCPGRam = std::make_unique<CTCPGram>(values);
+                    std::vector<double>       values(drained.begin() + offset, drained.begin() + offset + MeasurementSample::NUM_VALUES);
+                    std::unique_ptr<CTCPGram> TCPGRam = std::make_unique<CTCPGram>(values, driver->GetSampleTimeNs(values[0]));
                     TCPServer.PushSendPackage(TCPGRam);
                 }
             }
@@ -211,6 +284,20 @@ int main(int argc, char *argv[])
                     case 't':
                         manualMessage = std::make_unique<CTrack::Message>(TAG_COMMAND_SHUTDOWN);
                         break;
+                    case 'l':
+                    {
+                        std::vector<double> values;
+                        if (driver->GetValues(values))
+                        {
+                            std::string valueString;
+                            for (const auto &value : values)
+                            {
+                                valueString += fmt::format(" {:.3f} ", value);
+                            }
+                            PrintInfo("{} ({} frames, {:.1f} Hz, {} dropped)", valueString, driver->GetFrameNumber(), driver->GetCurrentFPS(), driver->GetNumDropped());
+                        }
+                    };
+                    break;
                     case 'z':
                     {
                         if (stressTest && !stressTest->IsRunning())
@@ -235,6 +322,30 @@ int main(int argc, char *argv[])
                         }
                     };
                     break;
+                    case 'm':
+                    {
+                        if (clientStress.IsRunning())
+                        {
+                            clientStress.Stop();
+                        }
+                        else
+                        {
+                            clientStress.Start(ClientStressConfig());
+                        }
+                    };
+                    break;
+                    case 'f':
+                    {
+                        if (CTrack::FlightRecorder::IsEnabled())
+                        {
+                            manualMessage = std::make_unique<CTrack::Message>(ProxyMsg::DumpTrace);
+                        }
+                        else
+                        {
+                            PrintWarning("Flight recorder is off, start the proxy with flight_recorder=<entries per thread>");
+                        }
+                    };
+                    break;
                 }
             }
         }
@@ -243,12 +354,14 @@ int main(int argc, char *argv[])
             PrintError("An error occurred : %s", e.what());
             std::unique_ptr<CTCPGram> TCPGRam = std::make_unique<CTCPGram>(e);
             TCPServer.PushSendPackage(TCPGRam);
+            CTrack::FlightRecorder::DumpOnError(e.what());
         }
         catch (...)
         {
             PrintError("An unknown error occurred");
             std::unique_ptr<CTCPGram> TCPGRam = std::make_unique<CTCPGram>("An unknown error occurred", TCPGRAM_CODE_ERROR);
             TCPServer.PushSendPackage(TCPGRam);
+            CTrack::FlightRecorder::DumpOnError("unknown error");
         }
     }
     // Stop stress test if running before shutdown
@@ -258,8 +371,9 @@ int main(int argc, char *argv[])
         stressTest->Stop();
     }
     stressTest.reset();
+    clientStress.Stop();
 
     PrintInfo("Closing server");
     TCPServer.Close();
-    return 0;
+    return exitCode;
 }
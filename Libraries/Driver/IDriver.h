@@ -95,6 +95,14 @@ class IDriver
     /// @return FPS value (0.0 if not tracking)
     virtual double GetCurrentFPS() const = 0;
 
+    /// @brief Get the acquisition time of the frame returned by GetValues
+    /// @return Steady clock nanoseconds (see CTrack::FrameTimestamps), 0 if unknown
+    /// @details Passed to the data telegram so the acquire to wire latency can be accounted
+    virtual int64_t GetAcquireTimeNs() const
+    {
+        return 0; // Default: the telegram uses its encode time
+    }
+
     //-------------------------------------------------------------------------
     // Optional: Device-Specific Capabilities (with defaults)
     //-------------------------------------------------------------------------
@@ -0,0 +1,156 @@
+#include "FrameTiming.h"
+
+#include "../Utility/LogHistogram.h"
+#include "../XML/ProxyMessages.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+namespace CTrack
+{
+    void FrameTimestamps::WriteTrailer(char *pDestination) const
+    {
+        uint32_t Magic     = TRAILER_MAGIC;
+        uint8_t  NumStamps = TRAILER_STAMPS;
+        memcpy(pDestination, &Magic, sizeof(Magic));
+        memcpy(pDestination + sizeof(Magic), &NumStamps, sizeof(NumStamps));
+        memcpy(pDestination + sizeof(Magic) + sizeof(NumStamps), Stamps.data(), TRAILER_STAMPS * sizeof(int64_t));
+    }
+
+    bool FrameTimestamps::ReadTrailer(const char *pSource, size_t Size)
+    {
+        uint32_t Magic     = 0;
+        uint8_t  NumStamps = 0;
+        if (Size < sizeof(Magic) + sizeof(NumStamps))
+        {
+            return false;
+        }
+        memcpy(&Magic, pSource, sizeof(Magic));
+        memcpy(&NumStamps, pSource + sizeof(Magic), sizeof(NumStamps));
+        if (Magic != TRAILER_MAGIC || Size < sizeof(Magic) + sizeof(NumStamps) + NumStamps * sizeof(int64_t))
+        {
+            return false;
+        }
+        // newer senders may append stages we do not know, older ones fewer
+        size_t NumKnown = std::min<size_t>(NumStamps, TRAILER_STAMPS);
+        memcpy(Stamps.data(), pSource + sizeof(Magic) + sizeof(NumStamps), NumKnown * sizeof(int64_t));
+        return true;
+    }
+
+    namespace FrameTiming
+    {
+        namespace
+        {
+            struct LatencyHistogram
+            {
+                const char   *Name;
+                FrameStage    From;
+                FrameStage    To;
+                CLogHistogram Histogram; // nanoseconds
+            };
+
+            std::atomic<bool> g_bTrailerEnabled{false};
+
+            LatencyHistogram g_Sent[] = {
+                {"acquire_encode", FrameStage::Acquire, FrameStage::Encode, {}},
+                {"encode_enqueue", FrameStage::Encode, FrameStage::Enqueue, {}},
+                {"enqueue_wire", FrameStage::Enqueue, FrameStage::Wire, {}},
+                {"acquire_wire", FrameStage::Acquire, FrameStage::Wire, {}},
+            };
+            LatencyHistogram g_Received[] = {
+                {"wire_receive", FrameStage::Wire, FrameStage::Receive, {}},
+                {"acquire_receive", FrameStage::Acquire, FrameStage::Receive, {}},
+            };
+
+            template <size_t N> void Record(LatencyHistogram (&Histograms)[N], const FrameTimestamps &Stamps)
+            {
+                for (auto &Latency : Histograms)
+                {
+                    if (Stamps.Has(Latency.From) && Stamps.Has(Latency.To))
+                    {
+                        int64_t Delta = Stamps.Get(Latency.To) - Stamps.Get(Latency.From);
+                        Latency.Histogram.Record(Delta > 0 ? static_cast<uint64_t>(Delta) : 0);
+                    }
+                }
+            }
+
+            template <size_t N> void Report(LatencyHistogram (&Histograms)[N], json &Result)
+            {
+                for (auto &Latency : Histograms)
+                {
+                    const CLogHistogram &Histogram = Latency.Histogram;
+                    if (Histogram.GetCount() == 0)
+                    {
+                        continue;
+                    }
+                    Result[Latency.Name] = {{"count", Histogram.GetCount()},
+                                            {"mean_us", Histogram.GetMean() / 1000.0},
+                                            {"p50_us", Histogram.GetPercentile(0.50) / 1000.0},
+                                            {"p99_us", Histogram.GetPercentile(0.99) / 1000.0},
+                                            {"p999_us", Histogram.GetPercentile(0.999) / 1000.0},
+                                            {"max_us", Histogram.GetMax() / 1000.0}};
+                }
+            }
+        } // namespace
+
+        void SetTrailerEnabled(bool bEnabled)
+        {
+            g_bTrailerEnabled.store(bEnabled, std::memory_order_release);
+        }
+
+        bool IsTrailerEnabled()
+        {
+            return g_bTrailerEnabled.load(std::memory_order_acquire);
+        }
+
+        void RecordSent(const FrameTimestamps &Stamps)
+        {
+            Record(g_Sent, Stamps);
+        }
+
+        void RecordReceived(const FrameTimestamps &Stamps)
+        {
+            Record(g_Received, Stamps);
+        }
+
+        json GetLatencyReport()
+        {
+            json Result = json::object();
+            Report(g_Sent, Result);
+            Report(g_Received, Result);
+            return Result;
+        }
+
+        void ResetLatency()
+        {
+            for (auto &Latency : g_Sent)
+            {
+                Latency.Histogram.Reset();
+            }
+            for (auto &Latency : g_Received)
+            {
+                Latency.Histogram.Reset();
+            }
+        }
+
+        Reply OnDiagnostics(const Message &message)
+        {
+            const json &Params = message.GetParams();
+            if (Params.contains(ProxyParam::Trailer))
+            {
+                SetTrailerEnabled(Params[ProxyParam::Trailer].get<bool>());
+            }
+
+            Reply reply                             = std::make_unique<Message>(ProxyMsg::Diagnostics);
+            reply->GetParams()[ProxyParam::Latency] = GetLatencyReport();
+            reply->GetParams()[ProxyParam::Trailer] = IsTrailerEnabled();
+
+            if (Params.value(ProxyParam::Reset, false))
+            {
+                ResetLatency();
+            }
+            return reply;
+        }
+    } // namespace FrameTiming
+} // namespace CTrack
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "Message.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+Per-frame pipeline timestamps
+
+Every data telegram records when its frame passed each stage of the proxy pipeline, in nanoseconds on the
+steady clock (QueryPerformanceCounter on Windows, so proxy and engine stamps on one PC are comparable) :
+
+    Acquire     the driver produced the frame (passed to the CTCPGram constructor, else equal to Encode)
+    Encode      the doubles were packed into the telegram
+    Enqueue     the telegram was pushed into the send buffer of the communication thread
+    Wire        the communication thread handed it to the first socket
+    Receive     a receiving communication thread extracted it (engine side, never sent)
+
+The proxy keeps histograms of the stage to stage latencies, reported by the proxy.diagnostics message.
+When the trailer is enabled the first four stamps are also appended to the data telegram :
+
+    uint32 TRAILER_MAGIC | uint8 number of stamps | int64 stamp[n]
+
+CTCPGram::GetDoubleArray accepts the trailer. Older readers do not : their GetDoubleArray asserts that the payload
+holds exactly the channel count doubles, so the trailer is off by default and is only enabled when the receiver
+is built with this version.
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+namespace CTrack
+{
+    enum class FrameStage : uint8_t
+    {
+        Acquire = 0,
+        Encode,
+        Enqueue,
+        Wire,
+        Receive,
+        Count
+    };
+
+    struct FrameTimestamps
+    {
+        static constexpr uint32_t TRAILER_MAGIC  = 0x53545443; // "CTTS"
+        static constexpr uint8_t  TRAILER_STAMPS = static_cast<uint8_t>(FrameStage::Receive);
+        static constexpr size_t   TRAILER_SIZE   = sizeof(uint32_t) + sizeof(uint8_t) + TRAILER_STAMPS * sizeof(int64_t);
+
+        std::array<int64_t, static_cast<size_t>(FrameStage::Count)> Stamps{}; // 0 = not stamped
+
+        static int64_t Now() { return ToNs(std::chrono::steady_clock::now()); }
+        static int64_t ToNs(std::chrono::steady_clock::time_point Time)
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(Time.time_since_epoch()).count();
+        }
+
+        void    Stamp(FrameStage Stage) { Stamps[static_cast<size_t>(Stage)] = Now(); }
+        void    Set(FrameStage Stage, int64_t TimeNs) { Stamps[static_cast<size_t>(Stage)] = TimeNs; }
+        int64_t Get(FrameStage Stage) const { return Stamps[static_cast<size_t>(Stage)]; }
+        bool    Has(FrameStage Stage) const { return Get(Stage) != 0; }
+
+        void WriteTrailer(char *pDestination) const;
+        bool ReadTrailer(const char *pSource, size_t Size);
+    };
+
+    namespace FrameTiming
+    {
+        // append the stamps to outgoing data telegrams
+        void SetTrailerEnabled(bool bEnabled);
+        bool IsTrailerEnabled();
+
+        // account a telegram that reached the wire (proxy) or was received (engine, only with a trailer)
+        void RecordSent(const FrameTimestamps &Stamps);
+        void RecordReceived(const FrameTimestamps &Stamps);
+
+        // { "<from>_<to>": { "count", "mean_us", "p50_us", "p99_us", "p999_us", "max_us" }, ... }
+        json GetLatencyReport();
+        void ResetLatency();
+
+        // handler for ProxyMsg::Diagnostics, params { "reset": bool, "trailer": bool } are both optional
+        Reply OnDiagnostics(const Message &message);
+    } // namespace FrameTiming
+} // namespace CTrack
@@ -1,8 +1,13 @@
 #include "Message.h"
 #include "../Utility/logging.h"
 
-constexpr const char *ParamsKey = "params";
-constexpr const char *IDKey     = "id";
+#include <cstring>
+#include <fmt/format.h>
+#include <stdexcept>
+
+constexpr const char *ParamsKey      = "params";
+constexpr const char *IDKey          = "id";
+constexpr const char *AttachmentsKey = "attachments";
 
 namespace CTrack
 {
@@ -25,7 +30,8 @@ namespace CTrack
     // Copy constructor
     Message::Message(const Message &other)
     {
-        data_ = other.data_;
+        data_        = other.data_;
+        attachments_ = other.attachments_;
 #ifdef _DEBUG
         debugMessage_ = other.debugMessage_;
 #endif
@@ -36,7 +42,8 @@ namespace CTrack
     {
         if (this != &other)
         {
-            data_ = other.data_;
+            data_        = other.data_;
+            attachments_ = other.attachments_;
 #ifdef _DEBUG
             debugMessage_ = other.debugMessage_;
 #endif
@@ -50,7 +57,8 @@ namespace CTrack
     {
         if (this != &other)
         {
-            data_ = std::move(other.data_);
+            data_        = std::move(other.data_);
+            attachments_ = std::move(other.attachments_);
 #ifdef _DEBUG
             debugMessage_ = std::move(other.debugMessage_);
 #endif
@@ -62,7 +70,8 @@ namespace CTrack
     {
         if (this != &other)
         {
-            data_ = std::move(other.data_);
+            data_        = std::move(other.data_);
+            attachments_ = std::move(other.attachments_);
 #ifdef _DEBUG
             debugMessage_ = std::move(other.debugMessage_);
 #endif
@@ -103,6 +112,32 @@ namespace CTrack
         return Message(std::move(parsed), raw_json_tag);
     }
 
+    // Static: Deserialize a telegram payload, the json text up to the '\0' and the attachments behind it
+    Message Message::Deserialize(const char *pPayload, size_t PayloadSize)
+    {
+        const char *pEnd     = static_cast<const char *>(memchr(pPayload, '\0', PayloadSize));
+        size_t      TextSize = pEnd ? static_cast<size_t>(pEnd - pPayload) : PayloadSize;
+        Message     message  = Deserialize(std::string(pPayload, TextSize));
+
+        auto iterSizes       = message.data_.find(AttachmentsKey);
+        if (iterSizes != message.data_.end())
+        {
+            size_t Offset = TextSize + 1;
+            for (const auto &Size : *iterSizes)
+            {
+                size_t NumBytes = Size.get<size_t>();
+                if (Offset > PayloadSize || NumBytes > PayloadSize - Offset)
+                {
+                    throw std::invalid_argument(fmt::format("Message attachment of {} bytes exceeds the telegram of {} bytes", NumBytes, PayloadSize));
+                }
+                message.attachments_.push_back(std::make_shared<const std::vector<char>>(pPayload + Offset, pPayload + Offset + NumBytes));
+                Offset += NumBytes;
+            }
+            message.data_.erase(iterSizes);
+        }
+        return message;
+    }
+
     // GetID
     const std::string &Message::GetID() const
     {
@@ -170,6 +205,65 @@ namespace CTrack
         return data_.dump();
     }
 
+    // SerializeTo : the json text, its '\0' and the attachments
+    void Message::SerializeTo(std::vector<char> &Payload) const
+    {
+        std::string Text = Serialize();
+        if (!attachments_.empty() && (!data_.is_object() || data_.empty()))
+        {
+            json Envelope = data_.is_object() ? data_ : json::object();
+            for (const auto &pAttachment : attachments_)
+            {
+                Envelope[AttachmentsKey].push_back(pAttachment->size());
+            }
+            Text = Envelope.dump();
+        }
+        else if (!attachments_.empty())
+        {
+            // the sizes are spliced into the text, data_ never holds them
+            Text.pop_back();
+            Text += fmt::format(",\"{}\":[", AttachmentsKey);
+            for (size_t i = 0; i < attachments_.size(); i++)
+            {
+                Text += fmt::format(i ? ",{}" : "{}", attachments_[i]->size());
+            }
+            Text += "]}";
+        }
+
+        size_t PayloadSize = Text.size() + 1;
+        for (const auto &pAttachment : attachments_)
+        {
+            PayloadSize += pAttachment->size();
+        }
+        Payload.resize(PayloadSize);
+        char *pTo = Payload.data();
+        memcpy(pTo, Text.c_str(), Text.size() + 1);
+        pTo += Text.size() + 1;
+        for (const auto &pAttachment : attachments_)
+        {
+            if (!pAttachment->empty())
+            {
+                memcpy(pTo, pAttachment->data(), pAttachment->size());
+                pTo += pAttachment->size();
+            }
+        }
+    }
+
+    size_t Message::AddAttachment(std::vector<char> bytes)
+    {
+        attachments_.push_back(std::make_shared<const std::vector<char>>(std::move(bytes)));
+        return attachments_.size() - 1;
+    }
+
+    const std::vector<char> &Message::GetAttachment(size_t id) const
+    {
+        if (id >= attachments_.size())
+        {
+            throw std::out_of_range(fmt::format("Message {} has no attachment {}", GetID(), id));
+        }
+        return *attachments_[id];
+    }
+
     // DebugUpdate
     void Message::DebugUpdate()
     {
@@ -4,8 +4,10 @@
 #undef strtoull
 #undef strtoll
 #include <nlohmann/json.hpp>
+#include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace CTrack
 {
@@ -15,9 +17,27 @@ namespace CTrack
     };
     constexpr RawJsonTag raw_json_tag{};
 
+    //------------------------------------------------------------------------------------------------------------------
+    /*
+    Message : { "id", "params" } json envelope of a TCPGRAM_CODE_MESSAGE telegram
+
+    Attachments are binary blobs that travel as raw bytes behind the json text instead of base64 inside it. The
+    params (or the XML inside them) refer to an attachment by the ID AddAttachment returns. On the wire :
+
+        json text with "attachments" : [ size, ... ] | '\0' | bytes of attachment 0 | bytes of attachment 1 | ...
+
+    A receiver that does not know attachments stops at the '\0' and only misses the blobs.
+
+    Only SerializeTo, the payload of a binary message telegram, carries the attachments. Serialize returns the json
+    text alone, for logging, replay scripts and the legacy text telegrams, and the attachments are dropped there.
+    */
+    //------------------------------------------------------------------------------------------------------------------
+
     class Message
     {
       public:
+        using Attachment = std::shared_ptr<const std::vector<char>>; // shared, copies of a message do not copy the blobs
+
         Message() = default;
         Message(const std::string &id);
         Message(const std::string &id, json params);
@@ -27,6 +47,7 @@ namespace CTrack
         Message(json raw, RawJsonTag);
         Message           &operator=(Message &&other);
         static Message     Deserialize(const std::string &jsonString);
+        static Message     Deserialize(const char *pPayload, size_t PayloadSize); // telegram payload, with the attachments
         const std::string &GetID() const;
         void               SetID(const std::string_view &id);
         const bool         HasParams() const;
@@ -34,11 +55,18 @@ namespace CTrack
         json              &GetParams();
         void               SetParams(const json &params);
         const json        &Raw() const;
-        std::string        Serialize() const;
+        std::string        Serialize() const; // json text only, without the attachments
+        void               SerializeTo(std::vector<char> &Payload) const; // telegram payload, with the attachments
         void               DebugUpdate();
 
+        size_t                         AddAttachment(std::vector<char> bytes); // returns the ID
+        size_t                         GetNumAttachments() const { return attachments_.size(); }
+        const std::vector<char>       &GetAttachment(size_t id) const; // throws std::out_of_range
+        const std::vector<Attachment> &GetAttachments() const { return attachments_; }
+
       private:
-        mutable json data_;
+        mutable json            data_;
+        std::vector<Attachment> attachments_;
 #ifdef _DEBUG
         std::string debugMessage_; // For debugging purposes, can be used to store a message about the content of the message
 #endif
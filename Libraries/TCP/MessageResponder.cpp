@@ -5,6 +5,8 @@
 #else
 #include "../Utility/Print.h"
 #endif
+#include "../Utility/Metrics.h"
+#include "../Testing/ProfilingControl.h"
 
 namespace CTrack
 {
@@ -25,6 +27,7 @@ namespace CTrack
 
     void MessageResponder::RespondToMessage(const Message &message)
     {
+        CTRACK_ZONE_CATEGORY_NC(ProfileCategory::Messaging, "MessageResponder::RespondToMessage", 0xAA88FF);
         // standard handlers
         std::vector<Handler> copiedHandlers;
         {
@@ -39,13 +42,22 @@ namespace CTrack
                 }
             }
         }
-        // Call handlers outside lock for deadlock safety
-        for (auto &handler : copiedHandlers)
+        // Call handlers outside lock for deadlock safety, their duration goes to the metrics registry
+        if (!copiedHandlers.empty())
         {
-            if (auto reply = handler(message))
+            CLogHistogram &Duration = CMetricsRegistry::Instance().Histogram("handler." + message.GetID() + "_us");
+            for (auto &handler : copiedHandlers)
             {
-                reply->DebugUpdate();
-                SendTrackMessage(*reply);
+                Reply reply;
+                {
+                    CScopedTimer Timer(Duration);
+                    reply = handler(message);
+                }
+                if (reply)
+                {
+                    reply->DebugUpdate();
+                    SendTrackMessage(*reply);
+                }
             }
         }
 
@@ -42,6 +42,9 @@ void InterruptSet(bool bValue)
 
 #endif
 
+#include "../Utility/Metrics.h"
+#include "../Testing/ProfilingControl.h"
+
 constexpr int MAX_DEBUG_TELEGRAMS = 500;
 
 #pragma comment(lib, "Iphlpapi.lib")
@@ -491,6 +494,7 @@ bool CCommunicationInterface::GetReceivePackage(std::unique_ptr<CTCPGram> &TCPGr
 
 void CCommunicationInterface::PushSendPackage(std::unique_ptr<CTCPGram> &rTCPGram)
 {
+    rTCPGram->MarkEnqueued();
     std::lock_guard<std::mutex> Lock(m_sendMutex);
     m_arSendBuffer.emplace_back(std::move(rTCPGram));
 }
@@ -1414,6 +1418,12 @@ void CCommunicationThread::ThreadFunction()
     bool                 bUDPBroadcast;
     bool                 bContinueBigLoop = true;
 
+    CTrack::CMetricCounter *pMetricTelegramsSent     = nullptr;
+    CTrack::CMetricCounter *pMetricBytesSent         = nullptr;
+    CTrack::CMetricCounter *pMetricTelegramsReceived = nullptr;
+    CTrack::CMetricCounter *pMetricBytesReceived     = nullptr;
+    CTrack::CMetricGauge   *pMetricSendQueue         = nullptr;
+
     try
     {
         SetQuit(false);
@@ -1440,6 +1450,14 @@ void CCommunicationThread::ThreadFunction()
             CTRACK_THROW_ERROR(ErrorMessage);
         }
 
+        // per port traffic metrics, looked up once for the lifetime of the thread
+        CTrack::CMetricsRegistry &Registry = CTrack::CMetricsRegistry::Instance();
+        pMetricTelegramsSent     = &Registry.Counter(fmt::format("tcp.{}.telegrams_sent", PortNumber));
+        pMetricBytesSent         = &Registry.Counter(fmt::format("tcp.{}.bytes_sent", PortNumber));
+        pMetricTelegramsReceived = &Registry.Counter(fmt::format("tcp.{}.telegrams_received", PortNumber));
+        pMetricBytesReceived     = &Registry.Counter(fmt::format("tcp.{}.bytes_received", PortNumber));
+        pMetricSendQueue         = &Registry.Gauge(fmt::format("tcp.{}.send_queue", PortNumber));
+
         //--------------------------------------------------------------------------------------------------------
         // create the socket
         //--------------------------------------------------------------------------------------------------------
@@ -1648,6 +1666,10 @@ void CCommunicationThread::ThreadFunction()
             // get the next telegram, until all telegrams have been send if sending is not possible because of closed
             // connection, remove the socket from arConnectionSocket
             //--------------------------------------------------------------------------------------------------------
+            {
+                std::lock_guard<std::mutex> Lock(m_sendMutex);
+                pMetricSendQueue->Set(static_cast<double>(m_arSendBuffer.size()));
+            }
             std::unique_ptr<CTCPGram> TCPGram;
             bool                      bAvailable = GetSendPackage(TCPGram);
             while (bAvailable)
@@ -1655,10 +1677,12 @@ void CCommunicationThread::ThreadFunction()
                 bool bAllSocketsCompleted = true;
                 if (TCPGram)
                 {
+                    CTRACK_ZONE_SAMPLED_NC(CTrack::ProfileCategory::Transport, "TCP::Send", 0x44AAFF);
                     if (m_OnSendFunction)
                     {
                         m_OnSendFunction(TCPGram, true, PortNumber);
                     };
+                    TCPGram->MarkWire();
                     SOCKET   Destination    = TCPGram->GetDestination();
                     CSocket *pCurrentSocket = SocketFirst();
                     while (pCurrentSocket != nullptr)
@@ -1690,6 +1714,11 @@ void CCommunicationThread::ThreadFunction()
                 }
                 if (bAllSocketsCompleted) // get the next package
                 {
+                    if (TCPGram)
+                    {
+                        pMetricTelegramsSent->Add();
+                        pMetricBytesSent->Add(TCPGram->GetSize() + sizeof(TMessageHeader));
+                    }
                     bAvailable = GetSendPackage(TCPGram);
                 }
             }
@@ -1705,6 +1734,10 @@ void CCommunicationThread::ThreadFunction()
                     std::unique_ptr<CTCPGram> TCPGram;
                     while (pCurrentSocket->ReadExtractTelegram(TCPGram))
                     {
+                        CTRACK_ZONE_CATEGORY_NC(CTrack::ProfileCategory::Transport, "TCP::Receive", 0x44AAFF);
+                        TCPGram->MarkReceived();
+                        pMetricTelegramsReceived->Add();
+                        pMetricBytesReceived->Add(TCPGram->GetSize() + sizeof(TMessageHeader));
                         if (m_OnReceiveFunction)
                             m_OnReceiveFunction(TCPGram, false, PortNumber);
 
@@ -58,12 +58,72 @@ void CTCPGram::EncodeText(const std::string &iText, unsigned char Code)
 void CTCPGram::EncodeDoubleArray(std::vector<double> &iDoubleArray)
 {
     std::uint16_t NumChannels = iDoubleArray.size();
-    size_t        PackageSize = sizeof(double) * NumChannels + sizeof(std::uint16_t);
+    size_t        DataSize    = sizeof(double) * NumChannels + sizeof(std::uint16_t);
+    size_t        PackageSize = DataSize + (CTrack::FrameTiming::IsTrailerEnabled() ? CTrack::FrameTimestamps::TRAILER_SIZE : 0);
     m_MessageHeader.SetPayloadSize(PackageSize);
     m_MessageHeader.SetCode(TCPGRAM_CODE_DATA);
     m_Data.resize(PackageSize);
     memcpy(m_Data.data(), &NumChannels, sizeof(std::uint16_t));
     memcpy(m_Data.data() + sizeof(std::uint16_t), iDoubleArray.data(), sizeof(double) * NumChannels);
+
+    m_Timestamps.Stamp(CTrack::FrameStage::Encode);
+    if (!m_Timestamps.Has(CTrack::FrameStage::Acquire))
+    {
+        m_Timestamps.Set(CTrack::FrameStage::Acquire, m_Timestamps.Get(CTrack::FrameStage::Encode));
+    }
+    if (PackageSize > DataSize)
+    {
+        m_Timestamps.WriteTrailer(m_Data.data() + DataSize);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+Pipeline timestamps, the trailer follows the doubles of a data telegram
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+static size_t DoubleArraySize(const std::vector<char> &Data)
+{
+    std::uint16_t NumChannels = 0;
+    if (Data.size() < sizeof(std::uint16_t))
+        return Data.size();
+    memcpy(&NumChannels, Data.data(), sizeof(std::uint16_t));
+    return sizeof(std::uint16_t) + sizeof(double) * NumChannels;
+}
+
+bool CTCPGram::HasTimestampTrailer()
+{
+    if (GetCode() != TCPGRAM_CODE_DATA)
+        return false;
+    size_t DataSize = DoubleArraySize(m_Data);
+    return m_Data.size() >= DataSize + CTrack::FrameTimestamps::TRAILER_SIZE;
+}
+
+void CTCPGram::MarkEnqueued()
+{
+    if (GetCode() == TCPGRAM_CODE_DATA)
+        m_Timestamps.Stamp(CTrack::FrameStage::Enqueue);
+}
+
+void CTCPGram::MarkWire()
+{
+    if (GetCode() != TCPGRAM_CODE_DATA || m_Timestamps.Has(CTrack::FrameStage::Wire))
+        return;
+    m_Timestamps.Stamp(CTrack::FrameStage::Wire);
+    if (HasTimestampTrailer())
+        m_Timestamps.WriteTrailer(m_Data.data() + DoubleArraySize(m_Data));
+    CTrack::FrameTiming::RecordSent(m_Timestamps);
+}
+
+void CTCPGram::MarkReceived()
+{
+    if (GetCode() != TCPGRAM_CODE_DATA)
+        return;
+    m_Timestamps.Stamp(CTrack::FrameStage::Receive);
+    size_t DataSize = DoubleArraySize(m_Data);
+    if (m_Data.size() > DataSize && m_Timestamps.ReadTrailer(m_Data.data() + DataSize, m_Data.size() - DataSize))
+        CTrack::FrameTiming::RecordReceived(m_Timestamps);
 }
 
 #ifdef _MANAGED
@@ -95,7 +155,7 @@ bool CTCPGram::GetDoubleArray(std::vector<double> &arDoubles)
 
     std::uint16_t NumChannels = 0;
     memcpy(&NumChannels, m_Data.data(), sizeof(std::uint16_t));
-    assert(NumChannels == (m_Data.size() - sizeof(std::uint16_t)) / sizeof(double));
+    assert(m_Data.size() >= sizeof(std::uint16_t) + sizeof(double) * NumChannels); // may be followed by the timestamp trailer
 
     double *pDouble = reinterpret_cast<double *>(m_Data.data() + sizeof(std::uint16_t));
     arDoubles.resize(NumChannels);
@@ -165,8 +225,9 @@ CTCPGram::CTCPGram(TiXmlElement &rCommand, unsigned char Code)
     EncodeText(XMLText, Code);
 }
 
-CTCPGram::CTCPGram(std::vector<double> &arDoubles)
+CTCPGram::CTCPGram(std::vector<double> &arDoubles, std::int64_t AcquireTimeNs)
 {
+    m_Timestamps.Set(CTrack::FrameStage::Acquire, AcquireTimeNs);
     EncodeDoubleArray(arDoubles);
 }
 
@@ -265,7 +326,9 @@ CTCPGram::CTCPGram(const std::exception &e)
 
 CTCPGram::CTCPGram(const CTrack::Message &message)
 {
-    EncodeText(message.Serialize(), TCPGRAM_CODE_MESSAGE);
+    message.SerializeTo(m_Data);
+    m_MessageHeader.SetPayloadSize(m_Data.size());
+    m_MessageHeader.SetCode(TCPGRAM_CODE_MESSAGE);
 }
 
 void CTCPGram::CopyFrom(std::unique_ptr<CTCPGram> &rFrom)
@@ -273,6 +336,7 @@ void CTCPGram::CopyFrom(std::unique_ptr<CTCPGram> &rFrom)
     m_Destination   = rFrom->m_Destination;
     m_MessageHeader = rFrom->m_MessageHeader;
     m_Data          = rFrom->m_Data;
+    m_Timestamps    = rFrom->m_Timestamps;
 }
 
 unsigned char CTCPGram::GetCode()
@@ -341,7 +405,7 @@ bool CTCPGram::GetMessage(CTrack::Message &message)
 {
     if (GetCode() != TCPGRAM_CODE_MESSAGE)
         return false;
-    message = CTrack::Message::Deserialize(GetText());
+    message = CTrack::Message::Deserialize(m_Data.data(), m_Data.size());
     return true;
 }
 
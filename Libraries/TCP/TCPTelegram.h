@@ -1,5 +1,6 @@
 #pragma once
 
+#include "FrameTiming.h"
 #include "Message.h"
 
 #include <tinyxml.h>
@@ -117,7 +118,7 @@ __pragma(pack(pop))
     explicit CTCPGram(char *pBytes, size_t NumBytes, unsigned char Code);
     explicit CTCPGram(TiXmlElement &rCommand, unsigned char Code);
     explicit CTCPGram(std::unique_ptr<TiXmlElement> &rCommand, unsigned char Code);
-    explicit CTCPGram(std::vector<double> &arDoubles);
+    explicit CTCPGram(std::vector<double> &arDoubles, std::int64_t AcquireTimeNs = 0); // AcquireTimeNs : see FrameTimestamps, 0 = now
     explicit CTCPGram(const std::exception &);
     explicit CTCPGram(const CTrack::Message &);
 
@@ -149,11 +150,16 @@ __pragma(pack(pop))
 #endif
 
   public: // make movable only
-    explicit CTCPGram(CTCPGram &&rTCPGram) noexcept { m_Data = std::move(rTCPGram.m_Data); };
+    explicit CTCPGram(CTCPGram &&rTCPGram) noexcept
+    {
+        m_Data       = std::move(rTCPGram.m_Data);
+        m_Timestamps = rTCPGram.m_Timestamps;
+    };
     CTCPGram &operator=(CTCPGram &&rTCPGram) noexcept
     {
         m_MessageHeader = rTCPGram.m_MessageHeader;
         m_Data          = std::move(rTCPGram.m_Data);
+        m_Timestamps    = rTCPGram.m_Timestamps;
         rTCPGram.m_MessageHeader.Reset();
         return *this;
     }
@@ -185,9 +191,17 @@ __pragma(pack(pop))
     virtual void                          Clear();
     virtual std::exception                GetException();
 
+  public: // pipeline timestamps of data telegrams, see FrameTiming.h
+    void MarkEnqueued();
+    void MarkWire();     // stamps once, patches the trailer and accounts the latencies
+    void MarkReceived(); // reads the trailer if present
+    bool HasTimestampTrailer();
+
   public:
     TMessageHeader    m_MessageHeader;
     std::vector<char> m_Data;
     SOCKET            m_Destination = ALL_DESTINATIONS; // if 0 then all client sockets will get this telegram
     SOCKET            m_Source      = 0;
+
+    CTrack::FrameTimestamps m_Timestamps;
 };
@@ -0,0 +1,459 @@
+#include "ClientStressTest.h"
+#include "../TCP/TCPTelegram.h"
+#include "../Utility/Logging.h"
+#include "../Utility/Metrics.h"
+#include "../Utility/Print.h"
+#include "../XML/ProxyMessages.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <fmt/core.h>
+#include <ws2tcpip.h>
+
+using Clock = std::chrono::steady_clock;
+
+static Clock::duration ToDuration(double seconds)
+{
+    return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+}
+
+static double MicrosecondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+static SOCKET ConnectLoopback(unsigned short port)
+{
+    SOCKET clientSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (clientSocket == INVALID_SOCKET)
+    {
+        return INVALID_SOCKET;
+    }
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port   = htons(port);
+    inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+    if (connect(clientSocket, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == SOCKET_ERROR)
+    {
+        closesocket(clientSocket);
+        return INVALID_SOCKET;
+    }
+    // short receive time-out so the client notices stop requests while the proxy is not streaming
+    DWORD timeoutMs = 50;
+    setsockopt(clientSocket, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char *>(&timeoutMs), sizeof(timeoutMs));
+    return clientSocket;
+}
+
+// a reset instead of a graceful close, the server finds out on its next send
+static void CloseAbortive(SOCKET clientSocket)
+{
+    linger abortive{1, 0};
+    setsockopt(clientSocket, SOL_SOCKET, SO_LINGER, reinterpret_cast<const char *>(&abortive), sizeof(abortive));
+    closesocket(clientSocket);
+}
+
+// splits the received byte stream on the TMessageHeader sizes
+class TelegramSplitter
+{
+  public:
+    void Reset() { m_Buffer.clear(); }
+
+    template <typename OnTelegram> void Feed(const char *pData, size_t size, OnTelegram onTelegram)
+    {
+        m_Buffer.insert(m_Buffer.end(), pData, pData + size);
+        size_t position = 0;
+        while (m_Buffer.size() - position >= sizeof(TMessageHeader))
+        {
+            TMessageHeader header;
+            std::memcpy(header.GetData(), m_Buffer.data() + position, sizeof(TMessageHeader));
+            size_t telegramSize = header.GetPayloadSize() + sizeof(TMessageHeader);
+            if (m_Buffer.size() - position < telegramSize)
+            {
+                break;
+            }
+            onTelegram(header.GetCode());
+            position += telegramSize;
+        }
+        m_Buffer.erase(m_Buffer.begin(), m_Buffer.begin() + position);
+    }
+
+  private:
+    std::vector<char> m_Buffer;
+};
+
+static nlohmann::json HistogramToJson(const CLogHistogram &histogram, double scale)
+{
+    return {{"count", histogram.GetCount()},
+            {"mean", histogram.GetMean() * scale},
+            {"p99", histogram.GetPercentile(0.99) * scale},
+            {"max", histogram.GetMax() * scale}};
+}
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+ClientStressConfig
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+nlohmann::json ClientStressConfig::ToJson() const
+{
+    return {{"clients", NumClients},
+            {"duration", DurationSeconds},
+            {"interval", IntervalSeconds},
+            {"stall", StallSeconds},
+            {"slow_bps", SlowReadBytesPerSecond},
+            {"burst", BurstMessages}};
+}
+
+ClientStressConfig ClientStressConfig::FromJson(const nlohmann::json &params)
+{
+    ClientStressConfig config;
+    if (params.is_number())
+    {
+        config.NumClients = params.get<size_t>();
+        return config;
+    }
+    config.NumClients             = params.value("clients", config.NumClients);
+    config.DurationSeconds        = params.value("duration", config.DurationSeconds);
+    config.IntervalSeconds        = std::max(0.1, params.value("interval", config.IntervalSeconds));
+    config.StallSeconds           = params.value("stall", config.StallSeconds);
+    config.SlowReadBytesPerSecond = std::max(100.0, params.value("slow_bps", config.SlowReadBytesPerSecond));
+    config.BurstMessages          = params.value("burst", config.BurstMessages);
+    return config;
+}
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+ClientStressTest
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+ClientStressTest::ClientStressTest(unsigned short port) : m_Port(port)
+{
+}
+
+ClientStressTest::~ClientStressTest()
+{
+    Stop();
+}
+
+void ClientStressTest::Start(const ClientStressConfig &config)
+{
+    if (m_bRunning)
+    {
+        PrintWarning("Client stress test is already running");
+        return;
+    }
+    if (m_Controller.joinable())
+    {
+        m_Controller.join();
+    }
+
+    m_Config = config;
+    m_Clients.clear();
+    for (size_t i = 0; i < m_Config.NumClients; i++)
+    {
+        auto client       = std::make_unique<ClientState>();
+        client->Index     = i;
+        client->Behaviour = static_cast<ClientBehaviour>(i % 5);
+        m_Clients.push_back(std::move(client));
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_ReportMutex);
+        m_Report = nlohmann::json();
+    }
+
+    m_bStopRequested = false;
+    m_bRunning       = true;
+    m_Controller     = std::thread(&ClientStressTest::RunController, this);
+    PrintInfo("Client stress test STARTED on port {} : {} clients for {} s", m_Port, m_Config.NumClients, m_Config.DurationSeconds);
+}
+
+void ClientStressTest::Stop()
+{
+    m_bStopRequested = true;
+    if (m_Controller.joinable())
+    {
+        m_Controller.join();
+    }
+}
+
+bool ClientStressTest::IsRunning() const
+{
+    return m_bRunning;
+}
+
+nlohmann::json ClientStressTest::GetReport() const
+{
+    std::lock_guard<std::mutex> lock(m_ReportMutex);
+    return m_Report;
+}
+
+const char *ClientStressTest::BehaviourToString(ClientBehaviour behaviour)
+{
+    switch (behaviour)
+    {
+        case ClientBehaviour::Steady:
+            return "steady";
+        case ClientBehaviour::Reconnect:
+            return "reconnect";
+        case ClientBehaviour::Stall:
+            return "stall";
+        case ClientBehaviour::Slow:
+            return "slow";
+        case ClientBehaviour::Burst:
+            return "burst";
+        default:
+            return "unknown";
+    }
+}
+
+void ClientStressTest::RunController()
+{
+    CTrack::CMetricCounter &serverTelegrams = CTrack::CMetricsRegistry::Instance().Counter(fmt::format("tcp.{}.telegrams_sent", m_Port));
+    uint64_t                serverStart     = serverTelegrams.Get();
+    auto                    startTime       = Clock::now();
+    auto                    endTime         = startTime + ToDuration(m_Config.DurationSeconds);
+
+    std::vector<std::thread> clientThreads;
+    for (auto &client : m_Clients)
+    {
+        clientThreads.emplace_back(&ClientStressTest::RunClient, this, std::ref(*client));
+    }
+    while (!m_bStopRequested && Clock::now() < endTime)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    m_bStopRequested = true;
+    for (auto &clientThread : clientThreads)
+    {
+        clientThread.join();
+    }
+
+    double durationSeconds = std::chrono::duration<double>(Clock::now() - startTime).count();
+    BuildReport(durationSeconds);
+    {
+        std::lock_guard<std::mutex> lock(m_ReportMutex);
+        m_Report["server_fps"] = (serverTelegrams.Get() - serverStart) / durationSeconds;
+    }
+    m_bRunning = false;
+}
+
+void ClientStressTest::RunClient(ClientState &client)
+{
+    WSADATA wsaData;
+    WSAStartup(MAKEWORD(2, 2), &wsaData);
+
+    std::string    requestText = CTrack::Message(ProxyMsg::Metrics).Serialize();
+    TMessageHeader requestHeader;
+    requestHeader.SetCode(TCPGRAM_CODE_MESSAGE);
+    requestHeader.SetPayloadSize(static_cast<std::uint32_t>(requestText.size() + 1));
+    std::vector<char> request(requestHeader.GetData(), requestHeader.GetData() + requestHeader.GetHeaderSize());
+    request.insert(request.end(), requestText.c_str(), requestText.c_str() + requestText.size() + 1);
+
+    // the slow reader takes a slice every 10 ms
+    size_t chunkSize = client.Behaviour == ClientBehaviour::Slow ? std::max<size_t>(1, static_cast<size_t>(m_Config.SlowReadBytesPerSecond / 100.0)) : 64 * 1024;
+    std::vector<char> buffer(chunkSize);
+    TelegramSplitter  splitter;
+
+    SOCKET            clientSocket = INVALID_SOCKET;
+    Clock::time_point connectedAt;
+    Clock::time_point recoveryStart = Clock::now();
+    Clock::time_point stallEnd;
+    Clock::time_point burstStart;
+    bool              awaitingFrame = false;
+    bool              awaitingDrain = false;
+    bool              stalled       = false;
+    bool              awaitingBurst = false;
+    uint64_t          burstTarget   = 0;
+
+    // stagger the clients over the interval so their events do not coincide
+    Clock::time_point nextEvent = Clock::now() + ToDuration(m_Config.IntervalSeconds * (1.0 + double(client.Index) / std::max<size_t>(1, m_Config.NumClients)));
+
+    auto disconnect = [&](bool planned)
+    {
+        client.ConnectedSeconds += std::chrono::duration<double>(Clock::now() - connectedAt).count();
+        if (planned)
+        {
+            CloseAbortive(clientSocket);
+        }
+        else
+        {
+            closesocket(clientSocket);
+            client.Disconnects++;
+        }
+        clientSocket  = INVALID_SOCKET;
+        recoveryStart = Clock::now();
+        awaitingDrain = false;
+        stalled       = false;
+        awaitingBurst = false;
+    };
+
+    while (!m_bStopRequested)
+    {
+        if (clientSocket == INVALID_SOCKET)
+        {
+            clientSocket = ConnectLoopback(m_Port);
+            if (clientSocket == INVALID_SOCKET)
+            {
+                client.ConnectFailures++;
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                continue;
+            }
+            client.Connects++;
+            connectedAt   = Clock::now();
+            awaitingFrame = true;
+            splitter.Reset();
+        }
+
+        auto now = Clock::now();
+        if (now >= nextEvent)
+        {
+            nextEvent = now + ToDuration(m_Config.IntervalSeconds);
+            switch (client.Behaviour)
+            {
+                case ClientBehaviour::Reconnect:
+                    disconnect(true);
+                    continue;
+                case ClientBehaviour::Stall:
+                    stalled  = true;
+                    stallEnd = now + ToDuration(m_Config.StallSeconds);
+                    break;
+                case ClientBehaviour::Burst:
+                    burstStart    = now;
+                    burstTarget   = client.Messages + m_Config.BurstMessages;
+                    awaitingBurst = m_Config.BurstMessages > 0;
+                    for (size_t i = 0; i < m_Config.BurstMessages; i++)
+                    {
+                        send(clientSocket, request.data(), static_cast<int>(request.size()), 0);
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+        if (stalled)
+        {
+            if (now < stallEnd)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                continue;
+            }
+            stalled       = false;
+            awaitingDrain = true;
+            recoveryStart = now;
+        }
+
+        int received = recv(clientSocket, buffer.data(), static_cast<int>(buffer.size()), 0);
+        if (received > 0)
+        {
+            client.Bytes += received;
+            splitter.Feed(buffer.data(), received,
+                          [&](unsigned char code)
+                          {
+                              if (code == TCPGRAM_CODE_DATA)
+                              {
+                                  client.Frames++;
+                                  if (awaitingFrame)
+                                  {
+                                      client.RecoveryUs.Record(static_cast<uint64_t>(MicrosecondsSince(recoveryStart)));
+                                      awaitingFrame = false;
+                                  }
+                              }
+                              else if (code == TCPGRAM_CODE_MESSAGE)
+                              {
+                                  client.Messages++;
+                              }
+                          });
+            if (awaitingBurst && client.Messages >= burstTarget)
+            {
+                client.BurstUs.Record(static_cast<uint64_t>(MicrosecondsSince(burstStart)));
+                awaitingBurst = false;
+            }
+            if (awaitingDrain)
+            {
+                u_long pending = 0;
+                if (ioctlsocket(clientSocket, FIONREAD, &pending) != SOCKET_ERROR && pending == 0)
+                {
+                    client.RecoveryUs.Record(static_cast<uint64_t>(MicrosecondsSince(recoveryStart)));
+                    awaitingDrain = false;
+                }
+            }
+            if (client.Behaviour == ClientBehaviour::Slow)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+        }
+        else if (received == 0 || WSAGetLastError() != WSAETIMEDOUT)
+        {
+            disconnect(false); // closed by the server
+        }
+    }
+    if (clientSocket != INVALID_SOCKET)
+    {
+        client.ConnectedSeconds += std::chrono::duration<double>(Clock::now() - connectedAt).count();
+        closesocket(clientSocket);
+    }
+    WSACleanup();
+}
+
+void ClientStressTest::BuildReport(double durationSeconds)
+{
+    nlohmann::json clients = nlohmann::json::array();
+    double         sum = 0.0, sumSquares = 0.0;
+    size_t         numFullRate = 0;
+    double         steadyMin = 0.0, steadyMax = 0.0;
+    for (const auto &client : m_Clients)
+    {
+        double fps  = client->ConnectedSeconds > 0.0 ? client->Frames / client->ConnectedSeconds : 0.0;
+        double mbps = client->ConnectedSeconds > 0.0 ? client->Bytes / client->ConnectedSeconds / 1e6 : 0.0;
+        clients.push_back({{"index", client->Index},
+                           {"behaviour", BehaviourToString(client->Behaviour)},
+                           {"frames", client->Frames.load()},
+                           {"messages", client->Messages.load()},
+                           {"bytes", client->Bytes.load()},
+                           {"fps", fps},
+                           {"mbps", mbps},
+                           {"connects", client->Connects},
+                           {"connect_failures", client->ConnectFailures},
+                           {"disconnects", client->Disconnects},
+                           {"recovery_ms", HistogramToJson(client->RecoveryUs, 1e-3)},
+                           {"burst_ms", HistogramToJson(client->BurstUs, 1e-3)}});
+
+        // steady and burst clients read everything, their rates should be equal
+        if (client->Behaviour == ClientBehaviour::Steady || client->Behaviour == ClientBehaviour::Burst)
+        {
+            sum += fps;
+            sumSquares += fps * fps;
+            numFullRate++;
+        }
+        if (client->Behaviour == ClientBehaviour::Steady)
+        {
+            steadyMin = (steadyMin == 0.0) ? fps : std::min(steadyMin, fps);
+            steadyMax = std::max(steadyMax, fps);
+        }
+    }
+    double fairness = sumSquares > 0.0 ? (sum * sum) / (numFullRate * sumSquares) : 0.0;
+
+    nlohmann::json report = {{"port", m_Port},
+                             {"config", m_Config.ToJson()},
+                             {"duration_s", durationSeconds},
+                             {"fairness", fairness},
+                             {"steady_fps_min", steadyMin},
+                             {"steady_fps_max", steadyMax},
+                             {"clients", clients}};
+    CTrack::CLogging::getInstance().record("stress.clients", report);
+
+    PrintInfo("Client stress test ENDED after {:.0f} s : steady {:.1f}-{:.1f} fps, fairness {:.3f}", durationSeconds, steadyMin, steadyMax, fairness);
+    for (const auto &client : clients)
+    {
+        PrintInfo("  client {:2} {:<10} {:8.1f} fps {:4} disconnects, recovery max {:.1f} ms", client["index"].get<size_t>(),
+                  client["behaviour"].get<std::string>(), client["fps"].get<double>(), client["disconnects"].get<uint64_t>(),
+                  client["recovery_ms"]["max"].get<double>());
+    }
+
+    std::lock_guard<std::mutex> lock(m_ReportMutex);
+    m_Report = std::move(report);
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "../Utility/LogHistogram.h"
+
+#undef strtoull
+#undef strtoll
+#include <nlohmann/json.hpp>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Multi-client load on the TCP server of a proxy
+ *
+ * StressTest drives the IDriver directly, this class exercises the other half : the fan-out loop of
+ * CCommunicationThread that writes every telegram to every connected CSocket and deletes sockets on
+ * disconnect. It opens raw loopback sockets to the proxy port (not CCommunicationObject clients, those would
+ * share the communication thread of the server in the same process) and gives every client a behaviour :
+ *
+ *   steady      reads as fast as possible, the reference for the delivery rate
+ *   reconnect   drops the connection every interval and reconnects
+ *   stall       stops reading for StallSeconds every interval, so its socket buffers fill up
+ *   slow        reads at most SlowReadBytesPerSecond
+ *   burst       sends BurstMessages proxy.metrics requests every interval
+ *
+ * Behaviours are assigned round robin. Start it while the proxy streams at full rate. The report gives per
+ * client the delivery rate, the recovery times (reconnect until the first data telegram, end of a stall until
+ * the receive buffer is drained) and the Jain fairness index of the steady and burst clients, which should all
+ * receive every frame :
+ *
+ *   { "port", "duration_s", "fairness", "steady_fps_min", "steady_fps_max",
+ *     "clients": [ { "index", "behaviour", "frames", "messages", "bytes", "fps", "mbps", "connects", "connect_failures",
+ *                    "disconnects", "recovery_ms": { "count", "mean", "p99", "max" }, "burst_ms": {...} } ] }
+ */
+struct ClientStressConfig
+{
+    size_t NumClients{10};
+    double DurationSeconds{60.0};
+    double IntervalSeconds{5.0};           // period of reconnects, stalls and bursts
+    double StallSeconds{2.0};
+    double SlowReadBytesPerSecond{100000.0};
+    size_t BurstMessages{50};
+
+    nlohmann::json            ToJson() const;
+    static ClientStressConfig FromJson(const nlohmann::json &params);
+};
+
+class ClientStressTest
+{
+  public:
+    enum class ClientBehaviour
+    {
+        Steady,
+        Reconnect,
+        Stall,
+        Slow,
+        Burst
+    };
+
+    explicit ClientStressTest(unsigned short port);
+    ~ClientStressTest();
+
+    void Start(const ClientStressConfig &config);
+    void Stop();
+    bool IsRunning() const;
+
+    // valid once the run has ended, also recorded in the log as "stress.clients"
+    nlohmann::json GetReport() const;
+
+  private:
+    struct ClientState
+    {
+        size_t                Index{0};
+        ClientBehaviour       Behaviour{ClientBehaviour::Steady};
+        std::atomic<uint64_t> Frames{0};
+        std::atomic<uint64_t> Messages{0};
+        std::atomic<uint64_t> Bytes{0};
+        uint64_t              Connects{0};
+        uint64_t              ConnectFailures{0};
+        uint64_t              Disconnects{0};       // by the server, not the planned reconnects
+        double                ConnectedSeconds{0.0};
+        CLogHistogram         RecoveryUs;
+        CLogHistogram         BurstUs;              // burst sent until as many message telegrams arrived
+    };
+
+    void        RunController();
+    void        RunClient(ClientState &client);
+    void        BuildReport(double durationSeconds);
+    static const char *BehaviourToString(ClientBehaviour behaviour);
+
+    unsigned short                            m_Port;
+    ClientStressConfig                        m_Config;
+    std::vector<std::unique_ptr<ClientState>> m_Clients;
+    std::thread                               m_Controller;
+    std::atomic<bool>                         m_bRunning{false};
+    std::atomic<bool>                         m_bStopRequested{false};
+    nlohmann::json                            m_Report;
+    mutable std::mutex                        m_ReportMutex;
+};
@@ -0,0 +1,329 @@
+#include "FlightRecorder.h"
+#include "../TCP/Message.h"
+#include "../Utility/Logging.h"
+#include "../Utility/Print.h"
+#include "../XML/ProxyMessages.h"
+
+#include <algorithm>
+#include <fmt/format.h>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <windows.h>
+
+namespace CTrack
+{
+    namespace FlightRecorder
+    {
+        //------------------------------------------------------------------------------------------------------------------
+        /*
+        Rings
+
+        A ring is written by its owner thread only. The fields of an entry are relaxed atomics so that a dump can read
+        them while the owner keeps recording; the owner publishes an entry by advancing Head. Entries the owner may
+        have overwritten while the dump copied them are dropped, so a dump never shows a torn zone.
+
+        Rings are never freed : a thread that ends releases its ring for the next new thread. The ring keeps the index
+        at which every owner started, so the entries of ended threads stay in the dump until they are overwritten.
+        */
+        //------------------------------------------------------------------------------------------------------------------
+
+        struct Entry
+        {
+            std::atomic<const ZoneSite *> Site{nullptr};
+            std::atomic<uint64_t>         Start{0};
+            std::atomic<uint64_t>         End{0};
+        };
+
+        struct ThreadRing
+        {
+            explicit ThreadRing(size_t Capacity) : Entries(std::make_unique<Entry[]>(Capacity)), Mask(Capacity - 1) {}
+
+            std::unique_ptr<Entry[]>                   Entries;
+            size_t                                     Mask;
+            std::atomic<uint64_t>                      Head{0};
+            std::vector<std::pair<uint64_t, uint32_t>> Owners; // first entry index, thread id
+            bool                                       bInUse{false};
+        };
+
+        struct Registry
+        {
+            std::mutex                               Lock;
+            std::vector<std::unique_ptr<ThreadRing>> Rings;
+            size_t                                   EntriesPerThread{DEFAULT_ENTRIES_PER_THREAD};
+            uint64_t                                 CalibrationTicks{Ticks()};
+            std::chrono::steady_clock::time_point    CalibrationTime{std::chrono::steady_clock::now()};
+            std::chrono::steady_clock::time_point    LastErrorDump{};
+            size_t                                   DumpCount{0};
+        };
+
+        static Registry &GetRegistry()
+        {
+            static Registry Instance;
+            return Instance;
+        }
+
+        static size_t RoundUpToPowerOfTwo(size_t Value)
+        {
+            size_t Result = 1;
+            while (Result < Value)
+            {
+                Result <<= 1;
+            }
+            return Result;
+        }
+
+        static ThreadRing *AcquireRing()
+        {
+            Registry                   &Reg = GetRegistry();
+            std::lock_guard<std::mutex> Lock(Reg.Lock);
+
+            ThreadRing *pRing = nullptr;
+            for (auto &pCandidate : Reg.Rings)
+            {
+                if (!pCandidate->bInUse && pCandidate->Mask + 1 == Reg.EntriesPerThread)
+                {
+                    pRing = pCandidate.get();
+                    break;
+                }
+            }
+            if (!pRing)
+            {
+                Reg.Rings.push_back(std::make_unique<ThreadRing>(Reg.EntriesPerThread));
+                pRing = Reg.Rings.back().get();
+            }
+            // owners whose entries have all been overwritten are forgotten
+            uint64_t Head     = pRing->Head.load(std::memory_order_relaxed);
+            uint64_t Capacity = pRing->Mask + 1;
+            while (pRing->Owners.size() > 1 && pRing->Owners[1].first + Capacity <= Head)
+            {
+                pRing->Owners.erase(pRing->Owners.begin());
+            }
+            pRing->Owners.emplace_back(Head, static_cast<uint32_t>(GetCurrentThreadId()));
+            pRing->bInUse = true;
+            return pRing;
+        }
+
+        // releases the ring of the thread when the thread ends
+        struct RingOwner
+        {
+            ThreadRing *pRing{nullptr};
+
+            ~RingOwner()
+            {
+                if (pRing)
+                {
+                    std::lock_guard<std::mutex> Lock(GetRegistry().Lock);
+                    pRing->bInUse = false;
+                }
+            }
+        };
+
+        static thread_local RingOwner t_Ring;
+
+        void SetEnabled(bool bEnabled, size_t EntriesPerThread)
+        {
+            if (EntriesPerThread > 0)
+            {
+                Registry                   &Reg = GetRegistry();
+                std::lock_guard<std::mutex> Lock(Reg.Lock);
+                Reg.EntriesPerThread = RoundUpToPowerOfTwo(std::clamp(EntriesPerThread, MIN_ENTRIES_PER_THREAD, MAX_ENTRIES_PER_THREAD));
+            }
+            g_Enabled.store(bEnabled, std::memory_order_relaxed);
+        }
+
+        void Record(const ZoneSite *pSite, uint64_t Start, uint64_t End)
+        {
+            ThreadRing *pRing = t_Ring.pRing;
+            if (!pRing)
+            {
+                pRing = t_Ring.pRing = AcquireRing();
+            }
+            uint64_t Head  = pRing->Head.load(std::memory_order_relaxed);
+            Entry   &Slot  = pRing->Entries[Head & pRing->Mask];
+            Slot.Site.store(pSite, std::memory_order_relaxed);
+            Slot.Start.store(Start, std::memory_order_relaxed);
+            Slot.End.store(End, std::memory_order_relaxed);
+            pRing->Head.store(Head + 1, std::memory_order_release);
+        }
+
+        //------------------------------------------------------------------------------------------------------------------
+        /*
+        Chrome trace
+
+        { "displayTimeUnit": "ns", "traceEvents": [ { "name", "cat": "zone", "ph": "X", "ts", "dur", "pid", "tid",
+                                                      "args": { "function", "file", "line" } }, ... ] }
+
+        ts and dur are in microseconds since the start of the process clock, so the traces of several proxies on one
+        PC line up when they are loaded together.
+        */
+        //------------------------------------------------------------------------------------------------------------------
+
+        struct Snapshot
+        {
+            uint32_t       ThreadId;
+            const ZoneSite *pSite;
+            uint64_t       Start;
+            uint64_t       End;
+        };
+
+        static void CopyRing(ThreadRing &Ring, std::vector<Snapshot> &Result)
+        {
+            uint64_t Capacity = Ring.Mask + 1;
+            uint64_t Head     = Ring.Head.load(std::memory_order_acquire);
+            uint64_t From     = Head > Capacity ? Head - Capacity : 0;
+            size_t   Offset   = Result.size();
+            size_t   Owner    = 0;
+
+            for (uint64_t Index = From; Index < Head; ++Index)
+            {
+                while (Owner + 1 < Ring.Owners.size() && Ring.Owners[Owner + 1].first <= Index)
+                {
+                    ++Owner;
+                }
+                const Entry &Slot = Ring.Entries[Index & Ring.Mask];
+                Result.push_back({Ring.Owners[Owner].second, Slot.Site.load(std::memory_order_relaxed), Slot.Start.load(std::memory_order_relaxed),
+                                  Slot.End.load(std::memory_order_relaxed)});
+            }
+
+            // the owner may have lapped the copy, one extra entry for the slot it is writing now
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint64_t NewHead = Ring.Head.load(std::memory_order_relaxed);
+            if (NewHead + 1 > From + Capacity)
+            {
+                uint64_t Overwritten = std::min<uint64_t>(NewHead + 1 - Capacity - From, Head - From);
+                Result.erase(Result.begin() + Offset, Result.begin() + Offset + static_cast<size_t>(Overwritten));
+            }
+        }
+
+        size_t DumpChromeTrace(const std::string &FileName)
+        {
+            Registry             &Reg = GetRegistry();
+            std::vector<Snapshot> Zones;
+            double                NsPerTick = 1.0;
+            {
+                std::lock_guard<std::mutex> Lock(Reg.Lock);
+                for (auto &pRing : Reg.Rings)
+                {
+                    CopyRing(*pRing, Zones);
+                }
+            }
+#ifdef CTRACK_FLIGHT_RECORDER_TSC
+            // the counter rate from the time since startup, a short run gets a longer reference
+            if (std::chrono::steady_clock::now() - Reg.CalibrationTime < std::chrono::milliseconds(100))
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+            uint64_t NowTicks  = Ticks();
+            double   ElapsedNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - Reg.CalibrationTime).count();
+            NsPerTick          = ElapsedNs / static_cast<double>(NowTicks - Reg.CalibrationTicks);
+#endif
+
+            std::ofstream File(FileName, std::ios::out | std::ios::trunc);
+            if (!File.is_open())
+            {
+                throw std::runtime_error(fmt::format("cannot write the trace file {}", FileName));
+            }
+
+            double   BaseUs    = std::chrono::duration<double, std::micro>(Reg.CalibrationTime.time_since_epoch()).count();
+            uint32_t ProcessId = static_cast<uint32_t>(GetCurrentProcessId());
+            auto     ToUs      = [&](uint64_t Tick) { return BaseUs + static_cast<double>(static_cast<int64_t>(Tick - Reg.CalibrationTicks)) * NsPerTick / 1000.0; };
+
+            // names and paths are escaped once per site, Windows paths contain backslashes
+            std::unordered_map<const ZoneSite *, std::string> Escaped;
+
+            File << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+            size_t Count = 0;
+            for (const Snapshot &Zone : Zones)
+            {
+                if (!Zone.pSite)
+                {
+                    continue;
+                }
+                std::string &Fields = Escaped[Zone.pSite];
+                if (Fields.empty())
+                {
+                    const ZoneSite &Site = *Zone.pSite;
+                    Fields = fmt::format("\"name\":{},\"cat\":\"zone\",\"ph\":\"X\",\"args\":{{\"function\":{},\"file\":{},\"line\":{}}}",
+                                         nlohmann::json(Site.Name ? Site.Name : Site.Function).dump(), nlohmann::json(Site.Function).dump(),
+                                         nlohmann::json(Site.File).dump(), Site.Line);
+                }
+                double Start = ToUs(Zone.Start);
+                File << (Count++ ? ",\n" : "\n")
+                     << fmt::format("{{{},\"ts\":{:.3f},\"dur\":{:.3f},\"pid\":{},\"tid\":{}}}", Fields, Start, ToUs(Zone.End) - Start, ProcessId, Zone.ThreadId);
+            }
+            File << "\n]}\n";
+            return Count;
+        }
+
+        static std::string NextDumpFileName()
+        {
+            Registry &Reg = GetRegistry();
+            size_t    Number;
+            {
+                std::lock_guard<std::mutex> Lock(Reg.Lock);
+                Number = ++Reg.DumpCount;
+            }
+            return GetLogFileName(fmt::format("trace{}.json", Number));
+        }
+
+        static std::string Dump(std::string FileName, std::string_view Reason)
+        {
+            if (FileName.empty())
+            {
+                FileName = NextDumpFileName();
+            }
+            size_t Count = DumpChromeTrace(FileName);
+            PrintInfo("Flight recorder : {} zones written to {}", Count, FileName);
+            CLogging::getInstance().record("flight_recorder.dump", {{"file", FileName}, {"zones", Count}, {"reason", Reason}});
+            return FileName;
+        }
+
+        std::string DumpOnError(std::string_view Reason)
+        {
+            if (!IsEnabled())
+            {
+                return {};
+            }
+            Registry &Reg = GetRegistry();
+            {
+                std::lock_guard<std::mutex> Lock(Reg.Lock);
+                auto                        Now = std::chrono::steady_clock::now();
+                if (Reg.LastErrorDump != std::chrono::steady_clock::time_point{} && Now - Reg.LastErrorDump < std::chrono::seconds(10))
+                {
+                    return {};
+                }
+                Reg.LastErrorDump = Now;
+            }
+            try
+            {
+                return Dump({}, Reason);
+            }
+            catch (const std::exception &e)
+            {
+                PrintError("Flight recorder : {}", e.what());
+                return {};
+            }
+        }
+
+        Reply OnDumpTrace(const Message &message)
+        {
+            const auto &Params = message.GetParams();
+            if (Params.contains(ProxyParam::FlightRecorder))
+            {
+                SetEnabled(Params[ProxyParam::FlightRecorder].get<bool>());
+            }
+
+            Reply reply                                    = std::make_unique<Message>(ProxyMsg::DumpTrace);
+            reply->GetParams()[ProxyParam::FlightRecorder] = IsEnabled();
+            if (IsEnabled())
+            {
+                std::string FileName                      = Dump(Params.value(ProxyParam::TraceFile, std::string()), "message");
+                reply->GetParams()[ProxyParam::TraceFile] = FileName;
+            }
+            return reply;
+        }
+    } // namespace FlightRecorder
+} // namespace CTrack
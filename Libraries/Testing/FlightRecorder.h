@@ -0,0 +1,113 @@
+#pragma once
+
+//
+// FlightRecorder.h
+//
+// Always-on recording of the CTRACK_ZONE_* scopes for when no Tracy profiler is attached.
+//
+// Every thread owns a fixed size ring of (zone, start, end) entries. Closing a zone stores three words
+// in the ring of the calling thread, no lock and no allocation, so the recorder can stay enabled in the
+// field. The newest entries of all rings are written as a Chrome trace (chrome://tracing, Perfetto UI)
+// on demand, on an error, or on the proxy.dump_trace message.
+//
+// Usage:
+//   1. Call CTrack::FlightRecorder::SetEnabled(true, entries) at startup, see ProxyCmdLine::FlightRecorder
+//   2. The CTRACK_ZONE_* macros of ProfilingControl.h record, with or without TRACY_ENABLE
+//   3. CTRACK_FLIGHT_ZONE(name) records a scope that is not sent to Tracy
+//
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define CTRACK_FLIGHT_RECORDER_TSC
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CTRACK_FLIGHT_RECORDER_TSC
+#endif
+
+namespace CTrack
+{
+    class Message;
+    using Reply = std::unique_ptr<Message>;
+
+    namespace FlightRecorder
+    {
+        // static per macro expansion, a Name of nullptr shows the Function
+        struct ZoneSite
+        {
+            const char *Name;
+            const char *Function;
+            const char *File;
+            uint32_t    Line;
+        };
+
+        constexpr size_t DEFAULT_ENTRIES_PER_THREAD = 16384;
+        constexpr size_t MIN_ENTRIES_PER_THREAD     = 64;
+        constexpr size_t MAX_ENTRIES_PER_THREAD     = size_t(1) << 20; // 24 MB per thread
+
+        inline std::atomic<bool> g_Enabled{false};
+
+        // EntriesPerThread is clamped to MIN/MAX_ENTRIES_PER_THREAD, rounded up to a power of two and applies to
+        // the rings of threads that record for the first time afterwards, 0 keeps the current size
+        void SetEnabled(bool bEnabled, size_t EntriesPerThread = 0);
+
+        inline bool IsEnabled()
+        {
+            return g_Enabled.load(std::memory_order_relaxed);
+        }
+
+        // time stamp counter where available, converted to nanoseconds when the trace is written
+        inline uint64_t Ticks()
+        {
+#ifdef CTRACK_FLIGHT_RECORDER_TSC
+            return __rdtsc();
+#else
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+        }
+
+        void Record(const ZoneSite *pSite, uint64_t Start, uint64_t End);
+
+        // writes the rings as Chrome trace json, returns the number of zones written
+        size_t DumpChromeTrace(const std::string &FileName);
+
+        // dump next to the log file, at most once every ten seconds so that an error storm does not fill the
+        // disk; returns the file name or an empty string when nothing was written
+        std::string DumpOnError(std::string_view Reason);
+
+        // handler for ProxyMsg::DumpTrace, params { "file": name, "flight_recorder": bool } are both optional
+        Reply OnDumpTrace(const Message &message);
+
+        class CZone
+        {
+          public:
+            explicit CZone(const ZoneSite *pSite) : m_pSite(IsEnabled() ? pSite : nullptr), m_Start(m_pSite ? Ticks() : 0) {}
+            ~CZone()
+            {
+                if (m_pSite)
+                {
+                    Record(m_pSite, m_Start, Ticks());
+                }
+            }
+            CZone(const CZone &)            = delete;
+            CZone &operator=(const CZone &) = delete;
+
+          protected:
+            const ZoneSite *m_pSite;
+            uint64_t        m_Start;
+        };
+    } // namespace FlightRecorder
+} // namespace CTrack
+
+#define CTRACK_FLIGHT_CONCAT_IMPL(a, b) a##b
+#define CTRACK_FLIGHT_CONCAT(a, b)      CTRACK_FLIGHT_CONCAT_IMPL(a, b)
+
+#define CTRACK_FLIGHT_ZONE(name) \
+    static constexpr CTrack::FlightRecorder::ZoneSite CTRACK_FLIGHT_CONCAT(__ctrack_flight_site,__LINE__) { name, __FUNCTION__, __FILE__, (uint32_t)__LINE__ }; \
+    CTrack::FlightRecorder::CZone CTRACK_FLIGHT_CONCAT(__ctrack_flight_zone,__LINE__)( &CTRACK_FLIGHT_CONCAT(__ctrack_flight_site,__LINE__) );
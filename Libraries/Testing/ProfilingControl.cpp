@@ -0,0 +1,100 @@
+#include "ProfilingControl.h"
+#include "../TCP/Message.h"
+#include "../XML/ProxyMessages.h"
+
+#include <algorithm>
+#include <fmt/core.h>
+#include <stdexcept>
+
+namespace CTrack
+{
+    // names of the categories in the settings
+    static const std::pair<const char *, uint32_t> CategoryNames[] = {
+        {"general", ProfileCategory::General},
+        {"driver", ProfileCategory::Driver},
+        {"transport", ProfileCategory::Transport},
+        {"messaging", ProfileCategory::Messaging},
+        {"logging", ProfileCategory::Logging},
+    };
+
+    nlohmann::json GetProfilingSettings()
+    {
+        uint32_t       Categories = g_ProfilingCategories.load(std::memory_order_relaxed);
+        nlohmann::json Names      = nlohmann::json::array();
+        for (const auto &[Name, Bit] : CategoryNames)
+        {
+            if (Categories & Bit)
+            {
+                Names.push_back(Name);
+            }
+        }
+        return {{ProxyParam::Enabled, IsProfilingEnabled()},
+                {ProxyParam::Categories, Names},
+                {ProxyParam::SampleEvery, g_ProfilingSampleEvery.load(std::memory_order_relaxed)}};
+    }
+
+    void ConfigureProfiling(const nlohmann::json &Settings)
+    {
+        // validate every key first, a bad one leaves all settings as they were
+        const bool bCategories  = Settings.contains(ProxyParam::Categories);
+        const bool bSampleEvery = Settings.contains(ProxyParam::SampleEvery);
+        const bool bEnabled     = Settings.contains(ProxyParam::Enabled);
+        uint32_t   Categories   = 0;
+        uint32_t   Every        = 1;
+        if (bCategories)
+        {
+            if (!Settings[ProxyParam::Categories].is_array())
+            {
+                throw std::invalid_argument(fmt::format("profiling '{}' must be an array of category names", ProxyParam::Categories));
+            }
+            for (const auto &Name : Settings[ProxyParam::Categories])
+            {
+                const std::string Key   = Name.is_string() ? Name.get<std::string>() : Name.dump();
+                auto              Found = std::find_if(std::begin(CategoryNames), std::end(CategoryNames), [&Key](const auto &Entry) { return Key == Entry.first; });
+                if (Found == std::end(CategoryNames))
+                {
+                    throw std::invalid_argument(fmt::format("unknown profiling category '{}'", Key));
+                }
+                Categories |= Found->second;
+            }
+        }
+        if (bSampleEvery)
+        {
+            const nlohmann::json &Value = Settings[ProxyParam::SampleEvery];
+            if (!Value.is_number_integer() || Value.get<int64_t>() < 0 || Value.get<int64_t>() > UINT32_MAX)
+            {
+                throw std::invalid_argument(fmt::format("profiling '{}' must be a frame count, not {}", ProxyParam::SampleEvery, Value.dump()));
+            }
+            Every = std::max(1u, static_cast<uint32_t>(Value.get<int64_t>()));
+        }
+        if (bEnabled && !Settings[ProxyParam::Enabled].is_boolean())
+        {
+            throw std::invalid_argument(fmt::format("profiling '{}' must be true or false", ProxyParam::Enabled));
+        }
+
+        if (bCategories)
+        {
+            g_ProfilingCategories.store(Categories, std::memory_order_relaxed);
+        }
+        if (bSampleEvery)
+        {
+            g_ProfilingSampleEvery.store(Every, std::memory_order_relaxed);
+            g_ProfilingFrame.store(0, std::memory_order_relaxed);
+            if (Every == 1)
+            {
+                g_ProfilingActive.fetch_or(ProfileCategory::SampledFrame, std::memory_order_relaxed);
+            }
+        }
+        if (bEnabled)
+        {
+            g_ProfilingEnabled.store(Settings[ProxyParam::Enabled].get<bool>(), std::memory_order_relaxed);
+        }
+        UpdateProfilingActive();
+    }
+
+    Reply OnProfiling(const Message &message)
+    {
+        ConfigureProfiling(message.GetParams());
+        return std::make_unique<Message>(ProxyMsg::Profiling, GetProfilingSettings());
+    }
+} // namespace CTrack
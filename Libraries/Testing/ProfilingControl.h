@@ -14,31 +14,116 @@
 //   4. Use CTRACK_PLOT instead of TracyPlot
 //   5. Use CTRACK_MESSAGE_* instead of TracyMessage*
 //
+// Zones belong to a category that can be switched off on its own
+// (CTRACK_ZONE_CATEGORY_NC). Zones that run every device frame use
+// CTRACK_ZONE_SAMPLED_NC and are only captured in 1 out of N frames; the
+// driver marks the start of a frame with CTRACK_PROFILE_FRAME. Both are set
+// at runtime with the proxy.profiling message (ConfigureProfiling).
+//
+// The zone macros also record into the flight recorder when it is enabled,
+// independent of TRACY_ENABLE and of the profiling flag (FlightRecorder.h).
+//
 
 #ifdef TRACY_ENABLE
 #include <tracy/Tracy.hpp>
 #endif
 
+#include "FlightRecorder.h"
+
+#undef strtoull
+#undef strtoll
+#include <nlohmann/json.hpp>
+
 #include <atomic>
+#include <cstdint>
+#include <memory>
 
 namespace CTrack
 {
 
+class Message;
+using Reply = std::unique_ptr<Message>;
+
+namespace ProfileCategory
+{
+    constexpr uint32_t General   = 0x01; // CTRACK_ZONE_SCOPED* without a category
+    constexpr uint32_t Driver    = 0x02;
+    constexpr uint32_t Transport = 0x04;
+    constexpr uint32_t Messaging = 0x08;
+    constexpr uint32_t Logging   = 0x10;
+    constexpr uint32_t All       = 0xFF;
+
+    // not a category : set during the frames picked by the 1-in-N sampling
+    constexpr uint32_t SampledFrame = 0x100;
+} // namespace ProfileCategory
+
 // Global profiling enabled flag - thread-safe
 inline std::atomic<bool> g_ProfilingEnabled{false};
 
+// Enabled categories and sampling, set through ConfigureProfiling
+inline std::atomic<uint32_t> g_ProfilingCategories{ProfileCategory::All};
+inline std::atomic<uint32_t> g_ProfilingSampleEvery{1};
+inline std::atomic<uint32_t> g_ProfilingFrame{0};
+
+// The flag, the categories and SampledFrame folded in one word, a zone tests it with a single relaxed load
+inline std::atomic<uint32_t> g_ProfilingActive{ProfileCategory::SampledFrame};
+
+inline void UpdateProfilingActive()
+{
+    uint32_t Categories = g_ProfilingEnabled.load(std::memory_order_relaxed) ? g_ProfilingCategories.load(std::memory_order_relaxed) : 0;
+
+    // SampledFrame is owned by AdvanceProfilingFrame, only the category bits are replaced
+    uint32_t Active = g_ProfilingActive.load(std::memory_order_relaxed);
+    while (!g_ProfilingActive.compare_exchange_weak(Active, (Active & ProfileCategory::SampledFrame) | Categories, std::memory_order_relaxed))
+    {
+    }
+}
+
 // Set profiling enabled/disabled at runtime
 inline void SetProfilingEnabled(bool enabled)
 {
-    g_ProfilingEnabled.store(enabled, std::memory_order_release);
+    g_ProfilingEnabled.store(enabled, std::memory_order_relaxed);
+    UpdateProfilingActive();
 }
 
 // Check if profiling is enabled
 inline bool IsProfilingEnabled()
 {
-    return g_ProfilingEnabled.load(std::memory_order_acquire);
+    return g_ProfilingEnabled.load(std::memory_order_relaxed);
+}
+
+// All bits of Required are active : the categories of the zone, plus SampledFrame for a sampled zone
+inline bool IsProfilingActive(uint32_t Required)
+{
+    return (g_ProfilingActive.load(std::memory_order_relaxed) & Required) == Required;
+}
+
+// Start of a device frame, picks the frames in which the sampled zones are captured
+inline void AdvanceProfilingFrame()
+{
+    uint32_t Every    = g_ProfilingSampleEvery.load(std::memory_order_relaxed);
+    bool     bSampled = Every <= 1 || g_ProfilingFrame.fetch_add(1, std::memory_order_relaxed) % Every == 0;
+    bool     bActive  = (g_ProfilingActive.load(std::memory_order_relaxed) & ProfileCategory::SampledFrame) != 0;
+    if (bSampled && !bActive)
+    {
+        g_ProfilingActive.fetch_or(ProfileCategory::SampledFrame, std::memory_order_relaxed);
+    }
+    else if (!bSampled && bActive)
+    {
+        g_ProfilingActive.fetch_and(~ProfileCategory::SampledFrame, std::memory_order_relaxed);
+    }
 }
 
+// { "enabled": bool, "categories": [ "general", "driver", "transport", "messaging", "logging" ], "sample_every": N }
+nlohmann::json GetProfilingSettings();
+
+// same keys as GetProfilingSettings, all optional. Throws std::invalid_argument on an unknown category or a value
+// of the wrong type, before any setting is changed
+void ConfigureProfiling(const nlohmann::json &Settings);
+
+// handler for ProxyMsg::Profiling, the params are passed to ConfigureProfiling, replies the settings
+Reply OnProfiling(const Message &message);
+
 } // namespace CTrack
 
 //
@@ -53,21 +138,22 @@ inline bool IsProfilingEnabled()
 // Zone macros - use Tracy's internal structure with our profiling flag
 // The 'active' parameter controls whether the zone actually captures data
 
-#define CTRACK_ZONE_SCOPED() \
-    static constexpr tracy::SourceLocationData TracyConcat(__tracy_source_location,TracyLine) { nullptr, TracyFunction, TracyFile, (uint32_t)TracyLine, 0 }; \
-    tracy::ScopedZone TracyConcat(___tracy_scoped_zone,TracyLine)( &TracyConcat(__tracy_source_location,TracyLine), CTrack::IsProfilingEnabled() );
+#define CTRACK_ZONE_ACTIVE(name, color, required) \
+    static constexpr tracy::SourceLocationData TracyConcat(__tracy_source_location,TracyLine) { name, TracyFunction, TracyFile, (uint32_t)TracyLine, color }; \
+    tracy::ScopedZone TracyConcat(___tracy_scoped_zone,TracyLine)( &TracyConcat(__tracy_source_location,TracyLine), CTrack::IsProfilingActive(required) ); \
+    CTRACK_FLIGHT_ZONE(name)
 
-#define CTRACK_ZONE_SCOPED_N(name) \
-    static constexpr tracy::SourceLocationData TracyConcat(__tracy_source_location,TracyLine) { name, TracyFunction, TracyFile, (uint32_t)TracyLine, 0 }; \
-    tracy::ScopedZone TracyConcat(___tracy_scoped_zone,TracyLine)( &TracyConcat(__tracy_source_location,TracyLine), CTrack::IsProfilingEnabled() );
+#define CTRACK_ZONE_SCOPED()                           CTRACK_ZONE_ACTIVE(nullptr, 0, CTrack::ProfileCategory::General)
+#define CTRACK_ZONE_SCOPED_N(name)                     CTRACK_ZONE_ACTIVE(name, 0, CTrack::ProfileCategory::General)
+#define CTRACK_ZONE_SCOPED_C(color)                    CTRACK_ZONE_ACTIVE(nullptr, color, CTrack::ProfileCategory::General)
+#define CTRACK_ZONE_SCOPED_NC(name, color)             CTRACK_ZONE_ACTIVE(name, color, CTrack::ProfileCategory::General)
 
-#define CTRACK_ZONE_SCOPED_C(color) \
-    static constexpr tracy::SourceLocationData TracyConcat(__tracy_source_location,TracyLine) { nullptr, TracyFunction, TracyFile, (uint32_t)TracyLine, color }; \
-    tracy::ScopedZone TracyConcat(___tracy_scoped_zone,TracyLine)( &TracyConcat(__tracy_source_location,TracyLine), CTrack::IsProfilingEnabled() );
+// Zone of one category, and a per-frame zone that is only captured in the sampled frames
+#define CTRACK_ZONE_CATEGORY_NC(category, name, color) CTRACK_ZONE_ACTIVE(name, color, (category))
+#define CTRACK_ZONE_SAMPLED_NC(category, name, color)  CTRACK_ZONE_ACTIVE(name, color, (category) | CTrack::ProfileCategory::SampledFrame)
 
-#define CTRACK_ZONE_SCOPED_NC(name, color) \
-    static constexpr tracy::SourceLocationData TracyConcat(__tracy_source_location,TracyLine) { name, TracyFunction, TracyFile, (uint32_t)TracyLine, color }; \
-    tracy::ScopedZone TracyConcat(___tracy_scoped_zone,TracyLine)( &TracyConcat(__tracy_source_location,TracyLine), CTrack::IsProfilingEnabled() );
+// Start of a device frame for the 1-in-N sampling
+#define CTRACK_PROFILE_FRAME() CTrack::AdvanceProfilingFrame()
 
 // Frame mark - only if profiling enabled
 #define CTRACK_FRAME_MARK() \
@@ -95,11 +181,14 @@ inline bool IsProfilingEnabled()
 
 #else // TRACY_ENABLE not defined
 
-// No-op macros when Tracy is not enabled
-#define CTRACK_ZONE_SCOPED()
-#define CTRACK_ZONE_SCOPED_N(name)
-#define CTRACK_ZONE_SCOPED_C(color)
-#define CTRACK_ZONE_SCOPED_NC(name, color)
+// Without Tracy the zones only feed the flight recorder, the other macros are no-ops
+#define CTRACK_ZONE_SCOPED()                           CTRACK_FLIGHT_ZONE(nullptr)
+#define CTRACK_ZONE_SCOPED_N(name)                     CTRACK_FLIGHT_ZONE(name)
+#define CTRACK_ZONE_SCOPED_C(color)                    CTRACK_FLIGHT_ZONE(nullptr)
+#define CTRACK_ZONE_SCOPED_NC(name, color)             CTRACK_FLIGHT_ZONE(name)
+#define CTRACK_ZONE_CATEGORY_NC(category, name, color) CTRACK_FLIGHT_ZONE(name)
+#define CTRACK_ZONE_SAMPLED_NC(category, name, color)  CTRACK_FLIGHT_ZONE(name)
+#define CTRACK_PROFILE_FRAME()
 #define CTRACK_FRAME_MARK()
 #define CTRACK_FRAME_MARK_NAMED(name)
 #define CTRACK_PLOT(name, val)
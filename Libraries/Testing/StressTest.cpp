@@ -1,17 +1,33 @@
 #include "StressTest.h"
+#include "FlightRecorder.h"
 #include "../Utility/Print.h"
 #include "../Utility/Logging.h"
 #include "../XML/ProxyKeywords.h"
 
+#include <algorithm>
 #include <filesystem>
 #include <fmt/core.h>
 #include <iomanip>
 #include <sstream>
+#include <stdexcept>
 
 #ifdef TRACY_ENABLE
 #include <tracy/Tracy.hpp>
 #endif
 
+// keywords of the actions in a replay file
+static const std::pair<const char *, StressTest::TestAction> ReplayActionKeys[] = {
+    {"hardware_detect", StressTest::TestAction::HardwareDetect},
+    {"config_detect", StressTest::TestAction::ConfigDetect},
+    {"start_tracking", StressTest::TestAction::StartTracking},
+    {"stop_tracking", StressTest::TestAction::StopTracking},
+};
+
+static std::chrono::steady_clock::duration ToDuration(double seconds)
+{
+    return std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+}
+
 StressTest::StressTest(CTrack::IDriver* driver, std::shared_ptr<CTrack::MessageResponder> responder)
     : m_pDriver(driver)
     , m_pResponder(responder)
@@ -28,6 +44,92 @@ StressTest::~StressTest()
     CloseLogFile();
 }
 
+StressTest::ReplayScript StressTest::ReplayScript::Load(const std::string &FileName)
+{
+    std::ifstream file(FileName);
+    if (!file)
+    {
+        throw std::runtime_error(fmt::format("Replay file {} could not be opened", FileName));
+    }
+    nlohmann::json root = nlohmann::json::parse(file, nullptr, false);
+    if (root.is_discarded() || !root.is_object())
+    {
+        throw std::runtime_error(fmt::format("Replay file {} is not a json object", FileName));
+    }
+
+    ReplayScript script;
+    script.Speed           = root.value("speed", 1.0);
+    script.FrequencyHz     = root.value("frequency", 0.0);
+    script.DurationSeconds = root.value("duration", 0.0);
+    if (script.Speed <= 0.0)
+    {
+        throw std::runtime_error(fmt::format("Replay file {} : speed must be positive", FileName));
+    }
+    if (root.contains("thresholds"))
+    {
+        const nlohmann::json &thresholds    = root["thresholds"];
+        script.Thresholds.MinFPS           = thresholds.value("min_fps", 0.0);
+        script.Thresholds.MaxRunP99Us      = thresholds.value("max_run_p99_us", 0.0);
+        script.Thresholds.MaxDroppedFrames = thresholds.value("max_dropped_frames", int64_t(-1));
+    }
+
+    for (const auto &entry : root.value("timeline", nlohmann::json::array()))
+    {
+        ReplayEvent event;
+        event.AtSeconds = entry.value("at", 0.0);
+        if (entry.contains("message"))
+        {
+            try
+            {
+                event.Inject = CTrack::Message::Deserialize(entry["message"].dump());
+            }
+            catch (const std::exception &e)
+            {
+                throw std::runtime_error(fmt::format("Replay file {} : invalid message at {} s : {}", FileName, event.AtSeconds, e.what()));
+            }
+        }
+        else
+        {
+            std::string key   = entry.value("action", "");
+            auto        match = std::find_if(std::begin(ReplayActionKeys), std::end(ReplayActionKeys),
+                                             [&key](const auto &actionKey) { return key == actionKey.first; });
+            if (match == std::end(ReplayActionKeys))
+            {
+                throw std::runtime_error(fmt::format("Replay file {} : unknown action \"{}\" at {} s", FileName, key, event.AtSeconds));
+            }
+            event.Action = match->second;
+        }
+        script.Events.push_back(std::move(event));
+    }
+    std::stable_sort(script.Events.begin(), script.Events.end(), [](const ReplayEvent &a, const ReplayEvent &b) { return a.AtSeconds < b.AtSeconds; });
+    return script;
+}
+
+nlohmann::json StressTest::ReplayScript::ToJson() const
+{
+    nlohmann::json timeline = nlohmann::json::array();
+    for (const auto &event : Events)
+    {
+        if (event.Inject)
+        {
+            timeline.push_back({{"at", event.AtSeconds}, {"message", nlohmann::json::parse(event.Inject->Serialize())}});
+            continue;
+        }
+        for (const auto &[key, action] : ReplayActionKeys)
+        {
+            if (action == event.Action)
+            {
+                timeline.push_back({{"at", event.AtSeconds}, {"action", key}});
+            }
+        }
+    }
+    return {{"speed", Speed},
+            {"frequency", FrequencyHz},
+            {"duration", DurationSeconds},
+            {"thresholds", {{"min_fps", Thresholds.MinFPS}, {"max_run_p99_us", Thresholds.MaxRunP99Us}, {"max_dropped_frames", Thresholds.MaxDroppedFrames}}},
+            {"timeline", timeline}};
+}
+
 void StressTest::Start()
 {
     if (m_State == TestState::Running)
@@ -35,7 +137,13 @@ void StressTest::Start()
         PrintWarning("Stress test is already running");
         return;
     }
+    if (m_TestThread.joinable())
+    {
+        m_TestThread.join(); // a previous test ended on its own
+    }
 
+    m_Mode             = TestMode::Random;
+    m_RecordedEvents.clear();
     m_bStopRequested   = false;
     m_IterationCount   = 0;
     m_ErrorCount       = 0;
@@ -65,10 +173,60 @@ void StressTest::Start()
     PrintInfo("Stress test STARTED - Press 'y' to stop");
 }
 
+void StressTest::StartReplay(const ReplayScript &script)
+{
+    if (m_State == TestState::Running)
+    {
+        PrintWarning("Stress test is already running");
+        return;
+    }
+    if (m_TestThread.joinable())
+    {
+        m_TestThread.join();
+    }
+
+    m_Mode               = TestMode::Replay;
+    m_Script             = script;
+    m_bStopRequested     = false;
+    m_IterationCount     = 0;
+    m_ErrorCount         = 0;
+    m_SuccessCount       = 0;
+    m_bCurrentlyTracking = false;
+    m_Frames             = 0;
+    m_DroppedFrames      = 0;
+    m_RunFailures        = 0;
+    m_MessagesInjected   = 0;
+    m_LastFrameNumber    = 0;
+    m_TrackingSeconds    = 0.0;
+    m_RunLatency.Reset();
+    {
+        std::lock_guard<std::mutex> lock(m_ReportMutex);
+        m_ReplayReport = nlohmann::json();
+    }
+    m_StartTime = std::chrono::steady_clock::now();
+
+    InitLogFile();
+    LogInfo("=== STRESS TEST REPLAY STARTED ===");
+    LogInfo(fmt::format("Device: {}", m_DeviceName));
+    LogInfo(fmt::format("Timeline: {} events at speed x{}, duration {} s", m_Script.Events.size(), m_Script.Speed, m_Script.DurationSeconds));
+    LogInfo(fmt::format("Thresholds: min fps {}, max Run() p99 {} us, max dropped frames {}", m_Script.Thresholds.MinFPS, m_Script.Thresholds.MaxRunP99Us,
+                        m_Script.Thresholds.MaxDroppedFrames));
+
+    m_State      = TestState::Running;
+    m_TestThread = std::thread(&StressTest::ReplayLoop, this);
+
+    PrintInfo("Stress test REPLAY STARTED - Press 'y' to stop");
+}
+
 void StressTest::Stop()
 {
     if (m_State != TestState::Running)
     {
+        // the test loop may have ended on its own after an error or at the end of a replay
+        if (m_TestThread.joinable())
+        {
+            m_TestThread.join();
+        }
         return;
     }
 
@@ -145,15 +303,34 @@ bool StressTest::IsTracking() const
     return m_bCurrentlyTracking.load();
 }
 
+StressTest::TestMode StressTest::GetMode() const
+{
+    return m_Mode;
+}
+
+nlohmann::json StressTest::GetReplayReport() const
+{
+    std::lock_guard<std::mutex> lock(m_ReportMutex);
+    return m_ReplayReport;
+}
+
 void StressTest::TestLoop()
 {
     LogInfo("Test loop started");
 
+    // every exit writes the action timeline, the runs that fail early need it most
+    struct TimelineWriter
+    {
+        StressTest *pTest;
+        ~TimelineWriter() { pTest->WriteRecordedTimeline(); }
+    } timelineWriter{this};
+
     // Phase 1: Mandatory Hardware Detection
     LogInfo("=== PHASE 1: Hardware Detection ===");
     m_IterationCount++;
     LogInfo(fmt::format("--- Iteration {} ---", m_IterationCount.load()));
     LogInfo("Executing mandatory Hardware Detection");
+    RecordAction(TestAction::HardwareDetect);
 
     if (!DoHardwareDetect())
     {
@@ -178,6 +355,7 @@ void StressTest::TestLoop()
     m_IterationCount++;
     LogInfo(fmt::format("--- Iteration {} ---", m_IterationCount.load()));
     LogInfo("Executing mandatory Configuration Detection");
+    RecordAction(TestAction::ConfigDetect);
 
     if (!DoConfigDetect())
     {
@@ -209,6 +387,7 @@ void StressTest::TestLoop()
 
         LogInfo(fmt::format("--- Iteration {} ---", m_IterationCount.load()));
         LogInfo(fmt::format("Selected action: {}", ActionToString(action)));
+        RecordAction(action);
 
         bool success = ExecuteAction(action);
 
@@ -238,6 +417,224 @@ void StressTest::TestLoop()
     LogInfo("Test loop ended");
 }
 
+void StressTest::RecordAction(TestAction action)
+{
+    // waits are implied by the time of the next action
+    if (m_Mode != TestMode::Random || action == TestAction::WaitShort || action == TestAction::WaitMedium || action == TestAction::WaitLong)
+    {
+        return;
+    }
+    ReplayEvent event;
+    event.AtSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_StartTime).count();
+    event.Action    = action;
+    m_RecordedEvents.push_back(std::move(event));
+}
+
+void StressTest::WriteRecordedTimeline()
+{
+    if (m_RecordedEvents.empty() || m_LogFilePath.empty())
+    {
+        return;
+    }
+    ReplayScript script;
+    script.DurationSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_StartTime).count();
+    script.Events          = m_RecordedEvents;
+
+    std::string   replayPath = std::filesystem::path(m_LogFilePath).replace_extension(".replay.json").string();
+    std::ofstream replayFile(replayPath);
+    replayFile << script.ToJson().dump(2) << std::endl;
+    LogInfo(fmt::format("Action timeline written to {}", replayPath));
+}
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+Replay : actions between frames on this thread, messages from the injector thread, Run() as fast as frames arrive
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+void StressTest::ReplayLoop()
+{
+    LogInfo("Replay loop started");
+
+    const std::vector<ReplayEvent> &events      = m_Script.Events;
+    double                          timelineEnd = std::max(m_Script.DurationSeconds, events.empty() ? 0.0 : events.back().AtSeconds);
+    auto                            startTime   = std::chrono::steady_clock::now();
+    auto                            endTime     = startTime + ToDuration(timelineEnd / m_Script.Speed);
+
+    std::thread injector(&StressTest::InjectMessages, this, startTime);
+
+    size_t nextEvent = 0;
+    bool   failed    = false;
+    while (!m_bStopRequested && !failed)
+    {
+        auto now = std::chrono::steady_clock::now();
+        while (nextEvent < events.size() && startTime + ToDuration(events[nextEvent].AtSeconds / m_Script.Speed) <= now)
+        {
+            const ReplayEvent &event = events[nextEvent++];
+            if (event.Inject)
+            {
+                continue;
+            }
+            m_IterationCount++;
+            LogInfo(fmt::format("--- Replay {:.3f} s : {} ---", event.AtSeconds, ActionToString(event.Action)));
+            if (!ExecuteAction(event.Action))
+            {
+                m_ErrorCount++;
+                LogError("Replay action failed - ending replay");
+                failed = true;
+                break;
+            }
+            m_SuccessCount++;
+        }
+        if (failed || now >= endTime)
+        {
+            break;
+        }
+        ReplayFrame();
+    }
+
+    // also ends the injector
+    m_bStopRequested = true;
+    injector.join();
+    DoShutdown();
+
+    EvaluateReplay(std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count());
+    bool passed = GetReplayReport().value("passed", false);
+    LogInfo("Replay loop ended");
+
+    // when the user stopped the replay, Stop() reports and closes the log
+    TestState expected = TestState::Running;
+    if (m_State.compare_exchange_strong(expected, passed ? TestState::Idle : TestState::Error))
+    {
+        LogInfo("=== STRESS TEST REPLAY COMPLETED ===");
+        CloseLogFile();
+        if (passed)
+        {
+            PrintInfo("Stress test REPLAY PASSED");
+        }
+        else
+        {
+            PrintError("Stress test REPLAY FAILED");
+        }
+    }
+}
+
+void StressTest::InjectMessages(std::chrono::steady_clock::time_point startTime)
+{
+    for (const auto &event : m_Script.Events)
+    {
+        if (!event.Inject)
+        {
+            continue;
+        }
+        auto due = startTime + ToDuration(event.AtSeconds / m_Script.Speed);
+        while (!m_bStopRequested && std::chrono::steady_clock::now() < due)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        if (m_bStopRequested || !m_pResponder)
+        {
+            return;
+        }
+        try
+        {
+            m_pResponder->RespondToMessage(*event.Inject);
+            m_MessagesInjected++;
+        }
+        catch (const std::exception &e)
+        {
+            LogWarning(fmt::format("Injected message {} threw : {}", event.Inject->GetID(), e.what()));
+        }
+    }
+}
+
+void StressTest::ReplayFrame()
+{
+    if (!m_bCurrentlyTracking || !m_pDriver->IsRunning())
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        return;
+    }
+#ifdef TRACY_ENABLE
+    ZoneScopedNC("StressTest::ReplayFrame", 0x00AAAA);
+#endif
+    auto runStart = std::chrono::steady_clock::now();
+    bool newFrame = m_pDriver->Run();
+    m_RunLatency.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - runStart).count());
+    if (!newFrame)
+    {
+        m_RunFailures++;
+        return;
+    }
+    m_pDriver->GetValues(m_Values);
+    m_Frames++;
+
+    // gaps in the device frame numbers are frames the proxy never saw
+    uint32_t frameNumber = m_pDriver->GetFrameNumber();
+    if (m_LastFrameNumber != 0 && frameNumber > m_LastFrameNumber + 1)
+    {
+        m_DroppedFrames += frameNumber - m_LastFrameNumber - 1;
+    }
+    m_LastFrameNumber = frameNumber;
+}
+
+void StressTest::EvaluateReplay(double durationSeconds)
+{
+    const ReplayThresholds &thresholds = m_Script.Thresholds;
+    double                  fps        = m_TrackingSeconds > 0.0 ? m_Frames / m_TrackingSeconds : 0.0;
+    double                  p99Us      = m_RunLatency.GetPercentile(0.99) / 1000.0;
+
+    nlohmann::json failures = nlohmann::json::array();
+    if (thresholds.MinFPS > 0.0 && fps < thresholds.MinFPS)
+    {
+        failures.push_back(fmt::format("frame rate {:.1f} fps below {:.1f}", fps, thresholds.MinFPS));
+    }
+    if (thresholds.MaxRunP99Us > 0.0 && p99Us > thresholds.MaxRunP99Us)
+    {
+        failures.push_back(fmt::format("Run() p99 {:.1f} us above {:.1f}", p99Us, thresholds.MaxRunP99Us));
+    }
+    if (thresholds.MaxDroppedFrames >= 0 && m_DroppedFrames > static_cast<uint64_t>(thresholds.MaxDroppedFrames))
+    {
+        failures.push_back(fmt::format("{} dropped frames above {}", m_DroppedFrames, thresholds.MaxDroppedFrames));
+    }
+    if (m_ErrorCount > 0)
+    {
+        failures.push_back(fmt::format("{} actions failed", m_ErrorCount.load()));
+    }
+
+    nlohmann::json report = {{"device", m_DeviceName},
+                             {"speed", m_Script.Speed},
+                             {"duration_s", durationSeconds},
+                             {"tracking_s", m_TrackingSeconds},
+                             {"frames", m_Frames},
+                             {"fps", fps},
+                             {"run_us",
+                              {{"count", m_RunLatency.GetCount()},
+                               {"mean", m_RunLatency.GetMean() / 1000.0},
+                               {"p50", m_RunLatency.GetPercentile(0.5) / 1000.0},
+                               {"p99", p99Us},
+                               {"max", m_RunLatency.GetMax() / 1000.0}}},
+                             {"dropped_frames", m_DroppedFrames},
+                             {"run_false", m_RunFailures},
+                             {"messages_injected", m_MessagesInjected.load()},
+                             {"actions", m_SuccessCount.load()},
+                             {"errors", m_ErrorCount.load()},
+                             {"thresholds", m_Script.ToJson()["thresholds"]},
+                             {"passed", failures.empty()},
+                             {"failures", failures}};
+    CTrack::CLogging::getInstance().record("stress.replay", report);
+
+    LogInfo(fmt::format("Replay : {} frames, {:.1f} fps, Run() p50 {:.1f} us p99 {:.1f} us, {} dropped, {} messages injected", m_Frames, fps,
+                        report["run_us"]["p50"].get<double>(), p99Us, m_DroppedFrames, m_MessagesInjected.load()));
+    for (const auto &failure : failures)
+    {
+        LogError(fmt::format("Threshold : {}", failure.get<std::string>()));
+    }
+
+    std::lock_guard<std::mutex> lock(m_ReportMutex);
+    m_ReplayReport = std::move(report);
+}
+
 StressTest::TestAction StressTest::SelectRandomAction()
 {
     // Smart action selection based on current state
@@ -467,8 +864,8 @@ bool StressTest::DoStartTracking()
     LogInfo("Executing Start Tracking...");
     PrintInfo(fmt::format("STRESS TEST [{}]: Start Tracking", m_DeviceName));
 
-    // Calculate frequency from polling interval
-    double frequencyHz = 1000.0 / m_PollingIntervalMs;
+    // Calculate frequency from polling interval, unless the replay script sets one
+    double frequencyHz = (m_Mode == TestMode::Replay && m_Script.FrequencyHz > 0.0) ? m_Script.FrequencyHz : 1000.0 / m_PollingIntervalMs;
 
     bool result = m_pDriver->Initialize(frequencyHz);
 
@@ -476,6 +873,7 @@ bool StressTest::DoStartTracking()
     {
         m_bCurrentlyTracking         = true;
         m_TrackingStartTime          = std::chrono::steady_clock::now();
+        m_LastFrameNumber            = 0;
         m_RequiredMeasurementSeconds = m_MeasurementDurationDistribution(m_RandomEngine);
         LogInfo(fmt::format("Tracking started successfully at {:.0f} Hz - will track for {} seconds before allowing stop",
                            frequencyHz, m_RequiredMeasurementSeconds));
@@ -508,6 +906,7 @@ bool StressTest::DoStopTracking()
     if (result)
     {
         m_bCurrentlyTracking = false;
+        m_TrackingSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - m_TrackingStartTime).count();
         LogInfo("Tracking stopped successfully");
         return true;
     }
@@ -689,7 +1088,7 @@ void StressTest::LogMessage(const std::string &level, const std::string &message
 void StressTest::LogInfo(const std::string &message)
 {
     LogMessage("INFO", message);
-    LOG_INFO(fmt::format("STRESS_TEST: {}", message));
+    LOG_INFO_FMT("STRESS_TEST: {}", message);
 #ifdef TRACY_ENABLE
     TracyMessageC(message.c_str(), message.size(), 0x44FF44);  // Green for info
 #endif
@@ -699,7 +1098,7 @@ void StressTest::LogWarning(const std::string &message)
 {
     LogMessage("WARNING", message);
     PrintWarning(fmt::format("STRESS_TEST: {}", message));
-    LOG_WARNING(fmt::format("STRESS_TEST: {}", message));
+    LOG_WARNING_FMT("STRESS_TEST: {}", message);
 #ifdef TRACY_ENABLE
     TracyMessageC(message.c_str(), message.size(), 0xFFFF00);  // Yellow for warning
 #endif
@@ -709,10 +1108,11 @@ void StressTest::LogError(const std::string &message)
 {
     LogMessage("ERROR", message);
     PrintError(fmt::format("STRESS_TEST: {}", message));
-    LOG_ERROR_MSG(fmt::format("STRESS_TEST: {}", message));
+    LOG_ERROR_FMT("STRESS_TEST: {}", message);
 #ifdef TRACY_ENABLE
     TracyMessageC(message.c_str(), message.size(), 0xFF4444);  // Red for error
 #endif
+    CTrack::FlightRecorder::DumpOnError(message);
 }
 
 void StressTest::LogAction(TestAction action, bool success, const std::string &details)
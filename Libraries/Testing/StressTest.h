@@ -3,6 +3,7 @@
 #include "../Driver/IDriver.h"
 #include "../TCP/Message.h"
 #include "../TCP/MessageResponder.h"
+#include "../Utility/LogHistogram.h"
 
 #include <atomic>
 #include <chrono>
@@ -10,6 +11,7 @@
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <random>
 #include <string>
 #include <thread>
@@ -28,6 +30,13 @@
  *
  * This class works with any device driver that implements the CTrack::IDriver interface,
  * including Vicon, Leica.LMF, NDI, and Template drivers.
+ *
+ * Replay mode turns the soak into a performance gate: a scripted or recorded timeline of
+ * actions is executed at an accelerated speed while Run()/GetValues() are called as fast as
+ * the driver delivers frames and control messages are injected from a second thread. The
+ * replay fails when the frame rate, the Run() latency p99 or the dropped frame count cross
+ * the thresholds of the script. Every random test writes its own actions as a replay file
+ * next to its log, so a soak that found a problem can be repeated deterministically.
  */
 class StressTest
 {
@@ -51,11 +60,58 @@ class StressTest
         Error
     };
 
+    enum class TestMode
+    {
+        Random,
+        Replay
+    };
+
+    /**
+     * @brief One entry of a replay timeline
+     *
+     * An action runs on the test thread between two frames, a message is passed to the
+     * responder from the injector thread while frames keep running.
+     */
+    struct ReplayEvent
+    {
+        double                         AtSeconds{0.0}; // timeline time, divided by the replay speed
+        TestAction                     Action{TestAction::WaitShort};
+        std::optional<CTrack::Message> Inject;
+    };
+
+    struct ReplayThresholds
+    {
+        double  MinFPS{0.0};          // 0 = not checked
+        double  MaxRunP99Us{0.0};     // 0 = not checked
+        int64_t MaxDroppedFrames{-1}; // -1 = not checked
+    };
+
+    /**
+     * @brief Replay file, see "Doc/Stress and profiling.md"
+     *
+     * { "speed": 10, "frequency": 1000, "duration": 60,
+     *   "thresholds": { "min_fps": 950, "max_run_p99_us": 2000, "max_dropped_frames": 0 },
+     *   "timeline": [ { "at": 0, "action": "hardware_detect" }, { "at": 5, "message": { "id": ..., "params": ... } } ] }
+     */
+    struct ReplayScript
+    {
+        double                   Speed{1.0};
+        double                   FrequencyHz{0.0};     // 0 = from the recommended polling interval
+        double                   DurationSeconds{0.0}; // timeline time, 0 = until the last event
+        ReplayThresholds         Thresholds;
+        std::vector<ReplayEvent> Events;
+
+        // throws std::runtime_error when the file cannot be read or an entry is invalid
+        static ReplayScript Load(const std::string &FileName);
+        nlohmann::json      ToJson() const;
+    };
+
     StressTest(CTrack::IDriver* driver, std::shared_ptr<CTrack::MessageResponder> responder);
     ~StressTest();
 
     // Start/stop the stress test
     void Start();
+    void StartReplay(const ReplayScript &script);
     void Stop();
     bool IsRunning() const;
 
@@ -65,6 +121,10 @@ class StressTest
     int         GetIterationCount() const;
     int         GetErrorCount() const;
     bool        IsTracking() const;  // Returns true if stress test is currently in a tracking session
+    TestMode    GetMode() const;
+
+    // Result of the last replay : frames, fps, run_us, dropped_frames, ..., passed, failures
+    nlohmann::json GetReplayReport() const;
 
   private:
     // Test execution
@@ -73,6 +133,14 @@ class StressTest
     bool        ExecuteAction(TestAction action);
     std::string ActionToString(TestAction action) const;
 
+    // Replay execution
+    void ReplayLoop();
+    void InjectMessages(std::chrono::steady_clock::time_point startTime);
+    void ReplayFrame();
+    void EvaluateReplay(double durationSeconds);
+    void RecordAction(TestAction action);
+    void WriteRecordedTimeline();
+
     // Action implementations
     bool DoHardwareDetect();
     bool DoConfigDetect();
@@ -128,4 +196,19 @@ class StressTest
 
     // Test start time
     std::chrono::steady_clock::time_point m_StartTime;
+
+    // Replay
+    TestMode                  m_Mode{TestMode::Random};
+    ReplayScript              m_Script;
+    CLogHistogram             m_RunLatency; // nanoseconds per Run() call while tracking
+    uint64_t                  m_Frames{0};
+    uint64_t                  m_DroppedFrames{0};
+    uint64_t                  m_RunFailures{0};
+    std::atomic<uint64_t>     m_MessagesInjected{0};
+    uint32_t                  m_LastFrameNumber{0};
+    double                    m_TrackingSeconds{0.0};
+    std::vector<double>       m_Values;
+    nlohmann::json            m_ReplayReport;
+    mutable std::mutex        m_ReportMutex;
+    std::vector<ReplayEvent>  m_RecordedEvents; // actions of a random test, written as a replay file
 };
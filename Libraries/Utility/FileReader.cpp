@@ -1,140 +1,285 @@
 #include "FileReader.h"
-#include <vector>
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstring>
 #include <fstream>
-#include <sstream>
 #include <iostream>
-#include <regex>
+#include <limits>
+#include <thread>
 
 namespace FileReader
 {
-    std::vector<std::vector<double>> ReadNumbersFromFileRegex(const std::string &filename)
+    //------------------------------------------------------------------------------------------------------------------
+    /*
+    Tokenizer : a 256 entry table tells in one lookup whether a character separates numbers,
+    numbers are converted with std::from_chars which neither allocates nor throws
+    */
+    //------------------------------------------------------------------------------------------------------------------
+
+    constexpr size_t PARALLEL_MIN_BYTES = 4 << 20; // smaller files are parsed on the calling thread
+
+    using DelimiterTable = std::array<bool, 256>;
+
+    static DelimiterTable MakeDelimiterTable(const std::string &delimiters)
     {
-        std::vector<std::vector<double>> data;
-        std::ifstream                    file(filename);
+        DelimiterTable Table{};
+        for (size_t i = 0; i < delimiters.size(); i++)
+        {
+            if (delimiters[i] == '\\' && i + 1 < delimiters.size() && delimiters[i + 1] == 's')
+            {
+                for (char c : {' ', '\t', '\r', '\n', '\v', '\f'})
+                    Table[static_cast<unsigned char>(c)] = true;
+                i++;
+            }
+            else
+            {
+                Table[static_cast<unsigned char>(delimiters[i])] = true;
+            }
+        }
+        Table[static_cast<unsigned char>('\n')] = true; // a line never continues a number
+        Table[static_cast<unsigned char>('\r')] = true;
+        return Table;
+    }
 
-        if (!file)
+    static bool ParseToken(const char *first, const char *last, double &value)
+    {
+        // from_chars rejects a leading '+', stod accepted it
+        if (*first == '+' && last - first > 1)
         {
-            std::cerr << "Error opening file: " << filename << std::endl;
-            return data;
+            first++;
+        }
+        // nan/inf in any case, including the forms written by printf
+        auto Result = std::from_chars(first, last, value, std::chars_format::general);
+        if (Result.ec == std::errc())
+        {
+            return true;
         }
 
-        std::string line;
-        std::regex  delimiter("[;|,\\s]+"); // Match semicolon, pipe, comma, or whitespace
+        std::string token(first, last);
+        if (Result.ec == std::errc::result_out_of_range)
+        {
+            std::cerr << "Number out of range in file: " << token << std::endl;
+        }
+        else
+        {
+            std::cerr << "Invalid number found in file: " << token << std::endl;
+        }
+        return false;
+    }
 
-        while (std::getline(file, line))
+    // parse the numbers of one line [first, last) and append them to values, returns the number of values added
+    static size_t ParseLine(const char *first, const char *last, const DelimiterTable &Table, std::vector<double> &values)
+    {
+        size_t      Count = 0;
+        const char *p     = first;
+        while (p < last)
         {
-            std::vector<double>        row;
-            std::sregex_token_iterator it(line.begin(), line.end(), delimiter, -1);
-            std::sregex_token_iterator end;
+            while (p < last && Table[static_cast<unsigned char>(*p)])
+                p++;
+            const char *TokenStart = p;
+            while (p < last && !Table[static_cast<unsigned char>(*p)])
+                p++;
+            double value;
+            if (p > TokenStart && ParseToken(TokenStart, p, value))
+            {
+                values.push_back(value);
+                Count++;
+            }
+        }
+        return Count;
+    }
 
-            for (; it != end; ++it)
+    // parse all lines in [first, last), row lengths go to RowSizes, empty lines are skipped
+    static void ParseBlock(const char *first, const char *last, const DelimiterTable &Table, std::vector<double> &Values, std::vector<size_t> &RowSizes)
+    {
+        const char *p = first;
+        while (p < last)
+        {
+            const char *EndOfLine = static_cast<const char *>(std::memchr(p, '\n', last - p));
+            if (EndOfLine == nullptr)
             {
-                std::string value = it->str();
-                if (!value.empty()) // Ignore empty values
-                {
-                    try
-                    {
-                        if (value == "nan" || value == "NaN")
-                        {
-                            row.push_back(std::numeric_limits<double>::quiet_NaN());
-                        }
-                        else if (value == "inf" || value == "Inf" || value == "+inf" || value == "+Inf")
-                        {
-                            row.push_back(std::numeric_limits<double>::infinity());
-                        }
-                        else if (value == "-inf" || value == "-Inf")
-                        {
-                            row.push_back(-std::numeric_limits<double>::infinity());
-                        }
-                        else
-                        {
-                            row.push_back(std::stod(value)); // Convert to double
-                        }
-                    }
-                    catch (const std::invalid_argument &)
-                    {
-                        std::cerr << "Invalid number found in file: " << value << std::endl;
-                    }
-                    catch (const std::out_of_range &)
-                    {
-                        std::cerr << "Number out of range in file: " << value << std::endl;
-                    }
-                }
+                EndOfLine = last;
+            }
+            size_t Count = ParseLine(p, EndOfLine, Table, Values);
+            if (Count)
+            {
+                RowSizes.push_back(Count);
             }
+            p = EndOfLine + 1;
+        }
+    }
+
+    static bool ReadFile(const std::string &filename, std::string &Content)
+    {
+        std::ifstream file(filename, std::ios::binary | std::ios::ate);
+        if (!file)
+        {
+            std::cerr << "Error opening file: " << filename << std::endl;
+            return false;
+        }
+        std::streamoff Size = file.tellg();
+        Content.resize(static_cast<size_t>(Size));
+        file.seekg(0);
+        file.read(Content.data(), Size);
+        return true;
+    }
 
-            if (!row.empty())
-            { // Avoid empty lines
-                data.push_back(row);
+    // split [Begin, End) on line boundaries, parse the chunks in parallel and gather them into Matrix
+    static void ParseMatrix(const char *Begin, const char *End, const DelimiterTable &Table, unsigned int NumThreads, NumberMatrix &Matrix)
+    {
+        if (NumThreads == 0)
+        {
+            NumThreads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        const size_t Size = static_cast<size_t>(End - Begin);
+        if (Size < PARALLEL_MIN_BYTES)
+        {
+            NumThreads = 1;
+        }
+        std::vector<const char *> Bounds{Begin};
+        for (unsigned int i = 1; i < NumThreads; i++)
+        {
+            const char *Split = std::max(Bounds.back(), Begin + Size * i / NumThreads);
+            const char *EndOfLine = static_cast<const char *>(std::memchr(Split, '\n', End - Split));
+            if (EndOfLine == nullptr)
+            {
+                break;
             }
+            Bounds.push_back(EndOfLine + 1);
         }
+        Bounds.push_back(End);
 
-        return data;
+        // parse the chunks
+        const size_t                     NumChunks  = Bounds.size() - 1;
+        std::vector<std::vector<double>> ChunkValues(NumChunks);
+        std::vector<std::vector<size_t>> ChunkRowSizes(NumChunks);
+        std::vector<std::thread>         Threads;
+        for (size_t i = 1; i < NumChunks; i++)
+        {
+            Threads.emplace_back([&, i]() { ParseBlock(Bounds[i], Bounds[i + 1], Table, ChunkValues[i], ChunkRowSizes[i]); });
+        }
+        ParseBlock(Bounds[0], Bounds[1], Table, ChunkValues[0], ChunkRowSizes[0]);
+        for (std::thread &Thread : Threads)
+        {
+            Thread.join();
+        }
+
+        // gather into one matrix
+        Matrix.NumRows    = 0;
+        Matrix.NumColumns = 0;
+        for (size_t i = 0; i < NumChunks; i++)
+        {
+            Matrix.NumRows += ChunkRowSizes[i].size();
+            for (size_t RowSize : ChunkRowSizes[i])
+                Matrix.NumColumns = std::max(Matrix.NumColumns, RowSize);
+        }
+        Matrix.Values.assign(Matrix.NumRows * Matrix.NumColumns, std::numeric_limits<double>::quiet_NaN());
+        double *pRow = Matrix.Values.data();
+        for (size_t i = 0; i < NumChunks; i++)
+        {
+            const double *pValue = ChunkValues[i].data();
+            for (size_t RowSize : ChunkRowSizes[i])
+            {
+                std::copy(pValue, pValue + RowSize, pRow);
+                pValue += RowSize;
+                pRow += Matrix.NumColumns;
+            }
+            std::vector<double>().swap(ChunkValues[i]);
+        }
     }
 
+    //------------------------------------------------------------------------------------------------------------------
+    /*
+    Public interface
+    */
+    //------------------------------------------------------------------------------------------------------------------
+
     std::vector<std::vector<double>> ReadNumbersFromFile(const std::string &filename, const std::string &delimiters)
     {
         std::vector<std::vector<double>> data;
-        std::ifstream                    file(filename);
+        std::string                      Content;
+        if (!ReadFile(filename, Content))
+        {
+            return data;
+        }
 
+        std::vector<double> Values;
+        std::vector<size_t> RowSizes;
+        ParseBlock(Content.data(), Content.data() + Content.size(), MakeDelimiterTable(delimiters), Values, RowSizes);
+
+        data.reserve(RowSizes.size());
+        auto it = Values.begin();
+        for (size_t Size : RowSizes)
+        {
+            data.emplace_back(it, it + Size);
+            it += Size;
+        }
+        return data;
+    }
+
+    NumberMatrix ReadNumberMatrixFromFile(const std::string &filename, const std::string &delimiters, unsigned int NumThreads)
+    {
+        NumberMatrix Matrix;
+        std::string  Content;
+        if (ReadFile(filename, Content))
+        {
+            ParseMatrix(Content.data(), Content.data() + Content.size(), MakeDelimiterTable(delimiters), NumThreads, Matrix);
+        }
+        return Matrix;
+    }
+
+    bool ReadNumberMatrixWindows(const std::string &filename, const std::function<void(const NumberMatrix &)> &Callback, size_t WindowBytes,
+                                 const std::string &delimiters, unsigned int NumThreads)
+    {
+        std::ifstream file(filename, std::ios::binary);
         if (!file)
         {
             std::cerr << "Error opening file: " << filename << std::endl;
-            return data;
+            return false;
         }
 
-        std::string line;
-        while (std::getline(file, line))
+        const DelimiterTable Table = MakeDelimiterTable(delimiters);
+        WindowBytes                = std::max<size_t>(WindowBytes, 1);
+        std::string  Buffer;
+        size_t       Pending = 0; // bytes at the start of Buffer, the unfinished last line of the previous window
+        NumberMatrix Window;
+        for (;;)
         {
-            std::vector<double> row;
-            std::istringstream  lineStream(line);
-            std::string         value;
-
-            while (std::getline(lineStream, value, delimiters[0]))
+            if (Buffer.size() < Pending + WindowBytes)
             {
-                std::istringstream valueStream(value);
-                std::string        token;
+                Buffer.resize(Pending + WindowBytes);
+            }
+            file.read(Buffer.data() + Pending, static_cast<std::streamsize>(WindowBytes));
+            const size_t Read      = static_cast<size_t>(file.gcount());
+            const bool   EndOfFile = Read < WindowBytes;
+            const size_t Used      = Pending + Read;
 
-                while (std::getline(valueStream, token, ' '))
+            // only whole lines are parsed, a line longer than the window makes the next window larger
+            size_t Parsed = Used;
+            if (!EndOfFile)
+            {
+                size_t EndOfLine = Buffer.rfind('\n', Used - 1);
+                if (EndOfLine == std::string::npos)
                 {
-                    if (!token.empty())
-                    {
-                        try
-                        {
-                            if (token == "nan" || token == "NaN")
-                            {
-                                row.push_back(std::numeric_limits<double>::quiet_NaN());
-                            }
-                            else if (token == "inf" || token == "Inf" || token == "+inf" || token == "+Inf")
-                            {
-                                row.push_back(std::numeric_limits<double>::infinity());
-                            }
-                            else if (token == "-inf" || token == "-Inf")
-                            {
-                                row.push_back(-std::numeric_limits<double>::infinity());
-                            }
-                            else
-                            {
-                                row.push_back(std::stod(token)); // Convert to double
-                            }
-                        }
-                        catch (const std::invalid_argument &)
-                        {
-                            std::cerr << "Invalid number found in file: " << token << std::endl;
-                        }
-                        catch (const std::out_of_range &)
-                        {
-                            std::cerr << "Number out of range in file: " << token << std::endl;
-                        }
-                    }
+                    Pending = Used;
+                    continue;
                 }
+                Parsed = EndOfLine + 1;
             }
 
-            if (!row.empty())
-            { // Avoid empty lines
-                data.push_back(row);
+            ParseMatrix(Buffer.data(), Buffer.data() + Parsed, Table, NumThreads, Window);
+            if (Window.NumRows)
+            {
+                Callback(Window);
+            }
+            if (EndOfFile)
+            {
+                return true;
             }
+            Pending = Used - Parsed;
+            std::memmove(Buffer.data(), Buffer.data() + Parsed, Pending);
         }
-
-        return data;
     }
 } // namespace FileReader
@@ -1,9 +1,33 @@
 #pragma once
 
+#include <functional>
 #include <vector>
 #include <string>
 
 namespace FileReader
 {
+    // Every character in delimiters separates numbers, "\\s" stands for any white space.
+    // nan, inf, +inf and -inf are accepted in any case, invalid tokens are reported on std::cerr and skipped.
+
+    // rows of numbers, empty lines are skipped
     std::vector<std::vector<double>> ReadNumbersFromFile(const std::string &filename, const std::string &delimiters = ";|,\\s");
+
+    // one contiguous row major matrix, rows shorter than the longest row are padded with NaN
+    struct NumberMatrix
+    {
+        std::vector<double> Values;
+        size_t              NumRows    = 0;
+        size_t              NumColumns = 0;
+
+        const double *GetRow(size_t Row) const { return Values.data() + Row * NumColumns; }
+    };
+
+    // large files are split in chunks on line boundaries and parsed in parallel, NumThreads 0 = hardware concurrency
+    NumberMatrix ReadNumberMatrixFromFile(const std::string &filename, const std::string &delimiters = ";|,\\s", unsigned int NumThreads = 0);
+
+    // streams the file in windows of about WindowBytes split on line boundaries, each window is parsed like
+    // ReadNumberMatrixFromFile and passed to Callback, columns are padded to the longest row of that window only
+    // memory stays in the order of WindowBytes whatever the file size, returns false if the file cannot be opened
+    bool ReadNumberMatrixWindows(const std::string &filename, const std::function<void(const NumberMatrix &)> &Callback, size_t WindowBytes = size_t(64) << 20,
+                                 const std::string &delimiters = ";|,\\s", unsigned int NumThreads = 0);
 };
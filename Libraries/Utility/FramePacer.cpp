@@ -0,0 +1,149 @@
+#include "FramePacer.h"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <thread>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <timeapi.h>
+#pragma comment(lib, "winmm.lib")
+#endif
+
+CFramePacer::CFramePacer()
+{
+#ifdef _WIN32
+    // with a 1 ms timer period Sleep overshoots by up to ~1 ms
+    m_SpinThreshold = std::chrono::microseconds(1500);
+#else
+    m_SpinThreshold = std::chrono::microseconds(200);
+#endif
+}
+
+CFramePacer::~CFramePacer()
+{
+    Stop();
+}
+
+void CFramePacer::Start(double rateHz)
+{
+    if (!m_bStarted)
+    {
+#ifdef _WIN32
+        timeBeginPeriod(1);
+#endif
+        m_bStarted = true;
+    }
+    m_RateHz       = rateHz > 0.0 ? rateHz : 1.0;
+    m_Period       = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / m_RateHz));
+    m_Start        = Clock::now();
+    m_FrameIndex   = 1;
+    m_NextDeadline = m_Start + m_Period;
+    ResetJitterStats();
+}
+
+void CFramePacer::Stop()
+{
+    if (m_bStarted)
+    {
+#ifdef _WIN32
+        timeEndPeriod(1);
+#endif
+        m_bStarted = false;
+    }
+}
+
+double CFramePacer::WaitNext()
+{
+    if (!m_bStarted)
+    {
+        return 0.0;
+    }
+
+    // coarse sleep, then spin the last part
+    Clock::time_point SleepUntil = m_NextDeadline - m_SpinThreshold;
+    if (Clock::now() < SleepUntil)
+    {
+        std::this_thread::sleep_until(SleepUntil);
+    }
+    Clock::time_point Now = Clock::now();
+    while (Now < m_NextDeadline)
+    {
+        std::this_thread::yield();
+        Now = Clock::now();
+    }
+
+    double Lateness = std::chrono::duration<double>(Now - m_NextDeadline).count();
+    AddSample(Lateness * 1e6);
+
+    // next deadline on the absolute schedule, restart the schedule when too far behind
+    m_FrameIndex++;
+    m_NextDeadline = m_Start + m_Period * m_FrameIndex;
+    if (Now - m_NextDeadline > m_Period * MAX_LATE_PERIODS)
+    {
+        m_SkippedFrames += (Now - m_NextDeadline) / m_Period;
+        m_Start        = Now;
+        m_FrameIndex   = 1;
+        m_NextDeadline = m_Start + m_Period;
+    }
+    return Lateness;
+}
+
+void CFramePacer::AddSample(double latenessUs)
+{
+    size_t Bucket = std::min(static_cast<size_t>(latenessUs), NUM_BUCKETS - 1);
+    m_Buckets[Bucket]++;
+    m_Frames++;
+    m_SumUs += latenessUs;
+    m_MaxUs = std::max(m_MaxUs, latenessUs);
+}
+
+CFramePacer::JitterStats CFramePacer::GetJitterStats() const
+{
+    JitterStats Stats;
+    Stats.Frames        = m_Frames;
+    Stats.SkippedFrames = m_SkippedFrames;
+    Stats.MaxUs         = m_MaxUs;
+    if (m_Frames == 0)
+    {
+        return Stats;
+    }
+    Stats.MeanUs     = m_SumUs / m_Frames;
+
+    uint64_t P50Rank = (m_Frames * 50 + 99) / 100;
+    uint64_t P99Rank = (m_Frames * 99 + 99) / 100;
+    uint64_t Count   = 0;
+    bool     bP50    = false;
+    for (size_t i = 0; i < NUM_BUCKETS; i++)
+    {
+        Count += m_Buckets[i];
+        if (!bP50 && Count >= P50Rank)
+        {
+            Stats.P50Us = static_cast<double>(i);
+            bP50        = true;
+        }
+        if (Count >= P99Rank)
+        {
+            Stats.P99Us = i == NUM_BUCKETS - 1 ? m_MaxUs : static_cast<double>(i);
+            break;
+        }
+    }
+    return Stats;
+}
+
+void CFramePacer::ResetJitterStats()
+{
+    m_Buckets.fill(0);
+    m_Frames        = 0;
+    m_SkippedFrames = 0;
+    m_SumUs         = 0.0;
+    m_MaxUs         = 0.0;
+}
+
+std::string CFramePacer::GetJitterReport() const
+{
+    JitterStats Stats = GetJitterStats();
+    return fmt::format("pacing {:.1f} Hz : {} frames, {} skipped, lateness mean {:.1f} us p50 {:.0f} us p99 {:.0f} us max {:.1f} us", m_RateHz, Stats.Frames,
+                       Stats.SkippedFrames, Stats.MeanUs, Stats.P50Us, Stats.P99Us, Stats.MaxUs);
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+CFramePacer : paces a loop at a fixed rate against absolute deadlines on the steady clock
+
+Each frame deadline is start + n * period, so sleep overshoot never accumulates into drift. The wait sleeps
+until shortly before the deadline and spins the remaining time, which keeps 1-10 kHz rates accurate on an OS
+whose sleep granularity is in the order of a millisecond. When the loop falls behind by more than
+MaxLatePeriods the schedule restarts from now and the missed frames are counted as skipped.
+
+Lateness (wake-up time minus deadline) is collected in 1 us buckets for the jitter report.
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+class CFramePacer
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    struct JitterStats
+    {
+        uint64_t Frames        = 0; // frames paced since the last reset
+        uint64_t SkippedFrames = 0; // frames dropped to catch up
+        double   MeanUs        = 0.0;
+        double   P50Us         = 0.0;
+        double   P99Us         = 0.0;
+        double   MaxUs         = 0.0;
+    };
+
+  public:
+    CFramePacer();
+    ~CFramePacer();
+
+    void Start(double rateHz);
+    void Stop();
+    bool IsStarted() const { return m_bStarted; }
+
+    // block until the next frame deadline, returns the lateness of this wake-up in seconds
+    double WaitNext();
+
+    // time left before the next deadline is spun instead of slept
+    void SetSpinThreshold(std::chrono::microseconds threshold) { m_SpinThreshold = threshold; }
+
+    double      GetRateHz() const { return m_RateHz; }
+    JitterStats GetJitterStats() const;
+    void        ResetJitterStats();
+    std::string GetJitterReport() const;
+
+  protected:
+    void AddSample(double latenessUs);
+
+  protected:
+    static constexpr size_t   NUM_BUCKETS      = 2000; // 1 us each, the last one collects everything later
+    static constexpr uint64_t MAX_LATE_PERIODS = 10;
+
+    bool                      m_bStarted = false;
+    double                    m_RateHz   = 0.0;
+    Clock::duration           m_Period{};
+    Clock::time_point         m_Start;
+    Clock::time_point         m_NextDeadline;
+    uint64_t                  m_FrameIndex = 0;
+    std::chrono::microseconds m_SpinThreshold;
+
+    // jitter statistics
+    std::array<uint32_t, NUM_BUCKETS> m_Buckets{};
+    uint64_t                          m_Frames        = 0;
+    uint64_t                          m_SkippedFrames = 0;
+    double                            m_SumUs         = 0.0;
+    double                            m_MaxUs         = 0.0;
+};
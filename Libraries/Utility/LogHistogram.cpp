@@ -0,0 +1,86 @@
+#include "LogHistogram.h"
+
+#include <algorithm>
+
+unsigned CLogHistogram::BucketIndex(uint64_t Value)
+{
+    if (Value < SUB_BUCKETS)
+    {
+        return static_cast<unsigned>(Value);
+    }
+    unsigned Exponent = 63;
+    while (!(Value >> Exponent))
+    {
+        Exponent--;
+    }
+    unsigned SubBucket = static_cast<unsigned>(Value >> (Exponent - SUB_BITS)) & (SUB_BUCKETS - 1);
+    return (Exponent - SUB_BITS + 1) * SUB_BUCKETS + SubBucket;
+}
+
+uint64_t CLogHistogram::BucketLowerBound(unsigned Index)
+{
+    if (Index < SUB_BUCKETS)
+    {
+        return Index;
+    }
+    unsigned Exponent  = Index / SUB_BUCKETS + SUB_BITS - 1;
+    unsigned SubBucket = Index % SUB_BUCKETS;
+    return static_cast<uint64_t>(SUB_BUCKETS + SubBucket) << (Exponent - SUB_BITS);
+}
+
+void CLogHistogram::Record(uint64_t Value)
+{
+    m_Buckets[BucketIndex(Value)].fetch_add(1, std::memory_order_relaxed);
+    m_Count.fetch_add(1, std::memory_order_relaxed);
+    m_Sum.fetch_add(Value, std::memory_order_relaxed);
+    uint64_t Max = m_Max.load(std::memory_order_relaxed);
+    while (Value > Max && !m_Max.compare_exchange_weak(Max, Value, std::memory_order_relaxed))
+    {
+    }
+}
+
+void CLogHistogram::Reset()
+{
+    for (auto &Bucket : m_Buckets)
+    {
+        Bucket.store(0, std::memory_order_relaxed);
+    }
+    m_Count.store(0, std::memory_order_relaxed);
+    m_Sum.store(0, std::memory_order_relaxed);
+    m_Max.store(0, std::memory_order_relaxed);
+}
+
+double CLogHistogram::GetMean() const
+{
+    uint64_t Count = GetCount();
+    return Count ? static_cast<double>(m_Sum.load(std::memory_order_relaxed)) / Count : 0.0;
+}
+
+double CLogHistogram::GetPercentile(double Fraction) const
+{
+    uint64_t Total = 0;
+    for (const auto &Bucket : m_Buckets)
+    {
+        Total += Bucket.load(std::memory_order_relaxed);
+    }
+    if (Total == 0)
+    {
+        return 0.0;
+    }
+
+    // rank of the requested sample, then the middle of the bucket that holds it (never above the maximum)
+    uint64_t Rank       = static_cast<uint64_t>(std::clamp(Fraction, 0.0, 1.0) * (Total - 1)) + 1;
+    uint64_t Cumulative = 0;
+    for (unsigned i = 0; i < NUM_BUCKETS; i++)
+    {
+        Cumulative += m_Buckets[i].load(std::memory_order_relaxed);
+        if (Cumulative >= Rank)
+        {
+            uint64_t Lower = BucketLowerBound(i);
+            uint64_t Upper = (i + 1 < NUM_BUCKETS) ? BucketLowerBound(i + 1) : Lower;
+            double   Mid   = Lower + (Upper - Lower) / 2.0;
+            return std::min(Mid, static_cast<double>(GetMax()));
+        }
+    }
+    return static_cast<double>(GetMax());
+}
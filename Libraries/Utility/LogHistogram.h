@@ -0,0 +1,42 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+CLogHistogram : lock-free histogram of unsigned values with logarithmic buckets
+
+Values below 16 have their own bucket, above that every power of two is split in 16 linear sub-buckets, so a
+percentile is accurate to about 6% over the full 64 bit range. Record() is a relaxed atomic increment and may
+be called from any number of threads, readers see a consistent enough snapshot for reporting.
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+class CLogHistogram
+{
+  public:
+    static constexpr unsigned SUB_BITS    = 4;
+    static constexpr unsigned SUB_BUCKETS = 1u << SUB_BITS;
+    static constexpr unsigned NUM_BUCKETS = (64 - SUB_BITS + 1) * SUB_BUCKETS;
+
+  public:
+    void Record(uint64_t Value);
+    void Reset();
+
+    uint64_t GetCount() const { return m_Count.load(std::memory_order_relaxed); }
+    uint64_t GetMax() const { return m_Max.load(std::memory_order_relaxed); }
+    double   GetMean() const;
+    // value below which Fraction (0..1) of the samples fall, 0 when empty
+    double   GetPercentile(double Fraction) const;
+
+    static unsigned BucketIndex(uint64_t Value);
+    static uint64_t BucketLowerBound(unsigned Index);
+
+  protected:
+    std::array<std::atomic<uint64_t>, NUM_BUCKETS> m_Buckets{};
+    std::atomic<uint64_t>                          m_Count{0};
+    std::atomic<uint64_t>                          m_Sum{0};
+    std::atomic<uint64_t>                          m_Max{0};
+};
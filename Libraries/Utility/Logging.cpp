@@ -1,6 +1,8 @@
 #include "Logging.h" // Should be first for precompiled headers if used
 #include "../../../version.h"
 #include "Print.h" // For PrintInfo used by CPrintLogRecord
+#include "Metrics.h"
+#include "../Testing/ProfilingControl.h"
 
 // Standard library includes
 #include <iostream>
@@ -231,6 +233,9 @@ namespace CTrack
         // Constructor: Initialize any default states.
         // File opening is handled by enableFileOutput.
         // std::cout << "Logger instance created." << std::endl; // For debugging the logger itself
+
+        // the writer thread updates the log.* metrics, construct the registry first so that it is destroyed last
+        CMetricsRegistry::Instance();
     }
 
     CLogging::~CLogging()
@@ -251,6 +256,22 @@ namespace CTrack
         // if (m_consoleOutputEnabled && !main_instance_destroyed) { // Example of console shutdown message
         //    std::cout << getCurrentTimestampISO8601() << " [INFO] Logger shutting down." << std::endl;
         // }
+
+        // the periodic metrics record calls record() on this instance, stop it while the logger is still whole
+        CMetricsRegistry::Instance().SetLogInterval(0.0);
+
+        // the writer drains the queue before it ends
+        if (m_bWriterRunning.load(std::memory_order_acquire))
+        {
+            {
+                std::scoped_lock lock(m_writerMutex);
+                m_bStopWriter = true;
+            }
+            m_writerWake.notify_one();
+            m_writerThread.join();
+        }
+        std::scoped_lock lock(m_logMutex);
+        logFileClose();
     }
 
     bool CLogging::logFileOpen()
@@ -328,24 +349,219 @@ namespace CTrack
         }
     }
 
-    std::string CLogging::getCurrentTimestampISO8601()
+    //------------------------------------------------------------------------------------------------------------------
+    /*
+    Record text
+
+    File lines are written as ndjson straight into a per thread buffer, no json DOM. The keys come in the order
+    nlohmann::json dumps them (sorted), so the lines read like those of record() :
+
+        {"level":"ERROR","message":"...","sourceDetails":{"error_code":5,"file":"a.cpp","function":"f","line":12},"timestamp":"..."}
+
+    Text that is not UTF-8 (an ANSI exception message) gets U+FFFD for the invalid bytes; dump() threw on it and the
+    record was lost.
+    */
+    //------------------------------------------------------------------------------------------------------------------
+
+    // "2025-01-31T12:34:56.789Z", the date and time are formatted once per second and thread
+    static std::string_view FormatTimestampISO8601()
     {
-        const auto         nowChrono = std::chrono::system_clock::now();
-        const auto         in_time_t = std::chrono::system_clock::to_time_t(nowChrono);
-        std::ostringstream timestamp_ss;
+        thread_local char        text[32];
+        thread_local std::time_t textSecond = -1;
 
-        // Standard C++ way to get tm struct safely
-        std::tm localTime{};
+        const auto        sinceEpoch = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch());
+        const std::time_t second     = static_cast<std::time_t>(sinceEpoch.count() / 1000);
+        if (second != textSecond)
+        {
+            std::tm localTime{};
 #if defined(_MSC_VER)
-        localtime_s(&localTime, &in_time_t);
+            localtime_s(&localTime, &second);
 #else
-        localtime_r(&in_time_t, &localTime); // POSIX
+            localtime_r(&second, &localTime); // POSIX
 #endif
+            fmt::format_to(text, "{:04}-{:02}-{:02}T{:02}:{:02}:{:02}", localTime.tm_year + 1900, localTime.tm_mon + 1, localTime.tm_mday, localTime.tm_hour,
+                           localTime.tm_min, localTime.tm_sec);
+            textSecond = second;
+        }
+        const int ms = static_cast<int>(sinceEpoch.count() % 1000);
+        text[19]     = '.';
+        text[20]     = static_cast<char>('0' + ms / 100);
+        text[21]     = static_cast<char>('0' + ms / 10 % 10);
+        text[22]     = static_cast<char>('0' + ms % 10);
+        text[23]     = 'Z'; // ISO 8601 UTC indicator
+        return std::string_view(text, 24);
+    }
+
+    // the length of the UTF-8 character at text[i], 0 when it is not valid
+    static size_t Utf8Length(std::string_view text, size_t i)
+    {
+        const unsigned char lead   = static_cast<unsigned char>(text[i]);
+        const size_t        length = lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : 2;
+        if (lead < 0xC2 || lead > 0xF4 || i + length > text.size())
+        {
+            return 0;
+        }
 
-        timestamp_ss << std::put_time(&localTime, "%Y-%m-%dT%H:%M:%S");
-        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(nowChrono.time_since_epoch()) % 1000;
-        timestamp_ss << '.' << std::setfill('0') << std::setw(3) << ms.count() << "Z"; // ISO 8601 UTC indicator
-        return timestamp_ss.str();
+        // the second byte rules out the overlong forms, the surrogates and what lies beyond U+10FFFF
+        unsigned char low = 0x80, high = 0xBF;
+        if (lead == 0xE0)
+            low = 0xA0;
+        else if (lead == 0xED)
+            high = 0x9F;
+        else if (lead == 0xF0)
+            low = 0x90;
+        else if (lead == 0xF4)
+            high = 0x8F;
+        for (size_t k = 1; k < length; k++)
+        {
+            const unsigned char next = static_cast<unsigned char>(text[i + k]);
+            if (next < (k == 1 ? low : 0x80) || next > (k == 1 ? high : 0xBF))
+            {
+                return 0;
+            }
+        }
+        return length;
+    }
+
+    // a json string, the runs that need no escaping are copied in one go
+    static void AppendJsonString(std::string &out, std::string_view text)
+    {
+        static const char hex[] = "0123456789abcdef";
+        out += '"';
+        size_t i = 0;
+        while (i < text.size())
+        {
+            size_t run = i;
+            while (run < text.size() && static_cast<unsigned char>(text[run]) >= 0x20 && static_cast<unsigned char>(text[run]) < 0x80 && text[run] != '"' &&
+                   text[run] != '\\')
+            {
+                run++;
+            }
+            out.append(text.data() + i, run - i);
+            if (run == text.size())
+            {
+                break;
+            }
+
+            const unsigned char c = static_cast<unsigned char>(text[run]);
+            i                     = run + 1;
+            if (c >= 0x80)
+            {
+                const size_t length = Utf8Length(text, run);
+                if (length > 0)
+                {
+                    out.append(text.data() + run, length);
+                    i = run + length;
+                }
+                else
+                {
+                    out += "\xEF\xBF\xBD"; // U+FFFD
+                }
+                continue;
+            }
+            switch (c)
+            {
+                case '"':
+                    out += "\\\"";
+                    break;
+                case '\\':
+                    out += "\\\\";
+                    break;
+                case '\b':
+                    out += "\\b";
+                    break;
+                case '\f':
+                    out += "\\f";
+                    break;
+                case '\n':
+                    out += "\\n";
+                    break;
+                case '\r':
+                    out += "\\r";
+                    break;
+                case '\t':
+                    out += "\\t";
+                    break;
+                default:
+                    out += "\\u00";
+                    out += hex[c >> 4];
+                    out += hex[c & 0x0F];
+                    break;
+            }
+        }
+        out += '"';
+    }
+
+    std::string CLogging::getCurrentTimestampISO8601()
+    {
+        return std::string(FormatTimestampISO8601());
+    }
+
+    void CLogging::appendFileLine(std::string &line, std::string_view timestamp, LogSeverity level, const source_location_t &location,
+                                  std::string_view primaryMessage, const std::optional<int> &directErrorCode, const std::optional<std::error_code> &stdErrorCode,
+                                  const std::optional<std::string> &exceptionType, const std::optional<std::vector<std::string>> &stackTrace)
+    {
+        line += "{\"level\":";
+        AppendJsonString(line, SeverityToString(level));
+        line += ",\"message\":";
+        AppendJsonString(line, primaryMessage);
+
+        // sourceDetails, a stack trace replaces file, function and line
+        const char *separator = "";
+        auto        key       = [&](const char *name)
+        {
+            line += separator;
+            line += '"';
+            line += name;
+            line += "\":";
+            separator = ",";
+        };
+        line += ",\"sourceDetails\":{";
+        if (directErrorCode)
+        {
+            key("error_code");
+            fmt::format_to(std::back_inserter(line), "{}", *directErrorCode);
+        }
+        if (exceptionType)
+        {
+            key("exception_type");
+            AppendJsonString(line, *exceptionType);
+        }
+        if (!stackTrace)
+        {
+            key("file");
+            AppendJsonString(line, SourceFileName(location.file_name()));
+            key("function");
+            AppendJsonString(line, location.function_name());
+            key("line");
+            fmt::format_to(std::back_inserter(line), "{}", location.line());
+        }
+        else
+        {
+            key("stack_trace");
+            line += '[';
+            for (size_t i = 0; i < stackTrace->size(); i++)
+            {
+                if (i > 0)
+                {
+                    line += ',';
+                }
+                AppendJsonString(line, (*stackTrace)[i]);
+            }
+            line += ']';
+        }
+        if (stdErrorCode)
+        {
+            key("system_error_category");
+            AppendJsonString(line, stdErrorCode->category().name());
+            key("system_error_message");
+            AppendJsonString(line, stdErrorCode->message());
+            key("system_error_value");
+            fmt::format_to(std::back_inserter(line), "{}", stdErrorCode->value());
+        }
+        line += "},\"timestamp\":";
+        AppendJsonString(line, timestamp);
+        line += '}';
     }
 
     std::string CLogging::getModuleFileName()
@@ -419,97 +635,214 @@ namespace CTrack
                                std::optional<std::error_code> stdErrorCode, std::optional<std::string> exceptionType,
                                std::optional<std::vector<std::string>> stackTrace)
     {
-        if (level < m_minLogLevel && level != LogSeverity::LOG_ERROR && level != LogSeverity::LOG_FATAL)
+        if (!isEnabled(level))
         {
             // Allow ERROR and FATAL messages to bypass the minLogLevel filter if it's set higher.
             return;
         }
 
-        std::scoped_lock lock(m_logMutex);
-        std::string      timestampStr = getCurrentTimestampISO8601();
+        const bool consoleOutput = m_consoleOutputEnabled.load(std::memory_order_relaxed);
+        const bool fileOutput    = m_fileOutputEnabled.load(std::memory_order_relaxed);
 
-        // Console Output (Plain Text)
-        if (m_consoleOutputEnabled)
-        {
-            std::ostringstream consoleMsg;
-            consoleMsg << timestampStr << " [" << SeverityToString(level) << "] "
-                       << "[" << std::filesystem::path(location.file_name()).filename().string() << ":" << location.line() << " (" << location.function_name()
-                       << ")] " << primaryMessage;
+        CTRACK_ZONE_CATEGORY_NC(ProfileCategory::Logging, "CLogging::log", 0x888888);
+        const std::string_view timestamp = FormatTimestampISO8601();
+        LogRecord              record;
+        record.level = level;
 
+        // Console Output (Plain Text), printed by the writer thread
+        if (consoleOutput)
+        {
+            auto out = std::back_inserter(record.consoleText);
+            fmt::format_to(out, "{} [{}] [{}:{} ({})] {}", timestamp, SeverityToString(level), SourceFileName(location.file_name()), location.line(),
+                           location.function_name(), primaryMessage);
             if (directErrorCode)
-                consoleMsg << " (Error Code: " << *directErrorCode << ")";
+                fmt::format_to(out, " (Error Code: {})", *directErrorCode);
             if (stdErrorCode)
-                consoleMsg << " (System Error: " << stdErrorCode->value() << " - " << stdErrorCode->message() << ")";
+                fmt::format_to(out, " (System Error: {} - {})", stdErrorCode->value(), stdErrorCode->message());
             if (exceptionType)
-                consoleMsg << " (Exception Type: " << *exceptionType << ")"; // primaryMessage is ex.what()
+                fmt::format_to(out, " (Exception Type: {})", *exceptionType); // primaryMessage is ex.what()
+        }
 
-            if (level == LogSeverity::LOG_ERROR || level == LogSeverity::LOG_FATAL)
-            {
-                PrintError(consoleMsg.str());
-            }
-            else if (level == LogSeverity::LOG_WARNING)
+        // File Output (NDJSON), one line of the batch built in a buffer that every thread keeps
+        if (fileOutput)
+        {
+            thread_local std::string line;
+            line.clear();
+            appendFileLine(line, timestamp, level, location, primaryMessage, directErrorCode, stdErrorCode, exceptionType, stackTrace);
+            record.fileLine.assign(line);
+        }
+
+        enqueue(std::move(record));
+        if (level == LogSeverity::LOG_FATAL)
+        {
+            flush();
+        }
+    }
+
+    void CLogging::enqueue(LogRecord &&record)
+    {
+        std::call_once(m_writerStarted,
+                       [this]
+                       {
+                           m_writerThread = std::thread(&CLogging::runWriter, this);
+                           m_bWriterRunning.store(true, std::memory_order_release);
+                       });
+
+        // a full queue drops the chatter and holds back the callers of WARNING and worse, the writer itself never
+        // waits for its own queue
+        const bool mayDrop = (m_overflowPolicy.load(std::memory_order_relaxed) == LogOverflowPolicy::DropBelowWarning &&
+                              (record.level == LogSeverity::LOG_INFO || record.level == LogSeverity::LOG_DEBUG)) ||
+                             std::this_thread::get_id() == m_writerThread.get_id();
+        while (!m_queue.TryPush(std::move(record)))
+        {
+            if (mayDrop)
             {
-                PrintWarning(consoleMsg.str());
+                m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+                return;
             }
-            else
+            std::unique_lock lock(m_writerMutex);
+            if (m_bStopWriter)
             {
-                PrintInfo(consoleMsg.str());
+                m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+                return;
             }
+            m_bWakeWriter = true;
+            m_writerWake.notify_one();
+            m_writerDone.wait_for(lock, LogFlushInterval);
         }
 
-        // File Output (JSON)
-        if (m_fileOutputEnabled && logFileOpen())
+        // do not wait for the interval when a burst fills the queue
+        if (m_queue.GetSizeApprox() >= m_queue.GetCapacity() / 4)
         {
-            nlohmann::json jsonLogEntry;
-            jsonLogEntry["timestamp"] = timestampStr;
-            jsonLogEntry["level"]     = std::string(SeverityToString(level));
-            jsonLogEntry["message"]   = std::string(primaryMessage); // Convert string_view to string for nlohmann::json
+            wakeWriter();
+        }
+    }
 
-            nlohmann::json sourceDetails;
-            if (!stackTrace)
+    void CLogging::wakeWriter()
+    {
+        {
+            std::scoped_lock lock(m_writerMutex);
+            m_bWakeWriter = true;
+        }
+        m_writerWake.notify_one();
+    }
+
+    //------------------------------------------------------------------------------------------------------------------
+    /*
+    Writer thread
+
+    Wakes every LogFlushInterval, or earlier on a flush() or a filling queue, and pops at most one queue of records :
+    the console texts are printed one by one, the file lines are joined and written with one write and one flush.
+    The file stays open between batches. Records dropped since the previous batch are reported in the file as
+
+        { "timestamp", "level": "WARNING", "type": "log.dropped", "data": { "dropped": n, "total": n } }
+
+    and in the metrics as log.written, log.dropped and log.queue_depth.
+    */
+    //------------------------------------------------------------------------------------------------------------------
+
+    void CLogging::runWriter()
+    {
+        CMetricCounter &writtenCounter = CMetricsRegistry::Instance().Counter("log.written");
+        CMetricCounter &droppedCounter = CMetricsRegistry::Instance().Counter("log.dropped");
+        CMetricGauge   &depthGauge     = CMetricsRegistry::Instance().Gauge("log.queue_depth");
+
+        std::string batch;
+        LogRecord   record;
+        uint64_t    reportedDrops = 0;
+        bool        stop          = false;
+        bool        backlog       = false;
+        while (!stop || backlog)
+        {
+            if (!backlog)
             {
-                sourceDetails["file"]         = std::filesystem::path(location.file_name()).filename().string();
-                sourceDetails["line"]         = location.line();
-                sourceDetails["function"]     = location.function_name();
-                jsonLogEntry["sourceDetails"] = sourceDetails;
+                std::unique_lock lock(m_writerMutex);
+                m_writerWake.wait_for(lock, LogFlushInterval, [this] { return m_bWakeWriter || m_bStopWriter; });
+                m_bWakeWriter = false;
+                stop          = m_bStopWriter;
             }
-            else
+
+            depthGauge.Set(static_cast<double>(m_queue.GetSizeApprox()));
+            size_t count = 0;
+            while (count < m_queue.GetCapacity() && m_queue.TryPop(record))
             {
-                nlohmann::json stackTraceArray = nlohmann::json::array();
-                for (const auto &trace : *stackTrace)
+                if (!record.consoleText.empty())
                 {
-                    stackTraceArray.push_back(trace);
+                    // PrintColor, not PrintError / PrintWarning : those log the text again
+                    PrintColor(record.level == LogSeverity::LOG_ERROR || record.level == LogSeverity::LOG_FATAL ? MessageType::Error
+                               : record.level == LogSeverity::LOG_WARNING                                        ? MessageType::Warning
+                                                                                                                 : MessageType::Info,
+                               record.consoleText);
                 }
-                sourceDetails["stack_trace"] = stackTraceArray;
+                if (!record.fileLine.empty())
+                {
+                    batch += record.fileLine;
+                    batch += '\n';
+                }
+                count++;
             }
+            backlog = count == m_queue.GetCapacity();
 
-            if (directErrorCode)
-                sourceDetails["error_code"] = *directErrorCode;
-            if (stdErrorCode)
+            const uint64_t dropped = m_droppedCount.load(std::memory_order_relaxed);
+            if (dropped != reportedDrops)
             {
-                sourceDetails["system_error_value"]    = stdErrorCode->value();
-                sourceDetails["system_error_message"]  = stdErrorCode->message();
-                sourceDetails["system_error_category"] = stdErrorCode->category().name();
-            }
-            if (exceptionType)
-            {
-                sourceDetails["exception_type"] = *exceptionType;
+                nlohmann::json jsonLogEntry;
+                jsonLogEntry["timestamp"] = getCurrentTimestampISO8601();
+                jsonLogEntry["level"]     = std::string(SeverityToString(LogSeverity::LOG_WARNING));
+                jsonLogEntry["type"]      = "log.dropped";
+                jsonLogEntry["data"]      = {{"dropped", dropped - reportedDrops}, {"total", dropped}};
+                batch += jsonLogEntry.dump();
+                batch += '\n';
+                droppedCounter.Add(dropped - reportedDrops);
+                reportedDrops = dropped;
             }
 
-            try
-            {
-                // Output NDJSON (each JSON object on a new line)
-                m_logFile << jsonLogEntry.dump() << std::endl;
-            }
-            catch (const std::exception &e)
+            writeBatch(batch);
+            writtenCounter.Add(count);
+            m_writtenPosition.store(m_queue.GetDequeuePosition(), std::memory_order_release);
             {
-                // Fallback to console if JSON serialization fails
-                PrintError("INTERNAL LOGGER ERROR: Failed to serialize JSON for file: {}", e.what());
+                std::scoped_lock lock(m_writerMutex);
             }
-            logFileClose();
+            m_writerDone.notify_all();
         }
     }
 
+    void CLogging::writeBatch(std::string &batch)
+    {
+        if (batch.empty())
+        {
+            return;
+        }
+        std::scoped_lock lock(m_logMutex);
+        if (m_fileOutputEnabled && logFileOpen())
+        {
+            m_logFile.write(batch.data(), static_cast<std::streamsize>(batch.size()));
+            m_logFile.flush();
+        }
+        batch.clear();
+    }
+
+    void CLogging::flush()
+    {
+        if (!m_bWriterRunning.load(std::memory_order_acquire) || std::this_thread::get_id() == m_writerThread.get_id())
+        {
+            return;
+        }
+        const size_t     target = m_queue.GetEnqueuePosition();
+        std::unique_lock lock(m_writerMutex);
+        while (m_writtenPosition.load(std::memory_order_acquire) < target && !m_bStopWriter)
+        {
+            m_bWakeWriter = true;
+            m_writerWake.notify_one();
+            m_writerDone.wait_for(lock, LogFlushInterval);
+        }
+    }
+
+    uint64_t CLogging::getDroppedCount() const
+    {
+        return m_droppedCount.load(std::memory_order_relaxed);
+    }
+
     // --- Public logging method implementations ---
     void CLogging::log(LogSeverity level, std::string_view message, const source_location_t &location)
     {
@@ -541,6 +874,26 @@ namespace CTrack
     }
 
     // --- Convenience method implementations ---
+    void CLogging::record(std::string_view type, const nlohmann::json &data)
+    {
+        if (!m_fileOutputEnabled.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+        CTRACK_ZONE_CATEGORY_NC(ProfileCategory::Logging, "CLogging::record", 0x888888);
+        LogRecord record;
+        record.fileLine = "{\"data\":";
+        record.fileLine += data.dump();
+        record.fileLine += ",\"level\":";
+        AppendJsonString(record.fileLine, SeverityToString(LogSeverity::LOG_INFO));
+        record.fileLine += ",\"timestamp\":";
+        AppendJsonString(record.fileLine, FormatTimestampISO8601());
+        record.fileLine += ",\"type\":";
+        AppendJsonString(record.fileLine, type);
+        record.fileLine += '}';
+        enqueue(std::move(record));
+    }
+
     void CLogging::info(std::string_view message, const source_location_t &loc)
     {
         log(LogSeverity::LOG_INFO, message, loc);
@@ -584,11 +937,7 @@ namespace CTrack
     }
     void CLogging::fatal(std::string_view message, const source_location_t &loc)
     {
-        log(LogSeverity::LOG_FATAL, message, loc);
-        if (m_logFile.is_open())
-        {
-            m_logFile.close();
-        }
+        log(LogSeverity::LOG_FATAL, message, loc); // flushes
     }
 
     // --- Configuration method implementations ---
@@ -600,8 +949,11 @@ namespace CTrack
 
     void CLogging::enableFileOutput(bool enable, const std::string &userFilepath)
     {
+        // what was logged so far goes to the current file
+        flush();
         std::scoped_lock lock(m_logMutex);
         m_fileOutputEnabled = enable;
+        logFileClose();
 
         if (enable)
         {
@@ -623,16 +975,17 @@ namespace CTrack
 
     void CLogging::setMinLogLevel(LogSeverity level)
     {
-        std::scoped_lock lock(m_logMutex);
-        m_minLogLevel = level;
+        m_minLogLevel.store(level, std::memory_order_relaxed);
+    }
+
+    void CLogging::setOverflowPolicy(LogOverflowPolicy policy)
+    {
+        m_overflowPolicy.store(policy, std::memory_order_relaxed);
     }
 
     LogSeverity CLogging::getMinLogLevel() const
     {
-        // Mutex not strictly needed for const access to an enum if writes are protected,
-        // but for consistency with setMinLogLevel or if it could be read during construction.
-        // std::scoped_lock lock(m_logMutex); // Uncomment if strict thread safety for this read is paramount
-        return m_minLogLevel;
+        return m_minLogLevel.load(std::memory_order_relaxed);
     }
 
     // --- CPrintLogRecord Member Function Definitions (from original Logging.cpp) ---
@@ -653,7 +1006,7 @@ namespace CTrack
     {
         m_Timer = std::chrono::high_resolution_clock::now();
         // Original used PrintInfo. If PrintInfo is to be replaced by CLogging:
-        LOG_INFO(fmt::format("{} : {}", m_Identifier, m_StartMessage));
+        LOG_INFO_FMT("{} : {}", m_Identifier, m_StartMessage);
         // If PrintInfo is a separate mechanism from "Print.h", it would be:
         // PrintInfo("{} : {}", m_Identifier, m_StartMessage); // Requires Print.h and its implementation
     }
@@ -663,7 +1016,7 @@ namespace CTrack
         auto                          finish  = std::chrono::high_resolution_clock::now();
         std::chrono::duration<double> elapsed = finish - m_Timer;
         // Original used PrintInfo. If PrintInfo is to be replaced by CLogging:
-        LOG_INFO(fmt::format("{} : {} [{:.3f}s]", m_Identifier, m_StopMessage, elapsed.count()));
+        LOG_INFO_FMT("{} : {} [{:.3f}s]", m_Identifier, m_StopMessage, elapsed.count());
         // If PrintInfo is a separate mechanism from "Print.h", it would be:
         // PrintInfo("{} : {} [{:.3f}s]", m_Identifier, m_StopMessage, elapsed.count()); // Requires Print.h
     }
@@ -4,7 +4,11 @@
 #undef strtoull
 #undef strtoll
 #include <nlohmann/json.hpp>
+#include <fmt/format.h>
+#include "MPSCQueue.h"
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <cstdint> // For std::uint_least32_t
 #include <filesystem>
 #include <fstream>
@@ -16,17 +20,49 @@
 #include <string>
 #include <string_view>
 #include <system_error>
+#include <thread>
 
 // --- Logging Macros (adapted from LogTesting.cpp) ---
-#define LOG_INFO(message)                        CTrack::CLogging::getInstance().info(message, MAKE_SOURCE_LOCATION())
-#define LOG_WARNING(message)                     CTrack::CLogging::getInstance().warning(message, MAKE_SOURCE_LOCATION())
-#define LOG_WARNING_EX(exception)                CTrack::CLogging::getInstance().warning(exception, MAKE_SOURCE_LOCATION())
-#define LOG_ERROR_MSG(message)                   CTrack::CLogging::getInstance().error(message, MAKE_SOURCE_LOCATION()) // Renamed from LOG_ERROR
-#define LOG_ERROR_EX(exception)                  CTrack::CLogging::getInstance().error(exception, MAKE_SOURCE_LOCATION())
-#define LOG_ERROR_CODE(message, code)            CTrack::CLogging::getInstance().error(message, code, MAKE_SOURCE_LOCATION())
-#define LOG_ERROR_STDCODE(message, stdErrorCode) CTrack::CLogging::getInstance().error(message, stdErrorCode, MAKE_SOURCE_LOCATION())
-#define LOG_DEBUG(message)                       CTrack::CLogging::getInstance().debug(message, MAKE_SOURCE_LOCATION())
-#define LOG_FATAL(message)                       CTrack::CLogging::getInstance().fatal(message, MAKE_SOURCE_LOCATION())
+// The level is checked before the arguments are evaluated, a disabled LOG_DEBUG costs two atomic loads. The source
+// location is a static of the call site with the directory already stripped from the file name.
+#define CTRACK_LOG_CALL(level, method, ...)                                                                                                                    \
+    do                                                                                                                                                         \
+    {                                                                                                                                                          \
+        CTrack::CLogging &logger_ = CTrack::CLogging::getInstance();                                                                                          \
+        if (logger_.isEnabled(level))                                                                                                                          \
+        {                                                                                                                                                      \
+            static const CTrack::source_location_polyfill location_(CTrack::SourceFileName(__FILE__), __func__, static_cast<std::uint_least32_t>(__LINE__)); \
+            logger_.method(__VA_ARGS__, location_);                                                                                                            \
+        }                                                                                                                                                      \
+    }                                                                                                                                                          \
+    while (0)
+#define CTRACK_LOG_FORMAT(level, ...)                                                                                                                          \
+    do                                                                                                                                                         \
+    {                                                                                                                                                          \
+        CTrack::CLogging &logger_ = CTrack::CLogging::getInstance();                                                                                          \
+        if (logger_.isEnabled(level))                                                                                                                          \
+        {                                                                                                                                                      \
+            static const CTrack::source_location_polyfill location_(CTrack::SourceFileName(__FILE__), __func__, static_cast<std::uint_least32_t>(__LINE__)); \
+            logger_.logFormat(level, location_, __VA_ARGS__);                                                                                                  \
+        }                                                                                                                                                      \
+    }                                                                                                                                                          \
+    while (0)
+
+#define LOG_INFO(message)                        CTRACK_LOG_CALL(CTrack::LogSeverity::LOG_INFO, info, message)
+#define LOG_WARNING(message)                     CTRACK_LOG_CALL(CTrack::LogSeverity::LOG_WARNING, warning, message)
+#define LOG_WARNING_EX(exception)                CTRACK_LOG_CALL(CTrack::LogSeverity::LOG_WARNING, warning, exception)
+#define LOG_ERROR_MSG(message)                   CTRACK_LOG_CALL(CTrack::LogSeverity::LOG_ERROR, error, message) // Renamed from LOG_ERROR
+#define LOG_ERROR_EX(exception)                  CTRACK_LOG_CALL(CTrack::LogSeverity::LOG_ERROR, error, exception)
+#define LOG_ERROR_CODE(message, code)            CTRACK_LOG_CALL(CTrack::LogSeverity::LOG_ERROR, error, message, code)
+#define LOG_ERROR_STDCODE(message, stdErrorCode) CTRACK_LOG_CALL(CTrack::LogSeverity::LOG_ERROR, error, message, stdErrorCode)
+#define LOG_DEBUG(message)                       CTRACK_LOG_CALL(CTrack::LogSeverity::LOG_DEBUG, debug, message)
+#define LOG_FATAL(message)                       CTRACK_LOG_CALL(CTrack::LogSeverity::LOG_FATAL, fatal, message)
+
+// fmt format strings, checked at compile time : LOG_INFO_FMT("{} channels at {:.1f} Hz", NumChannels, Frequency)
+#define LOG_INFO_FMT(...)    CTRACK_LOG_FORMAT(CTrack::LogSeverity::LOG_INFO, __VA_ARGS__)
+#define LOG_WARNING_FMT(...) CTRACK_LOG_FORMAT(CTrack::LogSeverity::LOG_WARNING, __VA_ARGS__)
+#define LOG_ERROR_FMT(...)   CTRACK_LOG_FORMAT(CTrack::LogSeverity::LOG_ERROR, __VA_ARGS__)
+#define LOG_DEBUG_FMT(...)   CTRACK_LOG_FORMAT(CTrack::LogSeverity::LOG_DEBUG, __VA_ARGS__)
 #define LOG_ERROR_MSG_SRC_LINE(errorCode, file, line, message)                                                                                                 \
     CTrack::CLogging::getInstance().error(message, errorCode, CTrack::source_location_polyfill(file, "", line)) // For backward compatibility
 
@@ -56,6 +92,18 @@ namespace CTrack
         [[nodiscard]] constexpr const char         *function_name() const noexcept { return function_name_; }
     };
     using source_location_t = CTrack::source_location_polyfill;
+
+    // the file name without its directories, evaluated once per call site by the LOG_ macros
+    constexpr const char *SourceFileName(const char *path)
+    {
+        const char *name = path;
+        for (const char *p = path; *p; ++p)
+        {
+            if (*p == '/' || *p == '\\')
+                name = p + 1;
+        }
+        return name;
+    }
 #define MAKE_SOURCE_LOCATION() CTrack::source_location_polyfill(__FILE__, __func__, static_cast<std::uint_least32_t>(__LINE__))
 
     // Original constants from Logging.h
@@ -75,6 +123,16 @@ namespace CTrack
     // Helper to convert LogSeverity to string (declaration)
     std::string_view SeverityToString(LogSeverity level);
 
+    // What a caller does when the queue of the log writer thread is full
+    enum class LogOverflowPolicy
+    {
+        DropBelowWarning, // INFO, DEBUG and record() are dropped and counted, WARNING and ERROR wait for room
+        Block             // every caller waits for room
+    };
+
+    constexpr size_t                    LogQueueCapacity = 8192;
+    constexpr std::chrono::milliseconds LogFlushInterval{100};
+
     class CLogging
     {
       public:
@@ -87,6 +145,14 @@ namespace CTrack
         CLogging(CLogging &&)                 = delete;
         CLogging &operator=(CLogging &&)      = delete;
 
+        // true when a record of this level reaches the console or the file, the LOG_ macros test it first
+        bool isEnabled(LogSeverity level) const
+        {
+            const LogSeverity minLevel = m_minLogLevel.load(std::memory_order_relaxed);
+            return (level >= minLevel || level == LogSeverity::LOG_ERROR || level == LogSeverity::LOG_FATAL) &&
+                   (m_consoleOutputEnabled.load(std::memory_order_relaxed) || m_fileOutputEnabled.load(std::memory_order_relaxed));
+        }
+
         // --- Public logging methods ---
         void log(LogSeverity level, std::string_view message, const source_location_t &location);
         void log(LogSeverity level, std::string_view message, int errorCode, const source_location_t &location);
@@ -94,6 +160,18 @@ namespace CTrack
         void log(LogSeverity level, const std::exception &ex, const source_location_t &location);
         void log(LogSeverity level, std::string_view message, const std::vector<std::string> &stackTrace, const source_location_t &location);
 
+        // the message is formatted on the stack, only when the level is enabled
+        template <typename... Args> void logFormat(LogSeverity level, const source_location_t &location, fmt::format_string<Args...> format, Args &&...args)
+        {
+            if (!isEnabled(level))
+            {
+                return;
+            }
+            fmt::memory_buffer message;
+            fmt::format_to(std::back_inserter(message), format, std::forward<Args>(args)...);
+            logInternal(level, location, std::string_view(message.data(), message.size()));
+        }
+
         // --- Convenience methods ---
         void info(std::string_view message, const source_location_t &loc);
         void warning(std::string_view message, const source_location_t &loc);
@@ -107,11 +185,21 @@ namespace CTrack
         void debug(std::string_view message, const source_location_t &loc);
         void fatal(std::string_view message, const source_location_t &loc); // For LOG_FATAL
 
+        // structured record for the log file only : { "timestamp", "level": "INFO", "type": type, "data": data }
+        void record(std::string_view type, const nlohmann::json &data);
+
+        // Records are formatted by the caller and written by a background thread in batches, every
+        // LogFlushInterval or sooner when the queue fills up. flush() waits until everything logged before
+        // the call is in the file; fatal() calls it, nothing else waits for the disk.
+        void     flush();
+        uint64_t getDroppedCount() const;
+
         // --- Configuration methods ---
         void        enableConsoleOutput(bool enable);
         void        enableFileOutput(bool enable, const std::string &filepath = ""); // Empty path for default name
         void        setMinLogLevel(LogSeverity level);
         LogSeverity getMinLogLevel() const;
+        void        setOverflowPolicy(LogOverflowPolicy policy);
 
         // Method to initialize logging with version info etc.
         // Can be called explicitly after getting the instance.
@@ -125,6 +213,19 @@ namespace CTrack
         bool logFileOpen();
         void logFileClose();
 
+        // a preformatted record, either text may be empty
+        struct LogRecord
+        {
+            LogSeverity level{LogSeverity::LOG_INFO};
+            std::string consoleText;
+            std::string fileLine;
+        };
+
+        void enqueue(LogRecord &&record);
+        void wakeWriter();
+        void runWriter();
+        void writeBatch(std::string &batch);
+
         // Core internal logging method
         void logInternal(LogSeverity              level,
                          const source_location_t &location, // Use the alias
@@ -135,18 +236,36 @@ namespace CTrack
         // Helper methods (can be static if they don't rely on instance members directly,
         // or non-static if they use instance-specific config like date formats if that were added)
         static std::string getCurrentTimestampISO8601();
+        static void        appendFileLine(std::string &line, std::string_view timestamp, LogSeverity level, const source_location_t &location,
+                                          std::string_view primaryMessage, const std::optional<int> &directErrorCode,
+                                          const std::optional<std::error_code> &stdErrorCode, const std::optional<std::string> &exceptionType,
+                                          const std::optional<std::vector<std::string>> &stackTrace);
         std::string        generateDefaultLogFileName(const std::string &mode);
         static std::string getApplicationName();
         static std::string getModuleFileName(); // Windows specific
 
         // Member variables
-        std::mutex    m_logMutex;
-        std::ofstream m_logFile;
-        bool          m_consoleOutputEnabled;
-        bool          m_fileOutputEnabled;
-        LogSeverity   m_minLogLevel;
-        std::string   m_logFileBaseName; // From original global g_LogFileBaseName concept
-        std::string   m_currentLogFilePath;
+        std::mutex               m_logMutex; // m_logFile and the paths
+        std::ofstream            m_logFile;
+        std::atomic<bool>        m_consoleOutputEnabled;
+        std::atomic<bool>        m_fileOutputEnabled;
+        std::atomic<LogSeverity> m_minLogLevel;
+        std::string              m_logFileBaseName; // From original global g_LogFileBaseName concept
+        std::string              m_currentLogFilePath;
+
+        // Writer thread
+        CMPSCQueue<LogRecord>          m_queue{LogQueueCapacity};
+        std::atomic<LogOverflowPolicy> m_overflowPolicy{LogOverflowPolicy::DropBelowWarning};
+        std::atomic<uint64_t>          m_droppedCount{0};
+        std::atomic<size_t>            m_writtenPosition{0}; // queue position up to which the file is flushed
+        std::once_flag                 m_writerStarted;
+        std::atomic<bool>              m_bWriterRunning{false};
+        std::thread                    m_writerThread;
+        std::mutex                     m_writerMutex;
+        std::condition_variable        m_writerWake;
+        std::condition_variable        m_writerDone;
+        bool                           m_bWakeWriter{false};
+        bool                           m_bStopWriter{false};
     };
 
     // --- Retaining CPrintLogRecord from original Logging.h ---
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+CMPSCQueue : bounded lock-free multiple producer / single consumer ring
+
+Any number of threads call TryPush, one thread calls TryPop. Every slot carries a sequence number : a producer
+claims a slot by advancing the tail with a compare exchange and publishes it by setting the sequence, the
+consumer takes slots in tail order once they are published. A producer that is preempted between claim and
+publish holds up the consumer, never the other producers. When the ring is full TryPush fails and the caller
+decides whether to drop or retry.
+
+The positions count every push and pop since construction; a consumer that has popped up to GetEnqueuePosition()
+read earlier has seen everything that was pushed before that call.
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+template <typename T> class CMPSCQueue
+{
+  public:
+    explicit CMPSCQueue(size_t Capacity = 1024)
+    {
+        size_t Size = 2;
+        while (Size < Capacity)
+        {
+            Size <<= 1;
+        }
+        m_Slots = std::make_unique<Slot[]>(Size);
+        for (size_t i = 0; i < Size; i++)
+        {
+            m_Slots[i].Sequence.store(i, std::memory_order_relaxed);
+        }
+        m_Mask = Size - 1;
+    }
+    CMPSCQueue(const CMPSCQueue &)            = delete;
+    CMPSCQueue &operator=(const CMPSCQueue &) = delete;
+
+    // producers
+    bool TryPush(T &&Value)
+    {
+        size_t Tail = m_Tail.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Slot  &Target   = m_Slots[Tail & m_Mask];
+            size_t Sequence = Target.Sequence.load(std::memory_order_acquire);
+            if (Sequence == Tail)
+            {
+                if (m_Tail.compare_exchange_weak(Tail, Tail + 1, std::memory_order_relaxed))
+                {
+                    Target.Value = std::move(Value);
+                    Target.Sequence.store(Tail + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (Sequence < Tail)
+            {
+                return false; // full
+            }
+            else
+            {
+                Tail = m_Tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // consumer
+    bool TryPop(T &Value)
+    {
+        Slot &Source = m_Slots[m_Head & m_Mask];
+        if (Source.Sequence.load(std::memory_order_acquire) != m_Head + 1)
+        {
+            return false; // empty, or the next producer has not published yet
+        }
+        Value = std::move(Source.Value);
+        Source.Sequence.store(m_Head + m_Mask + 1, std::memory_order_release);
+        m_Head++;
+        m_HeadPosition.store(m_Head, std::memory_order_release);
+        return true;
+    }
+
+    size_t GetCapacity() const { return m_Mask + 1; }
+    size_t GetEnqueuePosition() const { return m_Tail.load(std::memory_order_acquire); }
+    size_t GetDequeuePosition() const { return m_HeadPosition.load(std::memory_order_acquire); }
+    size_t GetSizeApprox() const
+    {
+        const size_t Head = GetDequeuePosition();
+        const size_t Tail = GetEnqueuePosition();
+        return Tail > Head ? Tail - Head : 0;
+    }
+
+  protected:
+    struct Slot
+    {
+        std::atomic<size_t> Sequence{0};
+        T                   Value{};
+    };
+
+    std::unique_ptr<Slot[]> m_Slots;
+    size_t                  m_Mask = 0;
+
+    alignas(64) size_t m_Head = 0;                     // consumer only
+    std::atomic<size_t> m_HeadPosition{0};             // m_Head for the other threads
+    alignas(64) std::atomic<size_t> m_Tail{0};         // claimed by the producers
+};
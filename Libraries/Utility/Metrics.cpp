@@ -0,0 +1,144 @@
+#include "Metrics.h"
+
+#include "Logging.h"
+#include "../TCP/Message.h"
+#include "../XML/ProxyMessages.h"
+
+namespace CTrack
+{
+    CMetricsRegistry &CMetricsRegistry::Instance()
+    {
+        static CMetricsRegistry Registry;
+        return Registry;
+    }
+
+    CMetricsRegistry::~CMetricsRegistry()
+    {
+        SetLogInterval(0.0);
+    }
+
+    template <typename T> static T &FindOrCreate(std::map<std::string, std::unique_ptr<T>> &Map, const std::string &Name)
+    {
+        auto &pMetric = Map[Name];
+        if (!pMetric)
+        {
+            pMetric = std::make_unique<T>();
+        }
+        return *pMetric;
+    }
+
+    CMetricCounter &CMetricsRegistry::Counter(const std::string &Name)
+    {
+        std::lock_guard<std::mutex> Lock(m_Lock);
+        return FindOrCreate(m_Counters, Name);
+    }
+
+    CMetricGauge &CMetricsRegistry::Gauge(const std::string &Name)
+    {
+        std::lock_guard<std::mutex> Lock(m_Lock);
+        return FindOrCreate(m_Gauges, Name);
+    }
+
+    CLogHistogram &CMetricsRegistry::Histogram(const std::string &Name)
+    {
+        std::lock_guard<std::mutex> Lock(m_Lock);
+        return FindOrCreate(m_Histograms, Name);
+    }
+
+    nlohmann::json CMetricsRegistry::Snapshot() const
+    {
+        nlohmann::json Result = {{"counters", nlohmann::json::object()}, {"gauges", nlohmann::json::object()}, {"histograms", nlohmann::json::object()}};
+
+        std::lock_guard<std::mutex> Lock(m_Lock);
+        for (const auto &[Name, pCounter] : m_Counters)
+        {
+            Result["counters"][Name] = pCounter->Get();
+        }
+        for (const auto &[Name, pGauge] : m_Gauges)
+        {
+            Result["gauges"][Name] = pGauge->Get();
+        }
+        for (const auto &[Name, pHistogram] : m_Histograms)
+        {
+            Result["histograms"][Name] = {{"count", pHistogram->GetCount()},
+                                          {"mean", pHistogram->GetMean()},
+                                          {"p50", pHistogram->GetPercentile(0.50)},
+                                          {"p99", pHistogram->GetPercentile(0.99)},
+                                          {"p999", pHistogram->GetPercentile(0.999)},
+                                          {"max", pHistogram->GetMax()}};
+        }
+        return Result;
+    }
+
+    void CMetricsRegistry::Reset()
+    {
+        std::lock_guard<std::mutex> Lock(m_Lock);
+        for (auto &[Name, pCounter] : m_Counters)
+        {
+            pCounter->Reset();
+        }
+        for (auto &[Name, pHistogram] : m_Histograms)
+        {
+            pHistogram->Reset();
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------------------
+    /*
+    Periodic logging
+    */
+    //------------------------------------------------------------------------------------------------------------------
+
+    void CMetricsRegistry::SetLogInterval(double IntervalSeconds)
+    {
+        if (m_LogThread.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> Lock(m_LogLock);
+                m_bLogQuit = true;
+            }
+            m_LogWake.notify_all();
+            m_LogThread.join();
+        }
+        m_LogIntervalSeconds = IntervalSeconds > 0.0 ? IntervalSeconds : 0.0;
+        m_bLogQuit           = false;
+        if (m_LogIntervalSeconds > 0.0)
+        {
+            m_LogThread = std::thread(&CMetricsRegistry::LogThread, this);
+        }
+    }
+
+    void CMetricsRegistry::LogThread()
+    {
+        auto Interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(m_LogIntervalSeconds));
+        auto Next     = std::chrono::steady_clock::now() + Interval;
+
+        std::unique_lock<std::mutex> Lock(m_LogLock);
+        while (!m_LogWake.wait_until(Lock, Next, [this] { return m_bLogQuit; }))
+        {
+            Lock.unlock();
+            CLogging::getInstance().record("metrics", Snapshot());
+            Lock.lock();
+            Next += Interval;
+        }
+    }
+
+    Reply CMetricsRegistry::OnMetrics(const Message &message)
+    {
+        CMetricsRegistry &Registry = Instance();
+        const auto       &Params   = message.GetParams();
+        if (Params.contains(ProxyParam::LogInterval))
+        {
+            Registry.SetLogInterval(Params[ProxyParam::LogInterval].get<double>());
+        }
+
+        Reply reply                                 = std::make_unique<Message>(ProxyMsg::Metrics);
+        reply->GetParams()[ProxyParam::Metrics]     = Registry.Snapshot();
+        reply->GetParams()[ProxyParam::LogInterval] = Registry.GetLogInterval();
+        if (Params.value(ProxyParam::Reset, false))
+        {
+            Registry.Reset();
+        }
+        return reply;
+    }
+} // namespace CTrack
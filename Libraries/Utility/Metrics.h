@@ -0,0 +1,154 @@
+#pragma once
+
+#include "LogHistogram.h"
+
+#undef strtoull
+#undef strtoll
+#include <nlohmann/json.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace CTrack
+{
+    class Message;
+    using Reply = std::unique_ptr<Message>;
+
+    //------------------------------------------------------------------------------------------------------------------
+    /*
+    Metrics registry
+
+    Named counters, gauges and log-bucket histograms shared by all components of a proxy. Looking a metric up
+    takes a lock, so hot paths look it up once and keep the reference (metrics are never removed); updating
+    one is a single relaxed atomic operation. Names are dotted, the unit is the suffix : "vicon.run_us",
+    "tcp.40001.bytes_sent".
+
+    The registry is snapshotted by the proxy.metrics message and can be written to the ndjson log at a fixed
+    interval.
+    */
+    //------------------------------------------------------------------------------------------------------------------
+
+    class CMetricCounter
+    {
+      public:
+        void     Add(uint64_t Value = 1) { m_Value.fetch_add(Value, std::memory_order_relaxed); }
+        uint64_t Get() const { return m_Value.load(std::memory_order_relaxed); }
+        void     Reset() { m_Value.store(0, std::memory_order_relaxed); }
+
+      protected:
+        std::atomic<uint64_t> m_Value{0};
+    };
+
+    class CMetricGauge
+    {
+      public:
+        void   Set(double Value) { m_Value.store(Value, std::memory_order_relaxed); }
+        double Get() const { return m_Value.load(std::memory_order_relaxed); }
+
+      protected:
+        std::atomic<double> m_Value{0.0};
+    };
+
+    // records the lifetime of the scope in microseconds
+    class CScopedTimer
+    {
+      public:
+        explicit CScopedTimer(CLogHistogram &Histogram) : m_Histogram(Histogram), m_Start(std::chrono::steady_clock::now()) {}
+        ~CScopedTimer()
+        {
+            auto Elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_Start).count();
+            m_Histogram.Record(static_cast<uint64_t>(Elapsed));
+        }
+
+      protected:
+        CLogHistogram                        &m_Histogram;
+        std::chrono::steady_clock::time_point m_Start;
+    };
+
+    // frames per second over windows of at least a second, replaces the per driver bookkeeping
+    class CFrameRateMeter
+    {
+      public:
+        void Reset()
+        {
+            m_Frames       = 0;
+            m_WindowFrames = 0;
+            m_FPS          = 0.0;
+        }
+        // count frames, returns the current rate
+        double Tick(uint64_t NumFrames = 1)
+        {
+            auto Now = std::chrono::steady_clock::now();
+            if (m_Frames == 0)
+            {
+                m_WindowStart = Now;
+            }
+            m_Frames += NumFrames;
+            m_WindowFrames += NumFrames;
+            double Elapsed = std::chrono::duration<double>(Now - m_WindowStart).count();
+            if (Elapsed >= 1.0)
+            {
+                m_FPS          = m_WindowFrames / Elapsed;
+                m_WindowStart  = Now;
+                m_WindowFrames = 0;
+            }
+            return m_FPS;
+        }
+        double   GetFPS() const { return m_FPS; }
+        uint64_t GetFrames() const { return m_Frames; }
+
+      protected:
+        std::chrono::steady_clock::time_point m_WindowStart;
+        uint64_t                              m_Frames       = 0;
+        uint64_t                              m_WindowFrames = 0;
+        double                                m_FPS          = 0.0;
+    };
+
+    class CMetricsRegistry
+    {
+      public:
+        static CMetricsRegistry &Instance();
+        ~CMetricsRegistry();
+
+        // find or create, the reference stays valid for the lifetime of the process
+        CMetricCounter &Counter(const std::string &Name);
+        CMetricGauge   &Gauge(const std::string &Name);
+        CLogHistogram  &Histogram(const std::string &Name);
+
+        // { "counters": {name: value}, "gauges": {name: value}, "histograms": {name: {count, mean, p50, p99, p999, max}} }
+        nlohmann::json Snapshot() const;
+        // zero counters and histograms, gauges keep their last value
+        void           Reset();
+
+        // write a snapshot to the ndjson log every IntervalSeconds, 0 = stop
+        void   SetLogInterval(double IntervalSeconds);
+        double GetLogInterval() const { return m_LogIntervalSeconds; }
+
+        // handler for ProxyMsg::Metrics, params { "reset": bool, "log_interval": seconds } are both optional
+        static Reply OnMetrics(const Message &message);
+
+      protected:
+        CMetricsRegistry() = default;
+        void LogThread();
+
+      protected:
+        mutable std::mutex                                     m_Lock;
+        std::map<std::string, std::unique_ptr<CMetricCounter>> m_Counters;
+        std::map<std::string, std::unique_ptr<CMetricGauge>>   m_Gauges;
+        std::map<std::string, std::unique_ptr<CLogHistogram>>  m_Histograms;
+
+        // periodic logging
+        std::thread             m_LogThread;
+        std::mutex              m_LogLock;
+        std::condition_variable m_LogWake;
+        double                  m_LogIntervalSeconds = 0.0;
+        bool                    m_bLogQuit           = false;
+    };
+} // namespace CTrack
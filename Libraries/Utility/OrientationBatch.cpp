@@ -0,0 +1,720 @@
+#include "Orientations.h"
+
+#include <algorithm>
+#include <cmath>
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+Batch conversions
+
+The calls per pose cost a virtual call and a scattered T4x4 each, which dominates when a recording of thousands of
+frames times dozens of bodies is post-processed. The batch versions run every formula over the arrays of a
+CPoseBatch instead : products, sums, divisions, sqrt, min and max in SIMD lanes (AVX, SSE2 or NEON, whatever the
+build targets), the library sin, cos, atan2 and acos in a plain loop over the same arrays, and the unwrap as a
+scan over the frames of every series afterwards.
+
+The results are bit for bit those of the calls per pose : the lanes round every operation in the order of the
+scalar formulas (no fused multiply-add), the trig functions are the same library calls, and the rare poses the
+scalar code handles in a branch (gimbal lock, no rotation) are redone with the scalar function. Branches that are
+cheap, like the four of the quaternion, are all computed and selected per lane. Benchmark.exe in "micro" mode checks this for every orientation before it times them.
+
+Managed code (Leica.LMF is compiled /clr) has no SIMD types, there the lanes are one pose wide.
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+#if defined(_M_CEE)
+#elif defined(__AVX__)
+#include <immintrin.h>
+#define ORIENTATION_BATCH_AVX
+#elif defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ORIENTATION_BATCH_SSE2
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#include <arm_neon.h>
+#define ORIENTATION_BATCH_NEON
+#endif
+
+namespace
+{
+    // one pose, also the remainder of the SIMD loops
+    struct Scalar
+    {
+        double v;
+
+        using Mask                  = bool;
+        static constexpr size_t Width = 1;
+        static Scalar           Load(const double *p) { return {*p}; }
+        static Scalar           Set(double x) { return {x}; }
+        void                    Store(double *p) const { *p = v; }
+    };
+    inline Scalar operator+(Scalar a, Scalar b) { return {a.v + b.v}; }
+    inline Scalar operator-(Scalar a, Scalar b) { return {a.v - b.v}; }
+    inline Scalar operator*(Scalar a, Scalar b) { return {a.v * b.v}; }
+    inline Scalar operator/(Scalar a, Scalar b) { return {a.v / b.v}; }
+    inline Scalar operator-(Scalar a) { return {-a.v}; }
+    inline Scalar Sqrt(Scalar a) { return {sqrt(a.v)}; }
+    inline Scalar Min(Scalar a, Scalar b) { return {a.v < b.v ? a.v : b.v}; } // the MIN and MAX macros
+    inline Scalar Max(Scalar a, Scalar b) { return {a.v > b.v ? a.v : b.v}; }
+    inline Scalar Abs(Scalar a) { return {fabs(a.v)}; }
+    inline bool   Less(Scalar a, Scalar b) { return a.v < b.v; }
+    inline bool   NotEqual(Scalar a, Scalar b) { return a.v != b.v; }
+    inline bool   And(bool a, bool b) { return a && b; }
+    inline Scalar Select(bool m, Scalar a, Scalar b) { return m ? a : b; }
+
+#if defined(ORIENTATION_BATCH_AVX)
+    struct Lanes
+    {
+        __m256d v;
+
+        using Mask                  = Lanes;
+        static constexpr size_t Width = 4;
+        static Lanes            Load(const double *p) { return {_mm256_loadu_pd(p)}; }
+        static Lanes            Set(double x) { return {_mm256_set1_pd(x)}; }
+        void                    Store(double *p) const { _mm256_storeu_pd(p, v); }
+    };
+    inline Lanes operator+(Lanes a, Lanes b) { return {_mm256_add_pd(a.v, b.v)}; }
+    inline Lanes operator-(Lanes a, Lanes b) { return {_mm256_sub_pd(a.v, b.v)}; }
+    inline Lanes operator*(Lanes a, Lanes b) { return {_mm256_mul_pd(a.v, b.v)}; }
+    inline Lanes operator/(Lanes a, Lanes b) { return {_mm256_div_pd(a.v, b.v)}; }
+    inline Lanes operator-(Lanes a) { return {_mm256_xor_pd(a.v, _mm256_set1_pd(-0.0))}; }
+    inline Lanes Sqrt(Lanes a) { return {_mm256_sqrt_pd(a.v)}; }
+    inline Lanes Min(Lanes a, Lanes b) { return {_mm256_min_pd(a.v, b.v)}; } // a < b ? a : b
+    inline Lanes Max(Lanes a, Lanes b) { return {_mm256_max_pd(a.v, b.v)}; } // a > b ? a : b
+    inline Lanes Abs(Lanes a) { return {_mm256_andnot_pd(_mm256_set1_pd(-0.0), a.v)}; }
+    inline Lanes Less(Lanes a, Lanes b) { return {_mm256_cmp_pd(a.v, b.v, _CMP_LT_OQ)}; }
+    inline Lanes NotEqual(Lanes a, Lanes b) { return {_mm256_cmp_pd(a.v, b.v, _CMP_NEQ_UQ)}; }
+    inline Lanes And(Lanes a, Lanes b) { return {_mm256_and_pd(a.v, b.v)}; }
+    inline Lanes Select(Lanes m, Lanes a, Lanes b) { return {_mm256_blendv_pd(b.v, a.v, m.v)}; }
+#define ORIENTATION_BATCH_SIMD
+#elif defined(ORIENTATION_BATCH_SSE2)
+    struct Lanes
+    {
+        __m128d v;
+
+        using Mask                  = Lanes;
+        static constexpr size_t Width = 2;
+        static Lanes            Load(const double *p) { return {_mm_loadu_pd(p)}; }
+        static Lanes            Set(double x) { return {_mm_set1_pd(x)}; }
+        void                    Store(double *p) const { _mm_storeu_pd(p, v); }
+    };
+    inline Lanes operator+(Lanes a, Lanes b) { return {_mm_add_pd(a.v, b.v)}; }
+    inline Lanes operator-(Lanes a, Lanes b) { return {_mm_sub_pd(a.v, b.v)}; }
+    inline Lanes operator*(Lanes a, Lanes b) { return {_mm_mul_pd(a.v, b.v)}; }
+    inline Lanes operator/(Lanes a, Lanes b) { return {_mm_div_pd(a.v, b.v)}; }
+    inline Lanes operator-(Lanes a) { return {_mm_xor_pd(a.v, _mm_set1_pd(-0.0))}; }
+    inline Lanes Sqrt(Lanes a) { return {_mm_sqrt_pd(a.v)}; }
+    inline Lanes Min(Lanes a, Lanes b) { return {_mm_min_pd(a.v, b.v)}; } // a < b ? a : b
+    inline Lanes Max(Lanes a, Lanes b) { return {_mm_max_pd(a.v, b.v)}; } // a > b ? a : b
+    inline Lanes Abs(Lanes a) { return {_mm_andnot_pd(_mm_set1_pd(-0.0), a.v)}; }
+    inline Lanes Less(Lanes a, Lanes b) { return {_mm_cmplt_pd(a.v, b.v)}; }
+    inline Lanes NotEqual(Lanes a, Lanes b) { return {_mm_cmpneq_pd(a.v, b.v)}; }
+    inline Lanes And(Lanes a, Lanes b) { return {_mm_and_pd(a.v, b.v)}; }
+    inline Lanes Select(Lanes m, Lanes a, Lanes b) { return {_mm_or_pd(_mm_and_pd(m.v, a.v), _mm_andnot_pd(m.v, b.v))}; }
+#define ORIENTATION_BATCH_SIMD
+#elif defined(ORIENTATION_BATCH_NEON)
+    struct Lanes
+    {
+        float64x2_t v;
+
+        using Mask                  = uint64x2_t;
+        static constexpr size_t Width = 2;
+        static Lanes            Load(const double *p) { return {vld1q_f64(p)}; }
+        static Lanes            Set(double x) { return {vdupq_n_f64(x)}; }
+        void                    Store(double *p) const { vst1q_f64(p, v); }
+    };
+    inline Lanes      operator+(Lanes a, Lanes b) { return {vaddq_f64(a.v, b.v)}; }
+    inline Lanes      operator-(Lanes a, Lanes b) { return {vsubq_f64(a.v, b.v)}; }
+    inline Lanes      operator*(Lanes a, Lanes b) { return {vmulq_f64(a.v, b.v)}; }
+    inline Lanes      operator/(Lanes a, Lanes b) { return {vdivq_f64(a.v, b.v)}; }
+    inline Lanes      operator-(Lanes a) { return {vnegq_f64(a.v)}; }
+    inline Lanes      Sqrt(Lanes a) { return {vsqrtq_f64(a.v)}; }
+    inline Lanes      Min(Lanes a, Lanes b) { return {vbslq_f64(vcltq_f64(a.v, b.v), a.v, b.v)}; } // not vminq, that one propagates NaN
+    inline Lanes      Max(Lanes a, Lanes b) { return {vbslq_f64(vcgtq_f64(a.v, b.v), a.v, b.v)}; }
+    inline Lanes      Abs(Lanes a) { return {vabsq_f64(a.v)}; }
+    inline uint64x2_t Less(Lanes a, Lanes b) { return vcltq_f64(a.v, b.v); }
+    inline uint64x2_t NotEqual(Lanes a, Lanes b) { return vreinterpretq_u64_u32(vmvnq_u32(vreinterpretq_u32_u64(vceqq_f64(a.v, b.v)))); }
+    inline uint64x2_t And(uint64x2_t a, uint64x2_t b) { return vandq_u64(a, b); }
+    inline Lanes      Select(uint64x2_t m, Lanes a, Lanes b) { return {vbslq_f64(m, a.v, b.v)}; }
+#define ORIENTATION_BATCH_SIMD
+#endif
+
+    // Kernel(V{}, i) converts the poses i .. i + V::Width - 1
+    template <typename F> void ForEachPose(size_t NumPoses, F &&Kernel)
+    {
+        size_t i = 0;
+#ifdef ORIENTATION_BATCH_SIMD
+        for (; i + Lanes::Width <= NumPoses; i += Lanes::Width)
+            Kernel(Lanes{}, i);
+#endif
+        for (; i < NumPoses; i++)
+            Kernel(Scalar{}, i);
+    }
+
+    // the library sin and cos of every angle, the scalar part of the forward conversions
+    struct CSinCos
+    {
+        CSinCos(const double *Angles, size_t NumPoses) : Sin(NumPoses), Cos(NumPoses)
+        {
+            for (size_t i = 0; i < NumPoses; i++)
+            {
+                Sin[i] = sin(Angles[i]);
+                Cos[i] = cos(Angles[i]);
+            }
+        }
+        std::vector<double> Sin, Cos;
+    };
+
+    struct CMatrixArrays
+    {
+        explicit CMatrixArrays(CPoseBatch &Batch)
+        {
+            for (int k = 0; k < 16; k++)
+                T[k] = Batch.GetT(k);
+        }
+        double *T[16];
+    };
+
+    // angles of the previous frame of every pose : pose i - NumSeries, or AnglesPrev for the first frame
+    template <typename F> void UnwrapScan(CPoseBatch &Batch, int NumChannels, const double *AnglesPrev, F &&UnwrapPose)
+    {
+        const size_t NumPoses  = Batch.GetNumPoses();
+        const size_t NumSeries = Batch.GetNumSeries();
+        double       Prev[CPoseBatch::MAX_CHANNELS], Angles[CPoseBatch::MAX_CHANNELS];
+        for (size_t i = 0; i < NumPoses; i++)
+        {
+            if (i < NumSeries)
+            {
+                if (!AnglesPrev)
+                    continue;
+                std::copy(AnglesPrev + i * NumChannels, AnglesPrev + (i + 1) * NumChannels, Prev);
+            }
+            else
+                Batch.GetAngles(i - NumSeries, Prev, NumChannels);
+            Batch.GetAngles(i, Angles, NumChannels);
+            UnwrapPose(Prev, Angles);
+            Batch.SetAngles(i, Angles, NumChannels);
+        }
+    }
+} // namespace
+
+//-------------------------------------------------------------------
+//              KERNELS
+//-------------------------------------------------------------------
+static void XYZ_FIX_BATCH(const double *A1, const double *A2, const double *A3, CPoseBatch &Batch)
+{
+    const size_t  N = Batch.GetNumPoses();
+    CSinCos       SC1(A1, N), SC2(A2, N), SC3(A3, N);
+    CMatrixArrays M(Batch);
+    ForEachPose(N,
+                [&](auto Tag, size_t i)
+                {
+                    using V = decltype(Tag);
+                    V s1 = V::Load(&SC1.Sin[i]), c1 = V::Load(&SC1.Cos[i]);
+                    V s2 = V::Load(&SC2.Sin[i]), c2 = V::Load(&SC2.Cos[i]);
+                    V s3 = V::Load(&SC3.Sin[i]), c3 = V::Load(&SC3.Cos[i]);
+                    (c3 * c2).Store(M.T[RC(0, 0)] + i);
+                    (c3 * s2 * s1 - s3 * c1).Store(M.T[RC(0, 1)] + i);
+                    (c3 * s2 * c1 + s3 * s1).Store(M.T[RC(0, 2)] + i);
+                    (s3 * c2).Store(M.T[RC(1, 0)] + i);
+                    (s3 * s2 * s1 + c3 * c1).Store(M.T[RC(1, 1)] + i);
+                    (s3 * s2 * c1 - c3 * s1).Store(M.T[RC(1, 2)] + i);
+                    (-s2).Store(M.T[RC(2, 0)] + i);
+                    (c2 * s1).Store(M.T[RC(2, 1)] + i);
+                    (c2 * c1).Store(M.T[RC(2, 2)] + i);
+                    V::Set(0.0).Store(M.T[RC(3, 0)] + i);
+                    V::Set(0.0).Store(M.T[RC(3, 1)] + i);
+                    V::Set(0.0).Store(M.T[RC(3, 2)] + i);
+                    V::Set(1.0).Store(M.T[RC(3, 3)] + i);
+                });
+}
+
+static void ZXY_EULER_BATCH(const double *A1, const double *A2, const double *A3, CPoseBatch &Batch)
+{
+    const size_t  N = Batch.GetNumPoses();
+    CSinCos       SC1(A1, N), SC2(A2, N), SC3(A3, N);
+    CMatrixArrays M(Batch);
+    ForEachPose(N,
+                [&](auto Tag, size_t i)
+                {
+                    using V = decltype(Tag);
+                    V s1 = V::Load(&SC1.Sin[i]), c1 = V::Load(&SC1.Cos[i]);
+                    V s2 = V::Load(&SC2.Sin[i]), c2 = V::Load(&SC2.Cos[i]);
+                    V s3 = V::Load(&SC3.Sin[i]), c3 = V::Load(&SC3.Cos[i]);
+                    (c3 * c1 - s3 * s2 * s1).Store(M.T[RC(0, 0)] + i);
+                    (-c2 * s1).Store(M.T[RC(0, 1)] + i);
+                    (s3 * c1 + c3 * s2 * s1).Store(M.T[RC(0, 2)] + i);
+                    (c3 * s1 + s3 * s2 * c1).Store(M.T[RC(1, 0)] + i);
+                    (c2 * c1).Store(M.T[RC(1, 1)] + i);
+                    (s3 * s1 - c3 * s2 * c1).Store(M.T[RC(1, 2)] + i);
+                    (-s3 * c2).Store(M.T[RC(2, 0)] + i);
+                    s2.Store(M.T[RC(2, 1)] + i);
+                    (c3 * c2).Store(M.T[RC(2, 2)] + i);
+                    V::Set(0.0).Store(M.T[RC(3, 0)] + i);
+                    V::Set(0.0).Store(M.T[RC(3, 1)] + i);
+                    V::Set(0.0).Store(M.T[RC(3, 2)] + i);
+                    V::Set(1.0).Store(M.T[RC(3, 3)] + i);
+                });
+}
+
+static void XYZ_FIX_REVERSE_BATCH(CPoseBatch &Batch, double *B1, double *B2, double *B3)
+{
+    const size_t        N = Batch.GetNumPoses();
+    CMatrixArrays       M(Batch);
+    std::vector<double> CPitch(N);
+    ForEachPose(N,
+                [&](auto Tag, size_t i)
+                {
+                    using V = decltype(Tag);
+                    V t00   = V::Load(M.T[RC(0, 0)] + i), t10 = V::Load(M.T[RC(1, 0)] + i);
+                    Sqrt(t00 * t00 + t10 * t10).Store(&CPitch[i]);
+                });
+
+    double Pose[16];
+    for (size_t i = 0; i < N; i++)
+    {
+        if (CPitch[i] > 1e-5)
+        {
+            B1[i] = atan2(M.T[RC(2, 1)][i], M.T[RC(2, 2)][i]);
+            B2[i] = atan2(-M.T[RC(2, 0)][i], CPitch[i]);
+            B3[i] = atan2(M.T[RC(1, 0)][i], M.T[RC(0, 0)][i]);
+        }
+        else
+        {
+            Batch.GetT4x4(i, Pose);
+            XYZ_FIX_REVERSE(Pose, B1[i], B2[i], B3[i]);
+        }
+    }
+}
+
+static void ZXY_EULER_REVERSE_BATCH(CPoseBatch &Batch, double *B1, double *B2, double *B3)
+{
+    const size_t        N = Batch.GetNumPoses();
+    CMatrixArrays       M(Batch);
+    std::vector<double> CX(N);
+    ForEachPose(N,
+                [&](auto Tag, size_t i)
+                {
+                    using V = decltype(Tag);
+                    V t01   = V::Load(M.T[RC(0, 1)] + i), t11 = V::Load(M.T[RC(1, 1)] + i);
+                    V C     = Min(V::Set(1.0), Sqrt(t01 * t01 + t11 * t11));
+                    Max(V::Set(-1.0), Min(V::Set(1.0), C)).Store(&CX[i]);
+                });
+
+    double Pose[16];
+    for (size_t i = 0; i < N; i++)
+    {
+        if (CX[i] > 1e-5)
+        {
+            B1[i] = atan2(-M.T[RC(0, 1)][i], M.T[RC(1, 1)][i]);
+            B2[i] = atan2(M.T[RC(2, 1)][i], CX[i]);
+            B3[i] = atan2(-M.T[RC(2, 0)][i], M.T[RC(2, 2)][i]);
+        }
+        else
+        {
+            Batch.GetT4x4(i, Pose);
+            ZXY_EULER_REVERSE(Pose, B1[i], B2[i], B3[i]);
+        }
+    }
+}
+
+static void SKREW_VECTOR_BATCH(const double *A1, const double *A2, const double *A3, CPoseBatch &Batch)
+{
+    const size_t        N = Batch.GetNumPoses();
+    CMatrixArrays       M(Batch);
+    std::vector<double> Eps(N);
+    ForEachPose(N,
+                [&](auto Tag, size_t i)
+                {
+                    using V = decltype(Tag);
+                    V a1 = V::Load(A1 + i), a2 = V::Load(A2 + i), a3 = V::Load(A3 + i);
+                    Sqrt(a1 * a1 + a2 * a2 + a3 * a3).Store(&Eps[i]);
+                });
+    CSinCos SC(Eps.data(), N);
+    ForEachPose(N,
+                [&](auto Tag, size_t i)
+                {
+                    using V = decltype(Tag);
+                    V E     = V::Load(&Eps[i]), SEps = V::Load(&SC.Sin[i]), CEps = V::Load(&SC.Cos[i]);
+                    V Ex = V::Load(A1 + i) / E, Ey = V::Load(A2 + i) / E, Ez = V::Load(A3 + i) / E;
+                    V OneMinusC = V::Set(1.0) - CEps;
+                    (Ex * Ex * OneMinusC + CEps).Store(M.T[RC(0, 0)] + i);
+                    (Ex * Ey * OneMinusC - Ez * SEps).Store(M.T[RC(0, 1)] + i);
+                    (Ex * Ez * OneMinusC + Ey * SEps).Store(M.T[RC(0, 2)] + i);
+                    (Ex * Ey * OneMinusC + Ez * SEps).Store(M.T[RC(1, 0)] + i);
+                    (Ey * Ey * OneMinusC + CEps).Store(M.T[RC(1, 1)] + i);
+                    (Ez * Ey * OneMinusC - Ex * SEps).Store(M.T[RC(1, 2)] + i);
+                    (Ex * Ez * OneMinusC - Ey * SEps).Store(M.T[RC(2, 0)] + i);
+                    (Ey * Ez * OneMinusC + Ex * SEps).Store(M.T[RC(2, 1)] + i);
+                    (Ez * Ez * OneMinusC + CEps).Store(M.T[RC(2, 2)] + i);
+                    V::Set(0.0).Store(M.T[RC(3, 0)] + i);
+                    V::Set(0.0).Store(M.T[RC(3, 1)] + i);
+                    V::Set(0.0).Store(M.T[RC(3, 2)] + i);
+                    V::Set(1.0).Store(M.T[RC(3, 3)] + i);
+                });
+
+    // no rotation is the identity, the lanes divided by zero
+    double Pose[16];
+    for (size_t i = 0; i < N; i++)
+    {
+        if (A1[i] == 0.0 && A2[i] == 0.0 && A3[i] == 0.0)
+        {
+            Batch.GetT4x4(i, Pose);
+            SKREW_VECTOR(A1[i], A2[i], A3[i], Pose);
+            Batch.SetT4x4(i, Pose);
+        }
+    }
+}
+
+static void SKREW_VECTOR_REVERSE_BATCH(CPoseBatch &Batch, double *B1, double *B2, double *B3)
+{
+    const size_t        N = Batch.GetNumPoses();
+    CMatrixArrays       M(Batch);
+    std::vector<double> Theta(N), SinTheta(N);
+    ForEachPose(N,
+                [&](auto Tag, size_t i)
+                {
+                    using V = decltype(Tag);
+                    V th    = V::Load(M.T[RC(0, 0)] + i) + V::Load(M.T[RC(1, 1)] + i) + V::Load(M.T[RC(2, 2)] + i);
+                    th      = th - V::Set(1.0);
+                    th      = th / V::Set(2.0);
+                    th      = Max(th, V::Set(-1.0));
+                    th      = Min(th, V::Set(1.0));
+                    th.Store(&Theta[i]);
+                });
+    for (size_t i = 0; i < N; i++)
+    {
+        Theta[i]    = acos(Theta[i]);
+        SinTheta[i] = Theta[i] != 0.0 ? sin(Theta[i]) : 0.0;
+    }
+    ForEachPose(N,
+                [&](auto Tag, size_t i)
+                {
+                    using V      = decltype(Tag);
+                    V Th         = V::Load(&Theta[i]);
+                    V STheta2    = V::Set(1.0) / (V::Set(2.0) * V::Load(&SinTheta[i]));
+                    auto Rotated = NotEqual(Th, V::Set(0.0));
+                    Select(Rotated, STheta2 * (V::Load(M.T[RC(2, 1)] + i) - V::Load(M.T[RC(1, 2)] + i)) * Th, V::Set(0.0)).Store(B1 + i);
+                    Select(Rotated, STheta2 * (V::Load(M.T[RC(0, 2)] + i) - V::Load(M.T[RC(2, 0)] + i)) * Th, V::Set(0.0)).Store(B2 + i);
+                    Select(Rotated, STheta2 * (V::Load(M.T[RC(1, 0)] + i) - V::Load(M.T[RC(0, 1)] + i)) * Th, V::Set(0.0)).Store(B3 + i);
+                });
+}
+
+//------------------------------------------------------------------------------------------------------------------
+// CPoseBatch
+//------------------------------------------------------------------------------------------------------------------
+void CPoseBatch::Resize(size_t NumPoses, size_t NumSeries)
+{
+    m_NumPoses  = NumPoses;
+    m_NumSeries = std::max<size_t>(NumSeries, 1);
+    for (auto &Values : m_T)
+        Values.resize(NumPoses);
+    for (auto &Values : m_Angles)
+        Values.resize(NumPoses);
+}
+
+void CPoseBatch::SetT4x4(size_t Pose, const double *T4x4)
+{
+    for (int k = 0; k < 16; k++)
+        m_T[k][Pose] = T4x4[k];
+}
+
+void CPoseBatch::GetT4x4(size_t Pose, double *T4x4) const
+{
+    for (int k = 0; k < 16; k++)
+        T4x4[k] = m_T[k][Pose];
+}
+
+void CPoseBatch::SetAngles(size_t Pose, const double *Angles, int NumAngles)
+{
+    for (int k = 0; k < NumAngles; k++)
+        m_Angles[k][Pose] = Angles[k];
+}
+
+void CPoseBatch::GetAngles(size_t Pose, double *Angles, int NumAngles) const
+{
+    for (int k = 0; k < NumAngles; k++)
+        Angles[k] = m_Angles[k][Pose];
+}
+
+//------------------------------------------------------------------------------------------------------------------
+// COrientation : one pose at a time through the virtual calls
+//------------------------------------------------------------------------------------------------------------------
+void COrientation::ToT4x4Batch(CPoseBatch &Batch)
+{
+    const int NumChannels = GetNumOrientChannels();
+    double    T4x4[16], Angles[CPoseBatch::MAX_CHANNELS];
+    for (size_t i = 0; i < Batch.GetNumPoses(); i++)
+    {
+        Batch.GetT4x4(i, T4x4); // keeps the elements ToT4x4 does not write
+        Batch.GetAngles(i, Angles, NumChannels);
+        ToT4x4(Angles, T4x4);
+        Batch.SetT4x4(i, T4x4);
+    }
+}
+
+void COrientation::From4x4Batch(CPoseBatch &Batch)
+{
+    const int NumChannels = GetNumOrientChannels();
+    double    T4x4[16], Angles[CPoseBatch::MAX_CHANNELS];
+    for (size_t i = 0; i < Batch.GetNumPoses(); i++)
+    {
+        Batch.GetT4x4(i, T4x4);
+        From4x4(T4x4, Angles);
+        Batch.SetAngles(i, Angles, NumChannels);
+    }
+}
+
+void COrientation::From4x4UnwrapBatch(CPoseBatch &Batch, const double *AnglesPrev)
+{
+    const int    NumChannels = GetNumOrientChannels();
+    const size_t NumSeries   = Batch.GetNumSeries();
+    double       T4x4[16], Prev[CPoseBatch::MAX_CHANNELS], Angles[CPoseBatch::MAX_CHANNELS];
+    for (size_t i = 0; i < Batch.GetNumPoses(); i++)
+    {
+        Batch.GetT4x4(i, T4x4);
+        if (i >= NumSeries)
+        {
+            Batch.GetAngles(i - NumSeries, Prev, NumChannels);
+            From4x4Unwrap(T4x4, Prev, Angles);
+        }
+        else if (AnglesPrev)
+        {
+            std::copy(AnglesPrev + i * NumChannels, AnglesPrev + (i + 1) * NumChannels, Prev);
+            From4x4Unwrap(T4x4, Prev, Angles);
+        }
+        else
+            From4x4(T4x4, Angles);
+        Batch.SetAngles(i, Angles, NumChannels);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------
+// COrientationRollPitchYaw
+//------------------------------------------------------------------------------------------------------------------
+void COrientationRollPitchYaw::ToT4x4Batch(CPoseBatch &Batch)
+{
+    XYZ_FIX_BATCH(Batch.GetAngles(0), Batch.GetAngles(1), Batch.GetAngles(2), Batch);
+}
+void COrientationRollPitchYaw::From4x4Batch(CPoseBatch &Batch)
+{
+    XYZ_FIX_REVERSE_BATCH(Batch, Batch.GetAngles(0), Batch.GetAngles(1), Batch.GetAngles(2));
+}
+void COrientationRollPitchYaw::From4x4UnwrapBatch(CPoseBatch &Batch, const double *AnglesPrev)
+{
+    From4x4Batch(Batch);
+    UnwrapScan(Batch, 3, AnglesPrev,
+               [](const double *Prev, double *Angles)
+               {
+                   NearestDegenerateAnglesCtrack(Angles[1] + PI / 2.0, Prev[0], Prev[2], Angles[0], Angles[2]);
+                   Unwrap(Prev[0], Angles[0]);
+                   Unwrap(Prev[1], Angles[1]);
+                   Unwrap(Prev[2], Angles[2]);
+               });
+}
+
+//------------------------------------------------------------------------------------------------------------------
+// COrientationSteerCamberSpin
+//------------------------------------------------------------------------------------------------------------------
+void COrientationSteerCamberSpin::ToT4x4Batch(CPoseBatch &Batch)
+{
+    ZXY_EULER_BATCH(Batch.GetAngles(0), Batch.GetAngles(1), Batch.GetAngles(2), Batch);
+}
+void COrientationSteerCamberSpin::From4x4Batch(CPoseBatch &Batch)
+{
+    ZXY_EULER_REVERSE_BATCH(Batch, Batch.GetAngles(0), Batch.GetAngles(1), Batch.GetAngles(2));
+}
+void COrientationSteerCamberSpin::From4x4UnwrapBatch(CPoseBatch &Batch, const double *AnglesPrev)
+{
+    From4x4Batch(Batch);
+    UnwrapScan(Batch, 3, AnglesPrev,
+               [](const double *Prev, double *Angles)
+               {
+                   NearestDegenerateAnglesCtrack(Angles[1] + PI / 2.0, Prev[0], Prev[2], Angles[0], Angles[2]);
+                   Unwrap(Prev[0], Angles[0]);
+                   Unwrap(Prev[1], Angles[1]);
+                   Unwrap(Prev[2], Angles[2]);
+               });
+}
+
+//------------------------------------------------------------------------------------------------------------------
+// COrientationSkrew
+//------------------------------------------------------------------------------------------------------------------
+void COrientationSkrew::ToT4x4Batch(CPoseBatch &Batch)
+{
+    SKREW_VECTOR_BATCH(Batch.GetAngles(0), Batch.GetAngles(1), Batch.GetAngles(2), Batch);
+}
+void COrientationSkrew::From4x4Batch(CPoseBatch &Batch)
+{
+    SKREW_VECTOR_REVERSE_BATCH(Batch, Batch.GetAngles(0), Batch.GetAngles(1), Batch.GetAngles(2));
+}
+void COrientationSkrew::From4x4UnwrapBatch(CPoseBatch &Batch, const double *AnglesPrev)
+{
+    From4x4Batch(Batch);
+    UnwrapScan(Batch, 3, AnglesPrev, [](const double *Prev, double *Angles) { SKREW_VECTOR_UNWRAP(Prev[0], Prev[1], Prev[2], Angles[0], Angles[1], Angles[2]); });
+}
+
+//------------------------------------------------------------------------------------------------------------------
+// COrientationKukaABC : Roll-Pitch-Yaw in reverse order
+//------------------------------------------------------------------------------------------------------------------
+void COrientationKukaABC::ToT4x4Batch(CPoseBatch &Batch)
+{
+    XYZ_FIX_BATCH(Batch.GetAngles(2), Batch.GetAngles(1), Batch.GetAngles(0), Batch);
+}
+void COrientationKukaABC::From4x4Batch(CPoseBatch &Batch)
+{
+    XYZ_FIX_REVERSE_BATCH(Batch, Batch.GetAngles(2), Batch.GetAngles(1), Batch.GetAngles(0));
+}
+void COrientationKukaABC::From4x4UnwrapBatch(CPoseBatch &Batch, const double *AnglesPrev)
+{
+    From4x4Batch(Batch);
+    UnwrapScan(Batch, 3, AnglesPrev,
+               [](const double *Prev, double *Angles)
+               {
+                   Unwrap(Prev[0], Angles[0]);
+                   Unwrap(Prev[1], Angles[1]);
+                   Unwrap(Prev[2], Angles[2]);
+               });
+}
+
+//------------------------------------------------------------------------------------------------------------------
+// COrientationQuaternion
+//------------------------------------------------------------------------------------------------------------------
+void COrientationQuaternion::ToT4x4Batch(CPoseBatch &Batch)
+{
+    CMatrixArrays M(Batch);
+    const double *Q0 = Batch.GetAngles(0), *Q1 = Batch.GetAngles(1), *Q2 = Batch.GetAngles(2), *Q3 = Batch.GetAngles(3);
+    ForEachPose(Batch.GetNumPoses(),
+                [&](auto Tag, size_t i)
+                {
+                    using V = decltype(Tag);
+                    V q0 = V::Load(Q0 + i), q1 = V::Load(Q1 + i), q2 = V::Load(Q2 + i), q3 = V::Load(Q3 + i);
+                    V XX = q1 * q1, YY = q2 * q2, ZZ = q3 * q3;
+                    V XY = q1 * q2, XZ = q1 * q3, YZ = q2 * q3;
+                    V XW = q1 * q0, YW = q2 * q0, ZW = q3 * q0;
+                    V One = V::Set(1.0), Two = V::Set(2.0), Zero = V::Set(0.0);
+                    (One - (Two * YY + Two * ZZ)).Store(M.T[RC(0, 0)] + i);
+                    (Two * XY - Two * ZW).Store(M.T[RC(0, 1)] + i);
+                    (Two * XZ + Two * YW).Store(M.T[RC(0, 2)] + i);
+                    (Two * XY + Two * ZW).Store(M.T[RC(1, 0)] + i);
+                    (One - (Two * XX + Two * ZZ)).Store(M.T[RC(1, 1)] + i);
+                    (Two * YZ - Two * XW).Store(M.T[RC(1, 2)] + i);
+                    (Two * XZ - Two * YW).Store(M.T[RC(2, 0)] + i);
+                    (Two * YZ + Two * XW).Store(M.T[RC(2, 1)] + i);
+                    (One - (Two * XX + Two * YY)).Store(M.T[RC(2, 2)] + i);
+                    Zero.Store(M.T[RC(0, 3)] + i);
+                    Zero.Store(M.T[RC(1, 3)] + i);
+                    Zero.Store(M.T[RC(2, 3)] + i);
+                    Zero.Store(M.T[RC(3, 0)] + i);
+                    Zero.Store(M.T[RC(3, 1)] + i);
+                    Zero.Store(M.T[RC(3, 2)] + i);
+                    One.Store(M.T[RC(3, 3)] + i);
+                });
+}
+
+void COrientationQuaternion::From4x4Batch(CPoseBatch &Batch)
+{
+    CMatrixArrays M(Batch);
+    double       *Q0 = Batch.GetAngles(0), *Q1 = Batch.GetAngles(1), *Q2 = Batch.GetAngles(2), *Q3 = Batch.GetAngles(3);
+    ForEachPose(Batch.GetNumPoses(),
+                [&](auto Tag, size_t i)
+                {
+                    using V = decltype(Tag);
+                    V T00 = V::Load(M.T[RC(0, 0)] + i), T01 = V::Load(M.T[RC(0, 1)] + i), T02 = V::Load(M.T[RC(0, 2)] + i);
+                    V T10 = V::Load(M.T[RC(1, 0)] + i), T11 = V::Load(M.T[RC(1, 1)] + i), T12 = V::Load(M.T[RC(1, 2)] + i);
+                    V T20 = V::Load(M.T[RC(2, 0)] + i), T21 = V::Load(M.T[RC(2, 1)] + i), T22 = V::Load(M.T[RC(2, 2)] + i);
+                    V One = V::Set(1.0), Two = V::Set(2.0), Quarter = V::Set(0.25);
+
+                    // the four branches of From4x4, the lanes keep the first one that applies
+                    V    tr     = T00 + T11 + T22;
+                    auto Trace  = Less(V::Set(0.0), tr);
+                    auto XLarge = And(Less(T11, T00), Less(T22, T00));
+                    auto YLarge = Less(T22, T11);
+
+                    auto Pick = [&](V a0, V a1, V a2, V a3) { return Select(Trace, a0, Select(XLarge, a1, Select(YLarge, a2, a3))); };
+
+                    // one sqrt and one division per channel like the scalar code, the operands are picked first
+                    V S     = Sqrt(Pick(tr + One, One + T00 - T11 - T22, One + T11 - T00 - T22, One + T22 - T00 - T11)) * Two;
+                    V Diag  = Quarter * S;
+                    V Q0Div = Pick(One, T21 - T12, T02 - T20, T10 - T01) / S;
+                    V Q1Div = Pick(T21 - T12, One, T01 + T10, T02 + T20) / S;
+                    V Q2Div = Pick(T02 - T20, T01 + T10, One, T12 + T21) / S;
+                    V Q3Div = Pick(T10 - T01, T02 + T20, T12 + T21, One) / S;
+                    Pick(Diag, Q0Div, Q0Div, Q0Div).Store(Q0 + i);
+                    Pick(Q1Div, Diag, Q1Div, Q1Div).Store(Q1 + i);
+                    Pick(Q2Div, Q2Div, Diag, Q2Div).Store(Q2 + i);
+                    Pick(Q3Div, Q3Div, Q3Div, Diag).Store(Q3 + i);
+                });
+}
+
+void COrientationQuaternion::From4x4UnwrapBatch(CPoseBatch &Batch, const double * /*AnglesPrev*/)
+{
+    From4x4Batch(Batch); // a quaternion is not unwrapped
+}
+
+//------------------------------------------------------------------------------------------------------------------
+// COrientationZVector
+//------------------------------------------------------------------------------------------------------------------
+void COrientationZVector::ToT4x4Batch(CPoseBatch &Batch)
+{
+    CMatrixArrays M(Batch);
+    const double *A0 = Batch.GetAngles(0), *A1 = Batch.GetAngles(1), *A2 = Batch.GetAngles(2);
+    ForEachPose(Batch.GetNumPoses(),
+                [&](auto Tag, size_t i)
+                {
+                    using V         = decltype(Tag);
+                    V    Zero       = V::Set(0.0), One = V::Set(1.0);
+                    auto Normalize3 = [](V &X, V &Y, V &Z)
+                    {
+                        V    Norm = Sqrt(X * X + Y * Y + Z * Z);
+                        auto Big  = Less(V::Set(0.0000001), Norm);
+                        X         = Select(Big, X / Norm, X);
+                        Y         = Select(Big, Y / Norm, Y);
+                        Z         = Select(Big, Z / Norm, Z);
+                    };
+
+                    V z0 = V::Load(A0 + i), z1 = V::Load(A1 + i), z2 = V::Load(A2 + i);
+                    Normalize3(z0, z1, z2);
+
+                    // X-axis unless Vz is close to it, then the Y-axis
+                    auto UseX = And(Less(Abs(z0), V::Set(0.9)), Less(Abs(z1), V::Set(0.9)));
+                    V    t0 = Select(UseX, One, Zero), t1 = Select(UseX, Zero, One), t2 = Zero;
+
+                    V y0 = t1 * z2 - t2 * z1, y1 = t2 * z0 - t0 * z2, y2 = t0 * z1 - t1 * z0;
+                    Normalize3(y0, y1, y2);
+                    V x0 = y1 * z2 - y2 * z1, x1 = y2 * z0 - y0 * z2, x2 = y0 * z1 - y1 * z0;
+                    Normalize3(x0, x1, x2);
+
+                    // right-handed, the Determinant of the scalar version
+                    V    Det  = x0 * y1 * z2 + y0 * z1 * x2 + z0 * x1 * y2 - z0 * y1 * x2 - y0 * x1 * z2 - x0 * z1 * y2;
+                    auto Flip = Less(Det, Zero);
+                    Select(Flip, -x0, x0).Store(M.T[RC(0, 0)] + i);
+                    Select(Flip, -x1, x1).Store(M.T[RC(1, 0)] + i);
+                    Select(Flip, -x2, x2).Store(M.T[RC(2, 0)] + i);
+                    y0.Store(M.T[RC(0, 1)] + i);
+                    y1.Store(M.T[RC(1, 1)] + i);
+                    y2.Store(M.T[RC(2, 1)] + i);
+                    z0.Store(M.T[RC(0, 2)] + i);
+                    z1.Store(M.T[RC(1, 2)] + i);
+                    z2.Store(M.T[RC(2, 2)] + i);
+                    Zero.Store(M.T[RC(0, 3)] + i);
+                    Zero.Store(M.T[RC(1, 3)] + i);
+                    Zero.Store(M.T[RC(2, 3)] + i);
+                    Zero.Store(M.T[RC(3, 0)] + i);
+                    Zero.Store(M.T[RC(3, 1)] + i);
+                    Zero.Store(M.T[RC(3, 2)] + i);
+                    One.Store(M.T[RC(3, 3)] + i);
+                });
+}
+
+void COrientationZVector::From4x4Batch(CPoseBatch &Batch)
+{
+    const size_t N = Batch.GetNumPoses();
+    std::copy(Batch.GetT(RC(0, 2)), Batch.GetT(RC(0, 2)) + N, Batch.GetAngles(0));
+    std::copy(Batch.GetT(RC(1, 2)), Batch.GetT(RC(1, 2)) + N, Batch.GetAngles(1));
+    std::copy(Batch.GetT(RC(2, 2)), Batch.GetT(RC(2, 2)) + N, Batch.GetAngles(2));
+}
+
+void COrientationZVector::From4x4UnwrapBatch(CPoseBatch &Batch, const double * /*AnglesPrev*/)
+{
+    From4x4Batch(Batch);
+}
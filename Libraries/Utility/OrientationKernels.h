@@ -0,0 +1,548 @@
+#pragma once
+
+#include "Orientations.h"
+
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <variant>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+OrientationKernels : the orientation conversions with the convention as a template parameter
+
+COrientationManager hands out a COrientation * per convention index, so every pose costs a map lookup and a
+virtual call, and the compiler cannot inline the conversion into the loop over the poses. Here every convention
+is a Kernel<ORIENTATION_...> with static functions on fixed size arrays, resolved once per stream into an
+AnyKernel variant :
+
+    COrientationStream Stream(ORIENTATION_QUATERNION);             // or the name, "Quaternion"
+    Stream.From4x4(Matrices, Angles);                               // one std::visit, then an inlined loop
+
+The math is defined once, in the functions of this header. The free functions of Orientations.h (XYZ_FIX, ...)
+and the COrientation classes call them, so both paths give the same values bit for bit.
+
+M is a Matrix4x4 or a double * to 16 values with RC(r, c) indexing, A an std::array or a double * to the channels.
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+namespace OrientationKernels
+{
+    using Matrix4x4 = std::array<double, 16>;
+
+    //------------------------------------------------------------------------------------------------------------------
+    // conversions
+    //------------------------------------------------------------------------------------------------------------------
+    inline void Unwrap(const double &PrevAngle, double &Angle, double Period = 2.0 * PI)
+    {
+        Angle += floor((PrevAngle - Angle) / Period + 0.5) * Period;
+    }
+
+    inline void NearestDegenerateAnglesCtrack(double a2, double a1prev, double a3prev, double &a1, double &a3)
+    {
+        double Tol = 1e-3;
+        if (fmod(fabs(a2), PI) < Tol)
+        {
+            int    Ca2   = (int)cos(a2);
+            double Uprev = a1prev - Ca2 * a3prev;
+            double U     = a1 - Ca2 * a3;
+            Unwrap(Uprev, U);
+            double Udiff = (Uprev - U) / 2.0;
+            a1 += Udiff;
+            a3 -= Ca2 * Udiff;
+        }
+    }
+
+    template <typename M> inline void XYZ_FIX(double a1, double a2, double a3, M &&T)
+    {
+        T[RC(0, 0)] = cos(a3) * cos(a2);
+        T[RC(0, 1)] = cos(a3) * sin(a2) * sin(a1) - sin(a3) * cos(a1);
+        T[RC(0, 2)] = cos(a3) * sin(a2) * cos(a1) + sin(a3) * sin(a1);
+        T[RC(1, 0)] = sin(a3) * cos(a2);
+        T[RC(1, 1)] = sin(a3) * sin(a2) * sin(a1) + cos(a3) * cos(a1);
+        T[RC(1, 2)] = sin(a3) * sin(a2) * cos(a1) - cos(a3) * sin(a1);
+        T[RC(2, 0)] = -sin(a2);
+        T[RC(2, 1)] = cos(a2) * sin(a1);
+        T[RC(2, 2)] = cos(a2) * cos(a1);
+        T[RC(3, 0)] = T[RC(3, 1)] = T[RC(3, 2)] = 0.0;
+        T[RC(3, 3)]                             = 1.0;
+    }
+
+    template <typename M> inline void XYZ_FIX_REVERSE(const M &T, double &a1, double &a2, double &a3)
+    {
+        double CPitch = sqrt(T[RC(0, 0)] * T[RC(0, 0)] + T[RC(1, 0)] * T[RC(1, 0)]);
+        if (CPitch > 1e-5)
+        {
+            a1 = atan2(T[RC(2, 1)], T[RC(2, 2)]);
+            a2 = atan2(-T[RC(2, 0)], CPitch);
+            a3 = atan2(T[RC(1, 0)], T[RC(0, 0)]);
+        }
+        else
+        {
+            a1            = 0.0;
+            double SPitch = -T[RC(2, 0)];
+            SPitch        = 1.0 < SPitch ? 1.0 : SPitch;
+            SPitch        = SPitch > -1.0 ? SPitch : -1.0;
+            a2            = asin(SPitch);
+            a3            = atan2(T[RC(0, 1)] / T[RC(2, 0)], T[RC(1, 1)]);
+        }
+    }
+
+    template <typename M> inline void ZXY_EULER(double a1, double a2, double a3, M &&T)
+    {
+        T[RC(0, 0)] = cos(a3) * cos(a1) - sin(a3) * sin(a2) * sin(a1);
+        T[RC(0, 1)] = -cos(a2) * sin(a1);
+        T[RC(0, 2)] = sin(a3) * cos(a1) + cos(a3) * sin(a2) * sin(a1);
+        T[RC(1, 0)] = cos(a3) * sin(a1) + sin(a3) * sin(a2) * cos(a1);
+        T[RC(1, 1)] = cos(a2) * cos(a1);
+        T[RC(1, 2)] = sin(a3) * sin(a1) - cos(a3) * sin(a2) * cos(a1);
+        T[RC(2, 0)] = -sin(a3) * cos(a2);
+        T[RC(2, 1)] = sin(a2);
+        T[RC(2, 2)] = cos(a3) * cos(a2);
+        T[RC(3, 0)] = T[RC(3, 1)] = T[RC(3, 2)] = 0.0;
+        T[RC(3, 3)]                             = 1.0;
+    }
+
+    template <typename M> inline void ZXY_EULER_REVERSE(const M &T, double &a1, double &a2, double &a3)
+    {
+        double CX = sqrt(T[RC(0, 1)] * T[RC(0, 1)] + T[RC(1, 1)] * T[RC(1, 1)]);
+        CX        = 1.0 < CX ? 1.0 : CX;
+        CX        = -1 > CX ? -1 : CX;
+        if (CX > 1e-5)
+        {
+            a1 = atan2(-T[RC(0, 1)], T[RC(1, 1)]);
+            a2 = atan2(T[RC(2, 1)], CX);
+            a3 = atan2(-T[RC(2, 0)], T[RC(2, 2)]);
+        }
+        else
+        {
+            a1        = 0.0;
+            double SX = T[RC(2, 1)];
+            SX        = -1.0 > SX ? -1.0 : SX;
+            SX        = 1.0 < SX ? 1.0 : SX;
+            a2        = asin(SX);
+            a3        = atan2(T[RC(1, 0)], T[RC(0, 0)]);
+        }
+    }
+
+    template <typename M> inline void SKREW_VECTOR(double a1, double a2, double a3, M &&T)
+    {
+        if (a1 == 0.0 && a2 == 0.0 && a3 == 0.0)
+        {
+            for (int r = 0; r < 3; r++)
+                for (int c = 0; c < 3; c++)
+                    T[RC(r, c)] = (r == c ? 1.0 : 0.0);
+            T[RC(3, 0)] = T[RC(3, 1)] = T[RC(3, 2)] = 0.0;
+            T[RC(3, 3)]                             = 1.0;
+            return;
+        }
+        double Eps  = sqrt(a1 * a1 + a2 * a2 + a3 * a3);
+        double SEps = sin(Eps);
+        double CEps = cos(Eps);
+        double Ex   = a1 / Eps;
+        double Ey   = a2 / Eps;
+        double Ez   = a3 / Eps;
+        T[RC(0, 0)] = Ex * Ex * (1.0 - CEps) + CEps;
+        T[RC(0, 1)] = Ex * Ey * (1.0 - CEps) - Ez * SEps;
+        T[RC(0, 2)] = Ex * Ez * (1.0 - CEps) + Ey * SEps;
+        T[RC(1, 0)] = Ex * Ey * (1.0 - CEps) + Ez * SEps;
+        T[RC(1, 1)] = Ey * Ey * (1.0 - CEps) + CEps;
+        T[RC(1, 2)] = Ez * Ey * (1.0 - CEps) - Ex * SEps;
+        T[RC(2, 0)] = Ex * Ez * (1.0 - CEps) - Ey * SEps;
+        T[RC(2, 1)] = Ey * Ez * (1.0 - CEps) + Ex * SEps;
+        T[RC(2, 2)] = Ez * Ez * (1.0 - CEps) + CEps;
+        T[RC(3, 0)] = T[RC(3, 1)] = T[RC(3, 2)] = 0.0;
+        T[RC(3, 3)]                             = 1.0;
+    }
+
+    template <typename M> inline void SKREW_VECTOR_REVERSE(const M &T, double &a1, double &a2, double &a3)
+    {
+        double th = T[RC(0, 0)] + T[RC(1, 1)] + T[RC(2, 2)];
+        th        = th - 1;
+        th        = th / 2;
+        th        = th > -1 ? th : -1;
+        th        = th < +1 ? th : +1;
+        double Theta = acos(th);
+        if (Theta != 0.0)
+        {
+            double STheta2 = 1.0 / (2 * sin(Theta));
+            a1             = STheta2 * (T[RC(2, 1)] - T[RC(1, 2)]) * Theta;
+            a2             = STheta2 * (T[RC(0, 2)] - T[RC(2, 0)]) * Theta;
+            a3             = STheta2 * (T[RC(1, 0)] - T[RC(0, 1)]) * Theta;
+        }
+        else
+        {
+            a1 = a2 = a3 = 0.0;
+        }
+    }
+
+    inline void SKREW_VECTOR_UNWRAP(const double &a1_prev, const double &a2_prev, const double &a3_prev, double &a1, double &a2, double &a3)
+    {
+        if ((a1 == 0.0) && (a2 == 0.0) && (a3 == 0.0))
+            return;
+        double Delta1(a1_prev - a1), Delta2(a2_prev - a2), Delta3(a3_prev - a3);
+        double a_norm = sqrt(a1 * a1 + a2 * a2 + a3 * a3);
+        double uk1(a1 / a_norm), uk2(a2 / a_norm), uk3(a3 / a_norm);
+        int    N = (int)floor((Delta1 * uk1 + Delta2 * uk2 + Delta3 * uk3) / (2 * PI) + 0.5);
+        a1 += 2 * PI * N * uk1;
+        a2 += 2 * PI * N * uk2;
+        a3 += 2 * PI * N * uk3;
+    }
+
+    // Angles : qw, qx, qy, qz
+    template <typename A, typename M> inline void QUATERNION(const A &Angles, M &&T)
+    {
+        double XX = Angles[1] * Angles[1];
+        double YY = Angles[2] * Angles[2];
+        double ZZ = Angles[3] * Angles[3];
+        double XY = Angles[1] * Angles[2];
+        double XZ = Angles[1] * Angles[3];
+        double YZ = Angles[2] * Angles[3];
+        double XW = Angles[1] * Angles[0];
+        double YW = Angles[2] * Angles[0];
+        double ZW = Angles[3] * Angles[0];
+
+        T[RC(0, 0)] = 1 - (2 * YY + 2 * ZZ);
+        T[RC(0, 1)] = 2 * XY - 2 * ZW;
+        T[RC(0, 2)] = 2 * XZ + 2 * YW;
+        T[RC(1, 0)] = 2 * XY + 2 * ZW;
+        T[RC(1, 1)] = 1 - (2 * XX + 2 * ZZ);
+        T[RC(1, 2)] = 2 * YZ - 2 * XW;
+        T[RC(2, 0)] = 2 * XZ - 2 * YW;
+        T[RC(2, 1)] = 2 * YZ + 2 * XW;
+        T[RC(2, 2)] = 1 - (2 * XX + 2 * YY);
+        T[RC(0, 3)] = 0.0;
+        T[RC(1, 3)] = 0.0;
+        T[RC(2, 3)] = 0.0;
+        T[RC(3, 0)] = 0.0;
+        T[RC(3, 1)] = 0.0;
+        T[RC(3, 2)] = 0.0;
+        T[RC(3, 3)] = 1.0;
+    }
+
+    template <typename M, typename A> inline void QUATERNION_REVERSE(const M &T, A &&Angles)
+    {
+        double tr = T[RC(0, 0)] + T[RC(1, 1)] + T[RC(2, 2)];
+        if (tr > 0)
+        {
+            double S  = sqrt(tr + 1.0) * 2;
+            Angles[0] = 0.25 * S;
+            Angles[1] = (T[RC(2, 1)] - T[RC(1, 2)]) / S;
+            Angles[2] = (T[RC(0, 2)] - T[RC(2, 0)]) / S;
+            Angles[3] = (T[RC(1, 0)] - T[RC(0, 1)]) / S;
+        }
+        else if ((T[RC(0, 0)] > T[RC(1, 1)]) & (T[RC(0, 0)] > T[RC(2, 2)]))
+        {
+            double S  = sqrt(1.0 + T[RC(0, 0)] - T[RC(1, 1)] - T[RC(2, 2)]) * 2;
+            Angles[0] = (T[RC(2, 1)] - T[RC(1, 2)]) / S;
+            Angles[1] = 0.25 * S;
+            Angles[2] = (T[RC(0, 1)] + T[RC(1, 0)]) / S;
+            Angles[3] = (T[RC(0, 2)] + T[RC(2, 0)]) / S;
+        }
+        else if (T[RC(1, 1)] > T[RC(2, 2)])
+        {
+            double S  = sqrt(1.0 + T[RC(1, 1)] - T[RC(0, 0)] - T[RC(2, 2)]) * 2;
+            Angles[0] = (T[RC(0, 2)] - T[RC(2, 0)]) / S;
+            Angles[1] = (T[RC(0, 1)] + T[RC(1, 0)]) / S;
+            Angles[2] = 0.25 * S;
+            Angles[3] = (T[RC(1, 2)] + T[RC(2, 1)]) / S;
+        }
+        else
+        {
+            double S  = sqrt(1.0 + T[RC(2, 2)] - T[RC(0, 0)] - T[RC(1, 1)]) * 2;
+            Angles[0] = (T[RC(1, 0)] - T[RC(0, 1)]) / S;
+            Angles[1] = (T[RC(0, 2)] + T[RC(2, 0)]) / S;
+            Angles[2] = (T[RC(1, 2)] + T[RC(2, 1)]) / S;
+            Angles[3] = 0.25 * S;
+        }
+    }
+
+    template <typename V> inline void Normalize(V &&Vector)
+    {
+        double Norm = sqrt(Vector[0] * Vector[0] + Vector[1] * Vector[1] + Vector[2] * Vector[2]);
+        if (Norm > 0.0000001)
+        {
+            for (int i = 0; i < 3; i++)
+                Vector[i] = Vector[i] / Norm;
+        }
+    }
+
+    template <typename M> inline double Determinant(const M &R)
+    {
+        return R[RC(0, 0)] * R[RC(1, 1)] * R[RC(2, 2)] + R[RC(0, 1)] * R[RC(1, 2)] * R[RC(2, 0)] + R[RC(0, 2)] * R[RC(1, 0)] * R[RC(2, 1)] -
+               R[RC(0, 2)] * R[RC(1, 1)] * R[RC(2, 0)] - R[RC(0, 1)] * R[RC(1, 0)] * R[RC(2, 2)] - R[RC(0, 0)] * R[RC(1, 2)] * R[RC(2, 1)];
+    }
+
+    template <typename V1, typename V2, typename V3> inline void CrossProduct(const V1 &A, const V2 &B, V3 &&Result)
+    {
+        Result[0] = (A[1] * B[2] - A[2] * B[1]);
+        Result[1] = (A[2] * B[0] - A[0] * B[2]);
+        Result[2] = (A[0] * B[1] - A[1] * B[0]);
+    }
+
+    // the z-axis of the T4x4, the x-axis is the one closest to world X or Y
+    template <typename A, typename M> inline void Z_VECTOR(const A &Angles, M &&T)
+    {
+        std::array<double, 3> Vz = {Angles[0], Angles[1], Angles[2]};
+        Normalize(Vz);
+
+        std::array<double, 3> Vx, Vy, TempAxis;
+        if (fabs(Vz[0]) < 0.9 && fabs(Vz[1]) < 0.9)
+            TempAxis = {1.0, 0.0, 0.0};
+        else
+            TempAxis = {0.0, 1.0, 0.0};
+
+        CrossProduct(TempAxis, Vz, Vy);
+        Normalize(Vy);
+        CrossProduct(Vy, Vz, Vx);
+        Normalize(Vx);
+
+        for (int i = 0; i < 3; i++)
+        {
+            T[RC(i, 0)] = Vx[i];
+            T[RC(i, 1)] = Vy[i];
+            T[RC(i, 2)] = Vz[i];
+            T[RC(i, 3)] = 0.0;
+        }
+        T[RC(3, 0)] = 0.0;
+        T[RC(3, 1)] = 0.0;
+        T[RC(3, 2)] = 0.0;
+        T[RC(3, 3)] = 1.0;
+
+        if (Determinant(T) < 0) // right-handed
+        {
+            for (int i = 0; i < 3; i++)
+                T[RC(i, 0)] = -T[RC(i, 0)];
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------------------
+    // Kernel<Convention> : the conversions of one COrientation, Prev is the same pose in the previous frame
+    //------------------------------------------------------------------------------------------------------------------
+    template <int Convention> struct Kernel;
+
+    template <> struct Kernel<ORIENTATION_ROLLPITCHYAW>
+    {
+        static constexpr int NumChannels = 3;
+        using Angles                     = std::array<double, NumChannels>;
+
+        template <typename A, typename M> static void ToT4x4(const A &Angles, M &&T) { XYZ_FIX(Angles[0], Angles[1], Angles[2], T); }
+        template <typename M, typename A> static void From4x4(const M &T, A &&Angles) { XYZ_FIX_REVERSE(T, Angles[0], Angles[1], Angles[2]); }
+        template <typename M, typename P, typename A> static void From4x4Unwrap(const M &T, const P &Prev, A &&Angles)
+        {
+            XYZ_FIX_REVERSE(T, Angles[0], Angles[1], Angles[2]);
+            NearestDegenerateAnglesCtrack(Angles[1] + PI / 2.0, Prev[0], Prev[2], Angles[0], Angles[2]);
+            Unwrap(Prev[0], Angles[0]);
+            Unwrap(Prev[1], Angles[1]);
+            Unwrap(Prev[2], Angles[2]);
+        }
+    };
+
+    template <> struct Kernel<ORIENTATION_STEERCAMBERSPIN>
+    {
+        static constexpr int NumChannels = 3;
+        using Angles                     = std::array<double, NumChannels>;
+
+        template <typename A, typename M> static void ToT4x4(const A &Angles, M &&T) { ZXY_EULER(Angles[0], Angles[1], Angles[2], T); }
+        template <typename M, typename A> static void From4x4(const M &T, A &&Angles) { ZXY_EULER_REVERSE(T, Angles[0], Angles[1], Angles[2]); }
+        template <typename M, typename P, typename A> static void From4x4Unwrap(const M &T, const P &Prev, A &&Angles)
+        {
+            ZXY_EULER_REVERSE(T, Angles[0], Angles[1], Angles[2]);
+            NearestDegenerateAnglesCtrack(Angles[1] + PI / 2.0, Prev[0], Prev[2], Angles[0], Angles[2]);
+            Unwrap(Prev[0], Angles[0]);
+            Unwrap(Prev[1], Angles[1]);
+            Unwrap(Prev[2], Angles[2]);
+        }
+    };
+
+    template <> struct Kernel<ORIENTATION_SKREW>
+    {
+        static constexpr int NumChannels = 3;
+        using Angles                     = std::array<double, NumChannels>;
+
+        template <typename A, typename M> static void ToT4x4(const A &Angles, M &&T) { SKREW_VECTOR(Angles[0], Angles[1], Angles[2], T); }
+        template <typename M, typename A> static void From4x4(const M &T, A &&Angles) { SKREW_VECTOR_REVERSE(T, Angles[0], Angles[1], Angles[2]); }
+        template <typename M, typename P, typename A> static void From4x4Unwrap(const M &T, const P &Prev, A &&Angles)
+        {
+            SKREW_VECTOR_REVERSE(T, Angles[0], Angles[1], Angles[2]);
+            SKREW_VECTOR_UNWRAP(Prev[0], Prev[1], Prev[2], Angles[0], Angles[1], Angles[2]);
+        }
+    };
+
+    // Roll-Pitch-Yaw in reverse order
+    template <> struct Kernel<ORIENTATION_KUKAABC>
+    {
+        static constexpr int NumChannels = 3;
+        using Angles                     = std::array<double, NumChannels>;
+
+        template <typename A, typename M> static void ToT4x4(const A &Angles, M &&T) { XYZ_FIX(Angles[2], Angles[1], Angles[0], T); }
+        template <typename M, typename A> static void From4x4(const M &T, A &&Angles) { XYZ_FIX_REVERSE(T, Angles[2], Angles[1], Angles[0]); }
+        template <typename M, typename P, typename A> static void From4x4Unwrap(const M &T, const P &Prev, A &&Angles)
+        {
+            XYZ_FIX_REVERSE(T, Angles[2], Angles[1], Angles[0]);
+            Unwrap(Prev[0], Angles[0]);
+            Unwrap(Prev[1], Angles[1]);
+            Unwrap(Prev[2], Angles[2]);
+        }
+    };
+
+    template <> struct Kernel<ORIENTATION_QUATERNION>
+    {
+        static constexpr int NumChannels = 4;
+        using Angles                     = std::array<double, NumChannels>;
+
+        template <typename A, typename M> static void ToT4x4(const A &Angles, M &&T) { QUATERNION(Angles, T); }
+        template <typename M, typename A> static void From4x4(const M &T, A &&Angles) { QUATERNION_REVERSE(T, Angles); }
+        template <typename M, typename P, typename A> static void From4x4Unwrap(const M &T, const P &, A &&Angles) { QUATERNION_REVERSE(T, Angles); }
+    };
+
+    template <> struct Kernel<ORIENTATION_ZVECTOR>
+    {
+        static constexpr int NumChannels = 3;
+        using Angles                     = std::array<double, NumChannels>;
+
+        template <typename A, typename M> static void ToT4x4(const A &Angles, M &&T) { Z_VECTOR(Angles, T); }
+        template <typename M, typename A> static void From4x4(const M &T, A &&Angles)
+        {
+            Angles[0] = T[RC(0, 2)];
+            Angles[1] = T[RC(1, 2)];
+            Angles[2] = T[RC(2, 2)];
+        }
+        template <typename M, typename P, typename A> static void From4x4Unwrap(const M &T, const P &, A &&Angles) { From4x4(T, Angles); }
+    };
+
+    // the 16 values column by column
+    template <> struct Kernel<ORIENTATION_4X4>
+    {
+        static constexpr int NumChannels = 16;
+        using Angles                     = std::array<double, NumChannels>;
+
+        template <typename A, typename M> static void ToT4x4(const A &Angles, M &&T)
+        {
+            for (int i = 0; i < 16; i++)
+                T[i] = Angles[i];
+        }
+        template <typename M, typename A> static void From4x4(const M &T, A &&Angles)
+        {
+            for (int i = 0; i < 16; i++)
+                Angles[i] = T[i];
+        }
+        template <typename M, typename P, typename A> static void From4x4Unwrap(const M &T, const P &, A &&Angles) { From4x4(T, Angles); }
+    };
+
+    // the rotation column by column
+    template <> struct Kernel<ORIENTATION_3X3>
+    {
+        static constexpr int NumChannels = 9;
+        using Angles                     = std::array<double, NumChannels>;
+
+        template <typename A, typename M> static void ToT4x4(const A &Angles, M &&T)
+        {
+            for (int c = 0; c < 3; c++)
+                for (int r = 0; r < 3; r++)
+                    T[RC(r, c)] = Angles[3 * c + r];
+            T[RC(0, 3)] = 0.0;
+            T[RC(1, 3)] = 0.0;
+            T[RC(2, 3)] = 0.0;
+            T[RC(3, 0)] = 0.0;
+            T[RC(3, 1)] = 0.0;
+            T[RC(3, 2)] = 0.0;
+            T[RC(3, 3)] = 1.0;
+        }
+        template <typename M, typename A> static void From4x4(const M &T, A &&Angles)
+        {
+            for (int c = 0; c < 3; c++)
+                for (int r = 0; r < 3; r++)
+                    Angles[3 * c + r] = T[RC(r, c)];
+        }
+        template <typename M, typename P, typename A> static void From4x4Unwrap(const M &T, const P &, A &&Angles) { From4x4(T, Angles); }
+    };
+
+    using AnyKernel = std::variant<Kernel<ORIENTATION_ROLLPITCHYAW>, Kernel<ORIENTATION_STEERCAMBERSPIN>, Kernel<ORIENTATION_SKREW>, Kernel<ORIENTATION_KUKAABC>,
+                                   Kernel<ORIENTATION_QUATERNION>, Kernel<ORIENTATION_ZVECTOR>, Kernel<ORIENTATION_4X4>, Kernel<ORIENTATION_3X3>>;
+
+    // throws std::invalid_argument for an index that is not one of the ORIENTATION_... conventions
+    inline AnyKernel MakeKernel(int Convention)
+    {
+        switch (Convention)
+        {
+        case ORIENTATION_ROLLPITCHYAW: return Kernel<ORIENTATION_ROLLPITCHYAW>{};
+        case ORIENTATION_STEERCAMBERSPIN: return Kernel<ORIENTATION_STEERCAMBERSPIN>{};
+        case ORIENTATION_SKREW: return Kernel<ORIENTATION_SKREW>{};
+        case ORIENTATION_KUKAABC: return Kernel<ORIENTATION_KUKAABC>{};
+        case ORIENTATION_QUATERNION: return Kernel<ORIENTATION_QUATERNION>{};
+        case ORIENTATION_ZVECTOR: return Kernel<ORIENTATION_ZVECTOR>{};
+        case ORIENTATION_4X4: return Kernel<ORIENTATION_4X4>{};
+        case ORIENTATION_3X3: return Kernel<ORIENTATION_3X3>{};
+        }
+        throw std::invalid_argument("unknown orientation convention " + std::to_string(Convention));
+    }
+
+    inline int GetNumChannels(const AnyKernel &Kernel)
+    {
+        return std::visit([](const auto &K) { return std::decay_t<decltype(K)>::NumChannels; }, Kernel);
+    }
+} // namespace OrientationKernels
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+COrientationStream : the conversions of the rigid bodies of a stream, frame after frame
+
+The convention is resolved once, in the constructor. A frame is NumSeries poses, Angles holds NumChannels
+values per pose. With unwrapping on, From4x4 continues the angles of the previous frame of the same stream.
+*/
+//------------------------------------------------------------------------------------------------------------------
+class COrientationStream
+{
+  public:
+    explicit COrientationStream(int Convention, bool bUnwrap = false) : m_Kernel(OrientationKernels::MakeKernel(Convention)), m_bUnwrap(bUnwrap) {}
+    explicit COrientationStream(const std::string &Name, bool bUnwrap = false) : COrientationStream(GetOrientationManager()->GetOrientationIndex(Name), bUnwrap) {}
+
+    int  GetNumChannels() const { return OrientationKernels::GetNumChannels(m_Kernel); }
+    void Reset() { m_Prev.clear(); } // the next frame is not unwrapped
+
+    void ToT4x4(const std::vector<double> &Angles, std::vector<OrientationKernels::Matrix4x4> &T4x4) const
+    {
+        std::visit(
+            [&](const auto &Kernel)
+            {
+                using K                = std::decay_t<decltype(Kernel)>;
+                const size_t NumSeries = Angles.size() / K::NumChannels;
+                T4x4.resize(NumSeries);
+                for (size_t i = 0; i < NumSeries; i++)
+                    K::ToT4x4(&Angles[i * K::NumChannels], T4x4[i]);
+            },
+            m_Kernel);
+    }
+
+    void From4x4(const std::vector<OrientationKernels::Matrix4x4> &T4x4, std::vector<double> &Angles)
+    {
+        std::visit(
+            [&](const auto &Kernel)
+            {
+                using K                = std::decay_t<decltype(Kernel)>;
+                const size_t NumSeries = T4x4.size();
+                Angles.resize(NumSeries * K::NumChannels);
+                if (m_bUnwrap && m_Prev.size() == Angles.size())
+                {
+                    for (size_t i = 0; i < NumSeries; i++)
+                        K::From4x4Unwrap(T4x4[i], &m_Prev[i * K::NumChannels], &Angles[i * K::NumChannels]);
+                }
+                else
+                {
+                    for (size_t i = 0; i < NumSeries; i++)
+                        K::From4x4(T4x4[i], &Angles[i * K::NumChannels]);
+                }
+            },
+            m_Kernel);
+        if (m_bUnwrap)
+            m_Prev = Angles;
+    }
+
+  protected:
+    OrientationKernels::AnyKernel m_Kernel;
+    bool                          m_bUnwrap;
+    std::vector<double>           m_Prev;
+};
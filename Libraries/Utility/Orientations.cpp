@@ -1,4 +1,5 @@
 ﻿#include "orientations.h"
+#include "OrientationKernels.h"
 #include "StringUtilities.h"
 #include <math.h>
 #include <fmt/core.h>
@@ -23,17 +24,7 @@
 //-------------------------------------------------------------------
 void XYZ_FIX(double a1, double a2, double a3, double *xyz_fix)
 {
-    xyz_fix[RC(0, 0)] = cos(a3) * cos(a2);
-    xyz_fix[RC(0, 1)] = cos(a3) * sin(a2) * sin(a1) - sin(a3) * cos(a1);
-    xyz_fix[RC(0, 2)] = cos(a3) * sin(a2) * cos(a1) + sin(a3) * sin(a1);
-    xyz_fix[RC(1, 0)] = sin(a3) * cos(a2);
-    xyz_fix[RC(1, 1)] = sin(a3) * sin(a2) * sin(a1) + cos(a3) * cos(a1);
-    xyz_fix[RC(1, 2)] = sin(a3) * sin(a2) * cos(a1) - cos(a3) * sin(a1);
-    xyz_fix[RC(2, 0)] = -sin(a2);
-    xyz_fix[RC(2, 1)] = cos(a2) * sin(a1);
-    xyz_fix[RC(2, 2)] = cos(a2) * cos(a1);
-    xyz_fix[RC(3, 0)] = xyz_fix[RC(3, 1)] = xyz_fix[RC(3, 2)] = 0.0;
-    xyz_fix[RC(3, 3)]                                         = 1.0;
+    OrientationKernels::XYZ_FIX(a1, a2, a3, xyz_fix);
 };
 
 // ... (Implementations for XZY_FIX, YXZ_FIX, YZX_FIX, ZXY_FIX, ZYX_FIX) ...
@@ -169,18 +160,8 @@ void YZX_EULER(double a1, double a2, double a3, double *yzx_euler)
     yzx_euler[RC(3, 3)]                                             = 1.0;
 }
 void ZXY_EULER(double a1, double a2, double a3, double *zxy_euler)
-{ /* Original implementation */
-    zxy_euler[RC(0, 0)] = cos(a3) * cos(a1) - sin(a3) * sin(a2) * sin(a1);
-    zxy_euler[RC(0, 1)] = -cos(a2) * sin(a1);
-    zxy_euler[RC(0, 2)] = sin(a3) * cos(a1) + cos(a3) * sin(a2) * sin(a1);
-    zxy_euler[RC(1, 0)] = cos(a3) * sin(a1) + sin(a3) * sin(a2) * cos(a1);
-    zxy_euler[RC(1, 1)] = cos(a2) * cos(a1);
-    zxy_euler[RC(1, 2)] = sin(a3) * sin(a1) - cos(a3) * sin(a2) * cos(a1);
-    zxy_euler[RC(2, 0)] = -sin(a3) * cos(a2);
-    zxy_euler[RC(2, 1)] = sin(a2);
-    zxy_euler[RC(2, 2)] = cos(a3) * cos(a2);
-    zxy_euler[RC(3, 0)] = zxy_euler[RC(3, 1)] = zxy_euler[RC(3, 2)] = 0.0;
-    zxy_euler[RC(3, 3)]                                             = 1.0;
+{
+    OrientationKernels::ZXY_EULER(a1, a2, a3, zxy_euler);
 }
 void ZYX_EULER(double a1, double a2, double a3, double *zyx_euler)
 { /* Original implementation */
@@ -287,40 +268,14 @@ void ZYZ_EULER(double a1, double a2, double a3, double *zyz_euler)
 }
 
 void SKREW_VECTOR(double a1, double a2, double a3, double *T)
-{ /* Original implementation */
-    if (a1 == 0.0 && a2 == 0.0 && a3 == 0.0)
-    {
-        for (int r = 0; r < 3; r++)
-            for (int c = 0; c < 3; c++)
-                T[RC(r, c)] = (r == c ? 1.0 : 0.0);
-        T[RC(3, 0)] = T[RC(3, 1)] = T[RC(3, 2)] = 0.0;
-        T[RC(3, 3)]                             = 1.0;
-        return;
-    }
-    double Eps, SEps, CEps, Ex, Ey, Ez;
-    Eps         = sqrt(a1 * a1 + a2 * a2 + a3 * a3);
-    SEps        = sin(Eps);
-    CEps        = cos(Eps);
-    Ex          = a1 / Eps;
-    Ey          = a2 / Eps;
-    Ez          = a3 / Eps;
-    T[RC(0, 0)] = Ex * Ex * (1.0 - CEps) + CEps;
-    T[RC(0, 1)] = Ex * Ey * (1.0 - CEps) - Ez * SEps;
-    T[RC(0, 2)] = Ex * Ez * (1.0 - CEps) + Ey * SEps;
-    T[RC(1, 0)] = Ex * Ey * (1.0 - CEps) + Ez * SEps;
-    T[RC(1, 1)] = Ey * Ey * (1.0 - CEps) + CEps;
-    T[RC(1, 2)] = Ez * Ey * (1.0 - CEps) - Ex * SEps;
-    T[RC(2, 0)] = Ex * Ez * (1.0 - CEps) - Ey * SEps;
-    T[RC(2, 1)] = Ey * Ez * (1.0 - CEps) + Ex * SEps;
-    T[RC(2, 2)] = Ez * Ez * (1.0 - CEps) + CEps;
-    T[RC(3, 0)] = T[RC(3, 1)] = T[RC(3, 2)] = 0.0;
-    T[RC(3, 3)]                             = 1.0;
+{
+    OrientationKernels::SKREW_VECTOR(a1, a2, a3, T);
 }
 
 // ... (Reverse functions, Unwrap, etc. implementations) ...
-void Unwrap(const double &PrevAngle, double &Angle, double Period = 2.0 * PI)
-{ /* Original implementation */
-    Angle += floor((PrevAngle - Angle) / Period + 0.5) * Period;
+void Unwrap(const double &PrevAngle, double &Angle, double Period)
+{
+    OrientationKernels::Unwrap(PrevAngle, Angle, Period);
 }
 void AlternativeAngles(const double &PrevRoll, double &Roll, double Pitch, double &Yaw)
 { /* Original implementation */
@@ -333,35 +288,12 @@ void AlternativeAngles(const double &PrevRoll, double &Roll, double Pitch, doubl
     }
 }
 void NearestDegenerateAnglesCtrack(double a2, double a1prev, double a3prev, double &a1, double &a3)
-{ /* Original implementation */
-    double Tol = 1e-3;
-    if (fmod(fabs(a2), PI) < Tol)
-    {
-        int    Ca2   = (int)cos(a2);
-        double Uprev = a1prev - Ca2 * a3prev;
-        double U     = a1 - Ca2 * a3;
-        Unwrap(Uprev, U);
-        double Udiff = (Uprev - U) / 2.0;
-        a1 += Udiff;
-        a3 -= Ca2 * Udiff;
-    }
+{
+    OrientationKernels::NearestDegenerateAnglesCtrack(a2, a1prev, a3prev, a1, a3);
 }
 void XYZ_FIX_REVERSE(double *xyz_fix, double &a1, double &a2, double &a3)
-{ /* Original implementation */
-    double CPitch = sqrt(sqr(xyz_fix[RC(0, 0)]) + sqr(xyz_fix[RC(1, 0)]));
-    if (CPitch > 1e-5)
-    {
-        a1 = atan2(xyz_fix[RC(2, 1)], xyz_fix[RC(2, 2)]);
-        a2 = atan2(-xyz_fix[RC(2, 0)], CPitch);
-        a3 = atan2(xyz_fix[RC(1, 0)], xyz_fix[RC(0, 0)]);
-    }
-    else
-    {
-        a1            = 0.0;
-        double SPitch = MAX(MIN(1.0, -xyz_fix[RC(2, 0)]), -1.0);
-        a2            = asin(SPitch);
-        a3            = atan2(xyz_fix[RC(0, 1)] / xyz_fix[RC(2, 0)], xyz_fix[RC(1, 1)]);
-    }
+{
+    OrientationKernels::XYZ_FIX_REVERSE(xyz_fix, a1, a2, a3);
 }
 void XYZ_FIX_REVERSE_UNWRAP(double *T, const double &a1_prev, const double &a2_prev, const double &a3_prev, double &a1, double &a2, double &a3)
 { /* Original implementation */
@@ -372,22 +304,8 @@ void XYZ_FIX_REVERSE_UNWRAP(double *T, const double &a1_prev, const double &a2_p
     Unwrap(a3_prev, a3);
 }
 void ZXY_EULER_REVERSE(double *zxy_euler, double &a1, double &a2, double &a3)
-{ /* Original implementation */
-    double CX = MIN(1.0, sqrt(sqr(zxy_euler[RC(0, 1)]) + sqr(zxy_euler[RC(1, 1)])));
-    CX        = MAX(-1, MIN(1, CX));
-    if (CX > 1e-5)
-    {
-        a1 = atan2(-zxy_euler[RC(0, 1)], zxy_euler[RC(1, 1)]);
-        a2 = atan2(zxy_euler[RC(2, 1)], CX);
-        a3 = atan2(-zxy_euler[RC(2, 0)], zxy_euler[RC(2, 2)]);
-    }
-    else
-    {
-        a1        = 0.0;
-        double SX = MIN(1.0, MAX(-1.0, zxy_euler[RC(2, 1)]));
-        a2        = asin(SX);
-        a3        = atan2(zxy_euler[RC(1, 0)], zxy_euler[RC(0, 0)]);
-    }
+{
+    OrientationKernels::ZXY_EULER_REVERSE(zxy_euler, a1, a2, a3);
 }
 void ZXY_EULER_REVERSE_UNWRAP(double *T, const double &a1_prev, const double &a2_prev, const double &a3_prev, double &a1, double &a2, double &a3)
 { /* Original implementation */
@@ -398,40 +316,17 @@ void ZXY_EULER_REVERSE_UNWRAP(double *T, const double &a1_prev, const double &a2
     Unwrap(a3_prev, a3);
 }
 void SKREW_VECTOR_REVERSE(double *T, double &a1, double &a2, double &a3)
-{ /* Original implementation */
-    double rc00  = T[RC(0, 0)];
-    double rc11  = T[RC(1, 1)];
-    double rc22  = T[RC(2, 2)];
-    double th    = rc00 + rc11 + rc22;
-    th           = th - 1;
-    th           = th / 2;
-    th           = MAX(th, -1);
-    th           = MIN(th, +1);
-    double Theta = acos(th);
-    if (Theta != 0.0)
-    {
-        double STheta2 = 1.0 / (2 * sin(Theta));
-        a1             = STheta2 * (T[RC(2, 1)] - T[RC(1, 2)]) * Theta;
-        a2             = STheta2 * (T[RC(0, 2)] - T[RC(2, 0)]) * Theta;
-        a3             = STheta2 * (T[RC(1, 0)] - T[RC(0, 1)]) * Theta;
-    }
-    else
-    {
-        a1 = a2 = a3 = 0.0;
-    }
+{
+    OrientationKernels::SKREW_VECTOR_REVERSE(T, a1, a2, a3);
 }
 void SKREW_VECTOR_REVERSE_UNWRAP(double *T, const double &a1_prev, const double &a2_prev, const double &a3_prev, double &a1, double &a2, double &a3)
 { /* Original implementation */
     SKREW_VECTOR_REVERSE(T, a1, a2, a3);
-    if ((a1 == 0.0) && (a2 == 0.0) && (a3 == 0.0))
-        return;
-    double Delta1(a1_prev - a1), Delta2(a2_prev - a2), Delta3(a3_prev - a3);
-    double a_norm = sqrt(a1 * a1 + a2 * a2 + a3 * a3);
-    double uk1(a1 / a_norm), uk2(a2 / a_norm), uk3(a3 / a_norm);
-    int    N = (int)floor((Delta1 * uk1 + Delta2 * uk2 + Delta3 * uk3) / (2 * PI) + 0.5);
-    a1 += 2 * PI * N * uk1;
-    a2 += 2 * PI * N * uk2;
-    a3 += 2 * PI * N * uk3;
+    SKREW_VECTOR_UNWRAP(a1_prev, a2_prev, a3_prev, a1, a2, a3);
+}
+void SKREW_VECTOR_UNWRAP(const double &a1_prev, const double &a2_prev, const double &a3_prev, double &a1, double &a2, double &a3)
+{
+    OrientationKernels::SKREW_VECTOR_UNWRAP(a1_prev, a2_prev, a3_prev, a1, a2, a3);
 }
 
 double ShiftAngleInRegion(double InputNumber, double LowerLimit, double UpperLimit)
@@ -527,15 +422,15 @@ COrientationRollPitchYaw::COrientationRollPitchYaw()
 }
 void COrientationRollPitchYaw::ToT4x4(double *Angles, double *T4x4)
 {
-    XYZ_FIX(Angles[0], Angles[1], Angles[2], T4x4);
+    OrientationKernels::Kernel<ORIENTATION_ROLLPITCHYAW>::ToT4x4(Angles, T4x4);
 }
 void COrientationRollPitchYaw::From4x4(double *T4x4, double *Angles)
 {
-    XYZ_FIX_REVERSE(T4x4, Angles[0], Angles[1], Angles[2]);
+    OrientationKernels::Kernel<ORIENTATION_ROLLPITCHYAW>::From4x4(T4x4, Angles);
 }
 void COrientationRollPitchYaw::From4x4Unwrap(double *T4x4, double AnglesPrev[], double *Angles)
 {
-    XYZ_FIX_REVERSE_UNWRAP(T4x4, AnglesPrev[0], AnglesPrev[1], AnglesPrev[2], Angles[0], Angles[1], Angles[2]);
+    OrientationKernels::Kernel<ORIENTATION_ROLLPITCHYAW>::From4x4Unwrap(T4x4, AnglesPrev, Angles);
 }
 
 //------------------------------------------------------------------------------------------------------------------
@@ -550,15 +445,15 @@ COrientationSteerCamberSpin::COrientationSteerCamberSpin()
 }
 void COrientationSteerCamberSpin::ToT4x4(double *Angles, double *T4x4)
 {
-    ZXY_EULER(Angles[0], Angles[1], Angles[2], T4x4);
+    OrientationKernels::Kernel<ORIENTATION_STEERCAMBERSPIN>::ToT4x4(Angles, T4x4);
 }
 void COrientationSteerCamberSpin::From4x4(double *T4x4, double *Angles)
 {
-    ZXY_EULER_REVERSE(T4x4, Angles[0], Angles[1], Angles[2]);
+    OrientationKernels::Kernel<ORIENTATION_STEERCAMBERSPIN>::From4x4(T4x4, Angles);
 }
 void COrientationSteerCamberSpin::From4x4Unwrap(double *T4x4, double AnglesPrev[], double *Angles)
 {
-    ZXY_EULER_REVERSE_UNWRAP(T4x4, AnglesPrev[0], AnglesPrev[1], AnglesPrev[2], Angles[0], Angles[1], Angles[2]);
+    OrientationKernels::Kernel<ORIENTATION_STEERCAMBERSPIN>::From4x4Unwrap(T4x4, AnglesPrev, Angles);
 }
 
 //------------------------------------------------------------------------------------------------------------------
@@ -573,15 +468,15 @@ COrientationSkrew::COrientationSkrew()
 }
 void COrientationSkrew::ToT4x4(double *Angles, double *T4x4)
 {
-    SKREW_VECTOR(Angles[0], Angles[1], Angles[2], T4x4);
+    OrientationKernels::Kernel<ORIENTATION_SKREW>::ToT4x4(Angles, T4x4);
 }
 void COrientationSkrew::From4x4(double *T4x4, double *Angles)
 {
-    SKREW_VECTOR_REVERSE(T4x4, Angles[0], Angles[1], Angles[2]);
+    OrientationKernels::Kernel<ORIENTATION_SKREW>::From4x4(T4x4, Angles);
 }
 void COrientationSkrew::From4x4Unwrap(double *T4x4, double AnglesPrev[], double *Angles)
 {
-    SKREW_VECTOR_REVERSE_UNWRAP(T4x4, AnglesPrev[0], AnglesPrev[1], AnglesPrev[2], Angles[0], Angles[1], Angles[2]);
+    OrientationKernels::Kernel<ORIENTATION_SKREW>::From4x4Unwrap(T4x4, AnglesPrev, Angles);
 }
 
 //------------------------------------------------------------------------------------------------------------------
@@ -596,15 +491,15 @@ COrientationKukaABC::COrientationKukaABC()
 }
 void COrientationKukaABC::ToT4x4(double *Angles, double *T4x4)
 {
-    KUKA_ABC(Angles[0], Angles[1], Angles[2], T4x4);
+    OrientationKernels::Kernel<ORIENTATION_KUKAABC>::ToT4x4(Angles, T4x4);
 }
 void COrientationKukaABC::From4x4(double *T4x4, double *Angles)
 {
-    KUKA_ABC_REVERSE(T4x4, Angles[0], Angles[1], Angles[2]);
+    OrientationKernels::Kernel<ORIENTATION_KUKAABC>::From4x4(T4x4, Angles);
 }
 void COrientationKukaABC::From4x4Unwrap(double *T4x4, double AnglesPrev[], double *Angles)
 {
-    KUKA_ABC_REVERSE_UNWRAP(T4x4, AnglesPrev[0], AnglesPrev[1], AnglesPrev[2], Angles[0], Angles[1], Angles[2]);
+    OrientationKernels::Kernel<ORIENTATION_KUKAABC>::From4x4Unwrap(T4x4, AnglesPrev, Angles);
 }
 
 //------------------------------------------------------------------------------------------------------------------
@@ -619,70 +514,12 @@ COrientationQuaternion::COrientationQuaternion()
     m_arAngleNames.push_back("qz");
 }
 void COrientationQuaternion::ToT4x4(double *Angles, double *T4x4)
-{ // Angles: qw, qx, qy, qz
-    double XX      = Angles[1] * Angles[1];
-    double YY      = Angles[2] * Angles[2];
-    double ZZ      = Angles[3] * Angles[3];
-    double XY      = Angles[1] * Angles[2];
-    double XZ      = Angles[1] * Angles[3];
-    double YZ      = Angles[2] * Angles[3];
-    double XW      = Angles[1] * Angles[0];
-    double YW      = Angles[2] * Angles[0];
-    double ZW      = Angles[3] * Angles[0];
-
-    T4x4[RC(0, 0)] = 1 - (2 * YY + 2 * ZZ);
-    T4x4[RC(0, 1)] = 2 * XY - 2 * ZW;
-    T4x4[RC(0, 2)] = 2 * XZ + 2 * YW; // Transposed based on typical OpenGL matrix layout in comments
-    T4x4[RC(1, 0)] = 2 * XY + 2 * ZW;
-    T4x4[RC(1, 1)] = 1 - (2 * XX + 2 * ZZ);
-    T4x4[RC(1, 2)] = 2 * YZ - 2 * XW;
-    T4x4[RC(2, 0)] = 2 * XZ - 2 * YW;
-    T4x4[RC(2, 1)] = 2 * YZ + 2 * XW;
-    T4x4[RC(2, 2)] = 1 - (2 * XX + 2 * YY);
-    // Make sure the translation part is zero and T4x4[RC(3,3)] is 1
-    T4x4[RC(0, 3)] = 0.0;
-    T4x4[RC(1, 3)] = 0.0;
-    T4x4[RC(2, 3)] = 0.0;
-    T4x4[RC(3, 0)] = 0.0;
-    T4x4[RC(3, 1)] = 0.0;
-    T4x4[RC(3, 2)] = 0.0;
-    T4x4[RC(3, 3)] = 1.0;
+{
+    OrientationKernels::Kernel<ORIENTATION_QUATERNION>::ToT4x4(Angles, T4x4);
 }
 void COrientationQuaternion::From4x4(double *T4x4, double *Angles)
-{ // Angles: qw, qx, qy, qz
-    double tr = T4x4[RC(0, 0)] + T4x4[RC(1, 1)] + T4x4[RC(2, 2)];
-    if (tr > 0)
-    {
-        double S  = sqrt(tr + 1.0) * 2;
-        Angles[0] = 0.25 * S;
-        Angles[1] = (T4x4[RC(2, 1)] - T4x4[RC(1, 2)]) / S;
-        Angles[2] = (T4x4[RC(0, 2)] - T4x4[RC(2, 0)]) / S;
-        Angles[3] = (T4x4[RC(1, 0)] - T4x4[RC(0, 1)]) / S;
-    }
-    else if ((T4x4[RC(0, 0)] > T4x4[RC(1, 1)]) & (T4x4[RC(0, 0)] > T4x4[RC(2, 2)]))
-    {
-        double S  = sqrt(1.0 + T4x4[RC(0, 0)] - T4x4[RC(1, 1)] - T4x4[RC(2, 2)]) * 2;
-        Angles[0] = (T4x4[RC(2, 1)] - T4x4[RC(1, 2)]) / S;
-        Angles[1] = 0.25 * S;
-        Angles[2] = (T4x4[RC(0, 1)] + T4x4[RC(1, 0)]) / S;
-        Angles[3] = (T4x4[RC(0, 2)] + T4x4[RC(2, 0)]) / S;
-    }
-    else if (T4x4[RC(1, 1)] > T4x4[RC(2, 2)])
-    {
-        double S  = sqrt(1.0 + T4x4[RC(1, 1)] - T4x4[RC(0, 0)] - T4x4[RC(2, 2)]) * 2;
-        Angles[0] = (T4x4[RC(0, 2)] - T4x4[RC(2, 0)]) / S;
-        Angles[1] = (T4x4[RC(0, 1)] + T4x4[RC(1, 0)]) / S;
-        Angles[2] = 0.25 * S;
-        Angles[3] = (T4x4[RC(1, 2)] + T4x4[RC(2, 1)]) / S;
-    }
-    else
-    {
-        double S  = sqrt(1.0 + T4x4[RC(2, 2)] - T4x4[RC(0, 0)] - T4x4[RC(1, 1)]) * 2;
-        Angles[0] = (T4x4[RC(1, 0)] - T4x4[RC(0, 1)]) / S;
-        Angles[1] = (T4x4[RC(0, 2)] + T4x4[RC(2, 0)]) / S;
-        Angles[2] = (T4x4[RC(1, 2)] + T4x4[RC(2, 1)]) / S;
-        Angles[3] = 0.25 * S;
-    }
+{
+    OrientationKernels::Kernel<ORIENTATION_QUATERNION>::From4x4(T4x4, Angles);
 }
 int COrientationQuaternion::GetIndex3x3()
 {
@@ -709,25 +546,16 @@ int COrientationQuaternion::GetIndexProbeButton()
 // COrientationZVector
 //------------------------------------------------------------------------------------------------------------------
 void Normalize(double *V)
-{ /* Original implementation */
-    double Norm = sqrt(V[0] * V[0] + V[1] * V[1] + V[2] * V[2]);
-    if (Norm > 0.0000001)
-    {
-        for (int i = 0; i < 3; i++)
-            V[i] = V[i] / Norm;
-    }
+{
+    OrientationKernels::Normalize(V);
 }
 double Determinant(double *R4x4)
-{ /* Original implementation */
-    return R4x4[RC(0, 0)] * R4x4[RC(1, 1)] * R4x4[RC(2, 2)] + R4x4[RC(0, 1)] * R4x4[RC(1, 2)] * R4x4[RC(2, 0)] +
-           R4x4[RC(0, 2)] * R4x4[RC(1, 0)] * R4x4[RC(2, 1)] - R4x4[RC(0, 2)] * R4x4[RC(1, 1)] * R4x4[RC(2, 0)] -
-           R4x4[RC(0, 1)] * R4x4[RC(1, 0)] * R4x4[RC(2, 2)] - R4x4[RC(0, 0)] * R4x4[RC(1, 2)] * R4x4[RC(2, 1)];
+{
+    return OrientationKernels::Determinant(R4x4);
 }
 void CrossProduct(double *V1, double *V2, double *VResult)
-{ /* Original implementation */
-    VResult[0] = (V1[1] * V2[2] - V1[2] * V2[1]);
-    VResult[1] = (V1[2] * V2[0] - V1[0] * V2[2]);
-    VResult[2] = (V1[0] * V2[1] - V1[1] * V2[0]); // Corrected cross product for VResult[1]
+{
+    OrientationKernels::CrossProduct(V1, V2, VResult);
 }
 double DotProduct(double *V1, double *V2)
 { /* Original implementation */
@@ -745,53 +573,12 @@ COrientationZVector::COrientationZVector()
     m_arAngleNames.push_back("Vz");
 }
 void COrientationZVector::ToT4x4(double *Angles, double *T4x4)
-{                                                     /* Original implementation slightly adapted */
-    double Vz[3] = {Angles[0], Angles[1], Angles[2]}; // Input is the Z vector
-    Normalize(Vz);
-
-    double Vx[3], Vy[3];
-    double tempAxis[3] = {0.0, 0.0, 1.0}; // Default X world axis
-    if (fabs(Vz[0]) < 0.9 && fabs(Vz[1]) < 0.9)
-    { // If Vz is not too close to Z-axis (to avoid issues with Y-axis later)
-        tempAxis[0] = 1.0;
-        tempAxis[1] = 0.0;
-        tempAxis[2] = 0.0; // Use X-axis
-    }
-    else
-    { // Vz is close to Z-axis, use Y-axis to generate X
-        tempAxis[0] = 0.0;
-        tempAxis[1] = 1.0;
-        tempAxis[2] = 0.0; // Use Y-axis
-    }
-
-    CrossProduct(tempAxis, Vz, Vy); // Vy = tempAxis x Vz (should be Y if Z is Z-axis like)
-    Normalize(Vy);
-    CrossProduct(Vy, Vz, Vx); // Vx = Vy x Vz
-    Normalize(Vx);
-
-    for (int i = 0; i < 3; i++)
-    {
-        T4x4[RC(i, 0)] = Vx[i];
-        T4x4[RC(i, 1)] = Vy[i];
-        T4x4[RC(i, 2)] = Vz[i];
-        T4x4[RC(i, 3)] = 0.0; // No translation
-    }
-    T4x4[RC(3, 0)] = 0.0;
-    T4x4[RC(3, 1)] = 0.0;
-    T4x4[RC(3, 2)] = 0.0;
-    T4x4[RC(3, 3)] = 1.0;
-
-    if (Determinant(T4x4) < 0)
-    { // Ensure right-handed system
-        for (int i = 0; i < 3; i++)
-            T4x4[RC(i, 0)] = -T4x4[RC(i, 0)]; // Flip X-axis
-    }
+{
+    OrientationKernels::Kernel<ORIENTATION_ZVECTOR>::ToT4x4(Angles, T4x4);
 }
 void COrientationZVector::From4x4(double *T4x4, double *Angles)
 {
-    Angles[0] = T4x4[RC(0, 2)];
-    Angles[1] = T4x4[RC(1, 2)];
-    Angles[2] = T4x4[RC(2, 2)];
+    OrientationKernels::Kernel<ORIENTATION_ZVECTOR>::From4x4(T4x4, Angles);
 }
 
 //------------------------------------------------------------------------------------------------------------------
@@ -817,7 +604,7 @@ void COrientation4x4::ToT4x4(double *MatrixAsAngles, double *T4x4_out)
     // Assumes MatrixAsAngles is a pointer to 16 doubles representing the 4x4 matrix (column-major)
     if (MatrixAsAngles && T4x4_out)
     {
-        memcpy(T4x4_out, MatrixAsAngles, 16 * sizeof(double));
+        OrientationKernels::Kernel<ORIENTATION_4X4>::ToT4x4(MatrixAsAngles, T4x4_out);
     }
 }
 
@@ -826,7 +613,7 @@ void COrientation4x4::From4x4(double *T4x4_in, double *MatrixAsAngles)
     // Assumes MatrixAsAngles is a pointer to 16 doubles to store the 4x4 matrix (column-major)
     if (MatrixAsAngles && T4x4_in)
     {
-        memcpy(MatrixAsAngles, T4x4_in, 16 * sizeof(double));
+        OrientationKernels::Kernel<ORIENTATION_4X4>::From4x4(T4x4_in, MatrixAsAngles);
     }
 }
 
@@ -853,25 +640,7 @@ void COrientation3x3::ToT4x4(double *Matrix3x3AsAngles, double *T4x4_out)
     // Assumes Matrix3x3AsAngles points to 9 doubles (column-major: R00,R10,R20, R01,R11,R21, R02,R12,R22)
     if (Matrix3x3AsAngles && T4x4_out)
     {
-        // Copy 3x3 part (column-major)
-        T4x4_out[RC(0, 0)] = Matrix3x3AsAngles[0];
-        T4x4_out[RC(1, 0)] = Matrix3x3AsAngles[1];
-        T4x4_out[RC(2, 0)] = Matrix3x3AsAngles[2];
-        T4x4_out[RC(0, 1)] = Matrix3x3AsAngles[3];
-        T4x4_out[RC(1, 1)] = Matrix3x3AsAngles[4];
-        T4x4_out[RC(2, 1)] = Matrix3x3AsAngles[5];
-        T4x4_out[RC(0, 2)] = Matrix3x3AsAngles[6];
-        T4x4_out[RC(1, 2)] = Matrix3x3AsAngles[7];
-        T4x4_out[RC(2, 2)] = Matrix3x3AsAngles[8];
-
-        // Set other parts for a proper rotation matrix (no translation)
-        T4x4_out[RC(0, 3)] = 0.0;
-        T4x4_out[RC(1, 3)] = 0.0;
-        T4x4_out[RC(2, 3)] = 0.0;
-        T4x4_out[RC(3, 0)] = 0.0;
-        T4x4_out[RC(3, 1)] = 0.0;
-        T4x4_out[RC(3, 2)] = 0.0;
-        T4x4_out[RC(3, 3)] = 1.0;
+        OrientationKernels::Kernel<ORIENTATION_3X3>::ToT4x4(Matrix3x3AsAngles, T4x4_out);
     }
 }
 
@@ -880,15 +649,7 @@ void COrientation3x3::From4x4(double *T4x4_in, double *Matrix3x3AsAngles)
     // Assumes Matrix3x3AsAngles points to 9 doubles to store the 3x3 part (column-major)
     if (Matrix3x3AsAngles && T4x4_in)
     {
-        Matrix3x3AsAngles[0] = T4x4_in[RC(0, 0)];
-        Matrix3x3AsAngles[1] = T4x4_in[RC(1, 0)];
-        Matrix3x3AsAngles[2] = T4x4_in[RC(2, 0)];
-        Matrix3x3AsAngles[3] = T4x4_in[RC(0, 1)];
-        Matrix3x3AsAngles[4] = T4x4_in[RC(1, 1)];
-        Matrix3x3AsAngles[5] = T4x4_in[RC(2, 1)];
-        Matrix3x3AsAngles[6] = T4x4_in[RC(0, 2)];
-        Matrix3x3AsAngles[7] = T4x4_in[RC(1, 2)];
-        Matrix3x3AsAngles[8] = T4x4_in[RC(2, 2)];
+        OrientationKernels::Kernel<ORIENTATION_3X3>::From4x4(T4x4_in, Matrix3x3AsAngles);
     }
 }
 
@@ -54,11 +54,52 @@ void ZYZ_EULER(double a1, double a2, double a3, double *zyz_euler);
 void SKREW_VECTOR(double a1, double a2, double a3, double *skrew_vector);
 void SKREW_VECTOR_REVERSE(double *T, double &a1, double &a2, double &a3);
 void SKREW_VECTOR_REVERSE_UNWRAP(double *T, const double &a1_prev, const double &a2_prev, const double &a3_prev, double &a1, double &a2, double &a3);
+void SKREW_VECTOR_UNWRAP(const double &a1_prev, const double &a2_prev, const double &a3_prev, double &a1, double &a2, double &a3);
 
 void XYZ_FIX_REVERSE(double *T, double &a1, double &a2, double &a3);
+void ZXY_EULER_REVERSE(double *T, double &a1, double &a2, double &a3);
+
+void Unwrap(const double &PrevAngle, double &Angle, double Period = 2.0 * PI);
+void NearestDegenerateAnglesCtrack(double a2, double a1prev, double a3prev, double &a1, double &a3);
 
 double ShiftAngleInRegion(double InputNumber, double LowerLimit = -180.0, double UpperLimit = 180.0);
 
+//------------------------------------------------------------------------------------------------------------------
+/*
+CPoseBatch : many poses as structure of arrays, for converting a whole recording at once
+
+GetT(RC(r, c))[i] is element (r, c) of the 4x4 of pose i, GetAngles(k)[i] is orientation channel k of pose i.
+Poses i and i + NumSeries are the same body in consecutive frames : F frames of B bodies are one batch of F * B
+poses with NumSeries = B, frame major. The unwrapping conversions scan along that stride.
+*/
+//------------------------------------------------------------------------------------------------------------------
+class CPoseBatch
+{
+  public:
+    static const int MAX_CHANNELS = 16;
+
+    void   Resize(size_t NumPoses, size_t NumSeries = 1);
+    size_t GetNumPoses() const { return m_NumPoses; };
+    size_t GetNumSeries() const { return m_NumSeries; };
+
+    double       *GetT(int Index) { return m_T[Index].data(); };
+    const double *GetT(int Index) const { return m_T[Index].data(); };
+    double       *GetAngles(int Channel) { return m_Angles[Channel].data(); };
+    const double *GetAngles(int Channel) const { return m_Angles[Channel].data(); };
+
+    // one pose as the 16 doubles of a T4x4 or as NumAngles channels
+    void SetT4x4(size_t Pose, const double *T4x4);
+    void GetT4x4(size_t Pose, double *T4x4) const;
+    void SetAngles(size_t Pose, const double *Angles, int NumAngles);
+    void GetAngles(size_t Pose, double *Angles, int NumAngles) const;
+
+  protected:
+    size_t              m_NumPoses  = 0;
+    size_t              m_NumSeries = 1;
+    std::vector<double> m_T[16];
+    std::vector<double> m_Angles[MAX_CHANNELS];
+};
+
 class COrientation
 {
   public:
@@ -76,6 +117,13 @@ class COrientation
     virtual void From4x4(double *T4x4, double *Angles) { ; };
     virtual void From4x4Unwrap(double *T4x4, double AnglesPrev[], double *Angles) { From4x4(T4x4, Angles); };
 
+  public: // the same for a batch, bit for bit equal to the calls per pose, see OrientationBatch.cpp
+    virtual void ToT4x4Batch(CPoseBatch &Batch);
+    virtual void From4x4Batch(CPoseBatch &Batch);
+    // AnglesPrev : the channels of every series in the frame before the batch, NumSeries x channels,
+    // nullptr converts the first frame without unwrapping
+    virtual void From4x4UnwrapBatch(CPoseBatch &Batch, const double *AnglesPrev);
+
   public: // getting indices into matrices, these are 0-based
     virtual int GetIndexPos();
     virtual int GetIndexOrient();
@@ -97,6 +145,9 @@ class COrientationRollPitchYaw : public COrientation
     void ToT4x4(double *Angles, double *T4x4) override;
     void From4x4(double *T4x4, double *Angles) override;
     void From4x4Unwrap(double *T4x4, double AnglesPrev[], double *Angles) override;
+    void ToT4x4Batch(CPoseBatch &Batch) override;
+    void From4x4Batch(CPoseBatch &Batch) override;
+    void From4x4UnwrapBatch(CPoseBatch &Batch, const double *AnglesPrev) override;
 };
 
 class COrientationSteerCamberSpin : public COrientation
@@ -106,6 +157,9 @@ class COrientationSteerCamberSpin : public COrientation
     void ToT4x4(double *Angles, double *T4x4) override;
     void From4x4(double *T4x4, double *Angles) override;
     void From4x4Unwrap(double *T4x4, double *AnglesPrev, double *Angles) override;
+    void ToT4x4Batch(CPoseBatch &Batch) override;
+    void From4x4Batch(CPoseBatch &Batch) override;
+    void From4x4UnwrapBatch(CPoseBatch &Batch, const double *AnglesPrev) override;
 };
 
 class COrientationSkrew : public COrientation
@@ -115,6 +169,9 @@ class COrientationSkrew : public COrientation
     void ToT4x4(double *Angles, double *T4x4) override;
     void From4x4(double *T4x4, double *Angles) override;
     void From4x4Unwrap(double *T4x4, double *AnglesPrev, double *Angles) override;
+    void ToT4x4Batch(CPoseBatch &Batch) override;
+    void From4x4Batch(CPoseBatch &Batch) override;
+    void From4x4UnwrapBatch(CPoseBatch &Batch, const double *AnglesPrev) override;
 };
 
 class COrientationKukaABC : public COrientation
@@ -124,6 +181,9 @@ class COrientationKukaABC : public COrientation
     void ToT4x4(double *Angles, double *T4x4) override;
     void From4x4(double *T4x4, double *Angles) override;
     void From4x4Unwrap(double *T4x4, double *AnglesPrev, double *Angles) override;
+    void ToT4x4Batch(CPoseBatch &Batch) override;
+    void From4x4Batch(CPoseBatch &Batch) override;
+    void From4x4UnwrapBatch(CPoseBatch &Batch, const double *AnglesPrev) override;
 };
 
 class COrientationQuaternion : public COrientation
@@ -132,6 +192,9 @@ class COrientationQuaternion : public COrientation
     COrientationQuaternion();
     void        ToT4x4(double *Angles, double *T4x4) override;
     void        From4x4(double *T4x4, double *Angles) override;
+    void        ToT4x4Batch(CPoseBatch &Batch) override;
+    void        From4x4Batch(CPoseBatch &Batch) override;
+    void        From4x4UnwrapBatch(CPoseBatch &Batch, const double *AnglesPrev) override;
     std::string GetBaseUnit() override { return ""; };
     int         GetIndex3x3() override;
     int         GetIndex3x3Next() override;
@@ -151,6 +214,9 @@ class COrientationZVector : public COrientation
     COrientationZVector();
     void        ToT4x4(double *Angles, double *T4x4) override;
     void        From4x4(double *T4x4, double *Angles) override;
+    void        ToT4x4Batch(CPoseBatch &Batch) override;
+    void        From4x4Batch(CPoseBatch &Batch) override;
+    void        From4x4UnwrapBatch(CPoseBatch &Batch, const double *AnglesPrev) override;
     std::string GetBaseUnit() override { return ""; };
 };
 
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+CSPSCQueue : bounded lock-free single producer / single consumer ring
+
+One thread calls TryPush, one other thread calls TryPop / Drain. The capacity is rounded up to a power of two,
+head and tail live on separate cache lines and each side caches the other side's index, so an uncontended
+push or pop touches no shared cache line. When the ring is full TryPush fails and the caller decides whether
+to drop or retry.
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+template <typename T> class CSPSCQueue
+{
+  public:
+    explicit CSPSCQueue(size_t Capacity = 1024)
+    {
+        size_t Size = 2;
+        while (Size < Capacity)
+        {
+            Size <<= 1;
+        }
+        m_Buffer.resize(Size);
+        m_Mask = Size - 1;
+    }
+    CSPSCQueue(const CSPSCQueue &)            = delete;
+    CSPSCQueue &operator=(const CSPSCQueue &) = delete;
+
+    // producer
+    bool TryPush(const T &Value)
+    {
+        const size_t Tail = m_Tail.load(std::memory_order_relaxed);
+        if (Tail - m_CachedHead > m_Mask)
+        {
+            m_CachedHead = m_Head.load(std::memory_order_acquire);
+            if (Tail - m_CachedHead > m_Mask)
+            {
+                return false; // full
+            }
+        }
+        m_Buffer[Tail & m_Mask] = Value;
+        m_Tail.store(Tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer
+    bool TryPop(T &Value)
+    {
+        const size_t Head = m_Head.load(std::memory_order_relaxed);
+        if (Head == m_CachedTail)
+        {
+            m_CachedTail = m_Tail.load(std::memory_order_acquire);
+            if (Head == m_CachedTail)
+            {
+                return false; // empty
+            }
+        }
+        Value = m_Buffer[Head & m_Mask];
+        m_Head.store(Head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer : hand everything that is queued now to Function(const T &), returns the number of items
+    template <typename F> size_t Drain(F &&Function)
+    {
+        const size_t Head = m_Head.load(std::memory_order_relaxed);
+        m_CachedTail      = m_Tail.load(std::memory_order_acquire);
+        for (size_t i = Head; i != m_CachedTail; i++)
+        {
+            Function(m_Buffer[i & m_Mask]);
+        }
+        m_Head.store(m_CachedTail, std::memory_order_release);
+        return m_CachedTail - Head;
+    }
+
+    size_t GetCapacity() const { return m_Mask + 1; }
+    size_t GetSizeApprox() const { return m_Tail.load(std::memory_order_acquire) - m_Head.load(std::memory_order_acquire); }
+
+  protected:
+    std::vector<T> m_Buffer;
+    size_t         m_Mask = 0;
+
+    alignas(64) std::atomic<size_t> m_Head{0}; // written by the consumer
+    size_t m_CachedTail = 0;                   // consumer copy of m_Tail
+    alignas(64) std::atomic<size_t> m_Tail{0}; // written by the producer
+    size_t m_CachedHead = 0;                   // producer copy of m_Head
+};
@@ -0,0 +1,435 @@
+#include "SimulationFile.h"
+#include "FileReader.h"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+constexpr char     SIM_MAGIC[8]       = {'C', 'T', 'R', 'K', 'S', 'I', 'M', '\0'};
+constexpr uint32_t SIM_VERSION        = 2;
+constexpr size_t   SIM_FIXED_HEADER   = 48;
+constexpr size_t   SIM_V1_HEADER      = 32; // version 1 has no source size and time
+constexpr uint64_t SIM_DATA_ALIGNMENT = 64;
+
+template <typename T> void Put(std::vector<char> &Buffer, const T &Value)
+{
+    const char *p = reinterpret_cast<const char *>(&Value);
+    Buffer.insert(Buffer.end(), p, p + sizeof(T));
+}
+
+template <typename T> T Get(const unsigned char *p)
+{
+    T Value;
+    std::memcpy(&Value, p, sizeof(T));
+    return Value;
+}
+
+// size and last write time of the text file a recording was converted from
+struct SourceStamp
+{
+    uint64_t Size      = 0;
+    int64_t  WriteTime = 0;
+
+    bool operator==(const SourceStamp &Other) const { return Size == Other.Size && WriteTime == Other.WriteTime; }
+};
+
+bool GetSourceStamp(const std::string &fileName, SourceStamp &Stamp)
+{
+    std::error_code ec;
+    Stamp.Size = std::filesystem::file_size(fileName, ec);
+    if (ec)
+        return false;
+    Stamp.WriteTime = static_cast<int64_t>(std::filesystem::last_write_time(fileName, ec).time_since_epoch().count());
+    return !ec;
+}
+
+// FNV-1a, stable between builds so a sidecar in the temp folder keeps its name
+uint64_t HashPath(const std::string &Path)
+{
+    uint64_t Hash = 0xcbf29ce484222325ull;
+    for (unsigned char c : Path)
+    {
+        Hash = (Hash ^ c) * 0x100000001b3ull;
+    }
+    return Hash;
+}
+
+// source stamp of a converted recording, false for a missing file, a version 1 file or one that was not converted from text
+bool ReadSourceStamp(const std::string &fileName, SourceStamp &Stamp)
+{
+    std::ifstream File(fileName, std::ios::binary);
+    unsigned char Header[SIM_FIXED_HEADER] = {};
+    File.read(reinterpret_cast<char *>(Header), sizeof(Header));
+    if (File.gcount() != sizeof(Header) || std::memcmp(Header, SIM_MAGIC, sizeof(SIM_MAGIC)) != 0 || Get<uint32_t>(Header + 8) != SIM_VERSION)
+    {
+        return false;
+    }
+    Stamp.Size      = Get<uint64_t>(Header + 32);
+    Stamp.WriteTime = Get<int64_t>(Header + 40);
+    return Stamp.Size != 0;
+}
+
+// fixed header and channel table padded to the data offset, the number of rows is patched once the rows are written
+std::vector<char> MakeHeader(size_t NumChannels, const std::vector<std::string> &ChannelNames, const std::vector<int> &ChannelTypes, const SourceStamp &Source)
+{
+    std::vector<char> Header(SIM_MAGIC, SIM_MAGIC + sizeof(SIM_MAGIC));
+    Put<uint32_t>(Header, SIM_VERSION);
+    Put<uint32_t>(Header, static_cast<uint32_t>(NumChannels));
+    Put<uint64_t>(Header, 0); // number of rows
+    Put<uint64_t>(Header, 0); // data offset, patched below
+    Put<uint64_t>(Header, Source.Size);
+    Put<int64_t>(Header, Source.WriteTime);
+    for (size_t i = 0; i < NumChannels; i++)
+    {
+        std::string Name = i < ChannelNames.size() ? ChannelNames[i] : fmt::format("column_{}", i);
+        int32_t     Type = i < ChannelTypes.size() ? ChannelTypes[i] : 0;
+        Put<int32_t>(Header, Type);
+        Put<uint32_t>(Header, static_cast<uint32_t>(Name.size()));
+        Header.insert(Header.end(), Name.begin(), Name.end());
+    }
+    uint64_t DataOffset = (Header.size() + SIM_DATA_ALIGNMENT - 1) / SIM_DATA_ALIGNMENT * SIM_DATA_ALIGNMENT;
+    Header.resize(static_cast<size_t>(DataOffset), 0);
+    std::memcpy(Header.data() + 24, &DataOffset, sizeof(DataOffset));
+    return Header;
+}
+} // namespace
+
+CSimulationFile::~CSimulationFile()
+{
+    Close();
+}
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+Open / close
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+void CSimulationFile::Open(const std::string &fileName)
+{
+    Close();
+
+#ifdef _WIN32
+    HANDLE hFile = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (hFile == INVALID_HANDLE_VALUE)
+    {
+        throw std::runtime_error(fmt::format("Cannot open simulation file : {}", fileName));
+    }
+    LARGE_INTEGER Size;
+    if (!GetFileSizeEx(hFile, &Size) || Size.QuadPart == 0)
+    {
+        CloseHandle(hFile);
+        throw std::runtime_error(fmt::format("Empty simulation file : {}", fileName));
+    }
+    HANDLE hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void  *pBase    = hMapping ? MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (pBase == nullptr)
+    {
+        if (hMapping)
+            CloseHandle(hMapping);
+        CloseHandle(hFile);
+        throw std::runtime_error(fmt::format("Cannot map simulation file : {}", fileName));
+    }
+    m_hFile    = hFile;
+    m_hMapping = hMapping;
+    m_pMapBase = pBase;
+    m_MapSize  = static_cast<uint64_t>(Size.QuadPart);
+#else
+    int fd = ::open(fileName.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw std::runtime_error(fmt::format("Cannot open simulation file : {}", fileName));
+    }
+    struct stat Stat;
+    if (fstat(fd, &Stat) != 0 || Stat.st_size == 0)
+    {
+        ::close(fd);
+        throw std::runtime_error(fmt::format("Empty simulation file : {}", fileName));
+    }
+    void *pBase = mmap(nullptr, static_cast<size_t>(Stat.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    if (pBase == MAP_FAILED)
+    {
+        ::close(fd);
+        throw std::runtime_error(fmt::format("Cannot map simulation file : {}", fileName));
+    }
+    madvise(pBase, static_cast<size_t>(Stat.st_size), MADV_SEQUENTIAL);
+    m_fd       = fd;
+    m_pMapBase = pBase;
+    m_MapSize  = static_cast<uint64_t>(Stat.st_size);
+#endif
+
+    try
+    {
+        ReadHeader(static_cast<const unsigned char *>(m_pMapBase), m_MapSize);
+    }
+    catch (const std::runtime_error &e)
+    {
+        Close();
+        throw std::runtime_error(fmt::format("{} : {}", e.what(), fileName));
+    }
+}
+
+void CSimulationFile::ReadHeader(const unsigned char *pBase, uint64_t fileSize)
+{
+    if (fileSize < SIM_V1_HEADER || std::memcmp(pBase, SIM_MAGIC, sizeof(SIM_MAGIC)) != 0)
+    {
+        throw std::runtime_error("Not a binary simulation file");
+    }
+    uint32_t Version     = Get<uint32_t>(pBase + 8);
+    uint32_t NumChannels = Get<uint32_t>(pBase + 12);
+    uint64_t NumRows     = Get<uint64_t>(pBase + 16);
+    uint64_t DataOffset  = Get<uint64_t>(pBase + 24);
+    if (Version != 1 && Version != SIM_VERSION)
+    {
+        throw std::runtime_error(fmt::format("Unsupported simulation file version {}", Version));
+    }
+    const uint64_t FixedHeader = Version == 1 ? SIM_V1_HEADER : SIM_FIXED_HEADER;
+    if (NumChannels == 0 || DataOffset % SIM_DATA_ALIGNMENT != 0 || DataOffset < FixedHeader || DataOffset > fileSize ||
+        (fileSize - DataOffset) / (sizeof(double) * NumChannels) < NumRows)
+    {
+        throw std::runtime_error("Corrupt simulation file header");
+    }
+
+    m_ChannelNames.clear();
+    m_ChannelTypes.clear();
+    uint64_t Offset = FixedHeader;
+    for (uint32_t i = 0; i < NumChannels; i++)
+    {
+        if (Offset + 8 > DataOffset)
+        {
+            throw std::runtime_error("Corrupt simulation file channel table");
+        }
+        int32_t  Type   = Get<int32_t>(pBase + Offset);
+        uint32_t Length = Get<uint32_t>(pBase + Offset + 4);
+        Offset += 8;
+        if (Offset + Length > DataOffset)
+        {
+            throw std::runtime_error("Corrupt simulation file channel table");
+        }
+        m_ChannelTypes.push_back(Type);
+        m_ChannelNames.emplace_back(reinterpret_cast<const char *>(pBase + Offset), Length);
+        Offset += Length;
+    }
+
+    m_NumChannels = NumChannels;
+    m_NumRows     = static_cast<size_t>(NumRows);
+    m_pData       = reinterpret_cast<const double *>(pBase + DataOffset);
+}
+
+void CSimulationFile::SetData(std::vector<double> &&Values, size_t NumChannels)
+{
+    Close();
+    m_OwnedData   = std::move(Values);
+    m_NumChannels = NumChannels;
+    m_NumRows     = NumChannels ? m_OwnedData.size() / NumChannels : 0;
+    m_pData       = m_NumRows ? m_OwnedData.data() : nullptr;
+    m_ChannelNames.clear();
+    m_ChannelTypes.assign(NumChannels, 0);
+    for (size_t i = 0; i < NumChannels; i++)
+    {
+        m_ChannelNames.push_back(fmt::format("column_{}", i));
+    }
+}
+
+void CSimulationFile::Close()
+{
+#ifdef _WIN32
+    if (m_pMapBase)
+        UnmapViewOfFile(m_pMapBase);
+    if (m_hMapping)
+        CloseHandle(static_cast<HANDLE>(m_hMapping));
+    if (m_hFile)
+        CloseHandle(static_cast<HANDLE>(m_hFile));
+    m_hFile    = nullptr;
+    m_hMapping = nullptr;
+#else
+    if (m_pMapBase)
+        munmap(m_pMapBase, static_cast<size_t>(m_MapSize));
+    if (m_fd >= 0)
+        ::close(m_fd);
+    m_fd = -1;
+#endif
+    m_pMapBase    = nullptr;
+    m_MapSize     = 0;
+    m_pData       = nullptr;
+    m_NumRows     = 0;
+    m_NumChannels = 0;
+    m_OwnedData.clear();
+    m_OwnedData.shrink_to_fit();
+}
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+Conversion from text
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+bool CSimulationFile::IsBinaryFile(const std::string &fileName)
+{
+    std::ifstream File(fileName, std::ios::binary);
+    char          Magic[sizeof(SIM_MAGIC)] = {};
+    File.read(Magic, sizeof(Magic));
+    return File.gcount() == sizeof(Magic) && std::memcmp(Magic, SIM_MAGIC, sizeof(SIM_MAGIC)) == 0;
+}
+
+size_t CSimulationFile::ConvertFromText(const std::string &textFile, const std::string &binaryFile, const std::vector<std::string> &ChannelNames,
+                                        const std::vector<int> &ChannelTypes)
+{
+    if (!std::ifstream(textFile))
+    {
+        throw std::runtime_error(fmt::format("Cannot open simulation file : {}", textFile));
+    }
+
+    // stamped before reading, a text file changed during the conversion is converted again next time
+    SourceStamp Source;
+    GetSourceStamp(textFile, Source);
+
+    // write to a temporary file so an interrupted conversion never leaves a valid looking recording
+    std::string TempFile = binaryFile + ".tmp";
+
+    // the text is streamed in windows parsed in parallel chunks, the first window fixes the number of columns,
+    // a later window with longer rows only sets the final count and the file is written again with it
+    size_t   NumChannels = 0;
+    uint64_t NumRows     = 0;
+    for (;;)
+    {
+        std::ofstream Output(TempFile, std::ios::binary | std::ios::trunc);
+        if (!Output)
+        {
+            throw std::runtime_error(fmt::format("Cannot create binary simulation file : {}", binaryFile));
+        }
+
+        size_t              LongestRow = NumChannels;
+        std::vector<double> Padded;
+        bool                HeaderWritten = false;
+        NumRows                           = 0;
+        FileReader::ReadNumberMatrixWindows(textFile, [&](const FileReader::NumberMatrix &Window) {
+            if (!HeaderWritten)
+            {
+                NumChannels = LongestRow = std::max(NumChannels, Window.NumColumns);
+                HeaderWritten            = true;
+                std::vector<char> Header = MakeHeader(NumChannels, ChannelNames, ChannelTypes, Source);
+                Output.write(Header.data(), Header.size());
+            }
+            LongestRow = std::max(LongestRow, Window.NumColumns);
+            if (LongestRow > NumChannels)
+            {
+                return; // written again with LongestRow columns
+            }
+
+            // rows shorter than NumChannels are padded with NaN
+            const double *pValues = Window.Values.data();
+            if (Window.NumColumns < NumChannels)
+            {
+                Padded.assign(Window.NumRows * NumChannels, std::numeric_limits<double>::quiet_NaN());
+                for (size_t Row = 0; Row < Window.NumRows; Row++)
+                {
+                    std::copy(Window.GetRow(Row), Window.GetRow(Row) + Window.NumColumns, Padded.data() + Row * NumChannels);
+                }
+                pValues = Padded.data();
+            }
+            Output.write(reinterpret_cast<const char *>(pValues), Window.NumRows * NumChannels * sizeof(double));
+            NumRows += Window.NumRows;
+        });
+
+        if (NumChannels == 0)
+        {
+            Output.close();
+            std::filesystem::remove(TempFile);
+            throw std::runtime_error(fmt::format("No data read from file : {}", textFile));
+        }
+        if (LongestRow > NumChannels)
+        {
+            NumChannels = LongestRow;
+            continue;
+        }
+
+        Output.seekp(16);
+        Output.write(reinterpret_cast<const char *>(&NumRows), sizeof(NumRows));
+        Output.close();
+        if (!Output)
+        {
+            std::filesystem::remove(TempFile);
+            throw std::runtime_error(fmt::format("Error writing binary simulation file : {}", binaryFile));
+        }
+        break;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(TempFile, binaryFile, ec);
+    if (ec)
+    {
+        std::filesystem::remove(TempFile, ec);
+        throw std::runtime_error(fmt::format("Cannot create binary simulation file : {}", binaryFile));
+    }
+    return static_cast<size_t>(NumRows);
+}
+
+std::string CSimulationFile::PrepareBinary(const std::string &simulationFile, const std::vector<std::string> &ChannelNames,
+                                           const std::vector<int> &ChannelTypes)
+{
+    namespace fs = std::filesystem;
+    if (IsBinaryFile(simulationFile))
+    {
+        return simulationFile;
+    }
+    if (!fs::exists(simulationFile))
+    {
+        throw std::runtime_error(fmt::format("Simulation file not found : {}", simulationFile));
+    }
+
+    // the temp folder is shared by recordings of the same name in different folders, the name carries a hash of the full path
+    std::vector<fs::path> Candidates = {fs::path(simulationFile + EXTENSION)};
+    std::error_code       ec;
+    fs::path              TempFolder = fs::temp_directory_path(ec);
+    if (!ec)
+    {
+        fs::path Absolute = fs::absolute(simulationFile, ec).lexically_normal();
+        Candidates.push_back(TempFolder / fmt::format("{}.{:016x}{}", Absolute.filename().string(), HashPath(Absolute.string()), EXTENSION));
+    }
+
+    // reuse a conversion of this very text file, same size and last write time
+    SourceStamp Source;
+    if (GetSourceStamp(simulationFile, Source))
+    {
+        for (const fs::path &Candidate : Candidates)
+        {
+            SourceStamp Converted;
+            if (ReadSourceStamp(Candidate.string(), Converted) && Converted == Source)
+            {
+                return Candidate.string();
+            }
+        }
+    }
+
+    std::string Error;
+    for (const fs::path &Candidate : Candidates)
+    {
+        try
+        {
+            ConvertFromText(simulationFile, Candidate.string(), ChannelNames, ChannelTypes);
+            return Candidate.string();
+        }
+        catch (const std::runtime_error &e)
+        {
+            Error = e.what();
+        }
+    }
+    throw std::runtime_error(Error);
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+Binary simulation recording
+
+    offset  size        content
+    0       8           magic "CTRKSIM\0"
+    8       4           format version (2)
+    12      4           number of channels (columns)
+    16      8           number of rows
+    24      8           offset of the first row, multiple of 64
+    32      8           size of the text file it was converted from, 0 when it was not converted
+    40      8           last write time of that text file, in file clock ticks
+    48      ...         per channel : int32 type, uint32 name length, name bytes (no terminator)
+    ...     ...         zero padding up to the data offset
+    data    rows*cols*8 doubles, row major, little endian
+
+The file is memory mapped, rows are paged in by the OS when Run() reaches them, so opening is instant
+regardless of the file size. Text recordings are converted once with ConvertFromText.
+Version 1 files have no source size and time, the channel table starts at offset 32.
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+class CSimulationFile
+{
+  public:
+    static constexpr char const *EXTENSION = ".ctsim";
+
+  public:
+    CSimulationFile() = default;
+    ~CSimulationFile();
+    CSimulationFile(const CSimulationFile &)            = delete;
+    CSimulationFile &operator=(const CSimulationFile &) = delete;
+
+    // map a binary recording, throws std::runtime_error on failure
+    void Open(const std::string &fileName);
+    // take ownership of rows generated in memory, Values is row major with NumChannels columns
+    void SetData(std::vector<double> &&Values, size_t NumChannels);
+    void Close();
+
+    bool          IsOpen() const { return m_pData != nullptr; }
+    size_t        GetNumRows() const { return m_NumRows; }
+    size_t        GetNumChannels() const { return m_NumChannels; }
+    const double *GetRow(size_t Row) const { return m_pData + Row * m_NumChannels; }
+
+    const std::vector<std::string> &GetChannelNames() const { return m_ChannelNames; }
+    const std::vector<int>         &GetChannelTypes() const { return m_ChannelTypes; }
+
+    // convert a text recording (any FileReader format) into a binary recording, returns the number of rows
+    // the longest row sets the number of columns, shorter rows are padded with NaN
+    // columns beyond ChannelNames are named "column_<n>" with type 0
+    // the text is streamed in bounded windows, memory does not grow with the file size
+    static size_t ConvertFromText(const std::string &textFile, const std::string &binaryFile, const std::vector<std::string> &ChannelNames,
+                                  const std::vector<int> &ChannelTypes);
+
+    // binary file to use for a simulation file : the file itself if it is binary, otherwise a converted sidecar
+    // next to the text file (or in the temp folder, named with a hash of the full path) that is rebuilt
+    // unless its header records the current size and last write time of the text file
+    static std::string PrepareBinary(const std::string &simulationFile, const std::vector<std::string> &ChannelNames, const std::vector<int> &ChannelTypes);
+
+    static bool IsBinaryFile(const std::string &fileName);
+
+  protected:
+    void ReadHeader(const unsigned char *pBase, uint64_t fileSize);
+
+  protected:
+    const double            *m_pData       = nullptr;
+    size_t                   m_NumRows     = 0;
+    size_t                   m_NumChannels = 0;
+    std::vector<std::string> m_ChannelNames;
+    std::vector<int>         m_ChannelTypes;
+
+    // mapping
+    void                    *m_pMapBase    = nullptr;
+    uint64_t                 m_MapSize     = 0;
+#ifdef _WIN32
+    void                    *m_hFile       = nullptr;
+    void                    *m_hMapping    = nullptr;
+#else
+    int                      m_fd          = -1;
+#endif
+
+    // in memory data
+    std::vector<double>      m_OwnedData;
+};
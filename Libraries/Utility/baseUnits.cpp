@@ -2,6 +2,9 @@
 #include "../XML/TinyXML_AttributeValues.h"
 #include <string>
 #include <fmt/core.h>
+#include <fmt/format.h>
+#include <algorithm>
+#include <iterator>
 
 std::vector<CConversion> Conventions_Velocity     = {{"mm/s", 1.0, 3}, {"m/s", 0.001, 5}, {"km/h", 0.0036, 6}};
 std::vector<CConversion> Conventions_Acceleration = {{"mm/s2", 1.0, 3}, {"m/s2", 0.001, 6}, {"g", 0.00010193679918451, 2}};
@@ -148,3 +151,91 @@ std::string CBaseUnits::GetFormatString(const std::string &iBaseUnit, int Defaul
     FormatString = fmt::format("%.{}f", GetNumDecimals(iBaseUnit, DefaultNumDecimals));
     return FormatString;
 }
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+CUnitPlan
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+void CUnitPlan::Compile(CBaseUnits &Units, const std::vector<std::string> &BaseUnits, int DefaultNumDecimals)
+{
+    m_Factors.clear();
+    m_NumDecimals.clear();
+    m_Units.clear();
+    m_FormatStrings.clear();
+    m_bIdentity = true;
+
+    // channels share a handful of base units, each is looked up once
+    std::map<std::string, size_t> mapResolved;
+    for (const auto &BaseUnit : BaseUnits)
+    {
+        auto iterResolved = mapResolved.find(BaseUnit);
+        if (iterResolved == mapResolved.end())
+        {
+            m_Factors.push_back(Units.GetConversionFactor(BaseUnit));
+            m_NumDecimals.push_back(Units.GetNumDecimals(BaseUnit, DefaultNumDecimals));
+            m_Units.push_back(Units.GetUnit(BaseUnit));
+            m_FormatStrings.push_back(fmt::format("%.{}f", m_NumDecimals.back()));
+            mapResolved.emplace(BaseUnit, m_Factors.size() - 1);
+        }
+        else
+        {
+            size_t Index = iterResolved->second;
+            m_Factors.push_back(m_Factors[Index]);
+            m_NumDecimals.push_back(m_NumDecimals[Index]);
+            m_Units.push_back(m_Units[Index]);
+            m_FormatStrings.push_back(m_FormatStrings[Index]);
+        }
+        if (m_Factors.back() != 1.0)
+            m_bIdentity = false;
+    }
+}
+
+void CUnitPlan::Convert(const double *pBase, double *pOut, size_t NumValues) const
+{
+    const size_t NumChannels = m_Factors.size();
+    if (NumChannels == 0)
+        return;
+    if (m_bIdentity)
+    {
+        if (pOut != pBase)
+            std::copy(pBase, pBase + NumValues, pOut);
+        return;
+    }
+
+    // the inner loop runs over the factors of one frame, contiguous on both sides so that it vectorizes
+    const double *pFactors = m_Factors.data();
+    size_t        Frame    = 0;
+    for (; Frame + NumChannels <= NumValues; Frame += NumChannels)
+    {
+        const double *pIn = pBase + Frame;
+        double       *pTo = pOut + Frame;
+        for (size_t i = 0; i < NumChannels; i++)
+            pTo[i] = pIn[i] * pFactors[i];
+    }
+
+    // a trailing partial frame uses the factors of its channels, as the identity path copies it
+    for (size_t i = 0; Frame + i < NumValues; i++)
+        pOut[Frame + i] = pBase[Frame + i] * pFactors[i];
+}
+
+void CUnitPlan::AppendText(const double *pBase, size_t NumValues, std::string &Text, char Separator) const
+{
+    const size_t NumChannels = m_Factors.size();
+    if (NumChannels == 0)
+        return;
+
+    Text.reserve(Text.size() + NumValues * 12);
+    auto Out = std::back_inserter(Text);
+    for (size_t Frame = 0; Frame + NumChannels <= NumValues; Frame += NumChannels)
+    {
+        for (size_t i = 0; i < NumChannels; i++)
+        {
+            if (i)
+                Text.push_back(Separator);
+            fmt::format_to(Out, "{:.{}f}", pBase[Frame + i] * m_Factors[i], m_NumDecimals[i]);
+        }
+        Text.push_back('\n');
+    }
+}
@@ -73,3 +73,47 @@ class CBaseUnits
     std::map<std::string, std::vector<CConversion>> m_mapConversions;
     std::map<std::string, int>                      m_mapConversionChoice;
 };
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+CUnitPlan : the conversions of a fixed list of channels, resolved once
+
+Compile looks up the base unit of every channel in CBaseUnits and keeps the factor, the number of decimals, the
+unit name and the format string per channel. A frame is NumChannels values, a block is any number of frames one
+after the other : Convert multiplies the whole block with the factors without a single string lookup.
+
+Compile again after a unit choice or a number of decimals changed in CBaseUnits.
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+class CUnitPlan
+{
+  public:
+    CUnitPlan() = default;
+    CUnitPlan(CBaseUnits &Units, const std::vector<std::string> &BaseUnits, int DefaultNumDecimals = 3) { Compile(Units, BaseUnits, DefaultNumDecimals); }
+
+  public:
+    void Compile(CBaseUnits &Units, const std::vector<std::string> &BaseUnits, int DefaultNumDecimals = 3);
+
+    size_t             GetNumChannels() const { return m_Factors.size(); }
+    bool               IsIdentity() const { return m_bIdentity; }
+    double             GetConversionFactor(size_t Channel) const { return m_Factors[Channel]; }
+    int                GetNumDecimals(size_t Channel) const { return m_NumDecimals[Channel]; }
+    const std::string &GetUnit(size_t Channel) const { return m_Units[Channel]; }
+    const std::string &GetFormatString(size_t Channel) const { return m_FormatStrings[Channel]; }
+
+    // NumValues is normally a multiple of GetNumChannels(), a trailing partial frame is converted channel by channel,
+    // pOut may be pBase
+    void Convert(const double *pBase, double *pOut, size_t NumValues) const;
+    void Convert(std::vector<double> &Values) const { Convert(Values.data(), Values.data(), Values.size()); }
+
+    // appends the converted frames as text, one line per frame with the channels separated by Separator
+    void AppendText(const double *pBase, size_t NumValues, std::string &Text, char Separator = '\t') const;
+
+  protected:
+    std::vector<double>      m_Factors;
+    std::vector<int>         m_NumDecimals;
+    std::vector<std::string> m_Units;
+    std::vector<std::string> m_FormatStrings;
+    bool                     m_bIdentity = true;
+};
@@ -75,6 +75,25 @@ namespace ProxyMsg
     // Params: { "type": "...", "message": "..." }
     constexpr char const *Event = "EVENT";
 
+    //--------------------------------------------------------------------------
+    // Diagnostics
+    //--------------------------------------------------------------------------
+    // Pipeline latency histograms of the data telegrams
+    // Params: { "reset": bool, "trailer": bool } / Response: { "latency": {...}, "trailer": bool }
+    constexpr char const *Diagnostics = "proxy.diagnostics";
+
+    // Snapshot of the metrics registry (counters, gauges, histograms)
+    // Params: { "reset": bool, "log_interval": seconds } / Response: { "metrics": {...}, "log_interval": seconds }
+    constexpr char const *Metrics = "proxy.metrics";
+
+    // Write the flight recorder rings as a Chrome trace, see FlightRecorder.h
+    // Params: { "file": path, "flight_recorder": bool } / Response: { "file": path, "flight_recorder": bool }
+    constexpr char const *DumpTrace = "proxy.dump_trace";
+
+    // Tracy zone categories and 1-in-N sampling of the per-frame zones, see ProfilingControl.h
+    // Params: { "enabled": bool, "categories": [...], "sample_every": N } all optional / Response: the same, current values
+    constexpr char const *Profiling = "proxy.profiling";
+
 } // namespace ProxyMsg
 
 //==============================================================================
@@ -179,6 +198,20 @@ namespace ProxyParam
     //--------------------------------------------------------------------------
     constexpr char const *SimFilePath = "filepath";
 
+    //--------------------------------------------------------------------------
+    // Diagnostics Parameters
+    //--------------------------------------------------------------------------
+    constexpr char const *Latency        = "latency";
+    constexpr char const *Trailer        = "trailer";
+    constexpr char const *Reset          = "reset";
+    constexpr char const *Metrics        = "metrics";
+    constexpr char const *LogInterval    = "log_interval";
+    constexpr char const *TraceFile      = "file";
+    constexpr char const *FlightRecorder = "flight_recorder";
+    constexpr char const *Enabled        = "enabled";
+    constexpr char const *Categories     = "categories";
+    constexpr char const *SampleEvery    = "sample_every";
+
 } // namespace ProxyParam
 
 //==============================================================================
@@ -228,9 +261,32 @@ namespace ButtonValue
 
 namespace ProxyCmdLine
 {
-    constexpr char const *Serial      = "serial";
-    constexpr char const *ShowConsole = "showconsole";
-    constexpr char const *TcpPort     = "tcpport";
-    constexpr char const *Profiling   = "profiling";
+    constexpr char const *Serial           = "serial";
+    constexpr char const *ShowConsole      = "showconsole";
+    constexpr char const *TcpPort          = "tcpport";
+    constexpr char const *Profiling        = "profiling";
+    constexpr char const *Timestamps       = "timestamps"; // append pipeline timestamps to data telegrams
+    constexpr char const *MetricsLog       = "metrics_log"; // seconds between metrics snapshots in the log, 0 = off
+    constexpr char const *FlightRecorder   = "flight_recorder"; // entries per thread ring of the zone flight recorder, 0 = off
+    constexpr char const *ProfilingControl = "profiling_control"; // proxy.profiling params applied at startup
+
+    // Synthetic device stream instead of real hardware (offline benchmarking)
+    constexpr char const *Synthetic          = "synthetic";
+    constexpr char const *SyntheticSubjects  = "synthetic_subjects";
+    constexpr char const *SyntheticMarkers   = "synthetic_markers";
+    constexpr char const *SyntheticUnlabeled = "synthetic_unlabeled";
+    constexpr char const *SyntheticRate      = "synthetic_rate";
+    constexpr char const *SyntheticReplay    = "synthetic_replay";
+
+    // Additional simulated devices, each on its own TCP port (Template proxy)
+    constexpr char const *SimDevices        = "sim_devices"; // count, or array of {"rate": Hz, "channels": n}
+    constexpr char const *SimDeviceRate     = "sim_device_rate";
+    constexpr char const *SimDeviceChannels = "sim_device_channels";
+    constexpr char const *SimAutoStart      = "sim_autostart";
+
+    // Unattended StressTest replay, the proxy exits with 1 when a threshold is crossed
+    constexpr char const *StressReplay      = "stress_replay";       // replay file, see StressTest::ReplayScript
+    constexpr char const *StressReplaySpeed = "stress_replay_speed"; // overrides the speed of the file
+    constexpr char const *StressClients     = "stress_clients";      // client count or ClientStressConfig object, starts ClientStressTest
 
 } // namespace ProxyCmdLine
@@ -1,6 +1,7 @@
 #include "TinyXML_AttributeValues.h"
 #include "MinMax.h"
 #include "TinyXML_Base64.h"
+#include "../TCP/Message.h"
 #include <algorithm>
 #include <iostream>
 #include <string>
@@ -30,20 +31,30 @@ bool GetSetAttributeTime(TiXmlElement *pXML, const char *AttributeName, time_t &
     return Success;
 }
 
+// strict SIMD decode, texts with other characters in them go through the lenient template
+static void DecodeBase64(const char *pText, std::vector<char> &Bytes)
+{
+    const size_t NumChars = strlen(pText);
+    if (!base64::Decode(pText, NumChars, Bytes))
+    {
+        Bytes.clear();
+        base64::decode(pText, pText + NumChars, back_inserter(Bytes));
+    }
+}
+
 bool GetSetAttributeBinary(TiXmlElement *pXML, const char *AttributeName, std::unique_ptr<char> &pBinaryBuffer, const int Length, bool Read)
 {
-    std::string XMLBuffer;
     if (Read)
     {
         const char *pAttribute = pXML->Attribute(AttributeName);
         if (pAttribute)
         {
-            size_t len = strlen(pAttribute);
-            XMLBuffer  = pAttribute;
             if (Length > 0)
             {
-                pBinaryBuffer.reset(new char[Length]);
-                base64::decode(XMLBuffer.begin(), XMLBuffer.end(), pBinaryBuffer.get());
+                std::vector<char> Bytes;
+                DecodeBase64(pAttribute, Bytes);
+                pBinaryBuffer.reset(new char[Length]());
+                std::copy_n(Bytes.begin(), std::min<size_t>(Bytes.size(), Length), pBinaryBuffer.get());
                 return true;
             }
         }
@@ -53,10 +64,45 @@ bool GetSetAttributeBinary(TiXmlElement *pXML, const char *AttributeName, std::u
     {
         if (!pXML)
             return false;
-        base64::encode(pBinaryBuffer.get(), pBinaryBuffer.get() + Length, back_inserter(XMLBuffer));
+        std::string XMLBuffer;
+        base64::Encode(pBinaryBuffer.get(), Length, XMLBuffer);
         pXML->SetAttribute(AttributeName, XMLBuffer.c_str());
-        size_t len = XMLBuffer.size();
+        return true;
+    }
+}
+
+constexpr const char *AttachmentPrefix = "attachment:";
 
+bool GetSetAttributeAttachment(TiXmlElement *pXML, const char *AttributeName, std::vector<char> &Bytes, CTrack::Message &rMessage, bool Read)
+{
+    if (!pXML)
+        return false;
+    if (Read)
+    {
+        const char *pAttribute = pXML->Attribute(AttributeName);
+        if (!pAttribute)
+            return false;
+        const size_t PrefixLength = strlen(AttachmentPrefix);
+        if (strncmp(pAttribute, AttachmentPrefix, PrefixLength) == 0)
+        {
+            // an ID that is not a number or not an attachment of this message
+            const char        *pID  = pAttribute + PrefixLength;
+            char              *pEnd = nullptr;
+            unsigned long long ID   = strtoull(pID, &pEnd, 10);
+            if (pEnd == pID || *pEnd != '\0' || ID >= rMessage.GetNumAttachments())
+                return false;
+            Bytes = rMessage.GetAttachment(static_cast<size_t>(ID));
+        }
+        else
+        {
+            DecodeBase64(pAttribute, Bytes);
+        }
+        return true;
+    }
+    else
+    {
+        size_t ID = rMessage.AddAttachment(Bytes);
+        pXML->SetAttribute(AttributeName, (AttachmentPrefix + std::to_string(ID)).c_str());
         return true;
     }
 }
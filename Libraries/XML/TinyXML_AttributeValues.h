@@ -22,6 +22,11 @@
 #define XML_READ  true
 #endif
 
+namespace CTrack
+{
+    class Message;
+}
+
 bool GetSetAttribute(TiXmlElement *pSettings, const char *AttributeName, char *value, const int MaxStringLength, bool Read);
 bool GetSetAttribute(TiXmlElement *pSettings, const char *AttributeName, int &value, bool Read);
 bool GetSetAttribute(TiXmlElement *pSettings, const char *AttributeName, unsigned short &value, bool Read);
@@ -47,6 +52,11 @@ bool GetSetAttribute(TiXmlElement *pSettings, const char *AttributeName, std::se
 bool GetSetAttributeTime(TiXmlElement *pSettings, const char *AttributeName, time_t &value, bool Read);
 bool GetSetAttributeBinary(TiXmlElement *pXML, const char *AttributeName, std::unique_ptr<char> &value, const int Length, bool Read);
 
+// the bytes travel as an attachment of the message that carries the XML, the attribute only holds "attachment:<ID>".
+// Reading also accepts the base64 text of GetSetAttributeBinary, written by a peer without attachments, and returns
+// false when the ID is not an attachment of rMessage.
+bool GetSetAttributeAttachment(TiXmlElement *pXML, const char *AttributeName, std::vector<char> &Bytes, CTrack::Message &rMessage, bool Read);
+
 std::vector<std::vector<double>> Unit4x4();
 
 #ifdef _MANAGED
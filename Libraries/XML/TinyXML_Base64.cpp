@@ -0,0 +1,376 @@
+#include "TinyXML_Base64.h"
+
+#include <cstdint>
+#include <cstring>
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+SIMD base64
+
+The kernels follow the well known pshufb formulation : encoding spreads 3 bytes over the 4 bytes of a 32 bit lane,
+cuts out the four 6 bit indices with two multiplies and maps the indices to characters with a 16 entry table of
+offsets. Decoding classifies every character on its two nibbles (a character is valid when the bits of the two
+table entries do not meet), adds the offset of its range and packs the 6 bit values back with two multiply-adds.
+
+The kernels only run on whole blocks with room to spare in the output, the scalar loops do the start and end of
+the buffer and find the exact position of an error the kernels only detect per block.
+
+MSVC compiles both kernels on x86 and x64 without /arch and picks one from cpuid at the first call, other
+compilers build the kernels the target allows. Managed code (Leica.LMF is compiled /clr) is scalar.
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+#if defined(_M_CEE)
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#include <intrin.h>
+#define BASE64_SSSE3
+#define BASE64_AVX2
+#define BASE64_CPUID
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#define BASE64_AVX2
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#define BASE64_SSSE3
+#endif
+
+namespace
+{
+    constexpr size_t BYTES_PER_LINE = 57; // 76 characters
+
+    //------------------------------------------------------------------------------------------------------------------
+    // scalar
+    //------------------------------------------------------------------------------------------------------------------
+
+    // 3 bytes to 4 characters
+    inline void EncodeGroup(const uint8_t *pIn, char *pOut)
+    {
+        uint32_t Input = (uint32_t(pIn[0]) << 16) | (uint32_t(pIn[1]) << 8) | pIn[2];
+        pOut[0]        = base64::to_table[(Input >> 18) & 0x3F];
+        pOut[1]        = base64::to_table[(Input >> 12) & 0x3F];
+        pOut[2]        = base64::to_table[(Input >> 6) & 0x3F];
+        pOut[3]        = base64::to_table[Input & 0x3F];
+    }
+
+    // the 6 bit value of a character, -1 for a character that is not in the alphabet ('=' included)
+    inline int DecodeChar(char c)
+    {
+        unsigned char u = static_cast<unsigned char>(c);
+        return (u < 128 && u != '=') ? base64::from_table[u] : -1;
+    }
+
+    //------------------------------------------------------------------------------------------------------------------
+    // SSSE3 : 12 bytes to 16 characters
+    //------------------------------------------------------------------------------------------------------------------
+
+#ifdef BASE64_SSSE3
+    inline __m128i EncodeLanes(__m128i In)
+    {
+        In                  = _mm_shuffle_epi8(In, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+        const __m128i T0    = _mm_and_si128(In, _mm_set1_epi32(0x0fc0fc00));
+        const __m128i T1    = _mm_mulhi_epu16(T0, _mm_set1_epi32(0x04000040));
+        const __m128i T2    = _mm_and_si128(In, _mm_set1_epi32(0x003f03f0));
+        const __m128i T3    = _mm_mullo_epi16(T2, _mm_set1_epi32(0x01000010));
+        const __m128i Index = _mm_or_si128(T1, T3);
+
+        const __m128i ShiftLUT = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                               '+' - 62, '/' - 63, 'A', 0, 0);
+        __m128i       Range    = _mm_subs_epu8(Index, _mm_set1_epi8(51));
+        const __m128i Less     = _mm_cmpgt_epi8(_mm_set1_epi8(26), Index);
+        Range                  = _mm_or_si128(Range, _mm_and_si128(Less, _mm_set1_epi8(13)));
+        return _mm_add_epi8(_mm_shuffle_epi8(ShiftLUT, Range), Index);
+    }
+
+    // false when a character of the block is not in the alphabet
+    inline bool DecodeLanes(__m128i In, __m128i &Out)
+    {
+        const __m128i LutLo   = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+        const __m128i LutHi   = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+        const __m128i LutRoll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+        const __m128i Nibble  = _mm_set1_epi8(0x0f);
+
+        const __m128i HiNibbles = _mm_and_si128(_mm_srli_epi32(In, 4), Nibble);
+        const __m128i LoNibbles = _mm_and_si128(In, Nibble);
+        const __m128i Lo        = _mm_shuffle_epi8(LutLo, LoNibbles);
+        const __m128i Hi        = _mm_shuffle_epi8(LutHi, HiNibbles);
+        if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(Lo, Hi), _mm_setzero_si128())) != 0)
+            return false;
+
+        const __m128i Eq2F   = _mm_cmpeq_epi8(In, _mm_set1_epi8('/'));
+        const __m128i Roll   = _mm_shuffle_epi8(LutRoll, _mm_add_epi8(Eq2F, HiNibbles));
+        const __m128i Values = _mm_add_epi8(In, Roll);
+
+        const __m128i MergeAB = _mm_maddubs_epi16(Values, _mm_set1_epi32(0x01400140));
+        const __m128i Merged  = _mm_madd_epi16(MergeAB, _mm_set1_epi32(0x00011000));
+        Out                   = _mm_shuffle_epi8(Merged, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        return true;
+    }
+
+    // reads 16 bytes per 12 it encodes, returns the number of bytes encoded
+    size_t EncodeSSSE3(const uint8_t *pIn, size_t NumBytes, char *pOut)
+    {
+        size_t Done = 0;
+        for (; Done + 16 <= NumBytes; Done += 12, pOut += 16)
+        {
+            __m128i In = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pIn + Done));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(pOut), EncodeLanes(In));
+        }
+        return Done;
+    }
+
+    // writes 16 bytes per 12 it decodes and stops 8 characters before the end, returns the number of characters decoded
+    size_t DecodeSSSE3(const char *pIn, size_t NumChars, uint8_t *pOut)
+    {
+        size_t Done = 0;
+        for (; Done + 24 <= NumChars; Done += 16, pOut += 12)
+        {
+            __m128i Out;
+            if (!DecodeLanes(_mm_loadu_si128(reinterpret_cast<const __m128i *>(pIn + Done)), Out))
+                break;
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(pOut), Out);
+        }
+        return Done;
+    }
+#endif
+
+    //------------------------------------------------------------------------------------------------------------------
+    // AVX2 : 24 bytes to 32 characters, the SSSE3 steps in both 128 bit lanes
+    //------------------------------------------------------------------------------------------------------------------
+
+#ifdef BASE64_AVX2
+#if defined(__GNUC__) && !defined(__AVX2__)
+#define BASE64_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define BASE64_TARGET_AVX2
+#endif
+
+    BASE64_TARGET_AVX2 size_t EncodeAVX2(const uint8_t *pIn, size_t NumBytes, char *pOut)
+    {
+        const __m256i Spread   = _mm256_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1, 10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+        const __m256i ShiftLUT = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                  '+' - 62, '/' - 63, 'A', 0, 0, 'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                                  '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+        size_t        Done     = 0;
+        for (; Done + 28 <= NumBytes; Done += 24, pOut += 32)
+        {
+            __m256i In = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(pIn + Done))),
+                                                 _mm_loadu_si128(reinterpret_cast<const __m128i *>(pIn + Done + 12)), 1);
+            In                  = _mm256_shuffle_epi8(In, Spread);
+            const __m256i T0    = _mm256_and_si256(In, _mm256_set1_epi32(0x0fc0fc00));
+            const __m256i T1    = _mm256_mulhi_epu16(T0, _mm256_set1_epi32(0x04000040));
+            const __m256i T2    = _mm256_and_si256(In, _mm256_set1_epi32(0x003f03f0));
+            const __m256i T3    = _mm256_mullo_epi16(T2, _mm256_set1_epi32(0x01000010));
+            const __m256i Index = _mm256_or_si256(T1, T3);
+
+            __m256i       Range = _mm256_subs_epu8(Index, _mm256_set1_epi8(51));
+            const __m256i Less  = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), Index);
+            Range               = _mm256_or_si256(Range, _mm256_and_si256(Less, _mm256_set1_epi8(13)));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(pOut), _mm256_add_epi8(_mm256_shuffle_epi8(ShiftLUT, Range), Index));
+        }
+        return Done;
+    }
+
+    // writes 32 bytes per 24 it decodes and stops 16 characters before the end
+    BASE64_TARGET_AVX2 size_t DecodeAVX2(const char *pIn, size_t NumChars, uint8_t *pOut)
+    {
+        const __m256i LutLo   = _mm256_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A, 0x15, 0x11, 0x11,
+                                                 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+        const __m256i LutHi   = _mm256_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x01,
+                                                 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+        const __m256i LutRoll = _mm256_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0, 0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+        const __m256i Pack    = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1, 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+        const __m256i Nibble  = _mm256_set1_epi8(0x0f);
+
+        size_t Done           = 0;
+        for (; Done + 48 <= NumChars; Done += 32, pOut += 24)
+        {
+            const __m256i In        = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pIn + Done));
+            const __m256i HiNibbles = _mm256_and_si256(_mm256_srli_epi32(In, 4), Nibble);
+            const __m256i Lo        = _mm256_shuffle_epi8(LutLo, _mm256_and_si256(In, Nibble));
+            const __m256i Hi        = _mm256_shuffle_epi8(LutHi, HiNibbles);
+            if (!_mm256_testz_si256(Lo, Hi))
+                break;
+
+            const __m256i Eq2F    = _mm256_cmpeq_epi8(In, _mm256_set1_epi8('/'));
+            const __m256i Values  = _mm256_add_epi8(In, _mm256_shuffle_epi8(LutRoll, _mm256_add_epi8(Eq2F, HiNibbles)));
+            const __m256i MergeAB = _mm256_maddubs_epi16(Values, _mm256_set1_epi32(0x01400140));
+            const __m256i Merged  = _mm256_madd_epi16(MergeAB, _mm256_set1_epi32(0x00011000));
+            const __m256i Packed  = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(Merged, Pack), _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(pOut), Packed);
+        }
+        return Done;
+    }
+#endif
+
+    //------------------------------------------------------------------------------------------------------------------
+    // dispatch
+    //------------------------------------------------------------------------------------------------------------------
+
+    using EncodeKernel = size_t (*)(const uint8_t *, size_t, char *);
+    using DecodeKernel = size_t (*)(const char *, size_t, uint8_t *);
+
+    size_t EncodeNone(const uint8_t *, size_t, char *) { return 0; }
+    size_t DecodeNone(const char *, size_t, uint8_t *) { return 0; }
+
+    struct Kernels
+    {
+        EncodeKernel Encode = EncodeNone;
+        DecodeKernel Decode = DecodeNone;
+    };
+
+    Kernels SelectKernels()
+    {
+        Kernels Result;
+#if defined(BASE64_CPUID)
+        int Info[4];
+        __cpuid(Info, 1);
+        const bool bSSSE3   = (Info[2] & (1 << 9)) != 0;
+        const bool bOSXSAVE = (Info[2] & (1 << 27)) != 0;
+        const bool bAVX     = (Info[2] & (1 << 28)) != 0;
+        bool       bAVX2    = false;
+        if (bOSXSAVE && bAVX && (_xgetbv(0) & 6) == 6)
+        {
+            __cpuidex(Info, 7, 0);
+            bAVX2 = (Info[1] & (1 << 5)) != 0;
+        }
+        if (bAVX2)
+            Result = {EncodeAVX2, DecodeAVX2};
+        else if (bSSSE3)
+            Result = {EncodeSSSE3, DecodeSSSE3};
+#elif defined(BASE64_AVX2)
+        Result = {EncodeAVX2, DecodeAVX2};
+#elif defined(BASE64_SSSE3)
+        Result = {EncodeSSSE3, DecodeSSSE3};
+#endif
+        return Result;
+    }
+
+    const Kernels &GetKernels()
+    {
+        static const Kernels Selected = SelectKernels();
+        return Selected;
+    }
+
+    // whole groups of 3 bytes, returns the number of characters written
+    size_t EncodeGroups(const uint8_t *pIn, size_t NumBytes, char *pOut)
+    {
+        size_t Done  = GetKernels().Encode(pIn, NumBytes, pOut);
+        char  *pText = pOut + Done / 3 * 4;
+        for (; Done + 3 <= NumBytes; Done += 3, pText += 4)
+            EncodeGroup(pIn + Done, pText);
+        return pText - pOut;
+    }
+} // namespace
+
+namespace base64
+{
+    size_t EncodedSize(size_t NumBytes, bool bLineBreaks)
+    {
+        return (NumBytes + 2) / 3 * 4 + (bLineBreaks ? NumBytes / BYTES_PER_LINE * 2 : 0);
+    }
+
+    size_t Encode(const void *pBytes, size_t NumBytes, char *pText, bool bLineBreaks)
+    {
+        const uint8_t *pIn  = static_cast<const uint8_t *>(pBytes);
+        char          *pOut = pText;
+        if (bLineBreaks)
+        {
+            for (; NumBytes >= BYTES_PER_LINE; NumBytes -= BYTES_PER_LINE, pIn += BYTES_PER_LINE)
+            {
+                pOut += EncodeGroups(pIn, BYTES_PER_LINE, pOut);
+                *pOut++ = '\r';
+                *pOut++ = '\n';
+            }
+        }
+        size_t Whole = NumBytes / 3 * 3;
+        pOut += EncodeGroups(pIn, Whole, pOut);
+
+        // the last 1 or 2 bytes and their padding
+        if (NumBytes > Whole)
+        {
+            uint8_t Last[3] = {pIn[Whole], NumBytes - Whole > 1 ? pIn[Whole + 1] : uint8_t(0), 0};
+            EncodeGroup(Last, pOut);
+            if (NumBytes - Whole == 1)
+                pOut[2] = '=';
+            pOut[3] = '=';
+            pOut += 4;
+        }
+        return pOut - pText;
+    }
+
+    void Encode(const void *pBytes, size_t NumBytes, std::string &Text, bool bLineBreaks)
+    {
+        Text.resize(EncodedSize(NumBytes, bLineBreaks));
+        Encode(pBytes, NumBytes, &Text[0], bLineBreaks);
+    }
+
+    size_t DecodedSizeMax(size_t NumChars)
+    {
+        return (NumChars + 3) / 4 * 3;
+    }
+
+    bool Decode(const char *pText, size_t NumChars, char *pBytes, size_t &NumBytes)
+    {
+        NumBytes = 0;
+
+        // the line breaks are removed first, only when there are any
+        std::string Compact;
+        if (memchr(pText, '\n', NumChars))
+        {
+            Compact.reserve(NumChars);
+            for (const char *p = pText, *pEnd = pText + NumChars; p < pEnd;)
+            {
+                const char *pBreak = static_cast<const char *>(memchr(p, '\n', pEnd - p));
+                const char *pLine  = pBreak ? pBreak : pEnd;
+                Compact.append(p, (pLine > p && pLine[-1] == '\r') ? pLine - 1 : pLine);
+                p = pLine + 1;
+            }
+            pText    = Compact.data();
+            NumChars = Compact.size();
+        }
+
+        // padding only at the end of a text of whole groups
+        if (NumChars % 4 == 0 && NumChars > 0 && pText[NumChars - 1] == '=')
+            NumChars -= (pText[NumChars - 2] == '=') ? 2 : 1;
+        if (NumChars % 4 == 1)
+            return false;
+
+        uint8_t *pOut = reinterpret_cast<uint8_t *>(pBytes);
+        size_t   Done = GetKernels().Decode(pText, NumChars, pOut);
+        pOut += Done / 4 * 3;
+        for (; Done + 4 <= NumChars; Done += 4, pOut += 3)
+        {
+            int a = DecodeChar(pText[Done]), b = DecodeChar(pText[Done + 1]), c = DecodeChar(pText[Done + 2]), d = DecodeChar(pText[Done + 3]);
+            if ((a | b | c | d) < 0)
+                return false;
+            uint32_t Value = (uint32_t(a) << 18) | (uint32_t(b) << 12) | (uint32_t(c) << 6) | uint32_t(d);
+            pOut[0]        = static_cast<uint8_t>(Value >> 16);
+            pOut[1]        = static_cast<uint8_t>(Value >> 8);
+            pOut[2]        = static_cast<uint8_t>(Value);
+        }
+
+        // 2 or 3 characters left, the last group without its padding
+        if (size_t Left = NumChars - Done; Left > 0)
+        {
+            int a = DecodeChar(pText[Done]), b = DecodeChar(pText[Done + 1]), c = Left > 2 ? DecodeChar(pText[Done + 2]) : 0;
+            if ((a | b | c) < 0)
+                return false;
+            uint32_t Value = (uint32_t(a) << 18) | (uint32_t(b) << 12) | (uint32_t(c) << 6);
+            *pOut++        = static_cast<uint8_t>(Value >> 16);
+            if (Left > 2)
+                *pOut++ = static_cast<uint8_t>(Value >> 8);
+        }
+        NumBytes = pOut - reinterpret_cast<uint8_t *>(pBytes);
+        return true;
+    }
+
+    bool Decode(const char *pText, size_t NumChars, std::vector<char> &Bytes)
+    {
+        size_t NumBytes = 0;
+        Bytes.resize(DecodedSizeMax(NumChars));
+        bool bValid = Decode(pText, NumChars, Bytes.data(), NumBytes);
+        Bytes.resize(NumBytes);
+        return bValid;
+    }
+} // namespace base64
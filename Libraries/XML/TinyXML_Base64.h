@@ -1,17 +1,32 @@
 #pragma once
 
-#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+base64
+
+Encode and Decode work on contiguous buffers, 12 or 24 bytes per step in SSSE3 or AVX2 (chosen once from the CPU,
+scalar under /clr and on other targets). Encode writes the same text as the encode template : a CRLF after every
+76 characters and '=' padding. Decode is strict : only the alphabet, LF or CRLF line breaks and at most two '='
+at the end, anything else fails.
+
+The encode / decode templates on iterators are kept for existing code. decode skips the characters that are not in
+the alphabet, which is why GetSetAttributeBinary falls back to it when Decode rejects a text.
+*/
+//------------------------------------------------------------------------------------------------------------------
 
 namespace base64
 {
-    const char  _to_table[64]   = {'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P', 'Q', 'R', 'S', 'T', 'U', 'V',
-                                   'W', 'X', 'Y', 'Z', 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p', 'q', 'r',
-                                   's', 't', 'u', 'v', 'w', 'x', 'y', 'z', '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '+', '/'};
-    const char *to_table        = _to_table;
+    inline constexpr char _to_table[64] = {'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P', 'Q', 'R', 'S', 'T', 'U', 'V',
+                                           'W', 'X', 'Y', 'Z', 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p', 'q', 'r',
+                                           's', 't', 'u', 'v', 'w', 'x', 'y', 'z', '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '+', '/'};
+    inline constexpr const char *to_table     = _to_table;
+    inline constexpr const char *to_table_end = _to_table + sizeof(_to_table);
 
-    const char *to_table_end    = _to_table + sizeof(_to_table);
-
-    const char _from_table[128] = {
+    inline constexpr char _from_table[128] = {
         -1, -1, -1, -1, -1, -1, -1, -1, // 0
         -1, -1, -1, -1, -1, -1, -1, -1, // 8
         -1, -1, -1, -1, -1, -1, -1, -1, // 16
@@ -29,7 +44,19 @@ namespace base64
         41, 42, 43, 44, 45, 46, 47, 48, // 112
         49, 50, 51, -1, -1, -1, -1, -1  // 120
     };
-    const char *from_table = _from_table;
+    inline constexpr const char *from_table = _from_table;
+
+    // the number of characters Encode writes
+    size_t EncodedSize(size_t NumBytes, bool bLineBreaks = true);
+    // pText holds EncodedSize(NumBytes, bLineBreaks) characters, returns that number
+    size_t Encode(const void *pBytes, size_t NumBytes, char *pText, bool bLineBreaks = true);
+    void   Encode(const void *pBytes, size_t NumBytes, std::string &Text, bool bLineBreaks = true);
+
+    // the most bytes Decode writes for NumChars characters
+    size_t DecodedSizeMax(size_t NumChars);
+    // pBytes holds DecodedSizeMax(NumChars) bytes, NumBytes is the number written. false for a text that is not base64
+    bool Decode(const char *pText, size_t NumChars, char *pBytes, size_t &NumBytes);
+    bool Decode(const char *pText, size_t NumChars, std::vector<char> &Bytes);
 } // namespace base64
 
 namespace base64
@@ -37,11 +64,6 @@ namespace base64
     typedef unsigned      uint32;
     typedef unsigned char uint8;
 
-    extern const char *to_table;
-    extern const char *to_table_end;
-
-    extern const char *from_table;
-
     template <class InputIterator, class OutputIterator> void encode(const InputIterator &begin, const InputIterator &end, OutputIterator out)
     {
         InputIterator it       = begin;
@@ -109,7 +131,7 @@ namespace base64
                     break; // pad character marks the end of the stream
                 ++it;
 
-                if (std::find(to_table, to_table_end, c) != to_table_end)
+                if (c < 128 && from_table[c] >= 0) // the alphabet, '=' is handled above
                 {
                     input[chars] = from_table[c];
                     chars++;
@@ -1,5 +1,11 @@
 #include "TinyXML_Extra.h"
 
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <iomanip>
 #include <iostream>
 #include <map>
@@ -70,96 +76,49 @@ TiXmlText *GetTextPointer(TiXmlElement *pElement)
     return NULL;
 }
 
-TiXmlNode *FindNode(TiXmlNode *pParentNode, const std::string &Path)
+// the first child named Name, an element only when bElement, created at the end when bCreate and missing
+static TiXmlNode *ChildNode(TiXmlNode *pParentNode, const char *Name, bool bElement, bool bCreate)
 {
-    size_t BackSlashPos = Path.find('\\');
-    if (BackSlashPos != std::string::npos)
-    {
-        std::string TagName   = Path.substr(0, BackSlashPos);
-        std::string NextPath  = Path.substr(BackSlashPos + 1);
+    TiXmlNode *pNode = bElement ? pParentNode->FirstChildElement(Name) : pParentNode->FirstChild(Name);
+    if (!pNode && bCreate)
+        pNode = pParentNode->LinkEndChild(new TiXmlElement(Name));
+    return pNode;
+}
 
-        TiXmlNode *pNextLevel = pParentNode->FirstChild(TagName.c_str());
-        if (!pNextLevel)
-            return NULL;
-        else
-            return FindNode(pNextLevel, NextPath);
+// follows the levels of Path from its character Start on, one name buffer for all levels
+static TiXmlNode *WalkPath(TiXmlNode *pNode, const std::string &Path, size_t Start, bool bElement, bool bCreate)
+{
+    std::string TagName;
+    while (pNode)
+    {
+        size_t BackSlashPos = Path.find('\\', Start);
+        TagName.assign(Path, Start, BackSlashPos == std::string::npos ? std::string::npos : BackSlashPos - Start);
+        pNode = ChildNode(pNode, TagName.c_str(), bElement, bCreate);
+        if (BackSlashPos == std::string::npos)
+            break;
+        Start = BackSlashPos + 1;
     }
-    else
-        return pParentNode->FirstChild(Path.c_str());
+    return pNode;
 }
 
-TiXmlNode *CreateNode(TiXmlNode *pParentNode, const std::string &Path)
+TiXmlNode *FindNode(TiXmlNode *pParentNode, const std::string &Path)
 {
-    size_t BackSlashPos = Path.find('\\');
-    if (BackSlashPos != std::string::npos)
-    {
-        std::string TagName  = Path.substr(0, BackSlashPos);
-        std::string NextPath = Path.substr(BackSlashPos + 1);
+    return WalkPath(pParentNode, Path, 0, false, false);
+}
 
-        TiXmlNode *pNode     = pParentNode->FirstChild(TagName.c_str());
-        if (!pNode)
-        {
-            pNode = new TiXmlElement(TagName.c_str());
-            pParentNode->LinkEndChild(pNode);
-        }
-        return CreateNode(pNode, NextPath);
-    }
-    else
-    {
-        TiXmlNode *pNode = pParentNode->FirstChild(Path.c_str());
-        if (!pNode)
-        {
-            pNode = new TiXmlElement(Path.c_str());
-            pParentNode->LinkEndChild(pNode);
-        }
-        return pNode;
-    }
+TiXmlNode *CreateNode(TiXmlNode *pParentNode, const std::string &Path)
+{
+    return WalkPath(pParentNode, Path, 0, false, true);
 }
 
 TiXmlElement *FindElement(TiXmlNode *pParentNode, const std::string &Path)
 {
-    size_t BackSlashPos = Path.find('\\');
-    if (BackSlashPos != std::string::npos)
-    {
-        std::string TagName      = Path.substr(0, BackSlashPos);
-        std::string NextPath     = Path.substr(BackSlashPos + 1);
-
-        TiXmlElement *pNextLevel = pParentNode->FirstChildElement(TagName.c_str());
-        if (!pNextLevel)
-            return NULL;
-        else
-            return FindElement(pNextLevel, NextPath);
-    }
-    else
-        return pParentNode->FirstChildElement(Path.c_str());
+    return static_cast<TiXmlElement *>(WalkPath(pParentNode, Path, 0, true, false));
 }
 
 TiXmlElement *CreateElement(TiXmlNode *pParentNode, const std::string &Path)
 {
-    size_t BackSlashPos = Path.find('\\');
-    if (BackSlashPos != std::string::npos)
-    {
-        std::string TagName  = Path.substr(0, BackSlashPos);
-        std::string NextPath = Path.substr(BackSlashPos + 1);
-
-        TiXmlElement *pNode  = pParentNode->FirstChildElement(TagName.c_str());
-        if (!pNode)
-        {
-            pNode = new TiXmlElement(TagName.c_str());
-            pParentNode->LinkEndChild(pNode);
-        }
-        return CreateElement(pNode, NextPath);
-    }
-    else
-    {
-        TiXmlElement *pNode = pParentNode->FirstChildElement(Path.c_str());
-        if (!pNode)
-        {
-            pNode = new TiXmlElement(Path.c_str());
-            pParentNode->LinkEndChild(pNode);
-        }
-        return pNode;
-    }
+    return static_cast<TiXmlElement *>(WalkPath(pParentNode, Path, 0, true, true));
 }
 
 bool GetAttributeHandleError(TiXmlElement *pXML, const char *AttributeName, std::string &Value, const char *File, int Line)
@@ -197,45 +156,130 @@ bool GetAttributeHandleError(TiXmlElement *pXML, const char *AttributeName, unsi
     return false;
 }
 
-int IntArrayToText(std::vector<int> &IntArray, std::string &Text)
+//------------------------------------------------------------------------------------------------------------------
+/*
+Numeric arrays and matrices as text
+
+The numbers are written with std::to_chars and read with std::from_chars straight from the attribute text, no
+streams and no copies of the text. The parsers stop where the former sscanf / operator>> versions stopped, so
+existing documents read back the same values. Matrices are written with the shortest text that reads back the
+same double, DoubleArrayToText keeps its 6 decimals.
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+static bool IsSpace(char c)
 {
-    char TextBuffer[1500];
-    Text = "";
-    for (auto iter : IntArray)
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// the white space and the '+' that sscanf and operator>> accept in front of a number, from_chars does not
+static const char *SkipToNumber(const char *pText, const char *pEnd)
+{
+    while (pText < pEnd && IsSpace(*pText))
+        pText++;
+    if (pText < pEnd && *pText == '+' && pText + 1 < pEnd && *(pText + 1) != '-')
+        pText++;
+    return pText;
+}
+
+// sscanf "%d"
+static const char *ScanNumber(const char *pText, const char *pEnd, int &Value)
+{
+    pText               = SkipToNumber(pText, pEnd);
+    auto [pNext, Error] = std::from_chars(pText, pEnd, Value);
+    return Error == std::errc() ? pNext : nullptr;
+}
+
+// sscanf "%lf" : inf, nan, hexadecimal and out of range values go to strtod, pEnd is the end of a std::string and so 0
+static const char *ScanNumber(const char *pText, const char *pEnd, double &Value)
+{
+    const char *pNumber = SkipToNumber(pText, pEnd);
+    const char *pSign   = (pNumber < pEnd && *pNumber == '-') ? pNumber + 1 : pNumber;
+    if (pSign < pEnd && (isdigit(static_cast<unsigned char>(*pSign)) || *pSign == '.'))
     {
-        _itoa_s(iter, TextBuffer, 10);
-        Text += TextBuffer;
-        Text += ';';
+        auto [pNext, Error] = std::from_chars(pNumber, pEnd, Value);
+        if (Error == std::errc() && (pNext == pEnd || (*pNext != 'x' && *pNext != 'X')))
+            return pNext;
     }
-    return static_cast<int>(IntArray.size());
+    char *pStrtod = nullptr;
+    Value         = strtod(pText, &pStrtod);
+    return pStrtod != pText ? pStrtod : nullptr;
 }
 
-int TextToIntArray(std::vector<int> &IntArray, const std::string &Text)
+// operator>> : decimal digits only, values that overflow fail and values that underflow are kept
+static const char *StreamNumber(const char *pText, const char *pEnd, double &Value)
+{
+    pText             = SkipToNumber(pText, pEnd);
+    const char *pSign = (pText < pEnd && *pText == '-') ? pText + 1 : pText;
+    if (pSign == pEnd || (!isdigit(static_cast<unsigned char>(*pSign)) && *pSign != '.'))
+        return nullptr;
+    auto [pNext, Error] = std::from_chars(pText, pEnd, Value);
+    if (Error == std::errc::result_out_of_range)
+    {
+        Value = strtod(std::string(pText, pNext).c_str(), nullptr);
+        return fabs(Value) != HUGE_VAL ? pNext : nullptr;
+    }
+    return Error == std::errc() ? pNext : nullptr;
+}
+
+template <typename T> static void AppendNumber(std::string &Text, T Value)
+{
+    char Buffer[32];
+    auto [pEnd, Error] = std::to_chars(Buffer, Buffer + sizeof(Buffer), Value);
+    Text.append(Buffer, pEnd);
+}
+
+static void AppendFixed(std::string &Text, double Value, int Precision)
+{
+    char Buffer[512]; // DBL_MAX has 309 digits before the decimal point
+    auto [pEnd, Error] = std::to_chars(Buffer, Buffer + sizeof(Buffer), Value, std::chars_format::fixed, Precision);
+    Text.append(Buffer, pEnd);
+}
+
+// "v;v;v;" : a value, then the text after the next ';' as long as more than one character is left
+template <typename T, typename Add> static void ParseSeparated(const std::string &Text, Add AddValue)
 {
-    int         i;
     const char *pText = Text.c_str();
-    IntArray.clear();
-    while (sscanf_s(pText, "%d;", &i) == 1)
+    const char *pEnd  = pText + Text.size();
+    T           Value;
+    while (ScanNumber(pText, pEnd, Value))
     {
-        IntArray.push_back(i);
-        pText = strchr(pText + 1, ';');
+        AddValue(Value);
+        pText = static_cast<const char *>(memchr(pText + 1, ';', pEnd - pText - 1));
         if (!pText)
             break;
         pText++;
-        if (strlen(pText) <= 1)
+        if (pEnd - pText <= 1)
             break;
     }
+}
+
+int IntArrayToText(std::vector<int> &IntArray, std::string &Text)
+{
+    Text.clear();
+    Text.reserve(IntArray.size() * 8);
+    for (auto iter : IntArray)
+    {
+        AppendNumber(Text, iter);
+        Text += ';';
+    }
+    return static_cast<int>(IntArray.size());
+}
+
+int TextToIntArray(std::vector<int> &IntArray, const std::string &Text)
+{
+    IntArray.clear();
+    ParseSeparated<int>(Text, [&IntArray](int i) { IntArray.push_back(i); });
     return static_cast<int>(IntArray.size());
 }
 
 int IntSetToText(std::set<int> &IntSet, std::string &Text)
 {
-    char TextBuffer[1500];
-    Text = "";
+    Text.clear();
+    Text.reserve(IntSet.size() * 8);
     for (auto iter : IntSet)
     {
-        _itoa_s(iter, TextBuffer, 10);
-        Text += TextBuffer;
+        AppendNumber(Text, iter);
         Text += ';';
     }
     return static_cast<int>(IntSet.size());
@@ -243,124 +287,107 @@ int IntSetToText(std::set<int> &IntSet, std::string &Text)
 
 int TextToIntSet(std::set<int> &IntSet, const std::string &Text)
 {
-    int         i;
-    const char *pText = Text.c_str();
     IntSet.clear();
-    while (sscanf_s(pText, "%d;", &i) == 1)
-    {
-        IntSet.emplace(i);
-        pText = strchr(pText + 1, ';');
-        if (!pText)
-            break;
-        pText++;
-        if (strlen(pText) <= 1)
-            break;
-    }
+    ParseSeparated<int>(Text, [&IntSet](int i) { IntSet.emplace(i); });
     return static_cast<int>(IntSet.size());
 }
 
 int DoubleArrayToText(std::vector<double> &rArray, std::string &Text)
 {
-    char TextBuffer[1500];
-    Text = "";
+    Text.clear();
+    Text.reserve(rArray.size() * 16);
     for (auto iter : rArray)
     {
-        sprintf_s(TextBuffer, sizeof(TextBuffer), "%.6lf;", iter);
-        Text += TextBuffer;
+        AppendFixed(Text, iter, 6);
+        Text += ';';
     }
     return static_cast<int>(rArray.size());
 }
 
 int TextToDoubleArray(std::vector<double> &rArray, const std::string &Text)
 {
-    double      f;
-    const char *pText = Text.c_str();
     rArray.clear();
-    while (sscanf_s(pText, "%lf;", &f) == 1)
-    {
-        rArray.push_back(f);
-        pText = strchr(pText + 1, ';');
-        if (!pText)
-            break;
-        pText++;
-        if (strlen(pText) <= 1)
-            break;
-    }
+    rArray.reserve(std::count(Text.begin(), Text.end(), ';') + 1);
+    ParseSeparated<double>(Text, [&rArray](double f) { rArray.push_back(f); });
     return static_cast<int>(rArray.size());
 }
 
-void MatrixToText(const std::vector<std::vector<double>> &iMatrix, std::string &Text)
+static void AppendMatrix(std::string &Text, const std::vector<std::vector<double>> &iMatrix)
 {
-    std::ostringstream oss;
     for (const auto &row : iMatrix)
     {
         for (const auto &value : row)
         {
-            oss << std::scientific << std::setprecision(12) << value << " ";
+            AppendNumber(Text, value);
+            Text += ' ';
         }
-        oss << ";"; // Use semicolon to separate rows
+        Text += ';'; // Use semicolon to separate rows
     }
-    Text = oss.str();
 }
 
-void TextToMatrix(std::vector<std::vector<double>> &rMatrix, const std::string &iText)
+// the rows of [pText, pEnd), a row stops at the first text that is not a number
+static void ParseMatrix(std::vector<std::vector<double>> &rMatrix, const char *pText, const char *pEnd)
 {
-    std::istringstream rowStream(iText);
-    std::string        Text;
-    size_t             numRows = 0;
-    size_t             numCols = 0;
-
-    while (std::getline(rowStream, Text, ';'))
+    while (pText < pEnd)
     {
-        std::istringstream  elementStream(Text);
+        const char *pRowEnd = static_cast<const char *>(memchr(pText, ';', pEnd - pText));
+        if (!pRowEnd)
+            pRowEnd = pEnd;
+
         std::vector<double> row;
         double              value;
-        size_t              currentRowCols = 0;
-
-        while (elementStream >> value)
-        {
+        const char         *pValue = pText;
+        while ((pValue = StreamNumber(pValue, pRowEnd, value)) != nullptr)
             row.push_back(value);
-            currentRowCols++;
-        }
-
         if (!row.empty())
-        {
-            numRows++;
-            rMatrix.push_back(row);
-            if (currentRowCols > numCols)
-            {
-                numCols = currentRowCols;
-            }
-        }
+            rMatrix.push_back(std::move(row));
+
+        pText = pRowEnd + 1;
     }
 }
 
+void MatrixToText(const std::vector<std::vector<double>> &iMatrix, std::string &Text)
+{
+    Text.clear();
+    Text.reserve(iMatrix.size() * (iMatrix.empty() ? 0 : iMatrix.front().size()) * 24 + iMatrix.size());
+    AppendMatrix(Text, iMatrix);
+}
+
+void TextToMatrix(std::vector<std::vector<double>> &rMatrix, const std::string &iText)
+{
+    rMatrix.clear();
+    ParseMatrix(rMatrix, iText.data(), iText.data() + iText.size());
+}
+
 void MatrixArrayToText(const std::vector<std::vector<std::vector<double>>> &rMatrixArray, std::string &Text)
 {
-    std::ostringstream oss;
+    Text.clear();
+    Text.reserve(rMatrixArray.size() * 16 * 24);
     for (const auto &matrix : rMatrixArray)
     {
-        MatrixToText(matrix, Text);
-        oss << "[" << Text << "]";
+        Text += '[';
+        AppendMatrix(Text, matrix);
+        Text += ']';
     }
-    Text = oss.str();
 }
 
 void TextToMatrixArray(std::vector<std::vector<std::vector<double>>> &rMatrixArray, const std::string &Text)
 {
-    std::istringstream matrixStream(Text);
-    std::string        LineText;
-    size_t             numMatrices = 0;
+    const char *pText = Text.data();
+    const char *pEnd  = pText + Text.size();
     rMatrixArray.clear();
-    while (std::getline(matrixStream, LineText, '['))
+    while (pText < pEnd)
     {
+        const char *pMatrixEnd = static_cast<const char *>(memchr(pText, '[', pEnd - pText));
+        if (!pMatrixEnd)
+            pMatrixEnd = pEnd;
+
         std::vector<std::vector<double>> matrix;
-        TextToMatrix(matrix, LineText);
+        ParseMatrix(matrix, pText, pMatrixEnd);
         if (!matrix.empty())
-        {
-            numMatrices++;
-            rMatrixArray.push_back(matrix);
-        }
+            rMatrixArray.push_back(std::move(matrix));
+
+        pText = pMatrixEnd + 1;
     }
 }
 
@@ -560,21 +587,21 @@ int TextToLongDoubleMap(std::map<long, double> &FloatMap, const std::string &Tex
     return static_cast<int>(FloatMap.size());
 }
 
+// removing the children leaves the path to their parent as it was, so that is walked once
+static void DeleteChildren(TiXmlNode *pParentXML, const std::string &Path)
+{
+    if (!pParentXML)
+        return;
+    const char *TagName = Path.c_str() + Path.rfind('\\') + 1; // npos + 1 is 0
+    TiXmlNode  *pNode   = NULL;
+    while ((pNode = pParentXML->FirstChild(TagName)) != NULL)
+        pParentXML->RemoveChild(pNode);
+}
+
 void DeleteNodes(TiXmlNode *pMainXML, const std::string &Path)
 {
-    TiXmlNode *pNode = NULL;
-    while ((pNode = FindNode(pMainXML, Path)) != NULL)
-    {
-        if (pNode)
-        {
-            TiXmlNode *pParentXML = pNode->Parent();
-            if (pParentXML)
-            {
-                pParentXML->RemoveChild(pNode);
-                pNode = NULL;
-            }
-        }
-    }
+    size_t BackSlashPos = Path.rfind('\\');
+    DeleteChildren(BackSlashPos == std::string::npos ? pMainXML : FindNode(pMainXML, Path.substr(0, BackSlashPos)), Path);
 }
 
 const char *GetText(TiXmlElement *pElement)
@@ -650,3 +677,117 @@ std::unique_ptr<TiXmlElement> LoadXmlFile(const std::string &filename)
 
     return rootElement;
 }
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+CXMLPathIndex
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+CXMLPathIndex::CXMLPathIndex(TiXmlNode *pRoot) : m_pRoot(pRoot)
+{
+}
+
+void CXMLPathIndex::SetRoot(TiXmlNode *pRoot)
+{
+    m_pRoot = pRoot;
+    Invalidate();
+}
+
+void CXMLPathIndex::Invalidate()
+{
+    m_Nodes.clear();
+    m_Elements.clear();
+    m_Recursed.clear();
+}
+
+TiXmlNode *CXMLPathIndex::Resolve(PathMap &Index, const std::string &Path, bool bElement, bool bCreate)
+{
+    auto Found = Index.find(Path);
+    if (Found != Index.end())
+        return Found->second;
+    if (!m_pRoot)
+        return nullptr;
+
+    // start below the deepest level that is known
+    TiXmlNode *pNode = m_pRoot;
+    size_t     Start = 0;
+    for (size_t BackSlashPos = Path.rfind('\\'); BackSlashPos != std::string::npos && BackSlashPos > 0; BackSlashPos = Path.rfind('\\', BackSlashPos - 1))
+    {
+        auto Level = Index.find(Path.substr(0, BackSlashPos));
+        if (Level != Index.end())
+        {
+            pNode = Level->second;
+            Start = BackSlashPos + 1;
+            break;
+        }
+    }
+
+    // and remember the levels below it
+    std::string TagName;
+    while (pNode)
+    {
+        size_t BackSlashPos = Path.find('\\', Start);
+        TagName.assign(Path, Start, BackSlashPos == std::string::npos ? std::string::npos : BackSlashPos - Start);
+        TiXmlNode *pChild = ChildNode(pNode, TagName.c_str(), bElement, false);
+        if (!pChild && bCreate)
+        {
+            pChild = ChildNode(pNode, TagName.c_str(), bElement, true);
+            m_Recursed.clear(); // a new element can come before the one found earlier
+        }
+        pNode = pChild;
+        if (!pNode)
+            break;
+        if (BackSlashPos == std::string::npos)
+        {
+            Index.emplace(Path, pNode);
+            break;
+        }
+        Index.emplace(Path.substr(0, BackSlashPos), pNode);
+        Start = BackSlashPos + 1;
+    }
+    return pNode;
+}
+
+TiXmlNode *CXMLPathIndex::FindNode(const std::string &Path)
+{
+    return Resolve(m_Nodes, Path, false, false);
+}
+
+TiXmlNode *CXMLPathIndex::CreateNode(const std::string &Path)
+{
+    return Resolve(m_Nodes, Path, false, true);
+}
+
+TiXmlElement *CXMLPathIndex::FindElement(const std::string &Path)
+{
+    return static_cast<TiXmlElement *>(Resolve(m_Elements, Path, true, false));
+}
+
+TiXmlElement *CXMLPathIndex::CreateElement(const std::string &Path)
+{
+    return static_cast<TiXmlElement *>(Resolve(m_Elements, Path, true, true));
+}
+
+TiXmlElement *CXMLPathIndex::FindRecursed(const char *TagName)
+{
+    auto Found = m_Recursed.find(TagName);
+    if (Found != m_Recursed.end())
+        return Found->second;
+    TiXmlElement *pRoot = m_pRoot ? m_pRoot->ToElement() : nullptr;
+    if (!pRoot)
+        return nullptr;
+    TiXmlElement *pResult = ::FindRecursed(pRoot, TagName);
+    if (pResult)
+        m_Recursed.emplace(TagName, pResult);
+    return pResult;
+}
+
+void CXMLPathIndex::DeleteNodes(const std::string &Path)
+{
+    if (!m_pRoot)
+        return;
+    size_t BackSlashPos = Path.rfind('\\');
+    DeleteChildren(BackSlashPos == std::string::npos ? m_pRoot : FindNode(Path.substr(0, BackSlashPos)), Path);
+    Invalidate(); // the removed nodes can be remembered under any path
+}
@@ -5,6 +5,7 @@
 #include <set>
 #include <memory>
 #include <string>
+#include <unordered_map>
 
 //
 // this function finds recursively the first TiXmlElement that matches TagName
@@ -62,3 +63,44 @@ int TextToVecIntMap(std::map<std::string, std::vector<int>> &VecIntMap, const st
 
 TiXmlElement *RemoveElement(TiXmlElement *removeThis);
 void          DeleteNodes(TiXmlNode *pMainXML, const std::string &Path);
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+CXMLPathIndex : path lookups on one tree that are walked once
+
+The methods do what the functions with the same name do below the root, and remember every level they resolve
+under its path ("Level1\Level2"). The next lookup of a path, or of a path below one that is known, starts from
+the remembered node. Paths that are not found are not remembered.
+
+Nodes created through the index only add children at the end, which leaves the remembered nodes valid. DeleteNodes
+through the index forgets everything. Any other change to the tree (RemoveChild, RemoveElement, renaming, the free
+functions) must be followed by Invalidate.
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+class CXMLPathIndex
+{
+  public:
+    explicit CXMLPathIndex(TiXmlNode *pRoot = nullptr);
+
+    void       SetRoot(TiXmlNode *pRoot);
+    TiXmlNode *GetRoot() const { return m_pRoot; }
+    void       Invalidate();
+    size_t     GetSize() const { return m_Nodes.size() + m_Elements.size() + m_Recursed.size(); }
+
+    TiXmlNode    *FindNode(const std::string &Path);
+    TiXmlNode    *CreateNode(const std::string &Path);
+    TiXmlElement *FindElement(const std::string &Path);
+    TiXmlElement *CreateElement(const std::string &Path);
+    TiXmlElement *FindRecursed(const char *TagName);
+    void          DeleteNodes(const std::string &Path);
+
+  protected:
+    using PathMap = std::unordered_map<std::string, TiXmlNode *>;
+    TiXmlNode *Resolve(PathMap &Index, const std::string &Path, bool bElement, bool bCreate);
+
+    TiXmlNode                                      *m_pRoot = nullptr;
+    PathMap                                         m_Nodes;    // FindNode, CreateNode
+    PathMap                                         m_Elements; // FindElement, CreateElement
+    std::unordered_map<std::string, TiXmlElement *> m_Recursed; // FindRecursed by tag name
+};
@@ -471,8 +471,7 @@ const char *TiXmlBase::GetEntity(const char *p, char *value, int *length, TiXmlE
 {
 
     // Presume an entity, and pull it out.
-    TIXML_STRING ent;
-    int          i;
+    int i;
     *length = 0;
 
     if (*(p + 1) && *(p + 1) == '#' && *(p + 2))
@@ -614,6 +613,41 @@ bool TiXmlBase::StringEqual(const char *p, const char *tag, bool ignoreCase, TiX
 const char *TiXmlBase::ReadText(const char *p, TIXML_STRING *text, bool trimWhiteSpace, const char *endTag, bool caseInsensitive, TiXmlEncoding encoding)
 {
     *text = "";
+
+    // Most texts come out exactly as they are in the input : no entities and, when the white space is
+    // condensed, only single spaces between the words. Find the end of such a text with the same steps
+    // as the loops below and copy it in one go, the loops are left for the texts that need rewriting.
+    const bool  condense = trimWhiteSpace && condenseWhiteSpace;
+    const char  endChar  = (endTag[0] && !endTag[1] && !caseInsensitive) ? endTag[0] : 0; // '<' and the quotes
+    auto        atEnd    = [&](const char *at) { return endChar ? *at == endChar : StringEqual(at, endTag, caseInsensitive, encoding); };
+    const char *start    = condense ? SkipWhiteSpace(p, encoding) : p;
+    const char *q        = start;
+    bool        plain    = (q != 0);
+    while (plain && *q && !atEnd(q))
+    {
+        if (*q == '&')
+        {
+            plain = false;
+        }
+        else if (condense && IsWhiteSpace(*q))
+        {
+            plain = (*q == ' ' && q[1] && !IsWhiteSpace(q[1]) && !atEnd(q + 1));
+            ++q;
+        }
+        else
+        {
+            int step = (encoding == TIXML_ENCODING_UTF8) ? utf8ByteTable[*((const unsigned char *)q)] : 1;
+            for (int i = 1; plain && i < step; ++i)
+                plain = (q[i] != 0); // a truncated character is left to GetChar
+            q += step;
+        }
+    }
+    if (plain)
+    {
+        text->assign(start, q - start);
+        return q + strlen(endTag);
+    }
+
     if (!trimWhiteSpace         // certain tags always keep whitespace
         || !condenseWhiteSpace) // if true, whitespace is always kept
     {
@@ -1154,10 +1188,6 @@ const char *TiXmlElement::Parse(const char *p, TiXmlParsingData *data, TiXmlEnco
         return 0;
     }
 
-    TIXML_STRING endTag("</");
-    endTag += value;
-    endTag += ">";
-
     // Check for and read attributes. Also look for an empty
     // tag or an end tag.
     while (p && *p)
@@ -1202,10 +1232,11 @@ const char *TiXmlElement::Parse(const char *p, TiXmlParsingData *data, TiXmlEnco
             if (!p || !*p)
                 return 0;
 
-            // We should find the end tag now
-            if (StringEqual(p, endTag.c_str(), false, encoding))
+            // We should find the end tag now, "</" value ">" compared in place
+            const size_t valueLength = value.length();
+            if (p[0] == '<' && p[1] == '/' && strncmp(p + 2, value.c_str(), valueLength) == 0 && p[2 + valueLength] == '>')
             {
-                p += endTag.length();
+                p += valueLength + 3;
                 return p;
             }
             else
@@ -1642,11 +1673,11 @@ const char *TiXmlText::Parse(const char *p, TiXmlParsingData *data, TiXmlEncodin
         p += strlen(startTag);
 
         // Keep all the white space, ignore the encoding, etc.
-        while (p && *p && !StringEqual(p, endTag, false, encoding))
-        {
-            value += *p;
-            ++p;
-        }
+        const char *cdataEnd = strstr(p, endTag);
+        if (!cdataEnd)
+            cdataEnd = p + strlen(p);
+        value.assign(p, cdataEnd - p);
+        p = cdataEnd;
 
         TIXML_STRING dummy;
         p = ReadText(p, &dummy, false, endTag, false, encoding);
@@ -2,10 +2,12 @@
 
 #include "../Libraries/XML/TinyXML_AttributeValues.h"
 #include "../Libraries/XML/ProxyKeywords.h"
-#include "../Libraries/utility/FileReader.h"
 #include "../Libraries/utility/Print.h"
 #include "../Libraries/Utility/errorException.h"
 #include "../Libraries/Testing/ProfilingControl.h"
+#include "../Libraries/TCP/FrameTiming.h"
+#include "../Libraries/Utility/Metrics.h"
+#include <algorithm>
 #include <cmath>
 #include <thread>
 #include <chrono>
@@ -13,7 +15,7 @@
 
 CTrack::Reply Driver::HardwareDetect(const CTrack::Message &message)
 {
-    CTRACK_ZONE_SCOPED_NC("Template::HardwareDetect", 0x4488FF);
+    CTRACK_ZONE_CATEGORY_NC(CTrack::ProfileCategory::Driver, "Template::HardwareDetect", 0x4488FF);
     bool                                          result            = true;
     CTrack::Reply                                 reply             = std::make_unique<CTrack::Message>(TAG_COMMAND_HARDWAREDETECT);
     bool                                          present           = true;
@@ -54,7 +56,7 @@ CTrack::Reply Driver::HardwareDetect(const CTrack::Message &message)
 
 CTrack::Reply Driver::ConfigDetect(const CTrack::Message &message)
 {
-    CTRACK_ZONE_SCOPED_NC("Template::ConfigDetect", 0x44FF88);
+    CTRACK_ZONE_CATEGORY_NC(CTrack::ProfileCategory::Driver, "Template::ConfigDetect", 0x44FF88);
     bool          Result                                    = true;
     CTrack::Reply reply                                     = std::make_unique<CTrack::Message>(TAG_COMMAND_CONFIGDETECT);
 
@@ -116,7 +118,7 @@ int Driver::FindChannelTypeIndex(const int Value)
 
 CTrack::Reply Driver::CheckInitialize(const CTrack::Message &message)
 {
-    CTRACK_ZONE_SCOPED_NC("Template::CheckInitialize", 0xFF8844);
+    CTRACK_ZONE_CATEGORY_NC(CTrack::ProfileCategory::Driver, "Template::CheckInitialize", 0xFF8844);
     bool          Result = true;
     std::string   ResultFeedback;
     CTrack::Reply reply      = std::make_unique<CTrack::Message>(TAG_COMMAND_CHECKINIT);
@@ -138,15 +140,23 @@ CTrack::Reply Driver::CheckInitialize(const CTrack::Message &message)
             throw std::runtime_error(message);
         }
 
-        m_matrixData = FileReader::ReadNumbersFromFile(m_simulationFile);
-        size_t nCols, nRows = m_matrixData.size();
+        // text recordings are converted once to a binary sidecar, the binary file is mapped instead of loaded
+        if (m_simulationFile.empty() && m_GeneratedChannels != 0)
+        {
+            GenerateSimulationData(m_channelNames.size(), m_MeasurementFrequencyHz);
+        }
+        else
+        {
+            m_SimulationData.Open(CSimulationFile::PrepareBinary(m_simulationFile, m_channelNames, m_channelTypes));
+        }
+        size_t nCols, nRows = m_SimulationData.GetNumRows();
         if (nRows == 0)
         {
             std::string message = fmt::format("No data read from file : {}", m_simulationFile);
             throw std::runtime_error(message);
         }
 
-        nCols = m_matrixData[0].size();
+        nCols = m_SimulationData.GetNumChannels();
         if (nCols < m_channelNames.size())
         {
             std::string message = fmt::format("Number of columns in file ({}) does not match number of channels ({})", nCols, m_channelNames.size());
@@ -157,10 +167,11 @@ CTrack::Reply Driver::CheckInitialize(const CTrack::Message &message)
         m_bRunning              = true;
         m_TimeStep              = 1.0 / m_MeasurementFrequencyHz;
         m_arDoubles[0]          = 0.0;
-        m_matrixDataCurrentRow  = m_matrixData.begin();
+        m_SimulationRow         = 0;
         m_ButtonChannelIndex    = FindChannelTypeIndex(ChannelTypeButton);
         m_ButtonTriggerPressed  = false;
         m_ButtonValidatePressed = false;
+        m_Pacer.Start(m_MeasurementFrequencyHz);
     }
     catch (const std::exception &e)
     {
@@ -175,15 +186,25 @@ CTrack::Reply Driver::CheckInitialize(const CTrack::Message &message)
 
 bool Driver::Run()
 {
-    CTRACK_ZONE_SCOPED_NC("Template::Run", 0x88FF44);
+    CTRACK_PROFILE_FRAME();
+    CTRACK_ZONE_SAMPLED_NC(CTrack::ProfileCategory::Driver, "Template::Run", 0x88FF44);
     if (m_bRunning)
     {
+        double lateness = m_Pacer.WaitNext();
+        CTRACK_PLOT("Template pacing lateness us", lateness * 1e6);
+    }
+    return Step();
+}
+
+bool Driver::Step()
+{
+    if (m_bRunning)
+    {
+        CTrack::CScopedTimer StepTimer(m_MetricStep);
+        m_AcquireTimeNs = CTrack::FrameTimestamps::Now();
         m_arDoubles[0] += m_TimeStep;
-        std::this_thread::sleep_for(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::duration<double>(m_TimeStep)));
-        for (int i = 1; i < m_arDoubles.size(); i++)
-        {
-            m_arDoubles[i] = (*m_matrixDataCurrentRow)[i];
-        }
+        const double *pRow = m_SimulationData.GetRow(m_SimulationRow);
+        std::copy(pRow + 1, pRow + m_arDoubles.size(), m_arDoubles.begin() + 1);
         // handle buttons
         if (m_ButtonChannelIndex != -1)
         {
@@ -202,31 +223,16 @@ bool Driver::Run()
         }
 
         // next row of data
-        m_matrixDataCurrentRow++;
-        if (m_matrixDataCurrentRow == m_matrixData.end())
+        m_SimulationRow++;
+        if (m_SimulationRow == m_SimulationData.GetNumRows())
         {
-            m_matrixDataCurrentRow = m_matrixData.begin();
+            m_SimulationRow = 0;
         }
 
         // Update frame number and FPS
         m_FrameNumber++;
-        auto now = std::chrono::steady_clock::now();
-        if (m_LastFPSFrameNumber == 0)
-        {
-            m_LastFPSUpdateTime  = now;
-            m_LastFPSFrameNumber = m_FrameNumber;
-        }
-        else
-        {
-            auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(now - m_LastFPSUpdateTime).count();
-            if (elapsedMs >= 1000)
-            {
-                uint32_t framesDelta = m_FrameNumber - m_LastFPSFrameNumber;
-                m_CurrentFPS         = framesDelta * 1000.0 / elapsedMs;
-                m_LastFPSUpdateTime  = now;
-                m_LastFPSFrameNumber = m_FrameNumber;
-            }
-        }
+        m_CurrentFPS = m_FrameRate.Tick();
+        m_MetricFrames.Add();
     }
     return m_bRunning;
 }
@@ -243,10 +249,15 @@ bool Driver::GetValues(std::vector<double> &values)
 
 CTrack::Reply Driver::ShutDown(const CTrack::Message &message)
 {
-    CTRACK_ZONE_SCOPED_NC("Template::ShutDown", 0xFF4444);
+    CTRACK_ZONE_CATEGORY_NC(CTrack::ProfileCategory::Driver, "Template::ShutDown", 0xFF4444);
     bool          Result              = true;
     CTrack::Reply reply               = std::make_unique<CTrack::Message>(TAG_COMMAND_SHUTDOWN);
 
+    if (m_Pacer.IsStarted())
+    {
+        PrintInfo("{}", m_Pacer.GetJitterReport());
+        m_Pacer.Stop();
+    }
     m_bRunning                        = false;
     reply->GetParams()[ATTRIB_RESULT] = Result;
     return reply;
@@ -342,10 +353,15 @@ bool Driver::Initialize(double frequencyHz)
     m_TimeStep               = 1.0 / m_MeasurementFrequencyHz;
     m_FrameNumber            = 0;
     m_CurrentFPS             = 0.0;
-    m_LastFPSFrameNumber     = 0;
+    m_FrameRate.Reset();
 
     // If no simulation data is loaded, create minimal data for stress testing
-    if (m_matrixData.empty())
+    if (!m_SimulationData.IsOpen() && m_GeneratedChannels != 0)
+    {
+        GenerateSimulationData(m_GeneratedChannels, frequencyHz);
+        m_arDoubles.assign(m_GeneratedChannels, 0.0);
+    }
+    else if (!m_SimulationData.IsOpen())
     {
         // Create a simple 3-channel simulated data set
         m_channelNames = {"Time", "X", "Y", "Z"};
@@ -353,28 +369,74 @@ bool Driver::Initialize(double frequencyHz)
         m_arDoubles.resize(m_channelNames.size(), 0.0);
 
         // Create simple circular motion simulation data
-        m_matrixData.clear();
+        std::vector<double> values;
         for (int i = 0; i < 100; i++)
         {
             double angle = 2.0 * 3.14159265 * i / 100.0;
-            std::vector<double> row = {
+            values.insert(values.end(), {
                 static_cast<double>(i) / frequencyHz,
                 100.0 * std::cos(angle),
                 100.0 * std::sin(angle),
                 0.0
-            };
-            m_matrixData.push_back(row);
+            });
         }
-        m_matrixDataCurrentRow = m_matrixData.begin();
+        m_SimulationData.SetData(std::move(values), m_channelNames.size());
+        m_SimulationRow = 0;
     }
 
+    m_Pacer.Start(m_MeasurementFrequencyHz);
     m_bRunning   = true;
     m_bConnected = true;
     return true;
 }
 
+void Driver::GenerateSimulationData(size_t numChannels, double frequencyHz)
+{
+    // time, then X Y Z triplets of markers moving on circles with different radii and phases
+    const size_t numRows = 100;
+    if (m_channelNames.size() != numChannels)
+    {
+        m_channelNames = {"Time"};
+        m_channelTypes = {ChannelType::Time};
+        for (size_t c = 1; c < numChannels; c++)
+        {
+            m_channelNames.push_back(fmt::format("{}{}", "XYZ"[(c - 1) % 3], (c - 1) / 3 + 1));
+            m_channelTypes.push_back(ChannelType::Normal);
+        }
+    }
+
+    std::vector<double> values(numRows * numChannels, 0.0);
+    for (size_t r = 0; r < numRows; r++)
+    {
+        double  angle = 2.0 * 3.14159265 * r / numRows;
+        double *pRow  = &values[r * numChannels];
+        pRow[0]       = static_cast<double>(r) / frequencyHz;
+        for (size_t c = 1; c < numChannels; c++)
+        {
+            size_t marker = (c - 1) / 3;
+            double radius = 100.0 + 10.0 * (marker % 50);
+            double phase  = angle + 0.1 * marker;
+            switch ((c - 1) % 3)
+            {
+                case 0:
+                    pRow[c] = radius * std::cos(phase);
+                    break;
+                case 1:
+                    pRow[c] = radius * std::sin(phase);
+                    break;
+                default:
+                    pRow[c] = 10.0 * marker;
+                    break;
+            }
+        }
+    }
+    m_SimulationData.SetData(std::move(values), numChannels);
+    m_SimulationRow = 0;
+}
+
 bool Driver::Shutdown()
 {
+    m_Pacer.Stop();
     m_bRunning = false;
     return true;
 }
@@ -2,6 +2,9 @@
 
 #include "../Libraries/Driver/IDriver.h"
 #include "../Libraries/TCP/Subscriber.h"
+#include "../Libraries/Utility/FramePacer.h"
+#include "../Libraries/Utility/Metrics.h"
+#include "../Libraries/Utility/SimulationFile.h"
 
 #include <atomic>
 #include <tinyxml.h>
@@ -43,6 +46,7 @@ class Driver : public CTrack::IDriver, public CTrack::Subscriber
     std::string  GetLastError() const override { return m_LastError; }
     uint32_t     GetFrameNumber() const override { return m_FrameNumber; }
     double       GetCurrentFPS() const override { return m_CurrentFPS; }
+    int64_t      GetAcquireTimeNs() const override { return m_AcquireTimeNs; }
 
     // Device-Specific Capabilities
     bool HasCapability(const std::string& capability) const override;
@@ -65,6 +69,12 @@ class Driver : public CTrack::IDriver, public CTrack::Subscriber
     void PressTriggerButton() { m_ButtonTriggerPressed = true; }
     void PressValidateButton() { m_ButtonValidatePressed = true; }
     int  FindChannelTypeIndex(const int Value);
+    std::string GetPacingReport() const { return m_Pacer.GetJitterReport(); }
+
+    // produce one frame without waiting, for callers that do their own pacing (Run() = wait + Step())
+    bool Step();
+    // generate data for this many channels when no simulation file is given, 0 = file required
+    void SetGeneratedChannels(size_t numChannels) { m_GeneratedChannels = numChannels; }
 
   public:
     double                   m_MeasurementFrequencyHz = 10.0;
@@ -80,17 +90,23 @@ class Driver : public CTrack::IDriver, public CTrack::Subscriber
     std::string              m_LastError;
     uint32_t                 m_FrameNumber            = 0;
     double                   m_CurrentFPS             = 0.0;
+    int64_t                  m_AcquireTimeNs          = 0;
 
   protected:
-    std::vector<std::vector<double>>           m_matrixData;
-    std::vector<std::vector<double>>::iterator m_matrixDataCurrentRow;
+    CSimulationFile m_SimulationData;       // memory mapped recording or generated rows
+    size_t          m_SimulationRow = 0;    // next row to send
+    CFramePacer     m_Pacer;                // absolute deadline pacing of Run()
+    size_t          m_GeneratedChannels = 0;
+
+    void GenerateSimulationData(size_t numChannels, double frequencyHz);
 
   protected:
     int  m_ButtonChannelIndex    = -1;
     bool m_ButtonTriggerPressed  = false;
     bool m_ButtonValidatePressed = false;
 
-    // For FPS calculation
-    std::chrono::steady_clock::time_point m_LastFPSUpdateTime;
-    uint32_t                              m_LastFPSFrameNumber = 0;
+    // FPS and metrics, shared by all simulated devices of the process
+    CTrack::CFrameRateMeter m_FrameRate;
+    CTrack::CMetricCounter &m_MetricFrames = CTrack::CMetricsRegistry::Instance().Counter("template.frames");
+    CLogHistogram          &m_MetricStep   = CTrack::CMetricsRegistry::Instance().Histogram("template.step_us");
 };
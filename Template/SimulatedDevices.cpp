@@ -0,0 +1,275 @@
+#include "SimulatedDevices.h"
+
+#include "../Libraries/TCP/TCPTelegram.h"
+#include "../Libraries/Testing/ProfilingControl.h"
+#include "../Libraries/Utility/Print.h"
+#include "../Libraries/Utility/os.h"
+#include "../Libraries/XML/ProxyKeywords.h"
+#include "../../CTrack_Data/ProxyHandshake.h"
+
+#include <algorithm>
+#include <fmt/core.h>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <timeapi.h>
+#pragma comment(lib, "winmm.lib")
+#endif
+
+namespace
+{
+constexpr auto SPIN_THRESHOLD = std::chrono::microseconds(1500);
+constexpr auto IDLE_SLEEP     = std::chrono::milliseconds(5); // no device is tracking
+constexpr int  MAX_LATE       = 10;                           // periods behind before a device restarts its schedule
+
+// the data telegram carries the channel count in a uint16_t
+constexpr int64_t MIN_CHANNELS = 2;
+constexpr int64_t MAX_CHANNELS = 65535;
+
+size_t CheckChannels(int64_t NumChannels, size_t Fallback, const std::string &Name)
+{
+    if (NumChannels < MIN_CHANNELS || NumChannels > MAX_CHANNELS)
+    {
+        PrintWarning("{} {} is outside [{}, {}], using {}", Name, NumChannels, MIN_CHANNELS, MAX_CHANNELS, Fallback);
+        return Fallback;
+    }
+    return static_cast<size_t>(NumChannels);
+}
+} // namespace
+
+CSimulatedDeviceHost::~CSimulatedDeviceHost()
+{
+    Close();
+}
+
+std::vector<SimulatedDeviceConfig> CSimulatedDeviceHost::ParseConfig(const nlohmann::json &Value, double DefaultRateHz, int64_t DefaultChannels)
+{
+    std::vector<SimulatedDeviceConfig> Devices;
+    SimulatedDeviceConfig              Default;
+    Default.RateHz      = DefaultRateHz;
+    Default.NumChannels = CheckChannels(DefaultChannels, Default.NumChannels, ProxyCmdLine::SimDeviceChannels);
+    if (Value.is_number_integer())
+    {
+        Devices.resize(std::max(0, Value.get<int>()), Default);
+    }
+    else if (Value.is_array())
+    {
+        for (const auto &Item : Value)
+        {
+            SimulatedDeviceConfig Config;
+            Config.RateHz      = Item.value("rate", DefaultRateHz);
+            Config.NumChannels = CheckChannels(Item.value("channels", static_cast<int64_t>(Default.NumChannels)), Default.NumChannels,
+                                               fmt::format("simulated device {} channels", Devices.size() + 1));
+            Devices.push_back(Config);
+        }
+    }
+    for (size_t i = 0; i < Devices.size(); i++)
+    {
+        if (!(Devices[i].RateHz > 0.0))
+        {
+            throw std::invalid_argument(fmt::format("simulated device {} : rate must be positive, not {}", i + 1, Devices[i].RateHz));
+        }
+    }
+    return Devices;
+}
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+Open / close
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+void CSimulatedDeviceHost::Open(const std::vector<SimulatedDeviceConfig> &Devices, unsigned short FirstPort, bool AutoStart)
+{
+    Close();
+    m_bQuit        = false;
+    int SearchPort = FirstPort;
+    for (size_t i = 0; i < Devices.size(); i++)
+    {
+        auto pDevice     = std::make_unique<Device>();
+        pDevice->Config  = Devices[i];
+        pDevice->pDriver = std::make_unique<Driver>();
+        pDevice->pDriver->SetGeneratedChannels(Devices[i].NumChannels);
+        pDevice->pServer = std::make_unique<CCommunicationObject>();
+        pDevice->pServer->SetThreadName(fmt::format("SimDevice{}", i + 1));
+        Subscribe(*pDevice);
+
+        pDevice->Port = static_cast<unsigned short>(FindAvailableTCPPortNumber(SearchPort));
+        pDevice->pServer->Open(TCP_SERVER, pDevice->Port);
+        SearchPort = pDevice->Port + 1;
+
+        if (AutoStart)
+        {
+            pDevice->pDriver->Initialize(Devices[i].RateHz);
+        }
+        PrintInfo("Simulated device {} on port {} : {} channels at {} Hz", i + 1, pDevice->Port, Devices[i].NumChannels, Devices[i].RateHz);
+        m_Devices.push_back(std::move(pDevice));
+    }
+
+    if (!m_Devices.empty())
+    {
+        m_TimerThread = std::thread(&CSimulatedDeviceHost::TimerThread, this);
+        ThreadSetName(m_TimerThread, "SimDeviceTimer");
+    }
+}
+
+void CSimulatedDeviceHost::Close()
+{
+    m_bQuit = true;
+    if (m_TimerThread.joinable())
+    {
+        m_TimerThread.join();
+    }
+    for (auto &pDevice : m_Devices)
+    {
+        pDevice->pServer->Close();
+    }
+    m_Devices.clear();
+}
+
+void CSimulatedDeviceHost::Subscribe(Device &device)
+{
+    // the driver handlers run on the main thread, the device lock keeps them apart from the timer thread
+    Driver *pDriver = device.pDriver.get();
+    auto    Locked  = [&device](CTrack::Reply (Driver::*pHandler)(const CTrack::Message &))
+    {
+        return [&device, pHandler](const CTrack::Message &message) -> CTrack::Reply
+        {
+            std::lock_guard<std::mutex> Lock(device.Lock);
+            return (device.pDriver.get()->*pHandler)(message);
+        };
+    };
+
+    auto &Responder = *device.pServer->GetMessageResponder();
+    pDriver->Subscribe(Responder, TAG_HANDSHAKE, &ProxyHandShake::ProxyHandShake);
+    pDriver->Subscribe(Responder, TAG_COMMAND_HARDWAREDETECT, Locked(&Driver::HardwareDetect));
+    pDriver->Subscribe(Responder, TAG_COMMAND_CONFIGDETECT, Locked(&Driver::ConfigDetect));
+    pDriver->Subscribe(Responder, TAG_COMMAND_CHECKINIT, Locked(&Driver::CheckInitialize));
+    pDriver->Subscribe(Responder, TAG_COMMAND_SHUTDOWN, Locked(&Driver::ShutDown));
+    pDriver->Subscribe(Responder, ProxyMsg::Diagnostics, &CTrack::FrameTiming::OnDiagnostics);
+    pDriver->Subscribe(Responder, ProxyMsg::Metrics, &CTrack::CMetricsRegistry::OnMetrics);
+}
+
+void CSimulatedDeviceHost::PollMessages()
+{
+    for (auto &pDevice : m_Devices)
+    {
+        // message telegrams are dispatched inside GetReceivePackage, data telegrams are not expected
+        std::unique_ptr<CTCPGram> TCPGram;
+        while (pDevice->pServer->GetReceivePackage(TCPGram))
+        {
+            PrintWarning("Simulated device on port {} : unexpected telegram code {}", pDevice->Port, TCPGram->GetCode());
+        }
+    }
+}
+
+std::string CSimulatedDeviceHost::GetReport() const
+{
+    std::string Report = fmt::format("{} simulated devices", m_Devices.size());
+    for (const auto &pDevice : m_Devices)
+    {
+        std::lock_guard<std::mutex> Lock(pDevice->Lock);
+        Report += fmt::format("\n  port {} : {} at {:.1f} Hz, {} frames sent, {} clients", pDevice->Port, pDevice->pDriver->IsRunning() ? "running" : "idle",
+                              pDevice->pDriver->GetCurrentFPS(), pDevice->FramesSent, pDevice->pServer->GetNumConnections());
+    }
+    return Report;
+}
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+Shared timer : absolute deadlines per device, sleep until the earliest one and spin the last part
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+void CSimulatedDeviceHost::TimerThread()
+{
+    using Clock = std::chrono::steady_clock;
+
+    bool bTimerPeriod = false; // the 1 ms timer period is only raised while a device is tracking
+    while (!m_bQuit)
+    {
+        Clock::time_point Now       = Clock::now();
+        Clock::time_point Earliest  = Now + IDLE_SLEEP;
+        bool              bTracking = false;
+
+        for (auto &pDevice : m_Devices)
+        {
+            Device             &device = *pDevice;
+            std::vector<double> Values;
+            int64_t             AcquireTimeNs = 0;
+            {
+                std::lock_guard<std::mutex> Lock(device.Lock);
+                Driver                     &driver = *device.pDriver;
+                if (!driver.IsRunning() || !(driver.m_MeasurementFrequencyHz > 0.0))
+                {
+                    device.RateHz = 0.0;
+                    continue;
+                }
+
+                // (re)start the schedule when tracking starts or the rate changes
+                if (device.RateHz != driver.m_MeasurementFrequencyHz)
+                {
+                    device.RateHz       = driver.m_MeasurementFrequencyHz;
+                    device.Period       = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / device.RateHz));
+                    device.NextDeadline = Now + device.Period;
+                }
+
+                if (device.NextDeadline <= Now)
+                {
+                    CTRACK_ZONE_SAMPLED_NC(CTrack::ProfileCategory::Driver, "SimDevice::Step", 0x88FF44);
+                    if (driver.Step())
+                    {
+                        Values        = driver.m_arDoubles;
+                        AcquireTimeNs = driver.GetAcquireTimeNs();
+                        device.FramesSent++;
+                    }
+                    device.NextDeadline += device.Period;
+                    if (Now - device.NextDeadline > device.Period * MAX_LATE)
+                    {
+                        device.NextDeadline = Now + device.Period;
+                    }
+                }
+                Earliest  = std::min(Earliest, device.NextDeadline);
+                bTracking = true;
+            }
+
+            if (!Values.empty())
+            {
+                std::unique_ptr<CTCPGram> TCPGram = std::make_unique<CTCPGram>(Values, AcquireTimeNs);
+                device.pServer->PushSendPackage(TCPGram);
+            }
+        }
+
+        if (bTracking != bTimerPeriod)
+        {
+#ifdef _WIN32
+            if (bTracking)
+            {
+                timeBeginPeriod(1);
+            }
+            else
+            {
+                timeEndPeriod(1);
+            }
+#endif
+            bTimerPeriod = bTracking;
+        }
+
+        // wait for the earliest deadline
+        Clock::time_point SleepUntil = Earliest - SPIN_THRESHOLD;
+        if (Clock::now() < SleepUntil)
+        {
+            std::this_thread::sleep_until(SleepUntil);
+        }
+        while (Clock::now() < Earliest && !m_bQuit)
+        {
+            std::this_thread::yield();
+        }
+    }
+#ifdef _WIN32
+    if (bTimerPeriod)
+    {
+        timeEndPeriod(1);
+    }
+#endif
+}
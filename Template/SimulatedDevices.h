@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Driver.h"
+#include "../Libraries/TCP/TCPCommunication.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------
+/*
+CSimulatedDeviceHost : N virtual trackers in one Template proxy
+
+Every device is a full Driver with its own TCP server endpoint, so the engine configures and starts each of them
+as if it were a separate proxy (handshake, hardware detect, config detect, check init, shutdown). Messages are
+handled on the main thread through PollMessages(). One shared timer thread paces all devices : it sleeps until
+the earliest device deadline, steps every device that is due and pushes its data telegram.
+
+Devices without a simulation file generate data for the channel layout requested in check init, so no
+recordings are needed for a fan-in load test. With AutoStart the devices start tracking immediately at their
+configured rate and channel count.
+*/
+//------------------------------------------------------------------------------------------------------------------
+
+struct SimulatedDeviceConfig
+{
+    double RateHz      = 100.0;
+    size_t NumChannels = 301; // time + 100 markers
+};
+
+class CSimulatedDeviceHost
+{
+  public:
+    CSimulatedDeviceHost() = default;
+    ~CSimulatedDeviceHost();
+
+    // open a server endpoint for every device, ports are searched upward from FirstPort
+    void Open(const std::vector<SimulatedDeviceConfig> &Devices, unsigned short FirstPort, bool AutoStart);
+    void Close();
+
+    // main thread : dispatch incoming messages of all devices
+    void PollMessages();
+
+    size_t      GetNumDevices() const { return m_Devices.size(); }
+    std::string GetReport() const;
+
+    // parse the "sim_devices" command line value : a count, or an array of {"rate": Hz, "channels": n}
+    // throws std::invalid_argument when a rate is not positive, channel counts outside [2, 65535] are replaced
+    // by the default with a warning
+    static std::vector<SimulatedDeviceConfig> ParseConfig(const nlohmann::json &Value, double DefaultRateHz, int64_t DefaultChannels);
+
+  protected:
+    struct Device
+    {
+        SimulatedDeviceConfig                 Config;
+        unsigned short                        Port = 0;
+        std::unique_ptr<CCommunicationObject> pServer;
+        std::unique_ptr<Driver>               pDriver; // destroyed first, its subscriptions refer to the server responder
+        std::mutex                            Lock; // driver state, shared by message handlers and the timer thread
+        std::chrono::steady_clock::time_point NextDeadline;
+        std::chrono::steady_clock::duration   Period{};
+        double                                RateHz = 0.0;
+        uint64_t                              FramesSent = 0; // under Lock
+    };
+
+    void TimerThread();
+    void Subscribe(Device &device);
+
+  protected:
+    std::vector<std::unique_ptr<Device>> m_Devices;
+    std::thread                          m_TimerThread;
+    std::atomic<bool>                    m_bQuit{false};
+};
@@ -1,3 +1,5 @@
+#include "../Libraries/Testing/ClientStressTest.h"
+#include "../Libraries/Testing/FlightRecorder.h"
 #include "../Libraries/Testing/StressTest.h"
 #include "../Libraries/TCP/TCPCommunication.h"
 #include "../Libraries/TCP/TCPTelegram.h"
@@ -15,6 +17,7 @@
 #include "../../CTrack_Data/ProxyHandshake.h"
 
 #include "Driver.h"
+#include "SimulatedDevices.h"
 
 #include <conio.h>
 #include <iostream>
@@ -33,19 +36,63 @@ int main(int argc, char *argv[])
     unsigned short PortNumber(40001);
     bool           showConsole{true};
     bool           profiling{false};
+    bool           simAutoStart{false};
+    bool           timestamps{false};
+    double         metricsLog{0.0};
+    int            flightRecorder{0};
+    std::string    stressReplay;
+    double         stressReplaySpeed{0.0};
+
+    std::vector<SimulatedDeviceConfig> simDevices;
 
     CommandLineParameters parameters(argc, argv);
 
     if (parameters.isInitializedFromJson())
     {
-        PortNumber  = parameters.getInt(TCPPORT, 40001);
-        showConsole = parameters.getBool(SHOWCONSOLE, false);
-        profiling   = parameters.getBool(PROFILING, false);
+        PortNumber        = parameters.getInt(TCPPORT, 40001);
+        showConsole       = parameters.getBool(SHOWCONSOLE, false);
+        profiling         = parameters.getBool(PROFILING, false);
+        simAutoStart      = parameters.getBool(ProxyCmdLine::SimAutoStart, false);
+        timestamps        = parameters.getBool(ProxyCmdLine::Timestamps, false);
+        metricsLog        = parameters.getDouble(ProxyCmdLine::MetricsLog, 0.0);
+        flightRecorder    = parameters.getInt(ProxyCmdLine::FlightRecorder, 0);
+        stressReplay      = parameters.getString(ProxyCmdLine::StressReplay, "");
+        stressReplaySpeed = parameters.getDouble(ProxyCmdLine::StressReplaySpeed, 0.0);
+        if (parameters.getJsonObject().contains(ProxyCmdLine::SimDevices))
+        {
+            try
+            {
+                simDevices = CSimulatedDeviceHost::ParseConfig(parameters.getJsonObject()[ProxyCmdLine::SimDevices],
+                                                               parameters.getDouble(ProxyCmdLine::SimDeviceRate, 100.0),
+                                                               parameters.getInt(ProxyCmdLine::SimDeviceChannels, 301));
+            }
+            catch (const std::exception &e)
+            {
+                PrintError("sim_devices ignored : {}", e.what());
+            }
+        }
     }
     PortNumber = FindAvailableTCPPortNumber(PortNumber);
 
     // Set global profiling flag - controls Tracy profiling in all components
     CTrack::SetProfilingEnabled(profiling);
+    if (parameters.isInitializedFromJson() && parameters.getJsonObject().contains(ProxyCmdLine::ProfilingControl))
+    {
+        try
+        {
+            CTrack::ConfigureProfiling(parameters.getJsonObject()[ProxyCmdLine::ProfilingControl]);
+        }
+        catch (const std::exception &e)
+        {
+            PrintError("profiling_control ignored : {}", e.what());
+        }
+    }
+    CTrack::FrameTiming::SetTrailerEnabled(timestamps);
+    CTrack::CMetricsRegistry::Instance().SetLogInterval(metricsLog);
+    size_t flightRecorderEntries = flightRecorder > 0 ? std::clamp<size_t>(flightRecorder, CTrack::FlightRecorder::MIN_ENTRIES_PER_THREAD,
+                                                                           CTrack::FlightRecorder::MAX_ENTRIES_PER_THREAD)
+                                                      : 0;
+    CTrack::FlightRecorder::SetEnabled(flightRecorder > 0, flightRecorderEntries);
 
     ShowConsole(showConsole);
     if (showConsole)
@@ -61,8 +108,13 @@ int main(int argc, char *argv[])
         PrintInfo("i : print info");
         PrintInfo("l : report last coordinates");
         PrintInfo("b : send big TCP package");
+        PrintInfo("j : report frame pacing jitter");
+        PrintInfo("d : report simulated devices");
+        PrintInfo("k : report pipeline latency");
         PrintInfo("z : start stress test");
         PrintInfo("y : stop stress test");
+        PrintInfo("m : start/stop multi-client stress test");
+        PrintInfo("f : dump the flight recorder as Chrome trace");
 #ifdef TRACY_ENABLE
         if (CTrack::IsProfilingEnabled())
         {
@@ -81,6 +133,8 @@ int main(int argc, char *argv[])
     std::vector<CTrack::Subscription> subscriptions;
     std::unique_ptr<CTrack::Message>  manualMessage;
     std::unique_ptr<StressTest>       stressTest;
+    ClientStressTest                  clientStress(PortNumber);
+    CSimulatedDeviceHost              simulatedDevices;
     bool                              bContinueLoop = true;
 
     // responders & handlers
@@ -98,16 +152,54 @@ int main(int argc, char *argv[])
     driver->Subscribe(*TCPServer.GetMessageResponder(), TAG_COMMAND_CONFIGDETECT, CTrack::MakeMemberHandler(driver.get(), &Driver::ConfigDetect));
     driver->Subscribe(*TCPServer.GetMessageResponder(), TAG_COMMAND_CHECKINIT, CTrack::MakeMemberHandler(driver.get(), &Driver::CheckInitialize));
     driver->Subscribe(*TCPServer.GetMessageResponder(), TAG_COMMAND_SHUTDOWN, CTrack::MakeMemberHandler(driver.get(), &Driver::ShutDown));
+    driver->Subscribe(*TCPServer.GetMessageResponder(), ProxyMsg::Diagnostics, &CTrack::FrameTiming::OnDiagnostics);
+    driver->Subscribe(*TCPServer.GetMessageResponder(), ProxyMsg::Metrics, &CTrack::CMetricsRegistry::OnMetrics);
+    driver->Subscribe(*TCPServer.GetMessageResponder(), ProxyMsg::DumpTrace, &CTrack::FlightRecorder::OnDumpTrace);
+    driver->Subscribe(*TCPServer.GetMessageResponder(), ProxyMsg::Profiling, &CTrack::OnProfiling);
 
     // start server
     TCPServer.Open(TCP_SERVER, PortNumber);
     PrintInfo("Server started on port {}", PortNumber);
 
+    // additional simulated devices on the following ports
+    simulatedDevices.Open(simDevices, PortNumber + 1, simAutoStart);
+
     // Initialize stress test
     stressTest = std::make_unique<StressTest>(driver.get(), TCPServer.GetMessageResponder());
 
+    if (parameters.isInitializedFromJson() && parameters.getJsonObject().contains(ProxyCmdLine::StressClients))
+    {
+        clientStress.Start(ClientStressConfig::FromJson(parameters.getJsonObject()[ProxyCmdLine::StressClients]));
+    }
+
+    // unattended replay, the proxy ends with the verdict as exit code
+    int exitCode = 0;
+    if (!stressReplay.empty())
+    {
+        try
+        {
+            StressTest::ReplayScript script = StressTest::ReplayScript::Load(stressReplay);
+            if (stressReplaySpeed > 0.0)
+            {
+                script.Speed = stressReplaySpeed;
+            }
+            stressTest->StartReplay(script);
+        }
+        catch (const std::exception &e)
+        {
+            PrintError("{}", e.what());
+            exitCode      = 1;
+            bContinueLoop = false;
+        }
+    }
+
     while (bContinueLoop)
     {
+        if (!stressReplay.empty() && !stressTest->IsRunning())
+        {
+            exitCode      = stressTest->GetState() == StressTest::TestState::Error ? 1 : 0;
+            bContinueLoop = false;
+        }
         CTRACK_FRAME_MARK();
         try
         {
@@ -143,6 +235,7 @@ int main(int argc, char *argv[])
                 TCPServer.GetMessageResponder()->RespondToMessage(*manualMessage);
                 manualMessage.reset();
             }
+            simulatedDevices.PollMessages();
 
             //------------------------------------------------------------------------------------------------------------------
             /*
@@ -160,7 +253,7 @@ int main(int argc, char *argv[])
                 //                     FullLine += ValueString + " ";
                 //                 };
                 //                 PrintInfo(FullLine);
-                std::unique_ptr<CTCPGram> TCPGRam = std::make_unique<CTCPGram>(driver->m_arDoubles);
+                std::unique_ptr<CTCPGram> TCPGRam = std::make_unique<CTCPGram>(driver->m_arDoubles, driver->GetAcquireTimeNs());
                 TCPServer.PushSendPackage(TCPGRam);
             }
 
@@ -201,6 +294,15 @@ int main(int argc, char *argv[])
                     case 'v':
                         driver->PressValidateButton();
                         break;
+                    case 'j':
+                        PrintInfo("{}", driver->GetPacingReport());
+                        break;
+                    case 'd':
+                        PrintInfo("{}", simulatedDevices.GetReport());
+                        break;
+                    case 'k':
+                        PrintInfo("{}", CTrack::FrameTiming::GetLatencyReport().dump(2));
+                        break;
                     case 'b':
                     {
                         size_t                     NumValues = 1000000;
@@ -260,6 +362,30 @@ int main(int argc, char *argv[])
                         }
                     };
                     break;
+                    case 'm':
+                    {
+                        if (clientStress.IsRunning())
+                        {
+                            clientStress.Stop();
+                        }
+                        else
+                        {
+                            clientStress.Start(ClientStressConfig());
+                        }
+                    };
+                    break;
+                    case 'f':
+                    {
+                        if (CTrack::FlightRecorder::IsEnabled())
+                        {
+                            manualMessage = std::make_unique<CTrack::Message>(ProxyMsg::DumpTrace);
+                        }
+                        else
+                        {
+                            PrintWarning("Flight recorder is off, start the proxy with flight_recorder=<entries per thread>");
+                        }
+                    };
+                    break;
                 }
             }
         }
@@ -268,12 +394,14 @@ int main(int argc, char *argv[])
             PrintError("An error occurred : {}", e.what());
             std::unique_ptr<CTCPGram> TCPGRam = std::make_unique<CTCPGram>(e);
             TCPServer.PushSendPackage(TCPGRam);
+            CTrack::FlightRecorder::DumpOnError(e.what());
         }
         catch (...)
         {
             PrintError("An unknown error occurred");
             std::unique_ptr<CTCPGram> TCPGRam = std::make_unique<CTCPGram>("An unknown error occurred", TCPGRAM_CODE_ERROR);
             TCPServer.PushSendPackage(TCPGRam);
+            CTrack::FlightRecorder::DumpOnError("unknown error");
         }
     }
     // Stop stress test if running before shutdown
@@ -283,8 +411,10 @@ int main(int argc, char *argv[])
         stressTest->Stop();
     }
     stressTest.reset();
+    clientStress.Stop();
 
     PrintInfo("Closing server");
+    simulatedDevices.Close();
     TCPServer.Close();
-    return 0;
+    return exitCode;
 }
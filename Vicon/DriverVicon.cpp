@@ -6,6 +6,8 @@
 #include "../Libraries/Utility/errorException.h"
 #include "../Libraries/Utility/orientations.h"
 #include "../Libraries/Utility/logging.h"
+#include "../Libraries/TCP/FrameTiming.h"
+#include "../Libraries/Utility/Metrics.h"
 #include "DriverVicon.h"
 
 #include <iostream>
@@ -13,11 +15,24 @@
 
 constexpr int DELAY_MS = 10;
 
+bool DriverVicon::SetOrientConvention(const std::string &Name)
+{
+    // no name is an engine that does not negotiate, its channels are laid out for the 3x3
+    int Convention = Name.empty() ? ORIENTATION_3X3 : GetOrientationManager()->GetOrientationIndex(Name);
+    if (Convention < 0)
+    {
+        return false;
+    }
+    m_OrientConvention = Convention;
+    m_OrientKernel     = OrientationKernels::MakeKernel(Convention);
+    return true;
+}
+
 bool DriverVicon::Connect()
 {
-    CTRACK_ZONE_SCOPED_NC("Vicon::Connect", 0x4488FF); // Blue
-    m_Client.Connect("localhost");
-    bool bConnected = m_Client.IsConnected().Connected;
+    CTRACK_ZONE_CATEGORY_NC(CTrack::ProfileCategory::Driver, "Vicon::Connect", 0x4488FF); // Blue
+    m_Client->Connect("localhost");
+    bool bConnected = m_Client->IsConnected().Connected;
     if (!bConnected)
     {
         m_LastError = "Failed to connect to Vicon DataStream";
@@ -27,18 +42,18 @@ bool DriverVicon::Connect()
     }
 
     // Store SDK version
-    auto Version  = m_Client.GetVersion();
+    auto Version  = m_Client->GetVersion();
     m_SDKVersion  = fmt::format("{}.{}.{}.{}", Version.Major, Version.Minor, Version.Point, Version.Revision);
 
-    m_Client.EnableDebugData();
-    m_Client.EnableCameraCalibrationData();
-    m_Client.EnableCentroidData();
-    m_Client.EnableMarkerRayData();
-    m_Client.EnableMarkerData();
-    m_Client.EnableSegmentData();
-    m_Client.EnableUnlabeledMarkerData();
-    m_Client.SetStreamMode(VICONSDK::StreamMode::ServerPush);
-    m_Client.SetAxisMapping(VICONSDK::Direction::Forward, VICONSDK::Direction::Left, VICONSDK::Direction::Up);
+    m_Client->EnableDebugData();
+    m_Client->EnableCameraCalibrationData();
+    m_Client->EnableCentroidData();
+    m_Client->EnableMarkerRayData();
+    m_Client->EnableMarkerData();
+    m_Client->EnableSegmentData();
+    m_Client->EnableUnlabeledMarkerData();
+    m_Client->SetStreamMode(VICONSDK::StreamMode::ServerPush);
+    m_Client->SetAxisMapping(VICONSDK::Direction::Forward, VICONSDK::Direction::Left, VICONSDK::Direction::Up);
 
     // get a few frames, the very first frames are not reliable
     int Attempts = 4;
@@ -46,7 +61,7 @@ bool DriverVicon::Connect()
     {
         Attempts = 4;
         std::this_thread::sleep_for(std::chrono::milliseconds(DELAY_MS));
-        while (m_Client.GetFrame().Result != VICONSDK::Result::Success)
+        while (m_Client->GetFrame().Result != VICONSDK::Result::Success)
         {
             Attempts--;
             if (Attempts < 0)
@@ -71,14 +86,14 @@ bool DriverVicon::Connect()
 
 void DriverVicon::Disconnect()
 {
-    CTRACK_ZONE_SCOPED_NC("Vicon::Disconnect", 0xFF4444); // Red
-    m_Client.Disconnect();
+    CTRACK_ZONE_CATEGORY_NC(CTrack::ProfileCategory::Driver, "Vicon::Disconnect", 0xFF4444); // Red
+    m_Client->Disconnect();
     m_bConnected = false;
 }
 
 CTrack::Reply DriverVicon::HardwareDetect(const CTrack::Message &message)
 {
-    CTRACK_ZONE_SCOPED_NC("Vicon::HardwareDetect", 0x44FF44); // Green
+    CTRACK_ZONE_CATEGORY_NC(CTrack::ProfileCategory::Driver, "Vicon::HardwareDetect", 0x44FF44); // Green
     bool                                          bPresent    = false;
     CTrack::Reply                                 reply       = std::make_unique<CTrack::Message>(TAG_COMMAND_HARDWAREDETECT);
     unsigned int                                  CameraCount = 0;
@@ -89,12 +104,12 @@ CTrack::Reply DriverVicon::HardwareDetect(const CTrack::Message &message)
     std::vector<std::vector<std::vector<double>>> CameraPositions;
 
     std::unique_ptr<TiXmlElement> ReturnXML = std::make_unique<TiXmlElement>(TAG_COMMAND_HARDWAREDETECT);
-    auto                          Version   = m_Client.GetVersion();
+    auto                          Version   = m_Client->GetVersion();
 
     // Connect to the Vicon DataStream server
     if (Connect())
     {
-        auto CameraCountResult = m_Client.GetCameraCount();
+        auto CameraCountResult = m_Client->GetCameraCount();
         if (CameraCountResult.Result == VICONSDK::Result::Success)
         {
             bPresent = true;
@@ -108,11 +123,11 @@ CTrack::Reply DriverVicon::HardwareDetect(const CTrack::Message &message)
                 std::string                      SerialString;
                 std::vector<std::vector<double>> CameraPos4x4   = Unit4x4();
 
-                VICONSDK::Output_GetCameraName CameraNameResult = m_Client.GetCameraName(i);
+                VICONSDK::Output_GetCameraName CameraNameResult = m_Client->GetCameraName(i);
                 if (CameraNameResult.Result == VICONSDK::Result::Success)
                 {
                     CameraName                                  = CameraNameResult.CameraName;
-                    VICONSDK::Output_GetCameraId CameraIDResult = m_Client.GetCameraId(CameraName);
+                    VICONSDK::Output_GetCameraId CameraIDResult = m_Client->GetCameraId(CameraName);
                     if (CameraIDResult.Result == VICONSDK::Result::Success)
                     {
                         SerialString = std::to_string(CameraIDResult.CameraId);
@@ -121,8 +136,8 @@ CTrack::Reply DriverVicon::HardwareDetect(const CTrack::Message &message)
                     std::string CameraFeedBack = fmt::format("{} {}", CameraName, SerialString);
                     FeedBack.append(CameraFeedBack);
 
-                    VICONSDK::Output_GetCameraGlobalTranslation    CameraPos = m_Client.GetCameraGlobalTranslation(CameraName);
-                    VICONSDK::Output_GetCameraGlobalRotationMatrix CameraRot = m_Client.GetCameraGlobalRotationMatrix(CameraName);
+                    VICONSDK::Output_GetCameraGlobalTranslation    CameraPos = m_Client->GetCameraGlobalTranslation(CameraName);
+                    VICONSDK::Output_GetCameraGlobalRotationMatrix CameraRot = m_Client->GetCameraGlobalRotationMatrix(CameraName);
                     if (CameraPos.Result == VICONSDK::Result::Success && CameraRot.Result == VICONSDK::Result::Success)
                     {
                         for (int r = 0; r < 3; r++)
@@ -160,14 +175,22 @@ CTrack::Reply DriverVicon::HardwareDetect(const CTrack::Message &message)
 
 CTrack::Reply DriverVicon::ConfigDetect(const CTrack::Message &message)
 {
-    CTRACK_ZONE_SCOPED_NC("Vicon::ConfigDetect", 0xFFAA00); // Orange
+    CTRACK_ZONE_CATEGORY_NC(CTrack::ProfileCategory::Driver, "Vicon::ConfigDetect", 0xFFAA00); // Orange
     CTrack::Reply reply  = std::make_unique<CTrack::Message>(TAG_COMMAND_CONFIGDETECT);
     auto         &params = reply->GetParams();
 
+    // 3x3 unless the engine asks for another convention, a quaternion is 7 values per subject instead of 12
+    std::string Requested = message.GetParams().value(ATTRIB_CONFIG_ORIENT_CONVENTION, std::string());
+    if (!SetOrientConvention(Requested))
+    {
+        SetOrientConvention(std::string());
+        PrintWarning("Unknown orientation convention {}, using {}", Requested, GetOrientationManager()->GetOrientationName(m_OrientConvention));
+    }
+
     if (Connect())
     {
         // add unlabeled markers
-        VICONSDK::Output_GetUnlabeledMarkerCount output_GetUnlabeledMarkerCount = m_Client.GetUnlabeledMarkerCount();
+        VICONSDK::Output_GetUnlabeledMarkerCount output_GetUnlabeledMarkerCount = m_Client->GetUnlabeledMarkerCount();
         if (output_GetUnlabeledMarkerCount.Result == VICONSDK::Result::Success)
         {
             int numUnlabeled = output_GetUnlabeledMarkerCount.MarkerCount;
@@ -175,7 +198,7 @@ CTrack::Reply DriverVicon::ConfigDetect(const CTrack::Message &message)
             std::vector<std::string> markerNames;
             for (unsigned int MarkerIndex = 0; MarkerIndex < output_GetUnlabeledMarkerCount.MarkerCount; ++MarkerIndex)
             {
-                VICONSDK::Output_GetUnlabeledMarkerGlobalTranslation markerGlobalPosition = m_Client.GetUnlabeledMarkerGlobalTranslation(MarkerIndex);
+                VICONSDK::Output_GetUnlabeledMarkerGlobalTranslation markerGlobalPosition = m_Client->GetUnlabeledMarkerGlobalTranslation(MarkerIndex);
                 std::string                                          MarkerName           = fmt::format("unlabeled_{}", MarkerIndex);
                 markerNames.push_back(MarkerName);
             }
@@ -183,20 +206,20 @@ CTrack::Reply DriverVicon::ConfigDetect(const CTrack::Message &message)
         }
 
         // get rigid bodies (6DOF)
-        VICONSDK::Output_GetSubjectCount subjectCount = m_Client.GetSubjectCount();
+        VICONSDK::Output_GetSubjectCount subjectCount = m_Client->GetSubjectCount();
         if (subjectCount.Result == VICONSDK::Result::Success)
         {
             for (unsigned int SubjectIndex = 0; SubjectIndex < subjectCount.SubjectCount; ++SubjectIndex)
             {
-                std::string SubjectName                                           = m_Client.GetSubjectName(SubjectIndex).SubjectName;
-                params[ATTRIB_6DOF][SubjectName][ATTRIB_CONFIG_ORIENT_CONVENTION] = GetOrientationManager()->GetOrientationName(ORIENTATION_3X3);
+                std::string SubjectName                                           = m_Client->GetSubjectName(SubjectIndex).SubjectName;
+                params[ATTRIB_6DOF][SubjectName][ATTRIB_CONFIG_ORIENT_CONVENTION] = GetOrientationManager()->GetOrientationName(m_OrientConvention);
                 params[ATTRIB_6DOF][SubjectName][ATTRIB_CONFIG_RESIDU]            = false;
 
                 // labeled 3D
-                unsigned int MarkerCount                                          = m_Client.GetMarkerCount(SubjectName).MarkerCount;
+                unsigned int MarkerCount                                          = m_Client->GetMarkerCount(SubjectName).MarkerCount;
                 for (unsigned int MarkerIndex = 0; MarkerIndex < MarkerCount; ++MarkerIndex)
                 {
-                    std::string MarkerName = m_Client.GetMarkerName(SubjectName, MarkerIndex).MarkerName;
+                    std::string MarkerName = m_Client->GetMarkerName(SubjectName, MarkerIndex).MarkerName;
                     params[ATTRIB_6DOF][SubjectName][ATTRIB_CONFIG_3DMARKERS].push_back(MarkerName);
                 }
             }
@@ -208,7 +231,7 @@ CTrack::Reply DriverVicon::ConfigDetect(const CTrack::Message &message)
 
 CTrack::Reply DriverVicon::CheckInitialize(const CTrack::Message &message)
 {
-    CTRACK_ZONE_SCOPED_NC("Vicon::CheckInitialize", 0x00FFFF); // Cyan
+    CTRACK_ZONE_CATEGORY_NC(CTrack::ProfileCategory::Driver, "Vicon::CheckInitialize", 0x00FFFF); // Cyan
     bool          Result = true;
     std::string   Feedback;
     CTrack::Reply reply      = std::make_unique<CTrack::Message>(TAG_COMMAND_CHECKINIT);
@@ -219,11 +242,20 @@ CTrack::Reply DriverVicon::CheckInitialize(const CTrack::Message &message)
     m_arMatrix3DNames        = message.GetParams().value(ATTRIB_CHECKINIT_3DNAMES, std::vector<std::string>{});
     m_arMatrix3DChannelIndex = message.GetParams().value(ATTRIB_CHECKINIT_3DINDICES, std::vector<int>{});
 
+    // the convention the channels were built with, an engine reusing a stored configuration sends none and gets the 3x3
+    std::string Convention   = message.GetParams().value(ATTRIB_CONFIG_ORIENT_CONVENTION, std::string());
+    if (!SetOrientConvention(Convention))
+    {
+        reply->GetParams()[ATTRIB_RESULT]          = false;
+        reply->GetParams()[ATTRIB_RESULT_FEEDBACK] = fmt::format("Unknown orientation convention {}", Convention);
+        return reply;
+    }
+
     // Reset frame tracking state (but don't set m_bRunning yet to avoid race condition)
     m_LastFrameNumber    = 0;
     m_InitialFrameNumber = 0;
-    m_LastFPSFrameNumber = 0;
     m_CurrentFPS         = 0.0;
+    m_FrameRate.Reset();
 
     if (!Connect())
     {
@@ -246,44 +278,37 @@ bool DriverVicon::Run()
 {
     if (m_bRunning)
     {
-        CTRACK_ZONE_SCOPED_NC("Vicon::Run", 0xFF00FF); // Magenta
-        auto FrameResult = m_Client.GetFrame();
+        CTRACK_PROFILE_FRAME();
+        CTRACK_ZONE_SAMPLED_NC(CTrack::ProfileCategory::Driver, "Vicon::Run", 0xFF00FF); // Magenta
+        auto FrameResult = m_Client->GetFrame();
         if (FrameResult.Result == VICONSDK::Result::Success)
         {
-            VICONSDK::Output_GetFrameNumber         currentFrameNumber  = m_Client.GetFrameNumber();
-            VICONSDK::Output_GetHardwareFrameNumber hardwareFrameNumber = m_Client.GetHardwareFrameNumber();
+            m_AcquireTimeNs = CTrack::FrameTimestamps::Now();
+            VICONSDK::Output_GetFrameNumber         currentFrameNumber  = m_Client->GetFrameNumber();
+            VICONSDK::Output_GetHardwareFrameNumber hardwareFrameNumber = m_Client->GetHardwareFrameNumber();
             if (m_LastFrameNumber != currentFrameNumber.FrameNumber)
             {
+                CTrack::CScopedTimer FrameTimer(m_MetricFrame);
                 m_arValues.clear();
-                m_LastFrameNumber = currentFrameNumber.FrameNumber;
+                unsigned int PreviousFrameNumber = m_LastFrameNumber.exchange(currentFrameNumber.FrameNumber);
+                uint64_t     NewFrames           = 1;
+                if (PreviousFrameNumber != 0 && currentFrameNumber.FrameNumber > PreviousFrameNumber)
+                {
+                    NewFrames = currentFrameNumber.FrameNumber - PreviousFrameNumber;
+                }
                 if (m_InitialFrameNumber == 0)
                 {
                     m_InitialFrameNumber = m_LastFrameNumber.load();
                 }
 
-                VICONSDK::Output_GetFrameRate Rate         = m_Client.GetFrameRate();
-                VICONSDK::Output_GetTimecode  timecode     = m_Client.GetTimecode();
+                VICONSDK::Output_GetFrameRate Rate         = m_Client->GetFrameRate();
+                VICONSDK::Output_GetTimecode  timecode     = m_Client->GetTimecode();
                 double                        RelativeTime = (m_LastFrameNumber - m_InitialFrameNumber) / Rate.FrameRateHz;
 
-                // Calculate actual FPS based on frame count and elapsed time
-                auto now = std::chrono::steady_clock::now();
-                if (m_LastFPSFrameNumber == 0)
-                {
-                    // Initialize FPS tracking
-                    m_LastFPSUpdateTime  = now;
-                    m_LastFPSFrameNumber = m_LastFrameNumber.load();
-                }
-                else
-                {
-                    auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(now - m_LastFPSUpdateTime).count();
-                    if (elapsedMs >= 1000) // Update FPS every second
-                    {
-                        unsigned int framesDelta = m_LastFrameNumber - m_LastFPSFrameNumber;
-                        m_CurrentFPS             = framesDelta * 1000.0 / elapsedMs;
-                        m_LastFPSUpdateTime      = now;
-                        m_LastFPSFrameNumber     = m_LastFrameNumber.load();
-                    }
-                }
+                // FPS over the hardware frame numbers, frames the SDK skipped still count
+                m_CurrentFPS = m_FrameRate.Tick(NewFrames);
+                m_MetricFrames.Add();
+                m_MetricFramesSkipped.Add(NewFrames - 1);
 
                 // Display frame number and FPS in top right corner of console
                 PrintStatusTopRight(fmt::format("Frame: {}  FPS: {:.1f}", m_LastFrameNumber.load(), m_CurrentFPS.load()));
@@ -291,28 +316,40 @@ bool DriverVicon::Run()
                 m_arValues.push_back(RelativeTime);
 
                 // get 6DOF data
-                VICONSDK::Output_GetSubjectCount subjectCount = m_Client.GetSubjectCount();
+                VICONSDK::Output_GetSubjectCount subjectCount = m_Client->GetSubjectCount();
                 for (unsigned int SubjectIndex = 0; SubjectIndex < subjectCount.SubjectCount; ++SubjectIndex)
                 {
-                    std::string                                  SubjectName       = m_Client.GetSubjectName(SubjectIndex).SubjectName;
-                    VICONSDK::Output_GetSegmentGlobalTranslation globalTranslation = m_Client.GetSegmentGlobalTranslation(SubjectName, SubjectName);
+                    std::string                                  SubjectName       = m_Client->GetSubjectName(SubjectIndex).SubjectName;
+                    VICONSDK::Output_GetSegmentGlobalTranslation globalTranslation = m_Client->GetSegmentGlobalTranslation(SubjectName, SubjectName);
                     for (int i = 0; i < 3; i++)
                     {
                         m_arValues.push_back(globalTranslation.Translation[i]);
                     }
 
-                    VICONSDK::Output_GetSegmentGlobalRotationMatrix globalRotationMatrix = m_Client.GetSegmentGlobalRotationMatrix(SubjectName, SubjectName);
+                    // the SDK rotation is row major, converted once into the negotiated convention
+                    VICONSDK::Output_GetSegmentGlobalRotationMatrix globalRotationMatrix = m_Client->GetSegmentGlobalRotationMatrix(SubjectName, SubjectName);
+                    OrientationKernels::Matrix4x4                   T4x4                 = {};
                     for (int r = 0; r < 3; r++)
                         for (int c = 0; c < 3; c++)
-                            m_arValues.push_back(globalRotationMatrix.Rotation[r + c * 3]);
+                            T4x4[RC(r, c)] = globalRotationMatrix.Rotation[r * 3 + c];
+                    T4x4[RC(3, 3)] = 1.0;
+                    std::visit(
+                        [&](const auto &K)
+                        {
+                            using Kernel = std::decay_t<decltype(K)>;
+                            typename Kernel::Angles Angles;
+                            Kernel::From4x4(T4x4, Angles);
+                            m_arValues.insert(m_arValues.end(), Angles.begin(), Angles.end());
+                        },
+                        m_OrientKernel);
 
                     // get the marker information for this 6DOF
-                    unsigned int MarkerCount = m_Client.GetMarkerCount(SubjectName).MarkerCount;
+                    unsigned int MarkerCount = m_Client->GetMarkerCount(SubjectName).MarkerCount;
                     for (unsigned int MarkerIndex = 0; MarkerIndex < MarkerCount; ++MarkerIndex)
                     {
-                        std::string                                 MarkerName           = m_Client.GetMarkerName(SubjectName, MarkerIndex).MarkerName;
-                        std::string                                 MarkerParentName     = m_Client.GetMarkerParentName(SubjectName, MarkerName).SegmentName;
-                        VICONSDK::Output_GetMarkerGlobalTranslation markerGlobalPosition = m_Client.GetMarkerGlobalTranslation(MarkerParentName, MarkerName);
+                        std::string                                 MarkerName           = m_Client->GetMarkerName(SubjectName, MarkerIndex).MarkerName;
+                        std::string                                 MarkerParentName     = m_Client->GetMarkerParentName(SubjectName, MarkerName).SegmentName;
+                        VICONSDK::Output_GetMarkerGlobalTranslation markerGlobalPosition = m_Client->GetMarkerGlobalTranslation(MarkerParentName, MarkerName);
                         for (int i = 0; i < 3; i++)
                         {
                             m_arValues.push_back(markerGlobalPosition.Translation[i]);
@@ -321,10 +358,10 @@ bool DriverVicon::Run()
                 }
 
                 // get unlabeled 3D data
-                VICONSDK::Output_GetUnlabeledMarkerCount output_GetUnlabeledMarkerCount = m_Client.GetUnlabeledMarkerCount();
+                VICONSDK::Output_GetUnlabeledMarkerCount output_GetUnlabeledMarkerCount = m_Client->GetUnlabeledMarkerCount();
                 for (unsigned int MarkerIndex = 0; MarkerIndex < output_GetUnlabeledMarkerCount.MarkerCount; ++MarkerIndex)
                 {
-                    VICONSDK::Output_GetUnlabeledMarkerGlobalTranslation markerGlobalPosition = m_Client.GetUnlabeledMarkerGlobalTranslation(MarkerIndex);
+                    VICONSDK::Output_GetUnlabeledMarkerGlobalTranslation markerGlobalPosition = m_Client->GetUnlabeledMarkerGlobalTranslation(MarkerIndex);
                     for (int i = 0; i < 3; i++)
                         m_arValues.push_back(markerGlobalPosition.Translation[i]);
                 }
@@ -342,7 +379,7 @@ bool DriverVicon::Run()
 
 bool DriverVicon::GetValues(std::vector<double> &values)
 {
-    CTRACK_ZONE_SCOPED_NC("Vicon::GetValues", 0x8888FF); // Light Blue
+    CTRACK_ZONE_SAMPLED_NC(CTrack::ProfileCategory::Driver, "Vicon::GetValues", 0x8888FF); // Light Blue
     if (m_bRunning)
     {
         values = m_arValues;
@@ -353,7 +390,7 @@ bool DriverVicon::GetValues(std::vector<double> &values)
 
 CTrack::Reply DriverVicon::ShutDown(const CTrack::Message &message)
 {
-    CTRACK_ZONE_SCOPED_NC("Vicon::ShutDown", 0xFF8800); // Dark Orange
+    CTRACK_ZONE_CATEGORY_NC(CTrack::ProfileCategory::Driver, "Vicon::ShutDown", 0xFF8800); // Dark Orange
     bool Result = true;
     m_bRunning  = false;
 
@@ -1,18 +1,20 @@
 #pragma once
 
-#include "DataStreamClient.h"
+#include "IViconClient.h"
 #include "../Libraries/Driver/IDriver.h"
 #include "../Libraries/TCP/Subscriber.h"
+#include "../Libraries/Utility/Metrics.h"
+#include "../Libraries/Utility/OrientationKernels.h"
 
 #include <atomic>
+#include <memory>
 #include <string>
 
-namespace VICONSDK = ViconDataStreamSDK::CPP;
-
 class DriverVicon : public CTrack::IDriver, public CTrack::Subscriber
 {
   public:
-    DriverVicon()          = default;
+    /// @param client ViconSDKClient for a live DataStream server, ViconSyntheticClient for offline runs
+    explicit DriverVicon(std::unique_ptr<IViconClient> client) : m_Client(std::move(client)) {}
     virtual ~DriverVicon() = default;
 
     //-------------------------------------------------------------------------
@@ -42,6 +44,7 @@ class DriverVicon : public CTrack::IDriver, public CTrack::Subscriber
     std::string  GetLastError() const override { return m_LastError; }
     uint32_t     GetFrameNumber() const override { return m_LastFrameNumber.load(); }
     double       GetCurrentFPS() const override { return m_CurrentFPS.load(); }
+    int64_t      GetAcquireTimeNs() const override { return m_AcquireTimeNs; }
 
     // Device-Specific Capabilities
     bool HasCapability(const std::string& capability) const override;
@@ -58,20 +61,26 @@ class DriverVicon : public CTrack::IDriver, public CTrack::Subscriber
     CTrack::Reply ShutDown(const CTrack::Message& message);
 
   protected:
-    ViconDataStreamSDK::CPP::Client       m_Client;
+    // resolves a convention name sent by the engine, an empty name selects the 3x3, false when there is no such convention
+    bool SetOrientConvention(const std::string &Name);
+
+    std::unique_ptr<IViconClient>         m_Client;
     double                                m_MeasurementFrequencyHz = 10.0;
     std::atomic<bool>                     m_bConnected{false};
     std::atomic<bool>                     m_bRunning{false};
     std::atomic<unsigned int>             m_LastFrameNumber{0};
     std::atomic<unsigned int>             m_InitialFrameNumber{0};
     std::vector<double>                   m_arValues;
+    int64_t                               m_AcquireTimeNs = 0;
     std::string                           m_LastError;
     std::string                           m_SDKVersion;
 
-    // For FPS calculation
-    std::chrono::steady_clock::time_point m_LastFPSUpdateTime;
-    std::atomic<unsigned int>             m_LastFPSFrameNumber{0};
+    // FPS and metrics
+    CTrack::CFrameRateMeter               m_FrameRate;
     std::atomic<double>                   m_CurrentFPS{0.0};
+    CTrack::CMetricCounter               &m_MetricFrames        = CTrack::CMetricsRegistry::Instance().Counter("vicon.frames");
+    CTrack::CMetricCounter               &m_MetricFramesSkipped = CTrack::CMetricsRegistry::Instance().Counter("vicon.frames_skipped");
+    CLogHistogram                        &m_MetricFrame         = CTrack::CMetricsRegistry::Instance().Histogram("vicon.frame_us");
 
     // Configuration data
     std::vector<std::string>              m_arChannelNames;
@@ -79,4 +88,8 @@ class DriverVicon : public CTrack::IDriver, public CTrack::Subscriber
     std::vector<std::string>              m_arMatrix3DNames;
     std::vector<int>                      m_arMatrix3DChannelIndex;
     std::vector<size_t>                   m_arDataToChannelIndices;
+
+    // 6DOF rotation channels, the engine asks for another convention in CONFIG_DETECT and repeats it in CHECK_INIT
+    int                                   m_OrientConvention = ORIENTATION_3X3;
+    OrientationKernels::AnyKernel         m_OrientKernel{OrientationKernels::Kernel<ORIENTATION_3X3>{}};
 };
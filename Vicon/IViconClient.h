@@ -0,0 +1,75 @@
+#pragma once
+
+#include "DataStreamClient.h"
+
+#include <string>
+
+namespace VICONSDK = ViconDataStreamSDK::CPP;
+
+/// @brief Subset of the Vicon DataStream client used by DriverVicon
+/// @details The output types are the SDK's own header-only classes, so the driver code is the same
+///          whether it talks to a live Nexus/Tracker server (ViconSDKClient) or to a generated or
+///          replayed stream (ViconSyntheticClient). Only ViconSDKClient needs ViconDataStreamSDK_CPP.lib.
+class IViconClient
+{
+  public:
+    virtual ~IViconClient() = default;
+
+    //-------------------------------------------------------------------------
+    // Connection
+    //-------------------------------------------------------------------------
+
+    virtual VICONSDK::Output_GetVersion     GetVersion() const                   = 0;
+    virtual VICONSDK::Output_Connect        Connect(const std::string &HostName) = 0;
+    virtual VICONSDK::Output_Disconnect     Disconnect()                         = 0;
+    virtual VICONSDK::Output_IsConnected    IsConnected() const                  = 0;
+
+    //-------------------------------------------------------------------------
+    // Stream configuration
+    //-------------------------------------------------------------------------
+
+    virtual VICONSDK::Output_EnableDebugData             EnableDebugData()                                                                        = 0;
+    virtual VICONSDK::Output_EnableCameraCalibrationData EnableCameraCalibrationData()                                                            = 0;
+    virtual VICONSDK::Output_EnableCentroidData          EnableCentroidData()                                                                     = 0;
+    virtual VICONSDK::Output_EnableMarkerRayData         EnableMarkerRayData()                                                                    = 0;
+    virtual VICONSDK::Output_EnableMarkerData            EnableMarkerData()                                                                       = 0;
+    virtual VICONSDK::Output_EnableSegmentData           EnableSegmentData()                                                                      = 0;
+    virtual VICONSDK::Output_EnableUnlabeledMarkerData   EnableUnlabeledMarkerData()                                                              = 0;
+    virtual VICONSDK::Output_SetStreamMode               SetStreamMode(const VICONSDK::StreamMode::Enum Mode)                                     = 0;
+    virtual VICONSDK::Output_SetAxisMapping              SetAxisMapping(VICONSDK::Direction::Enum X, VICONSDK::Direction::Enum Y, VICONSDK::Direction::Enum Z) = 0;
+
+    //-------------------------------------------------------------------------
+    // Frame
+    //-------------------------------------------------------------------------
+
+    virtual VICONSDK::Output_GetFrame               GetFrame()                     = 0;
+    virtual VICONSDK::Output_GetFrameNumber         GetFrameNumber() const         = 0;
+    virtual VICONSDK::Output_GetHardwareFrameNumber GetHardwareFrameNumber() const = 0;
+    virtual VICONSDK::Output_GetFrameRate           GetFrameRate() const           = 0;
+    virtual VICONSDK::Output_GetTimecode            GetTimecode() const            = 0;
+
+    //-------------------------------------------------------------------------
+    // Cameras
+    //-------------------------------------------------------------------------
+
+    virtual VICONSDK::Output_GetCameraCount                GetCameraCount() const                                        = 0;
+    virtual VICONSDK::Output_GetCameraName                 GetCameraName(unsigned int CameraIndex) const                 = 0;
+    virtual VICONSDK::Output_GetCameraId                   GetCameraId(const std::string &CameraName) const              = 0;
+    virtual VICONSDK::Output_GetCameraGlobalTranslation    GetCameraGlobalTranslation(const std::string &CameraName) const    = 0;
+    virtual VICONSDK::Output_GetCameraGlobalRotationMatrix GetCameraGlobalRotationMatrix(const std::string &CameraName) const = 0;
+
+    //-------------------------------------------------------------------------
+    // Subjects, segments and markers
+    //-------------------------------------------------------------------------
+
+    virtual VICONSDK::Output_GetSubjectCount                GetSubjectCount() const                                                                  = 0;
+    virtual VICONSDK::Output_GetSubjectName                 GetSubjectName(unsigned int SubjectIndex) const                                          = 0;
+    virtual VICONSDK::Output_GetSegmentGlobalTranslation    GetSegmentGlobalTranslation(const std::string &SubjectName, const std::string &SegmentName) const    = 0;
+    virtual VICONSDK::Output_GetSegmentGlobalRotationMatrix GetSegmentGlobalRotationMatrix(const std::string &SubjectName, const std::string &SegmentName) const = 0;
+    virtual VICONSDK::Output_GetMarkerCount                 GetMarkerCount(const std::string &SubjectName) const                                     = 0;
+    virtual VICONSDK::Output_GetMarkerName                  GetMarkerName(const std::string &SubjectName, unsigned int MarkerIndex) const            = 0;
+    virtual VICONSDK::Output_GetMarkerParentName            GetMarkerParentName(const std::string &SubjectName, const std::string &MarkerName) const  = 0;
+    virtual VICONSDK::Output_GetMarkerGlobalTranslation     GetMarkerGlobalTranslation(const std::string &SubjectName, const std::string &MarkerName) const = 0;
+    virtual VICONSDK::Output_GetUnlabeledMarkerCount        GetUnlabeledMarkerCount() const                                                          = 0;
+    virtual VICONSDK::Output_GetUnlabeledMarkerGlobalTranslation GetUnlabeledMarkerGlobalTranslation(unsigned int MarkerIndex) const                 = 0;
+};
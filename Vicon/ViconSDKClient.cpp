@@ -0,0 +1,172 @@
+#include "ViconSDKClient.h"
+
+//-----------------------------------------------------------------------------
+/*
+Thin forwarding layer, every call goes straight to the SDK client
+*/
+//-----------------------------------------------------------------------------
+
+VICONSDK::Output_GetVersion ViconSDKClient::GetVersion() const
+{
+    return m_Client.GetVersion();
+}
+
+VICONSDK::Output_Connect ViconSDKClient::Connect(const std::string &HostName)
+{
+    return m_Client.Connect(HostName);
+}
+
+VICONSDK::Output_Disconnect ViconSDKClient::Disconnect()
+{
+    return m_Client.Disconnect();
+}
+
+VICONSDK::Output_IsConnected ViconSDKClient::IsConnected() const
+{
+    return m_Client.IsConnected();
+}
+
+VICONSDK::Output_EnableDebugData ViconSDKClient::EnableDebugData()
+{
+    return m_Client.EnableDebugData();
+}
+
+VICONSDK::Output_EnableCameraCalibrationData ViconSDKClient::EnableCameraCalibrationData()
+{
+    return m_Client.EnableCameraCalibrationData();
+}
+
+VICONSDK::Output_EnableCentroidData ViconSDKClient::EnableCentroidData()
+{
+    return m_Client.EnableCentroidData();
+}
+
+VICONSDK::Output_EnableMarkerRayData ViconSDKClient::EnableMarkerRayData()
+{
+    return m_Client.EnableMarkerRayData();
+}
+
+VICONSDK::Output_EnableMarkerData ViconSDKClient::EnableMarkerData()
+{
+    return m_Client.EnableMarkerData();
+}
+
+VICONSDK::Output_EnableSegmentData ViconSDKClient::EnableSegmentData()
+{
+    return m_Client.EnableSegmentData();
+}
+
+VICONSDK::Output_EnableUnlabeledMarkerData ViconSDKClient::EnableUnlabeledMarkerData()
+{
+    return m_Client.EnableUnlabeledMarkerData();
+}
+
+VICONSDK::Output_SetStreamMode ViconSDKClient::SetStreamMode(const VICONSDK::StreamMode::Enum Mode)
+{
+    return m_Client.SetStreamMode(Mode);
+}
+
+VICONSDK::Output_SetAxisMapping ViconSDKClient::SetAxisMapping(VICONSDK::Direction::Enum X, VICONSDK::Direction::Enum Y, VICONSDK::Direction::Enum Z)
+{
+    return m_Client.SetAxisMapping(X, Y, Z);
+}
+
+VICONSDK::Output_GetFrame ViconSDKClient::GetFrame()
+{
+    return m_Client.GetFrame();
+}
+
+VICONSDK::Output_GetFrameNumber ViconSDKClient::GetFrameNumber() const
+{
+    return m_Client.GetFrameNumber();
+}
+
+VICONSDK::Output_GetHardwareFrameNumber ViconSDKClient::GetHardwareFrameNumber() const
+{
+    return m_Client.GetHardwareFrameNumber();
+}
+
+VICONSDK::Output_GetFrameRate ViconSDKClient::GetFrameRate() const
+{
+    return m_Client.GetFrameRate();
+}
+
+VICONSDK::Output_GetTimecode ViconSDKClient::GetTimecode() const
+{
+    return m_Client.GetTimecode();
+}
+
+VICONSDK::Output_GetCameraCount ViconSDKClient::GetCameraCount() const
+{
+    return m_Client.GetCameraCount();
+}
+
+VICONSDK::Output_GetCameraName ViconSDKClient::GetCameraName(unsigned int CameraIndex) const
+{
+    return m_Client.GetCameraName(CameraIndex);
+}
+
+VICONSDK::Output_GetCameraId ViconSDKClient::GetCameraId(const std::string &CameraName) const
+{
+    return m_Client.GetCameraId(CameraName);
+}
+
+VICONSDK::Output_GetCameraGlobalTranslation ViconSDKClient::GetCameraGlobalTranslation(const std::string &CameraName) const
+{
+    return m_Client.GetCameraGlobalTranslation(CameraName);
+}
+
+VICONSDK::Output_GetCameraGlobalRotationMatrix ViconSDKClient::GetCameraGlobalRotationMatrix(const std::string &CameraName) const
+{
+    return m_Client.GetCameraGlobalRotationMatrix(CameraName);
+}
+
+VICONSDK::Output_GetSubjectCount ViconSDKClient::GetSubjectCount() const
+{
+    return m_Client.GetSubjectCount();
+}
+
+VICONSDK::Output_GetSubjectName ViconSDKClient::GetSubjectName(unsigned int SubjectIndex) const
+{
+    return m_Client.GetSubjectName(SubjectIndex);
+}
+
+VICONSDK::Output_GetSegmentGlobalTranslation ViconSDKClient::GetSegmentGlobalTranslation(const std::string &SubjectName, const std::string &SegmentName) const
+{
+    return m_Client.GetSegmentGlobalTranslation(SubjectName, SegmentName);
+}
+
+VICONSDK::Output_GetSegmentGlobalRotationMatrix ViconSDKClient::GetSegmentGlobalRotationMatrix(const std::string &SubjectName, const std::string &SegmentName) const
+{
+    return m_Client.GetSegmentGlobalRotationMatrix(SubjectName, SegmentName);
+}
+
+VICONSDK::Output_GetMarkerCount ViconSDKClient::GetMarkerCount(const std::string &SubjectName) const
+{
+    return m_Client.GetMarkerCount(SubjectName);
+}
+
+VICONSDK::Output_GetMarkerName ViconSDKClient::GetMarkerName(const std::string &SubjectName, unsigned int MarkerIndex) const
+{
+    return m_Client.GetMarkerName(SubjectName, MarkerIndex);
+}
+
+VICONSDK::Output_GetMarkerParentName ViconSDKClient::GetMarkerParentName(const std::string &SubjectName, const std::string &MarkerName) const
+{
+    return m_Client.GetMarkerParentName(SubjectName, MarkerName);
+}
+
+VICONSDK::Output_GetMarkerGlobalTranslation ViconSDKClient::GetMarkerGlobalTranslation(const std::string &SubjectName, const std::string &MarkerName) const
+{
+    return m_Client.GetMarkerGlobalTranslation(SubjectName, MarkerName);
+}
+
+VICONSDK::Output_GetUnlabeledMarkerCount ViconSDKClient::GetUnlabeledMarkerCount() const
+{
+    return m_Client.GetUnlabeledMarkerCount();
+}
+
+VICONSDK::Output_GetUnlabeledMarkerGlobalTranslation ViconSDKClient::GetUnlabeledMarkerGlobalTranslation(unsigned int MarkerIndex) const
+{
+    return m_Client.GetUnlabeledMarkerGlobalTranslation(MarkerIndex);
+}
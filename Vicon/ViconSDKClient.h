@@ -0,0 +1,52 @@
+#pragma once
+
+#include "IViconClient.h"
+
+/// @brief IViconClient backed by the real ViconDataStreamSDK::CPP::Client
+class ViconSDKClient : public IViconClient
+{
+  public:
+    ViconSDKClient()           = default;
+    ~ViconSDKClient() override = default;
+
+    VICONSDK::Output_GetVersion  GetVersion() const override;
+    VICONSDK::Output_Connect     Connect(const std::string &HostName) override;
+    VICONSDK::Output_Disconnect  Disconnect() override;
+    VICONSDK::Output_IsConnected IsConnected() const override;
+
+    VICONSDK::Output_EnableDebugData             EnableDebugData() override;
+    VICONSDK::Output_EnableCameraCalibrationData EnableCameraCalibrationData() override;
+    VICONSDK::Output_EnableCentroidData          EnableCentroidData() override;
+    VICONSDK::Output_EnableMarkerRayData         EnableMarkerRayData() override;
+    VICONSDK::Output_EnableMarkerData            EnableMarkerData() override;
+    VICONSDK::Output_EnableSegmentData           EnableSegmentData() override;
+    VICONSDK::Output_EnableUnlabeledMarkerData   EnableUnlabeledMarkerData() override;
+    VICONSDK::Output_SetStreamMode               SetStreamMode(const VICONSDK::StreamMode::Enum Mode) override;
+    VICONSDK::Output_SetAxisMapping              SetAxisMapping(VICONSDK::Direction::Enum X, VICONSDK::Direction::Enum Y, VICONSDK::Direction::Enum Z) override;
+
+    VICONSDK::Output_GetFrame               GetFrame() override;
+    VICONSDK::Output_GetFrameNumber         GetFrameNumber() const override;
+    VICONSDK::Output_GetHardwareFrameNumber GetHardwareFrameNumber() const override;
+    VICONSDK::Output_GetFrameRate           GetFrameRate() const override;
+    VICONSDK::Output_GetTimecode            GetTimecode() const override;
+
+    VICONSDK::Output_GetCameraCount                GetCameraCount() const override;
+    VICONSDK::Output_GetCameraName                 GetCameraName(unsigned int CameraIndex) const override;
+    VICONSDK::Output_GetCameraId                   GetCameraId(const std::string &CameraName) const override;
+    VICONSDK::Output_GetCameraGlobalTranslation    GetCameraGlobalTranslation(const std::string &CameraName) const override;
+    VICONSDK::Output_GetCameraGlobalRotationMatrix GetCameraGlobalRotationMatrix(const std::string &CameraName) const override;
+
+    VICONSDK::Output_GetSubjectCount                       GetSubjectCount() const override;
+    VICONSDK::Output_GetSubjectName                        GetSubjectName(unsigned int SubjectIndex) const override;
+    VICONSDK::Output_GetSegmentGlobalTranslation           GetSegmentGlobalTranslation(const std::string &SubjectName, const std::string &SegmentName) const override;
+    VICONSDK::Output_GetSegmentGlobalRotationMatrix        GetSegmentGlobalRotationMatrix(const std::string &SubjectName, const std::string &SegmentName) const override;
+    VICONSDK::Output_GetMarkerCount                        GetMarkerCount(const std::string &SubjectName) const override;
+    VICONSDK::Output_GetMarkerName                         GetMarkerName(const std::string &SubjectName, unsigned int MarkerIndex) const override;
+    VICONSDK::Output_GetMarkerParentName                   GetMarkerParentName(const std::string &SubjectName, const std::string &MarkerName) const override;
+    VICONSDK::Output_GetMarkerGlobalTranslation            GetMarkerGlobalTranslation(const std::string &SubjectName, const std::string &MarkerName) const override;
+    VICONSDK::Output_GetUnlabeledMarkerCount               GetUnlabeledMarkerCount() const override;
+    VICONSDK::Output_GetUnlabeledMarkerGlobalTranslation   GetUnlabeledMarkerGlobalTranslation(unsigned int MarkerIndex) const override;
+
+  protected:
+    VICONSDK::Client m_Client;
+};
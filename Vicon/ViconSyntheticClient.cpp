@@ -0,0 +1,573 @@
+#include "ViconSyntheticClient.h"
+#include "../Libraries/Utility/FileReader.h"
+
+#include <fmt/format.h>
+
+#include <cmath>
+#include <thread>
+
+namespace
+{
+constexpr double PI                 = 3.14159265358979323846;
+constexpr double SUBJECT_GRID_MM    = 500.0; // spacing between subject home positions
+constexpr double SUBJECT_RADIUS_MM  = 100.0; // radius of the circle each subject travels
+constexpr double SUBJECT_HEIGHT_MM  = 1000.0;
+constexpr double SUBJECT_SPEED_RADS = 0.5 * PI;
+constexpr double MARKER_RADIUS_MM   = 50.0;
+constexpr double VOLUME_RADIUS_MM   = 3000.0; // unlabeled markers and cameras
+constexpr int    GRID_COLUMNS       = 25;
+} // namespace
+
+ViconSyntheticClient::ViconSyntheticClient(const ViconSyntheticConfig &Config) : m_Config(Config)
+{
+    if (m_Config.NumSubjects == 0)
+    {
+        m_Config.NumSubjects = 1;
+    }
+    if (m_Config.FrameRateHz <= 0.0)
+    {
+        m_Config.FrameRateHz = 100.0;
+    }
+
+    for (unsigned int i = 0; i < m_Config.NumCameras; i++)
+    {
+        m_CameraNames.push_back(fmt::format("Camera_{}", i + 1));
+    }
+
+    m_SubjectNames.reserve(m_Config.NumSubjects);
+    m_MarkerNames.resize(m_Config.NumSubjects);
+    m_MarkerLookup.resize(m_Config.NumSubjects);
+    for (unsigned int s = 0; s < m_Config.NumSubjects; s++)
+    {
+        m_SubjectNames.push_back(fmt::format("Body_{}", s + 1));
+        m_SubjectLookup[m_SubjectNames.back()] = s;
+        for (unsigned int m = 0; m < m_Config.MarkersPerSubject; m++)
+        {
+            m_MarkerNames[s].push_back(fmt::format("Body_{}_M{}", s + 1, m + 1));
+            m_MarkerLookup[s][m_MarkerNames[s].back()] = m;
+        }
+    }
+
+    // labeled markers sit on a ring in the subject frame, alternating in height so the body is not planar
+    m_MarkerLocal.resize(3 * m_Config.MarkersPerSubject);
+    for (unsigned int m = 0; m < m_Config.MarkersPerSubject; m++)
+    {
+        double Angle           = 2.0 * PI * m / m_Config.MarkersPerSubject;
+        m_MarkerLocal[3 * m]     = MARKER_RADIUS_MM * std::cos(Angle);
+        m_MarkerLocal[3 * m + 1] = MARKER_RADIUS_MM * std::sin(Angle);
+        m_MarkerLocal[3 * m + 2] = 20.0 * (m % 3);
+    }
+
+    // golden ratio spacing keeps unlabeled markers apart without a random generator
+    m_UnlabeledPhase.resize(m_Config.NumUnlabeled);
+    for (unsigned int u = 0; u < m_Config.NumUnlabeled; u++)
+    {
+        m_UnlabeledPhase[u] = std::fmod(u * 0.6180339887498949, 1.0);
+    }
+
+    m_SegmentTranslation.resize(m_Config.NumSubjects);
+    m_SegmentRotation.resize(m_Config.NumSubjects);
+    m_MarkerGlobal.resize(3 * m_Config.NumSubjects * m_Config.MarkersPerSubject);
+    m_Unlabeled.resize(3 * m_Config.NumUnlabeled);
+}
+
+//-----------------------------------------------------------------------------
+/*
+Connection
+*/
+//-----------------------------------------------------------------------------
+
+VICONSDK::Output_GetVersion ViconSyntheticClient::GetVersion() const
+{
+    VICONSDK::Output_GetVersion Output{};
+    Output.Major = 0; // 0.0.0.0 marks the synthetic stream in the device info
+    return Output;
+}
+
+VICONSDK::Output_Connect ViconSyntheticClient::Connect(const std::string &HostName)
+{
+    VICONSDK::Output_Connect Output{};
+    m_LastError.clear();
+    if (!m_Config.ReplayFile.empty() && !LoadReplay())
+    {
+        m_bConnected  = false;
+        Output.Result = VICONSDK::Result::ClientConnectionFailed;
+        return Output;
+    }
+    m_bConnected    = true;
+    m_bHasFrame     = false;
+    m_FrameNumber   = 0;
+    m_NextFrameTime = std::chrono::steady_clock::now();
+    Output.Result   = VICONSDK::Result::Success;
+    return Output;
+}
+
+VICONSDK::Output_Disconnect ViconSyntheticClient::Disconnect()
+{
+    VICONSDK::Output_Disconnect Output{};
+    Output.Result = m_bConnected ? VICONSDK::Result::Success : VICONSDK::Result::NotConnected;
+    m_bConnected  = false;
+    m_bHasFrame   = false;
+    return Output;
+}
+
+VICONSDK::Output_IsConnected ViconSyntheticClient::IsConnected() const
+{
+    VICONSDK::Output_IsConnected Output{};
+    Output.Connected = m_bConnected;
+    return Output;
+}
+
+bool ViconSyntheticClient::LoadReplay()
+{
+    size_t ExpectedColumns = m_Config.NumSubjects * (12 + 3 * m_Config.MarkersPerSubject) + 3 * m_Config.NumUnlabeled;
+    m_ReplayFrames         = FileReader::ReadNumbersFromFile(m_Config.ReplayFile);
+    if (m_ReplayFrames.empty())
+    {
+        m_LastError = fmt::format("No frames in replay file {}", m_Config.ReplayFile);
+        return false;
+    }
+    for (size_t i = 0; i < m_ReplayFrames.size(); i++)
+    {
+        if (m_ReplayFrames[i].size() != ExpectedColumns)
+        {
+            m_LastError = fmt::format("Replay file {} row {} has {} columns, expected {}", m_Config.ReplayFile, i, m_ReplayFrames[i].size(), ExpectedColumns);
+            m_ReplayFrames.clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+/*
+Stream configuration, everything is always streamed
+*/
+//-----------------------------------------------------------------------------
+
+template <typename T> static T SimpleSuccess()
+{
+    T Output{};
+    Output.Result = VICONSDK::Result::Success;
+    return Output;
+}
+
+VICONSDK::Output_EnableDebugData ViconSyntheticClient::EnableDebugData()
+{
+    return SimpleSuccess<VICONSDK::Output_EnableDebugData>();
+}
+
+VICONSDK::Output_EnableCameraCalibrationData ViconSyntheticClient::EnableCameraCalibrationData()
+{
+    return SimpleSuccess<VICONSDK::Output_EnableCameraCalibrationData>();
+}
+
+VICONSDK::Output_EnableCentroidData ViconSyntheticClient::EnableCentroidData()
+{
+    return SimpleSuccess<VICONSDK::Output_EnableCentroidData>();
+}
+
+VICONSDK::Output_EnableMarkerRayData ViconSyntheticClient::EnableMarkerRayData()
+{
+    return SimpleSuccess<VICONSDK::Output_EnableMarkerRayData>();
+}
+
+VICONSDK::Output_EnableMarkerData ViconSyntheticClient::EnableMarkerData()
+{
+    return SimpleSuccess<VICONSDK::Output_EnableMarkerData>();
+}
+
+VICONSDK::Output_EnableSegmentData ViconSyntheticClient::EnableSegmentData()
+{
+    return SimpleSuccess<VICONSDK::Output_EnableSegmentData>();
+}
+
+VICONSDK::Output_EnableUnlabeledMarkerData ViconSyntheticClient::EnableUnlabeledMarkerData()
+{
+    return SimpleSuccess<VICONSDK::Output_EnableUnlabeledMarkerData>();
+}
+
+VICONSDK::Output_SetStreamMode ViconSyntheticClient::SetStreamMode(const VICONSDK::StreamMode::Enum Mode)
+{
+    return SimpleSuccess<VICONSDK::Output_SetStreamMode>();
+}
+
+VICONSDK::Output_SetAxisMapping ViconSyntheticClient::SetAxisMapping(VICONSDK::Direction::Enum X, VICONSDK::Direction::Enum Y, VICONSDK::Direction::Enum Z)
+{
+    return SimpleSuccess<VICONSDK::Output_SetAxisMapping>();
+}
+
+//-----------------------------------------------------------------------------
+/*
+Frame
+*/
+//-----------------------------------------------------------------------------
+
+VICONSDK::Output_GetFrame ViconSyntheticClient::GetFrame()
+{
+    VICONSDK::Output_GetFrame Output{};
+    if (!m_bConnected)
+    {
+        Output.Result = VICONSDK::Result::NotConnected;
+        return Output;
+    }
+
+    if (m_Config.bRealTime)
+    {
+        // behave like ServerPush : block until the next frame is due, never queue up missed frames
+        auto Now = std::chrono::steady_clock::now();
+        if (m_NextFrameTime > Now)
+        {
+            std::this_thread::sleep_until(m_NextFrameTime);
+            m_NextFrameTime += std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / m_Config.FrameRateHz));
+        }
+        else
+        {
+            m_NextFrameTime = Now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / m_Config.FrameRateHz));
+        }
+    }
+
+    m_FrameNumber++;
+    ComputeFrame();
+    m_bHasFrame   = true;
+    Output.Result = VICONSDK::Result::Success;
+    return Output;
+}
+
+void ViconSyntheticClient::ComputeFrame()
+{
+    const unsigned int NumMarkers = m_Config.MarkersPerSubject;
+
+    if (!m_ReplayFrames.empty())
+    {
+        const std::vector<double> &Row    = m_ReplayFrames[(m_FrameNumber - 1) % m_ReplayFrames.size()];
+        size_t                     Column = 0;
+        for (unsigned int s = 0; s < m_Config.NumSubjects; s++)
+        {
+            for (int i = 0; i < 3; i++)
+                m_SegmentTranslation[s][i] = Row[Column++];
+            for (int i = 0; i < 9; i++)
+                m_SegmentRotation[s][i] = Row[Column++];
+            for (unsigned int i = 0; i < 3 * NumMarkers; i++)
+                m_MarkerGlobal[3 * s * NumMarkers + i] = Row[Column++];
+        }
+        for (unsigned int i = 0; i < 3 * m_Config.NumUnlabeled; i++)
+            m_Unlabeled[i] = Row[Column++];
+        return;
+    }
+
+    const double Time = m_FrameNumber / m_Config.FrameRateHz;
+    for (unsigned int s = 0; s < m_Config.NumSubjects; s++)
+    {
+        double Angle = SUBJECT_SPEED_RADS * Time + 2.0 * PI * s / m_Config.NumSubjects;
+        double Cos   = std::cos(Angle);
+        double Sin   = std::sin(Angle);
+
+        std::array<double, 3> &T = m_SegmentTranslation[s];
+        T[0]                     = (s % GRID_COLUMNS) * SUBJECT_GRID_MM + SUBJECT_RADIUS_MM * Cos;
+        T[1]                     = (s / GRID_COLUMNS) * SUBJECT_GRID_MM + SUBJECT_RADIUS_MM * Sin;
+        T[2]                     = SUBJECT_HEIGHT_MM;
+
+        // rotation about Z, row major like the SDK
+        std::array<double, 9> &R = m_SegmentRotation[s];
+        R                        = {Cos, -Sin, 0.0, Sin, Cos, 0.0, 0.0, 0.0, 1.0};
+
+        double *Global           = &m_MarkerGlobal[3 * s * NumMarkers];
+        for (unsigned int m = 0; m < NumMarkers; m++)
+        {
+            const double *Local = &m_MarkerLocal[3 * m];
+            for (int r = 0; r < 3; r++)
+            {
+                Global[3 * m + r] = T[r] + R[3 * r] * Local[0] + R[3 * r + 1] * Local[1] + R[3 * r + 2] * Local[2];
+            }
+        }
+    }
+
+    for (unsigned int u = 0; u < m_Config.NumUnlabeled; u++)
+    {
+        double Angle         = 2.0 * PI * m_UnlabeledPhase[u] + 0.1 * SUBJECT_SPEED_RADS * Time;
+        m_Unlabeled[3 * u]     = VOLUME_RADIUS_MM * m_UnlabeledPhase[u] * std::cos(Angle);
+        m_Unlabeled[3 * u + 1] = VOLUME_RADIUS_MM * m_UnlabeledPhase[u] * std::sin(Angle);
+        m_Unlabeled[3 * u + 2] = 2000.0 * m_UnlabeledPhase[u];
+    }
+}
+
+VICONSDK::Output_GetFrameNumber ViconSyntheticClient::GetFrameNumber() const
+{
+    VICONSDK::Output_GetFrameNumber Output{};
+    Output.Result      = m_bHasFrame ? VICONSDK::Result::Success : VICONSDK::Result::NoFrame;
+    Output.FrameNumber = m_FrameNumber;
+    return Output;
+}
+
+VICONSDK::Output_GetHardwareFrameNumber ViconSyntheticClient::GetHardwareFrameNumber() const
+{
+    VICONSDK::Output_GetHardwareFrameNumber Output{};
+    Output.Result              = m_bHasFrame ? VICONSDK::Result::Success : VICONSDK::Result::NoFrame;
+    Output.HardwareFrameNumber = m_FrameNumber;
+    return Output;
+}
+
+VICONSDK::Output_GetFrameRate ViconSyntheticClient::GetFrameRate() const
+{
+    VICONSDK::Output_GetFrameRate Output{};
+    Output.Result      = m_bHasFrame ? VICONSDK::Result::Success : VICONSDK::Result::NoFrame;
+    Output.FrameRateHz = m_Config.FrameRateHz;
+    return Output;
+}
+
+VICONSDK::Output_GetTimecode ViconSyntheticClient::GetTimecode() const
+{
+    VICONSDK::Output_GetTimecode Output{};
+    Output.Result   = m_bHasFrame ? VICONSDK::Result::Success : VICONSDK::Result::NoFrame;
+    Output.Standard = VICONSDK::TimecodeStandard::None;
+    return Output;
+}
+
+//-----------------------------------------------------------------------------
+/*
+Cameras, evenly spread on a circle looking at the origin
+*/
+//-----------------------------------------------------------------------------
+
+VICONSDK::Output_GetCameraCount ViconSyntheticClient::GetCameraCount() const
+{
+    VICONSDK::Output_GetCameraCount Output{};
+    Output.Result      = m_bHasFrame ? VICONSDK::Result::Success : VICONSDK::Result::NoFrame;
+    Output.CameraCount = static_cast<unsigned int>(m_CameraNames.size());
+    return Output;
+}
+
+VICONSDK::Output_GetCameraName ViconSyntheticClient::GetCameraName(unsigned int CameraIndex) const
+{
+    VICONSDK::Output_GetCameraName Output{};
+    if (CameraIndex >= m_CameraNames.size())
+    {
+        Output.Result = VICONSDK::Result::InvalidIndex;
+        return Output;
+    }
+    Output.Result     = VICONSDK::Result::Success;
+    Output.CameraName = m_CameraNames[CameraIndex].c_str();
+    return Output;
+}
+
+VICONSDK::Output_GetCameraId ViconSyntheticClient::GetCameraId(const std::string &CameraName) const
+{
+    VICONSDK::Output_GetCameraId Output{};
+    Output.Result = VICONSDK::Result::InvalidCameraName;
+    for (size_t i = 0; i < m_CameraNames.size(); i++)
+    {
+        if (m_CameraNames[i] == CameraName)
+        {
+            Output.Result   = VICONSDK::Result::Success;
+            Output.CameraId = static_cast<unsigned int>(i + 1);
+        }
+    }
+    return Output;
+}
+
+VICONSDK::Output_GetCameraGlobalTranslation ViconSyntheticClient::GetCameraGlobalTranslation(const std::string &CameraName) const
+{
+    VICONSDK::Output_GetCameraGlobalTranslation Output{};
+    VICONSDK::Output_GetCameraId                Id = GetCameraId(CameraName);
+    Output.Result                                  = Id.Result;
+    if (Id.Result == VICONSDK::Result::Success)
+    {
+        double Angle          = 2.0 * PI * (Id.CameraId - 1) / m_CameraNames.size();
+        Output.Translation[0] = VOLUME_RADIUS_MM * std::cos(Angle);
+        Output.Translation[1] = VOLUME_RADIUS_MM * std::sin(Angle);
+        Output.Translation[2] = 2500.0;
+    }
+    return Output;
+}
+
+VICONSDK::Output_GetCameraGlobalRotationMatrix ViconSyntheticClient::GetCameraGlobalRotationMatrix(const std::string &CameraName) const
+{
+    VICONSDK::Output_GetCameraGlobalRotationMatrix Output{};
+    VICONSDK::Output_GetCameraId                   Id = GetCameraId(CameraName);
+    Output.Result                                     = Id.Result;
+    if (Id.Result == VICONSDK::Result::Success)
+    {
+        double Angle     = 2.0 * PI * (Id.CameraId - 1) / m_CameraNames.size() + PI;
+        double Cos       = std::cos(Angle);
+        double Sin       = std::sin(Angle);
+        double Rot[9]    = {Cos, -Sin, 0.0, Sin, Cos, 0.0, 0.0, 0.0, 1.0};
+        for (int i = 0; i < 9; i++)
+            Output.Rotation[i] = Rot[i];
+    }
+    return Output;
+}
+
+//-----------------------------------------------------------------------------
+/*
+Subjects, segments and markers : every subject has one segment with the same name
+*/
+//-----------------------------------------------------------------------------
+
+bool ViconSyntheticClient::FindSubject(const std::string &SubjectName, unsigned int &SubjectIndex) const
+{
+    auto it = m_SubjectLookup.find(SubjectName);
+    if (it == m_SubjectLookup.end())
+    {
+        return false;
+    }
+    SubjectIndex = it->second;
+    return true;
+}
+
+VICONSDK::Output_GetSubjectCount ViconSyntheticClient::GetSubjectCount() const
+{
+    VICONSDK::Output_GetSubjectCount Output{};
+    Output.Result       = m_bHasFrame ? VICONSDK::Result::Success : VICONSDK::Result::NoFrame;
+    Output.SubjectCount = m_bHasFrame ? static_cast<unsigned int>(m_SubjectNames.size()) : 0;
+    return Output;
+}
+
+VICONSDK::Output_GetSubjectName ViconSyntheticClient::GetSubjectName(unsigned int SubjectIndex) const
+{
+    VICONSDK::Output_GetSubjectName Output{};
+    if (SubjectIndex >= m_SubjectNames.size())
+    {
+        Output.Result = VICONSDK::Result::InvalidIndex;
+        return Output;
+    }
+    Output.Result      = VICONSDK::Result::Success;
+    Output.SubjectName = m_SubjectNames[SubjectIndex].c_str();
+    return Output;
+}
+
+VICONSDK::Output_GetSegmentGlobalTranslation ViconSyntheticClient::GetSegmentGlobalTranslation(const std::string &SubjectName, const std::string &SegmentName) const
+{
+    VICONSDK::Output_GetSegmentGlobalTranslation Output{};
+    unsigned int                                 Subject = 0;
+    if (!FindSubject(SubjectName, Subject))
+    {
+        Output.Result = VICONSDK::Result::InvalidSubjectName;
+        return Output;
+    }
+    if (SegmentName != SubjectName)
+    {
+        Output.Result = VICONSDK::Result::InvalidSegmentName;
+        return Output;
+    }
+    Output.Result = VICONSDK::Result::Success;
+    for (int i = 0; i < 3; i++)
+        Output.Translation[i] = m_SegmentTranslation[Subject][i];
+    return Output;
+}
+
+VICONSDK::Output_GetSegmentGlobalRotationMatrix ViconSyntheticClient::GetSegmentGlobalRotationMatrix(const std::string &SubjectName, const std::string &SegmentName) const
+{
+    VICONSDK::Output_GetSegmentGlobalRotationMatrix Output{};
+    unsigned int                                    Subject = 0;
+    if (!FindSubject(SubjectName, Subject))
+    {
+        Output.Result = VICONSDK::Result::InvalidSubjectName;
+        return Output;
+    }
+    if (SegmentName != SubjectName)
+    {
+        Output.Result = VICONSDK::Result::InvalidSegmentName;
+        return Output;
+    }
+    Output.Result = VICONSDK::Result::Success;
+    for (int i = 0; i < 9; i++)
+        Output.Rotation[i] = m_SegmentRotation[Subject][i];
+    return Output;
+}
+
+VICONSDK::Output_GetMarkerCount ViconSyntheticClient::GetMarkerCount(const std::string &SubjectName) const
+{
+    VICONSDK::Output_GetMarkerCount Output{};
+    unsigned int                    Subject = 0;
+    if (!FindSubject(SubjectName, Subject))
+    {
+        Output.Result = VICONSDK::Result::InvalidSubjectName;
+        return Output;
+    }
+    Output.Result      = VICONSDK::Result::Success;
+    Output.MarkerCount = static_cast<unsigned int>(m_MarkerNames[Subject].size());
+    return Output;
+}
+
+VICONSDK::Output_GetMarkerName ViconSyntheticClient::GetMarkerName(const std::string &SubjectName, unsigned int MarkerIndex) const
+{
+    VICONSDK::Output_GetMarkerName Output{};
+    unsigned int                   Subject = 0;
+    if (!FindSubject(SubjectName, Subject))
+    {
+        Output.Result = VICONSDK::Result::InvalidSubjectName;
+        return Output;
+    }
+    if (MarkerIndex >= m_MarkerNames[Subject].size())
+    {
+        Output.Result = VICONSDK::Result::InvalidIndex;
+        return Output;
+    }
+    Output.Result     = VICONSDK::Result::Success;
+    Output.MarkerName = m_MarkerNames[Subject][MarkerIndex].c_str();
+    return Output;
+}
+
+VICONSDK::Output_GetMarkerParentName ViconSyntheticClient::GetMarkerParentName(const std::string &SubjectName, const std::string &MarkerName) const
+{
+    VICONSDK::Output_GetMarkerParentName Output{};
+    unsigned int                         Subject = 0;
+    if (!FindSubject(SubjectName, Subject))
+    {
+        Output.Result = VICONSDK::Result::InvalidSubjectName;
+        return Output;
+    }
+    if (m_MarkerLookup[Subject].count(MarkerName) == 0)
+    {
+        Output.Result = VICONSDK::Result::InvalidMarkerName;
+        return Output;
+    }
+    Output.Result      = VICONSDK::Result::Success;
+    Output.SegmentName = m_SubjectNames[Subject].c_str();
+    return Output;
+}
+
+VICONSDK::Output_GetMarkerGlobalTranslation ViconSyntheticClient::GetMarkerGlobalTranslation(const std::string &SubjectName, const std::string &MarkerName) const
+{
+    VICONSDK::Output_GetMarkerGlobalTranslation Output{};
+    unsigned int                                Subject = 0;
+    if (!FindSubject(SubjectName, Subject))
+    {
+        Output.Result = VICONSDK::Result::InvalidSubjectName;
+        return Output;
+    }
+    auto it = m_MarkerLookup[Subject].find(MarkerName);
+    if (it == m_MarkerLookup[Subject].end())
+    {
+        Output.Result = VICONSDK::Result::InvalidMarkerName;
+        return Output;
+    }
+    const double *Global = &m_MarkerGlobal[3 * (Subject * m_Config.MarkersPerSubject + it->second)];
+    Output.Result        = VICONSDK::Result::Success;
+    for (int i = 0; i < 3; i++)
+        Output.Translation[i] = Global[i];
+    return Output;
+}
+
+VICONSDK::Output_GetUnlabeledMarkerCount ViconSyntheticClient::GetUnlabeledMarkerCount() const
+{
+    VICONSDK::Output_GetUnlabeledMarkerCount Output{};
+    Output.Result      = m_bHasFrame ? VICONSDK::Result::Success : VICONSDK::Result::NoFrame;
+    Output.MarkerCount = m_bHasFrame ? m_Config.NumUnlabeled : 0;
+    return Output;
+}
+
+VICONSDK::Output_GetUnlabeledMarkerGlobalTranslation ViconSyntheticClient::GetUnlabeledMarkerGlobalTranslation(unsigned int MarkerIndex) const
+{
+    VICONSDK::Output_GetUnlabeledMarkerGlobalTranslation Output{};
+    if (MarkerIndex >= m_Config.NumUnlabeled)
+    {
+        Output.Result = VICONSDK::Result::InvalidIndex;
+        return Output;
+    }
+    Output.Result = VICONSDK::Result::Success;
+    for (int i = 0; i < 3; i++)
+        Output.Translation[i] = m_Unlabeled[3 * MarkerIndex + i];
+    return Output;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "IViconClient.h"
+
+#include <array>
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// @brief Scale and timing of the synthetic Vicon stream
+struct ViconSyntheticConfig
+{
+    unsigned int NumSubjects       = 4;     ///< rigid bodies, 1..500
+    unsigned int MarkersPerSubject = 4;     ///< labeled markers on every rigid body
+    unsigned int NumUnlabeled      = 0;     ///< unlabeled markers, up to 10k
+    unsigned int NumCameras        = 8;     ///< cameras reported by hardware detect
+    double       FrameRateHz       = 100.0; ///< stream rate
+    bool         bRealTime         = true;  ///< GetFrame blocks until the next frame is due (ServerPush), false = free running
+    std::string  ReplayFile;                ///< optional recorded frames, see ViconSyntheticClient
+};
+
+/// @brief IViconClient that generates or replays a Vicon stream without a DataStream server
+/// @details Every frame is a deterministic function of the frame number, so two runs with the same
+///          configuration produce identical data. Subjects move on a circle around their own grid
+///          cell and rotate about Z, labeled markers are fixed offsets in the subject frame and
+///          unlabeled markers follow a helix.
+///
+///          When ReplayFile is set, the frames are read from that file instead: one row per frame with
+///          for every subject x y z and the 9 values of the row-major rotation matrix followed by
+///          x y z of each of its markers, then x y z of every unlabeled marker. Replay loops at the end.
+class ViconSyntheticClient : public IViconClient
+{
+  public:
+    explicit ViconSyntheticClient(const ViconSyntheticConfig &Config = ViconSyntheticConfig());
+    ~ViconSyntheticClient() override = default;
+
+    const ViconSyntheticConfig &GetConfig() const { return m_Config; }
+    const std::string          &GetLastError() const { return m_LastError; }
+
+    VICONSDK::Output_GetVersion  GetVersion() const override;
+    VICONSDK::Output_Connect     Connect(const std::string &HostName) override;
+    VICONSDK::Output_Disconnect  Disconnect() override;
+    VICONSDK::Output_IsConnected IsConnected() const override;
+
+    VICONSDK::Output_EnableDebugData             EnableDebugData() override;
+    VICONSDK::Output_EnableCameraCalibrationData EnableCameraCalibrationData() override;
+    VICONSDK::Output_EnableCentroidData          EnableCentroidData() override;
+    VICONSDK::Output_EnableMarkerRayData         EnableMarkerRayData() override;
+    VICONSDK::Output_EnableMarkerData            EnableMarkerData() override;
+    VICONSDK::Output_EnableSegmentData           EnableSegmentData() override;
+    VICONSDK::Output_EnableUnlabeledMarkerData   EnableUnlabeledMarkerData() override;
+    VICONSDK::Output_SetStreamMode               SetStreamMode(const VICONSDK::StreamMode::Enum Mode) override;
+    VICONSDK::Output_SetAxisMapping              SetAxisMapping(VICONSDK::Direction::Enum X, VICONSDK::Direction::Enum Y, VICONSDK::Direction::Enum Z) override;
+
+    VICONSDK::Output_GetFrame               GetFrame() override;
+    VICONSDK::Output_GetFrameNumber         GetFrameNumber() const override;
+    VICONSDK::Output_GetHardwareFrameNumber GetHardwareFrameNumber() const override;
+    VICONSDK::Output_GetFrameRate           GetFrameRate() const override;
+    VICONSDK::Output_GetTimecode            GetTimecode() const override;
+
+    VICONSDK::Output_GetCameraCount                GetCameraCount() const override;
+    VICONSDK::Output_GetCameraName                 GetCameraName(unsigned int CameraIndex) const override;
+    VICONSDK::Output_GetCameraId                   GetCameraId(const std::string &CameraName) const override;
+    VICONSDK::Output_GetCameraGlobalTranslation    GetCameraGlobalTranslation(const std::string &CameraName) const override;
+    VICONSDK::Output_GetCameraGlobalRotationMatrix GetCameraGlobalRotationMatrix(const std::string &CameraName) const override;
+
+    VICONSDK::Output_GetSubjectCount                       GetSubjectCount() const override;
+    VICONSDK::Output_GetSubjectName                        GetSubjectName(unsigned int SubjectIndex) const override;
+    VICONSDK::Output_GetSegmentGlobalTranslation           GetSegmentGlobalTranslation(const std::string &SubjectName, const std::string &SegmentName) const override;
+    VICONSDK::Output_GetSegmentGlobalRotationMatrix        GetSegmentGlobalRotationMatrix(const std::string &SubjectName, const std::string &SegmentName) const override;
+    VICONSDK::Output_GetMarkerCount                        GetMarkerCount(const std::string &SubjectName) const override;
+    VICONSDK::Output_GetMarkerName                         GetMarkerName(const std::string &SubjectName, unsigned int MarkerIndex) const override;
+    VICONSDK::Output_GetMarkerParentName                   GetMarkerParentName(const std::string &SubjectName, const std::string &MarkerName) const override;
+    VICONSDK::Output_GetMarkerGlobalTranslation            GetMarkerGlobalTranslation(const std::string &SubjectName, const std::string &MarkerName) const override;
+    VICONSDK::Output_GetUnlabeledMarkerCount               GetUnlabeledMarkerCount() const override;
+    VICONSDK::Output_GetUnlabeledMarkerGlobalTranslation   GetUnlabeledMarkerGlobalTranslation(unsigned int MarkerIndex) const override;
+
+  protected:
+    bool LoadReplay();
+    void ComputeFrame();
+    bool FindSubject(const std::string &SubjectName, unsigned int &SubjectIndex) const;
+
+  protected:
+    ViconSyntheticConfig                                    m_Config;
+    bool                                                    m_bConnected  = false;
+    bool                                                    m_bHasFrame   = false;
+    unsigned int                                            m_FrameNumber = 0;
+    std::chrono::steady_clock::time_point                   m_NextFrameTime;
+    std::string                                             m_LastError;
+
+    // names, stable for the lifetime of a connection because the SDK output strings point into them
+    std::vector<std::string>                                m_CameraNames;
+    std::vector<std::string>                                m_SubjectNames;
+    std::vector<std::vector<std::string>>                   m_MarkerNames;
+    std::unordered_map<std::string, unsigned int>           m_SubjectLookup;
+    std::vector<std::unordered_map<std::string, unsigned>>  m_MarkerLookup;
+
+    // current frame
+    std::vector<std::array<double, 3>>                      m_SegmentTranslation;
+    std::vector<std::array<double, 9>>                      m_SegmentRotation;
+    std::vector<double>                                     m_MarkerLocal;    // 3 per labeled marker, subject frame
+    std::vector<double>                                     m_MarkerGlobal;   // 3 per labeled marker
+    std::vector<double>                                     m_UnlabeledPhase; // 1 per unlabeled marker
+    std::vector<double>                                     m_Unlabeled;      // 3 per unlabeled marker
+
+    // replay
+    std::vector<std::vector<double>>                        m_ReplayFrames;
+};
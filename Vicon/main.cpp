@@ -11,11 +11,16 @@
 #include "../Libraries/Testing/ProfilingControl.h"
 #include "../Libraries/XML/ProxyKeywords.h"
 #include "../Libraries/XML/TinyXML_AttributeValues.h"
+#include "../Libraries/Testing/ClientStressTest.h"
+#include "../Libraries/Testing/FlightRecorder.h"
 #include "../Libraries/Testing/StressTest.h"
 #include "../../CTrack_Data/ProxyHandshake.h"
 
 #include "DriverVicon.h"
+#include "ViconSDKClient.h"
+#include "ViconSyntheticClient.h"
 
+#include <algorithm>
 #include <conio.h>
 #include <iostream>
 #include <memory>
@@ -31,22 +36,57 @@ int main(int argc, char *argv[])
     
     //
     // command line parameters
-    unsigned short PortNumber(40001);
-    bool           showConsole{true};
-    bool           profiling{false};
+    unsigned short       PortNumber(40001);
+    bool                 showConsole{true};
+    bool                 profiling{false};
+    bool                 synthetic{false};
+    bool                 timestamps{false};
+    double               metricsLog{0.0};
+    int                  flightRecorder{0};
+    std::string          stressReplay;
+    double               stressReplaySpeed{0.0};
+    ViconSyntheticConfig syntheticConfig;
 
     CommandLineParameters parameters(argc, argv);
 
     if (parameters.isInitializedFromJson())
     {
-        PortNumber  = parameters.getInt(TCPPORT, 40001);
-        showConsole = parameters.getBool(SHOWCONSOLE, true);
-        profiling   = parameters.getBool(PROFILING, false);
+        PortNumber                        = parameters.getInt(TCPPORT, 40001);
+        showConsole                       = parameters.getBool(SHOWCONSOLE, true);
+        profiling                         = parameters.getBool(PROFILING, false);
+        synthetic                         = parameters.getBool(ProxyCmdLine::Synthetic, false);
+        timestamps                        = parameters.getBool(ProxyCmdLine::Timestamps, false);
+        metricsLog                        = parameters.getDouble(ProxyCmdLine::MetricsLog, 0.0);
+        flightRecorder                    = parameters.getInt(ProxyCmdLine::FlightRecorder, 0);
+        stressReplay                      = parameters.getString(ProxyCmdLine::StressReplay, "");
+        stressReplaySpeed                 = parameters.getDouble(ProxyCmdLine::StressReplaySpeed, 0.0);
+        syntheticConfig.NumSubjects       = std::clamp(parameters.getInt(ProxyCmdLine::SyntheticSubjects, syntheticConfig.NumSubjects), 1, 500);
+        syntheticConfig.MarkersPerSubject = std::max(parameters.getInt(ProxyCmdLine::SyntheticMarkers, syntheticConfig.MarkersPerSubject), 0);
+        syntheticConfig.NumUnlabeled      = std::clamp(parameters.getInt(ProxyCmdLine::SyntheticUnlabeled, syntheticConfig.NumUnlabeled), 0, 10000);
+        syntheticConfig.FrameRateHz       = parameters.getDouble(ProxyCmdLine::SyntheticRate, syntheticConfig.FrameRateHz);
+        syntheticConfig.ReplayFile        = parameters.getString(ProxyCmdLine::SyntheticReplay, "");
     }
     PortNumber = FindAvailableTCPPortNumber(PortNumber);
 
     // Set global profiling flag - controls Tracy profiling in all components
     CTrack::SetProfilingEnabled(profiling);
+    if (parameters.isInitializedFromJson() && parameters.getJsonObject().contains(ProxyCmdLine::ProfilingControl))
+    {
+        try
+        {
+            CTrack::ConfigureProfiling(parameters.getJsonObject()[ProxyCmdLine::ProfilingControl]);
+        }
+        catch (const std::exception &e)
+        {
+            PrintError("profiling_control ignored : {}", e.what());
+        }
+    }
+    CTrack::FrameTiming::SetTrailerEnabled(timestamps);
+    CTrack::CMetricsRegistry::Instance().SetLogInterval(metricsLog);
+    size_t flightRecorderEntries = flightRecorder > 0 ? std::clamp<size_t>(flightRecorder, CTrack::FlightRecorder::MIN_ENTRIES_PER_THREAD,
+                                                                           CTrack::FlightRecorder::MAX_ENTRIES_PER_THREAD)
+                                                      : 0;
+    CTrack::FlightRecorder::SetEnabled(flightRecorder > 0, flightRecorderEntries);
 
     ShowConsole(showConsole);
     if (showConsole)
@@ -59,6 +99,8 @@ int main(int argc, char *argv[])
         PrintInfo("t : stop track");
         PrintInfo("z : start stress test");
         PrintInfo("y : stop stress test");
+        PrintInfo("m : start/stop multi-client stress test");
+        PrintInfo("f : dump the flight recorder as Chrome trace");
 #ifdef TRACY_ENABLE
         if (CTrack::IsProfilingEnabled())
         {
@@ -69,10 +111,24 @@ int main(int argc, char *argv[])
             PrintInfo("Tracy profiling DISABLED (use profiling=true in settings to enable)");
         }
 #endif
+        if (synthetic)
+        {
+            PrintInfo("Synthetic Vicon stream : {} subjects x {} markers, {} unlabeled at {} Hz", syntheticConfig.NumSubjects,
+                      syntheticConfig.MarkersPerSubject, syntheticConfig.NumUnlabeled, syntheticConfig.FrameRateHz);
+        }
     }
 
     // startup server object
-    std::unique_ptr<DriverVicon>      driver = std::make_unique<DriverVicon>();
+    std::unique_ptr<IViconClient> client;
+    if (synthetic)
+    {
+        client = std::make_unique<ViconSyntheticClient>(syntheticConfig);
+    }
+    else
+    {
+        client = std::make_unique<ViconSDKClient>();
+    }
+    std::unique_ptr<DriverVicon>      driver = std::make_unique<DriverVicon>(std::move(client));
     CCommunicationObject              TCPServer;
     std::vector<CTrack::Subscription> subscriptions;
     std::unique_ptr<CTrack::Message>  manualMessage;
@@ -80,6 +136,7 @@ int main(int argc, char *argv[])
 
     // Stress test object - initialized after message responder is set up
     std::unique_ptr<StressTest>       stressTest;
+    ClientStressTest                  clientStress(PortNumber);
 
     TCPServer.SetOnConnectFunction([](SOCKET, size_t numConnections) { PrintInfo("connected : {}", numConnections); });
     TCPServer.SetOnDisconnectFunction([](SOCKET, size_t numConnections) { PrintWarning("DISCONNNECTED : {}", numConnections); });
@@ -97,6 +154,10 @@ int main(int argc, char *argv[])
     driver->Subscribe(*TCPServer.GetMessageResponder(), TAG_COMMAND_CONFIGDETECT, CTrack::MakeMemberHandler(driver.get(), &DriverVicon::ConfigDetect));
     driver->Subscribe(*TCPServer.GetMessageResponder(), TAG_COMMAND_CHECKINIT, CTrack::MakeMemberHandler(driver.get(), &DriverVicon::CheckInitialize));
     driver->Subscribe(*TCPServer.GetMessageResponder(), TAG_COMMAND_SHUTDOWN, CTrack::MakeMemberHandler(driver.get(), &DriverVicon::ShutDown));
+    driver->Subscribe(*TCPServer.GetMessageResponder(), ProxyMsg::Diagnostics, &CTrack::FrameTiming::OnDiagnostics);
+    driver->Subscribe(*TCPServer.GetMessageResponder(), ProxyMsg::Metrics, &CTrack::CMetricsRegistry::OnMetrics);
+    driver->Subscribe(*TCPServer.GetMessageResponder(), ProxyMsg::DumpTrace, &CTrack::FlightRecorder::OnDumpTrace);
+    driver->Subscribe(*TCPServer.GetMessageResponder(), ProxyMsg::Profiling, &CTrack::OnProfiling);
 
     TCPServer.Open(TCP_SERVER, PortNumber);
     PrintInfo("Server started on port {}", PortNumber);
@@ -104,9 +165,40 @@ int main(int argc, char *argv[])
     // Initialize stress test after message responder is available
     stressTest = std::make_unique<StressTest>(driver.get(), TCPServer.GetMessageResponder());
 
+    if (parameters.isInitializedFromJson() && parameters.getJsonObject().contains(ProxyCmdLine::StressClients))
+    {
+        clientStress.Start(ClientStressConfig::FromJson(parameters.getJsonObject()[ProxyCmdLine::StressClients]));
+    }
+
+    // unattended replay, the proxy ends with the verdict as exit code
+    int exitCode = 0;
+    if (!stressReplay.empty())
+    {
+        try
+        {
+            StressTest::ReplayScript script = StressTest::ReplayScript::Load(stressReplay);
+            if (stressReplaySpeed > 0.0)
+            {
+                script.Speed = stressReplaySpeed;
+            }
+            stressTest->StartReplay(script);
+        }
+        catch (const std::exception &e)
+        {
+            PrintError("{}", e.what());
+            exitCode      = 1;
+            bContinueLoop = false;
+        }
+    }
+
 
     while (bContinueLoop)
     {
+        if (!stressReplay.empty() && !stressTest->IsRunning())
+        {
+            exitCode      = stressTest->GetState() == StressTest::TestState::Error ? 1 : 0;
+            bContinueLoop = false;
+        }
         CTRACK_FRAME_MARK();
         try
         {
@@ -156,7 +248,7 @@ int main(int argc, char *argv[])
                 std::vector<double> arValues;
                 if (driver->GetValues(arValues))
                 {
-                    std::unique_ptr<CTCPGram> TCPGRam = std::make_unique<CTCPGram>(arValues);
+                    std::unique_ptr<CTCPGram> TCPGRam = std::make_unique<CTCPGram>(arValues, driver->GetAcquireTimeNs());
                     TCPServer.PushSendPackage(TCPGRam);
                 }
             }
@@ -226,6 +318,30 @@ int main(int argc, char *argv[])
                         }
                     };
                     break;
+                    case 'm':
+                    {
+                        if (clientStress.IsRunning())
+                        {
+                            clientStress.Stop();
+                        }
+                        else
+                        {
+                            clientStress.Start(ClientStressConfig());
+                        }
+                    };
+                    break;
+                    case 'f':
+                    {
+                        if (CTrack::FlightRecorder::IsEnabled())
+                        {
+                            manualMessage = std::make_unique<CTrack::Message>(ProxyMsg::DumpTrace);
+                        }
+                        else
+                        {
+                            PrintWarning("Flight recorder is off, start the proxy with flight_recorder=<entries per thread>");
+                        }
+                    };
+                    break;
                 }
             }
         }
@@ -234,12 +350,14 @@ int main(int argc, char *argv[])
             PrintError("An error occurred : {}", e.what());
             std::unique_ptr<CTCPGram> TCPGRam = std::make_unique<CTCPGram>(e);
             TCPServer.PushSendPackage(TCPGRam);
+            CTrack::FlightRecorder::DumpOnError(e.what());
         }
         catch (...)
         {
             PrintError("An unknown error occurred");
             std::unique_ptr<CTCPGram> TCPGRam = std::make_unique<CTCPGram>("An unknown error occurred", TCPGRAM_CODE_ERROR);
             TCPServer.PushSendPackage(TCPGRam);
+            CTrack::FlightRecorder::DumpOnError("unknown error");
         }
     }
     // Stop stress test if running
@@ -249,8 +367,9 @@ int main(int argc, char *argv[])
         stressTest->Stop();
     }
     stressTest.reset();
+    clientStress.Stop();
 
     PrintInfo("Closing server");
     TCPServer.Close();
-    return 0;
+    return exitCode;
 }